@@ -62,7 +62,8 @@ MEMORY
     INFOB                   : origin = 0x1900, length = 0x0080
     INFOC                   : origin = 0x1880, length = 0x0080
     INFOD                   : origin = 0x1800, length = 0x0080
-    FLASH                   : origin = 0x4400, length = 0xBB80
+    FLASH                   : origin = 0x4400, length = 0x9A00
+    SPOOL                   : origin = 0xDE00, length = 0x2000 /* spool.h log - 16 segments of 512 */
     FLASH2                  : origin = 0x10000,length = 0x14400
     INT00                   : origin = 0xFF80, length = 0x0002
     INT01                   : origin = 0xFF82, length = 0x0002
@@ -161,6 +162,9 @@ SECTIONS
     .mspabi.exidx : {} > FLASH              /* C++ Constructor tables            */
     .mspabi.extab : {} > FLASH              /* C++ Constructor tables            */
 
+    .spool     : {} > SPOOL, type = NOLOAD  /* Overflow spool log (spool.h)   */
+    .dumpram   : {} > USBRAM, type = NOLOAD /* traceDump/recordDump (trace.h, record.h) - USB unused */
+
     .infoA     : {} > INFOA              /* MSP430 INFO FLASH Memory segments */
     .infoB     : {} > INFOB
     .infoC     : {} > INFOC
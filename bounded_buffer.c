@@ -0,0 +1,609 @@
+/*
+ * bounded_buffer.c
+ *
+ * Bounded buffer objects - see bounded_buffer.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/gates/GateMutexPri.h>
+#include <xdc/runtime/Log.h>
+
+#include "bounded_buffer.h"
+#include "latency.h"
+#include "record.h"
+#include "cpuacct.h"
+#include "spool.h"
+
+#define BB_POOL_ALIGN	sizeof(UInt32)		// every storage block starts on a 32-bit boundary
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The buffer objects and the storage memory of their slots (no heap - BIOS.heapSize = 0).
+ */
+static BoundedBuffer_T bbObjects[BB_MAX_BUFFERS];
+static BBLanes_T bbLanes[BB_MAX_LANE_BUFFERS];
+static UInt32 bbPool[BB_POOL_SIZE / sizeof(UInt32)];
+
+static Int numBuffers = 0;		// buffer objects used
+static Int numLaneBuffers = 0;	// lane state objects used
+static SizeT poolUsed = 0;		// bytes of bbPool used
+static BoundedBuffer_T *spoolOwner = NULL;	// the buffer with bbPolicySpool_e
+
+
+/*
+ * Function: poolAlloc
+ * Description: take "size" bytes from the storage pool.
+ * Input: SizeT size - bytes wanted.
+ * Output: Ptr - the block, NULL if the pool is exhausted.
+ * Algorithm: bump allocation, rounded up to BB_POOL_ALIGN - buffers are never destroyed.
+*/
+static Ptr poolAlloc(SizeT size)
+{
+	Ptr block;
+
+	size = (size + BB_POOL_ALIGN - 1) & ~(BB_POOL_ALIGN - 1);
+	if(poolUsed + size > sizeof(bbPool)) {
+		return NULL;
+	}
+	block = (Ptr)((UInt8 *)bbPool + poolUsed);
+	poolUsed = poolUsed + size;
+	return block;
+}
+
+/*
+ * Function: constructMutex
+ * Description: construct the mutex of a new buffer.
+ * Input: BoundedBuffer_T *bb - the buffer.
+ * Output: void
+ * Algorithm: a GateMutexPri with BB_MUTEX_PI, a binary semaphore (mutex = 1) without - both
+ * 			  named "mutex"; the other handle is left NULL.
+*/
+static Void constructMutex(BoundedBuffer_T *bb)
+{
+#if BB_MUTEX_PI
+	GateMutexPri_Params gateParams;
+
+	GateMutexPri_Params_init(&gateParams);
+	gateParams.instance->name = "mutex";
+	GateMutexPri_construct(&bb->gateObj, &gateParams);
+	bb->gate = GateMutexPri_handle(&bb->gateObj);
+	bb->mutex = NULL;
+#else
+	Semaphore_Params semParams;
+
+	Semaphore_Params_init(&semParams);
+	semParams.instance->name = "mutex";
+	semParams.mode = Semaphore_Mode_BINARY;
+	Semaphore_construct(&bb->mutexObj, 1, &semParams);
+	bb->mutex = Semaphore_handle(&bb->mutexObj);
+	bb->gate = NULL;
+#endif
+}
+
+/*
+ * Function: BoundedBuffer_create
+ * Description: create an empty bounded buffer from the static pools.
+ * Input: BBEngine_E engine - queue engine, Int capacity - number of slots (power of two).
+ * Output: BoundedBuffer_Handle - the buffer, NULL on failure.
+ * Algorithm: check the capacity, take the object and the engine's storage (Int slots or MPMC
+ * 			  cells, plus the slots' latency tags with LATENCY_TRACE) from the pools, initialise
+ * 			  the storage like initArray (-1 everywhere) or the ring, and construct the buffer's
+ * 			  three semaphores.
+*/
+BoundedBuffer_Handle BoundedBuffer_create(BBEngine_E engine, Int capacity)
+{
+	BoundedBuffer_T *bb;
+	Semaphore_Params semParams;
+	Ptr storage;
+	RingTag_T *tags = NULL;
+	Int i = 0;
+
+	if(engine == bbEngineLanes_e) {
+		return BoundedBuffer_createLanes(2, capacity, 0);	// a routine and an urgent lane
+	}
+	if(capacity <= 0 || (capacity & (capacity - 1)) != 0) {
+		Log_info1("ERROR! Bounded buffer capacity %d is not a power of two.\n", capacity); //error log
+		return NULL;
+	}
+	if(numBuffers == BB_MAX_BUFFERS) {
+		Log_info0("ERROR! No free bounded buffer object.\n"); //error log
+		return NULL;
+	}
+	if(engine == bbEngineMpmc_e) {
+		storage = poolAlloc(capacity * sizeof(MpmcCell_T));
+	} else {
+		storage = poolAlloc(capacity * sizeof(Int));
+	}
+#if LATENCY_TRACE
+	if(storage != NULL) {
+		tags = (RingTag_T *)poolAlloc(capacity * sizeof(RingTag_T));
+		storage = (tags == NULL) ? NULL : storage;
+	}
+#endif
+	if(storage == NULL) {
+		Log_info1("ERROR! Bounded buffer pool exhausted, %d bytes left.\n", BoundedBuffer_poolFree()); //error log
+		return NULL;
+	}
+
+	bb = &bbObjects[numBuffers];
+	numBuffers++;
+	bb->engine = engine;
+	bb->capacity = capacity;
+	bb->mask = capacity - 1;
+	bb->storage = NULL;
+	bb->in = 0;
+	bb->out = 0;
+	bb->count = 0;
+	bb->tags = tags;
+	BoundedBuffer_setPolicy(bb, bbPolicyBlock_e, 0);
+	bb->isrStats.inserts = 0;
+	bb->isrStats.overflows = 0;
+	bb->isrStats.busy = 0;
+	bb->cellWaits = 0;
+
+	switch(engine) {
+	case bbEngineSpsc_e:
+		bb->storage = (volatile Int *)storage;
+		SpscRing_init(&bb->spsc, bb->storage, capacity);
+		SpscRing_setTags(&bb->spsc, tags);
+		break;
+	case bbEngineMpmc_e:
+		MpmcRing_init(&bb->mpmc, (MpmcCell_T *)storage, capacity);
+		MpmcRing_setTags(&bb->mpmc, tags);
+		break;
+	default:
+		bb->storage = (volatile Int *)storage;
+		for(i = 0 ; i < capacity ; i++) {
+			bb->storage[i] = -1;		// -1 marks an empty slot
+		}
+		break;
+	}
+
+	Semaphore_Params_init(&semParams);
+	semParams.instance->name = "emptySlots";
+	Semaphore_construct(&bb->emptySlotsObj, capacity, &semParams);
+	semParams.instance->name = "fullSlots";
+	Semaphore_construct(&bb->fullSlotsObj, 0, &semParams);
+	bb->emptySlots = Semaphore_handle(&bb->emptySlotsObj);
+	bb->fullSlots = Semaphore_handle(&bb->fullSlotsObj);
+	constructMutex(bb);
+	bb->lanes = 1;
+	bb->laneState = NULL;
+	bb->laneEmpty = &bb->emptySlots;
+
+	return bb;
+}
+
+/*
+ * Function: BoundedBuffer_createLanes
+ * Description: create an empty priority lanes buffer from the static pools.
+ * Input: Int lanes - 1, 2 or 4, Int capacity - total slots, UInt starveQuota - 0 for strict priority.
+ * Output: BoundedBuffer_Handle - the buffer, NULL on failure.
+ * Algorithm: check the geometry and that the pools hold the lane state and every lane (so a
+ * 			  failure takes nothing from them), then give every lane its MPMC cells (and latency
+ * 			  tags) and its laneEmpty counting semaphore; fullSlots and mutex as for the other
+ * 			  engines.
+*/
+BoundedBuffer_Handle BoundedBuffer_createLanes(Int lanes, Int capacity, UInt starveQuota)
+{
+	BoundedBuffer_T *bb;
+	BBLanes_T *ls;
+	Semaphore_Params semParams;
+	Int laneCapacity = 0;
+	SizeT laneBytes = 0;
+	Int l = 0;
+
+	if((lanes == 1 || lanes == 2 || lanes == 4) && lanes <= BB_MAX_LANES) {
+		laneCapacity = capacity / lanes;
+	}
+	if(laneCapacity < 2 || (laneCapacity & (laneCapacity - 1)) != 0 || laneCapacity * lanes != capacity) {
+		Log_info2("ERROR! Can't split a bounded buffer of %d slots into %d power of two lanes.\n", capacity, lanes); //error log
+		return NULL;
+	}
+	if(numBuffers == BB_MAX_BUFFERS) {
+		Log_info0("ERROR! No free bounded buffer object.\n"); //error log
+		return NULL;
+	}
+	if(numLaneBuffers == BB_MAX_LANE_BUFFERS) {
+		Log_info0("ERROR! No free lane state object - raise BB_MAX_LANE_BUFFERS.\n"); //error log
+		return NULL;
+	}
+	laneBytes = (laneCapacity * sizeof(MpmcCell_T) + BB_POOL_ALIGN - 1) & ~(BB_POOL_ALIGN - 1);
+#if LATENCY_TRACE
+	laneBytes = laneBytes + ((laneCapacity * sizeof(RingTag_T) + BB_POOL_ALIGN - 1) & ~(BB_POOL_ALIGN - 1));
+#endif
+	if(laneBytes * lanes > (SizeT)BoundedBuffer_poolFree()) {
+		Log_info1("ERROR! Bounded buffer pool exhausted, %d bytes left.\n", BoundedBuffer_poolFree()); //error log
+		return NULL;
+	}
+
+	bb = &bbObjects[numBuffers];
+	numBuffers++;
+	ls = &bbLanes[numLaneBuffers];
+	numLaneBuffers++;
+	bb->engine = bbEngineLanes_e;
+	bb->capacity = capacity;
+	bb->mask = laneCapacity - 1;
+	bb->storage = NULL;
+	bb->in = 0;
+	bb->out = 0;
+	bb->count = 0;
+	bb->tags = NULL;
+	bb->lanes = lanes;
+	bb->laneState = ls;
+	bb->laneEmpty = ls->empty;
+	ls->starveQuota = starveQuota;
+	ls->highStreak = 0;
+	ls->starvePromotions = 0;
+	BoundedBuffer_setPolicy(bb, bbPolicyBlock_e, 0);
+	bb->isrStats.inserts = 0;
+	bb->isrStats.overflows = 0;
+	bb->isrStats.busy = 0;
+	bb->cellWaits = 0;
+
+	Semaphore_Params_init(&semParams);
+	semParams.instance->name = "emptySlots";
+	for(l = 0 ; l < lanes ; l++) {
+		MpmcRing_init(&ls->ring[l], (MpmcCell_T *)poolAlloc(laneCapacity * sizeof(MpmcCell_T)), laneCapacity);
+#if LATENCY_TRACE
+		MpmcRing_setTags(&ls->ring[l], (RingTag_T *)poolAlloc(laneCapacity * sizeof(RingTag_T)));
+#endif
+		Semaphore_construct(&ls->emptyObj[l], laneCapacity, &semParams);
+		ls->empty[l] = Semaphore_handle(&ls->emptyObj[l]);
+		ls->taken[l] = 0;
+	}
+	semParams.instance->name = "fullSlots";
+	Semaphore_construct(&bb->fullSlotsObj, 0, &semParams);
+	bb->emptySlots = ls->empty[0];
+	bb->fullSlots = Semaphore_handle(&bb->fullSlotsObj);
+	constructMutex(bb);
+
+	return bb;
+}
+
+/*
+ * Function: BoundedBuffer_lock
+ * Description: enter the critical section of a locked engine buffer.
+ * Input: BoundedBuffer_Handle bb - the buffer.
+ * Output: IArg - the key for BoundedBuffer_unlock.
+ * Algorithm: GateMutexPri_enter, or a pend on the binary semaphore - a block is charged to
+ * 			  cpuWaitMutex_e either way (cpuacct.h).
+*/
+IArg BoundedBuffer_lock(BoundedBuffer_Handle bb)
+{
+#if BB_MUTEX_PI
+	IArg key;
+
+	cpuAcctWait = cpuWaitMutex_e;
+	key = GateMutexPri_enter(bb->gate);
+	cpuAcctWait = cpuWaitOther_e;
+	return key;
+#else
+	CPUACCT_PEND(bb->mutex, BIOS_WAIT_FOREVER, cpuWaitMutex_e);
+	return 0;
+#endif
+}
+
+Void BoundedBuffer_unlock(BoundedBuffer_Handle bb, IArg key)
+{
+#if BB_MUTEX_PI
+	GateMutexPri_leave(bb->gate, key);
+#else
+	(Void)key;
+	Semaphore_post(bb->mutex);
+#endif
+}
+
+/*
+ * Function: BoundedBuffer_tryLockIsr
+ * Description: enter the critical section from a Hwi/Swi, if it is free.
+ * Input: BoundedBuffer_Handle bb - the buffer.
+ * Output: Bool - TRUE if entered.
+ * Algorithm: a BIOS_NO_WAIT pend on the binary semaphore. A GateMutexPri can't be entered
+ * 			  outside a Task at all, so with BB_MUTEX_PI it is always FALSE.
+*/
+Bool BoundedBuffer_tryLockIsr(BoundedBuffer_Handle bb)
+{
+#if BB_MUTEX_PI
+	(Void)bb;
+	return FALSE;
+#else
+	return Semaphore_pend(bb->mutex, BIOS_NO_WAIT);
+#endif
+}
+
+Void BoundedBuffer_unlockIsr(BoundedBuffer_Handle bb)
+{
+#if BB_MUTEX_PI
+	(Void)bb;
+#else
+	Semaphore_post(bb->mutex);
+#endif
+}
+
+/*
+ * Function: countEvent
+ * Description: add one to a backpressure counter.
+ * Input: UInt32 *counter - a policyStats field.
+ * Output: void
+ * Algorithm: a short Hwi_disable window, as several producers may count at once.
+*/
+static Void countEvent(UInt32 *counter)
+{
+	UInt key = Hwi_disable();
+	*counter = *counter + 1;
+	Hwi_restore(key);
+}
+
+/*
+ * Function: BoundedBuffer_awaitCell
+ * Description: wait for a claimed ring cell to be published.
+ * Input: BoundedBuffer_Handle bb, Int attempt - retries so far (0 on the first).
+ * Output: Bool - FALSE once the wait is given up.
+ * Algorithm: the claimer is a preempted Task. Task_yield runs it if it has the caller's priority;
+ * 			  if it is of a lower priority only a blocked caller lets it run, so from
+ * 			  BB_CELL_YIELDS retries on the caller sleeps a tick per retry.
+*/
+Bool BoundedBuffer_awaitCell(BoundedBuffer_Handle bb, Int attempt)
+{
+	if(attempt == 0) {
+		countEvent(&bb->cellWaits);
+	}
+	if(attempt < BB_CELL_YIELDS) {
+		Task_yield();
+		return TRUE;
+	}
+	if(attempt >= BB_CELL_YIELDS + BB_CELL_WAIT_TICKS) {
+		return FALSE;
+	}
+	CPUACCT_SLEEP(1);
+	return TRUE;
+}
+
+Void BoundedBuffer_setPolicy(BoundedBuffer_Handle bb, BBPolicy_E policy, UInt param)
+{
+	if(policy == bbPolicyDropOldest_e && bb->engine == bbEngineSpsc_e) {
+		Log_info0("ERROR! A SPSC ring can't drop its oldest item, dropping the newest instead.\n"); //error log
+		policy = bbPolicyDropNewest_e;
+	}
+	if(policy == bbPolicySpool_e && (bb->engine == bbEngineSpsc_e || bb->engine == bbEngineLanes_e ||
+			(spoolOwner != NULL && spoolOwner != bb))) {
+		Log_info0("ERROR! The spool is taken, or can't serve this engine - blocking instead.\n"); //error log
+		policy = bbPolicyBlock_e;
+	}
+	if(policy == bbPolicySpool_e) {
+		spoolOwner = bb;
+		param = (param == 0 || param > (UInt)bb->capacity) ? (UInt)bb->capacity : param;
+		Spool_init();
+	}
+	bb->policy = policy;
+	bb->policyParam = param;
+	bb->sampleCount = 0;
+	bb->policyStats.drops = 0;
+	bb->policyStats.timeouts = 0;
+	bb->policyStats.overwrites = 0;
+}
+
+/*
+ * Function: BoundedBuffer_reserveSlot
+ * Description: take a free slot token of a lane as the buffer's backpressure policy allows.
+ * Input: BoundedBuffer_Handle bb, Int lane - the item's lane (0 for the single-lane engines).
+ * Output: BBStatus_E - see bounded_buffer.h.
+ * Algorithm: every policy but bbPolicyBlock_e first tries a BIOS_NO_WAIT pend - a free slot is
+ * 			  taken at once whatever the policy. When there is none: bbPolicyTimeout_e pends for
+ * 			  policyParam ticks, bbPolicySample_e keeps (and blocks for) one of every policyParam
+ * 			  items, bbPolicyDropOldest_e takes an item token on fullSlots to evict - and if the
+ * 			  consumers hold all of those (they are just removing items), simply waits for the slot
+ * 			  their removal frees. Several producers sample at once, so sampleCount is counted in
+ * 			  one Hwi_disable window with its drop - no lost count, no two producers kept for one. The pends that may fail are RECORD_PENDs (record.h), the ones
+ * 			  that may block CPUACCT_PENDs (cpuacct.h).
+*/
+BBStatus_E BoundedBuffer_reserveSlot(BoundedBuffer_Handle bb, Int lane)
+{
+	Semaphore_Handle emptySem = bb->laneEmpty[lane];
+	Bool keep = FALSE;
+	UInt key;
+
+	if(bb->policy == bbPolicyBlock_e || bb->policy == bbPolicySpool_e) {	// the spool step came first
+		CPUACCT_PEND(emptySem, BIOS_WAIT_FOREVER, cpuWaitEmptySlots_e);
+		return bbInsertOk_e;
+	}
+	if(RECORD_PEND(emptySem, BIOS_NO_WAIT)) {
+		return bbInsertOk_e;
+	}
+
+	switch(bb->policy) {
+	case bbPolicyTimeout_e:
+		if(!RECORD_RESULT(CPUACCT_PEND(emptySem, bb->policyParam, cpuWaitEmptySlots_e))) {
+			countEvent(&bb->policyStats.timeouts);
+			return bbInsertTimeout_e;
+		}
+		return bbInsertOk_e;
+	case bbPolicySample_e:
+		key = Hwi_disable();		// several producers count at once - one read-modify-write each
+		bb->sampleCount = bb->sampleCount + 1;
+		keep = (bb->sampleCount >= bb->policyParam);
+		if(keep) {
+			bb->sampleCount = 0;
+		} else {
+			bb->policyStats.drops = bb->policyStats.drops + 1;
+		}
+		Hwi_restore(key);
+		if(!keep) {
+			return bbInsertDropped_e;
+		}
+		CPUACCT_PEND(emptySem, BIOS_WAIT_FOREVER, cpuWaitEmptySlots_e);
+		return bbInsertOk_e;
+	case bbPolicyDropOldest_e:
+		if(RECORD_PEND(bb->fullSlots, BIOS_NO_WAIT)) {
+			return bbInsertOverwrote_e;
+		}
+		CPUACCT_PEND(emptySem, BIOS_WAIT_FOREVER, cpuWaitEmptySlots_e);
+		return bbInsertOk_e;
+	default:
+		countEvent(&bb->policyStats.drops);
+		return bbInsertDropped_e;
+	}
+}
+
+/*
+ * Function: BoundedBuffer_spoolItem
+ * Description: append the item to the overflow spool, if the buffer's high-water mark says so.
+ * Input: BoundedBuffer_Handle bb - a bbPolicySpool_e buffer, Int item.
+ * Output: BBStatus_E - see bounded_buffer.h.
+ * Algorithm: an empty spool and a count below policyParam go straight to the buffer - no lock.
+ * 			  Otherwise decide again under the spool's lock, which the consumers hold while they
+ * 			  move items back: a spool found empty there has put all its items into the buffer,
+ * 			  so an item inserted now comes after them.
+*/
+BBStatus_E BoundedBuffer_spoolItem(BoundedBuffer_Handle bb, Int item)
+{
+	BBStatus_E status = bbInsertSpooled_e;
+	IArg key;
+
+	if(Spool_pending() == 0 && BoundedBuffer_count(bb) < (Int)bb->policyParam) {
+		return bbInsertOk_e;
+	}
+	key = Spool_lock();
+	if(Spool_pending() == 0 && BoundedBuffer_count(bb) < (Int)bb->policyParam) {
+		status = bbInsertOk_e;
+	} else if(!Spool_append(item)) {
+		countEvent(&bb->policyStats.drops);
+		status = bbInsertDropped_e;
+	}
+	Spool_unlock(key);
+	return status;
+}
+
+/*
+ * Function: BoundedBuffer_evictOldest
+ * Description: discard the oldest item of a lane, to overwrite it.
+ * Input: BoundedBuffer_Handle bb, Int lane.
+ * Output: Bool - TRUE if an item was discarded.
+ * Algorithm: pop it from the lane's MPMC ring like a consumer would (its latency tag is dropped
+ * 			  with it) - the caller's fullSlots token stands for the consumer's.
+*/
+Bool BoundedBuffer_evictOldest(BoundedBuffer_Handle bb, Int lane)
+{
+	MpmcRing_T *ring = (bb->engine == bbEngineLanes_e) ? &bb->laneState->ring[lane] : &bb->mpmc;
+	RingTag_T tag;
+	Int item;
+
+	if(!MpmcRing_popTagged(ring, &item, &tag)) {
+		return FALSE;
+	}
+	countEvent(&bb->policyStats.overwrites);
+	return TRUE;
+}
+
+/*
+ * Function: BoundedBuffer_popLane
+ * Description: take one item of a lanes buffer, highest non-empty lane first.
+ * Input: BoundedBuffer_Handle bb, Int *item - receives the item, RingTag_T *tag - receives its tag.
+ * Output: Int - the lane the item came from.
+ * Algorithm: scan the lanes from the most urgent down - or, once highStreak reached starveQuota,
+ * 			  from lane 0 up - and pop the first item found. The caller's fullSlots token only
+ * 			  guarantees a claimed cell: a scan misses when that cell is not published yet (or
+ * 			  another consumer took an item under it), so wait (BoundedBuffer_awaitCell) and
+ * 			  scan again - -1 if the wait is given up. highStreak counts the items
+ * 			  taken in a row while a lower lane was waiting. The counters are statistics - a
+ * 			  lost update between two racing consumers is harmless.
+*/
+Int BoundedBuffer_popLane(BoundedBuffer_Handle bb, Int *item, RingTag_T *tag)
+{
+	BBLanes_T *ls = bb->laneState;
+	Bool lowFirst = (ls->starveQuota != 0 && ls->highStreak >= ls->starveQuota);
+	Bool waiting = FALSE;
+	Int l = 0;
+	Int other = 0;
+	Int attempt = 0;
+
+	while(1) {
+		if(lowFirst) {
+			for(l = 0 ; l < bb->lanes && !MpmcRing_popTagged(&ls->ring[l], item, tag) ; l++) {
+			}
+			if(l < bb->lanes) {
+				break;
+			}
+		} else {
+			for(l = bb->lanes - 1 ; l >= 0 && !MpmcRing_popTagged(&ls->ring[l], item, tag) ; l--) {
+			}
+			if(l >= 0) {
+				break;
+			}
+		}
+		if(!BoundedBuffer_awaitCell(bb, attempt)) {
+			return -1;
+		}
+		attempt = attempt + 1;
+	}
+
+	if(lowFirst) {
+		for(other = l + 1 ; other < bb->lanes ; other++) {
+			waiting = waiting || (MpmcRing_count(&ls->ring[other]) != 0);
+		}
+		if(waiting) {
+			ls->starvePromotions = ls->starvePromotions + 1;	// overtook an urgent item
+		}
+		ls->highStreak = 0;
+	} else {
+		for(other = 0 ; other < l ; other++) {
+			waiting = waiting || (MpmcRing_count(&ls->ring[other]) != 0);
+		}
+		ls->highStreak = waiting ? ls->highStreak + 1 : 0;
+	}
+	ls->taken[l] = ls->taken[l] + 1;
+	return l;
+}
+
+/*
+ * Function: BoundedBuffer_count
+ * Description: number of currently full slots, for Logs.
+ * Input: BoundedBuffer_Handle bb.
+ * Output: Int - count (locked engine) or a snapshot of the ring's item count (ring engines).
+ * Algorithm: dispatch on the buffer's engine, a lanes buffer sums its lanes.
+*/
+Int BoundedBuffer_count(BoundedBuffer_Handle bb)
+{
+	Int l = 0;
+	Int n = 0;
+
+	switch(bb->engine) {
+	case bbEngineSpsc_e:
+		return (Int)SpscRing_count(&bb->spsc);
+	case bbEngineMpmc_e:
+		return (Int)MpmcRing_count(&bb->mpmc);
+	case bbEngineLanes_e:
+		for(l = 0 ; l < bb->lanes ; l++) {
+			n = n + (Int)MpmcRing_count(&bb->laneState->ring[l]);
+		}
+		return n;
+	default:
+		return bb->count;
+	}
+}
+
+Int BoundedBuffer_poolFree(void)
+{
+	return (Int)(sizeof(bbPool) - poolUsed);
+}
+
+Int BoundedBuffer_numCreated(void)
+{
+	return numBuffers;
+}
+
+BoundedBuffer_Handle BoundedBuffer_get(Int index)
+{
+	if(index < 0 || index >= numBuffers) {
+		return NULL;
+	}
+	return &bbObjects[index];
+}
@@ -0,0 +1,362 @@
+/*
+ * bounded_buffer.h
+ *
+ * Bounded buffer objects for the producer/consumer pipelines.
+ *
+ * The shared buffer used to be a set of globals - buffer[BUFFER_SIZE], in, out, count and the
+ * static emptySlots/fullSlots/mutex semaphores of empty.cfg - so a device could run exactly one
+ * producer/consumer pipeline, with one buffer size for everything. A BoundedBuffer_T holds all
+ * of that per instance:
+ *
+ *  - its storage, taken from a static pool of BB_POOL_SIZE bytes when the buffer is created, so
+ *    every stream gets the capacity it needs and no RAM is reserved for an unused maximum;
+ *  - its in/out/count indices (locked engine) or its ring (SPSC/MPMC engines, see ring.h);
+ *  - its own emptySlots/fullSlots counting semaphores and mutex.
+ *
+ * With LATENCY_TRACE (latency.h) every slot also has a RingTag_T - 8 more bytes per slot from the
+ * same pool - which carries the item's insertion timestamp to the consumer.
+ *
+ * Priority lanes (bbEngineLanes_e, BoundedBuffer_createLanes): the capacity is split into K lanes,
+ * each an MPMC ring with its own emptySlots semaphore, under the one fullSlots readiness signal
+ * of the buffer. The lane state (BBLanes_T) comes from a pool of its own, BB_MAX_LANE_BUFFERS
+ * objects, so only a lanes buffer pays its RAM. A producer inserts into the lane of its item (insert_item_lane); a consumer
+ * takes from the highest non-empty lane, so an urgent item no longer waits behind a backlog of
+ * routine ones - except that after starveQuota items in a row were taken from above a waiting
+ * lower lane, the next item comes from the lowest non-empty lane (anti-starvation).
+ *
+ * Backpressure (BoundedBuffer_setPolicy): what insert_item does when the buffer (or the item's
+ * lane) is full. bbPolicyBlock_e waits for a free slot for as long as it takes - the original
+ * behaviour, under which one stalled consumer stalls every producer. The other policies bound
+ * the producer's wait: block for at most "param" ticks, drop the new item, overwrite the oldest
+ * item, or keep only every param-th of the items arriving while full (blocking for those). Every
+ * outcome is returned to the producer as a BBStatus_E and counted in the buffer's policyStats.
+ * bbPolicySpool_e loses nothing while it can: above a high-water mark of param items the new
+ * items go to the overflow spool in flash (spool.h), and the consumers move them back in order.
+ *
+ * The mutex of the locked engine (BoundedBuffer_lock/BoundedBuffer_unlock) is a priority
+ * inheritance GateMutexPri (BB_MUTEX_PI 1), no longer a binary semaphore: with producers and
+ * consumers of different priorities, a low priority Task preempted inside the critical section
+ * by medium priority work kept a high priority Task waiting for the mutex as long as that work
+ * ran - unbounded priority inversion. The owner of a GateMutexPri runs at the priority of its
+ * highest waiter until it leaves, so a waiter is only delayed by the critical section itself.
+ * A GateMutexPri can't be entered from a Hwi/Swi - BB_MUTEX_PI 0 brings the binary semaphore
+ * back for an interrupt producer on a locked engine buffer (try_insert_item, main.c).
+ *
+ * The engine is chosen per buffer too, so a single-producer/single-consumer stream can use the
+ * wait-free SPSC ring while another stream shares one buffer between several tasks.
+ *
+ * A semaphore token of an MPMC ring (bbEngineMpmc_e, bbEngineLanes_e) stands for a claimed cell,
+ * not a published one: a producer can be preempted between its tail CAS and the store that
+ * publishes the cell, while a later producer publishes its own cell and posts fullSlots. The
+ * consumer taking that token finds the head cell unpublished (and the same holds for a
+ * producer behind a consumer that claimed the tail's cell). It waits for the cell with
+ * BoundedBuffer_awaitCell - a Task_yield lets an equal priority claimer finish, a tick's sleep a
+ * lower priority one - and only a cell still unpublished after BB_CELL_WAIT_TICKS is an anomaly.
+ *
+ * The capacity MUST be a power of two: the cyclic "in"/"out" increment is then a mask with
+ * (capacity - 1) instead of % capacity - the MSP430 has no divide instruction, and % is a call
+ * to the run-time library's division routine.
+ *
+ * insert_item/remove_item/insert_items/remove_items (main.c) take the buffer handle - the
+ * producer and consumer Tasks get it as their arg1 (see topology.h).
+ */
+
+#ifndef BOUNDED_BUFFER_H_
+#define BOUNDED_BUFFER_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/gates/GateMutexPri.h>
+
+#include "ring.h"
+
+#ifndef BB_MAX_BUFFERS
+#define BB_MAX_BUFFERS	4		//BoundedBuffer_T objects in the pool
+#endif
+#ifndef BB_POOL_SIZE
+#define BB_POOL_SIZE	256		//Bytes of slot storage shared by all the buffers
+#endif
+#ifndef BB_MUTEX_PI
+#define BB_MUTEX_PI		1		//1 - the locked engine's mutex is a priority inheritance GateMutexPri, 0 - a binary semaphore
+#endif
+#ifndef BB_MAX_LANES
+#define BB_MAX_LANES	4		//Priority lanes of a bbEngineLanes_e buffer
+#endif
+#ifndef BB_MAX_LANE_BUFFERS
+#define BB_MAX_LANE_BUFFERS	1	//BBLanes_T objects in the pool - one per bbEngineLanes_e buffer (at least 1)
+#endif
+#ifndef BB_CELL_YIELDS
+#define BB_CELL_YIELDS	4		//Task_yields while waiting for a claimed ring cell, before sleeping a tick per retry
+#endif
+#ifndef BB_CELL_WAIT_TICKS
+#define BB_CELL_WAIT_TICKS	50	//Ticks slept waiting for one claimed ring cell before it counts as an anomaly
+#endif
+
+
+/*
+ Enum BBEngine_E - the queue engine of a buffer.
+ */
+typedef enum
+{
+	bbEngineLocked_e = 0,	// storage guarded by emptySlots/mutex/fullSlots (4 semaphore ops per item)
+	bbEngineSpsc_e = 1,		// wait-free SPSC ring - valid ONLY with one producer and one consumer Task!
+	bbEngineMpmc_e = 2,		// lock-free MPMC ring (per-slot sequence numbers), any number of Tasks
+	bbEngineLanes_e = 3		// priority lanes - one MPMC ring per lane, highest non-empty lane first
+} BBEngine_E;
+
+
+/*
+ Enum BBPolicy_E - what insert_item does when there is no free slot.
+ */
+typedef enum
+{
+	bbPolicyBlock_e = 0,		// wait forever (the default)
+	bbPolicyTimeout_e = 1,		// wait at most param Clock ticks, then give up
+	bbPolicyDropNewest_e = 2,	// don't wait - the new item is dropped
+	bbPolicyDropOldest_e = 3,	// don't wait - the oldest item is overwritten (not with bbEngineSpsc_e)
+	bbPolicySample_e = 4,		// drop the items arriving while full, except every param-th - wait for that one
+	bbPolicySpool_e = 5			// from param items in the buffer on, append to the overflow spool (spool.h)
+} BBPolicy_E;
+
+
+/*
+ Enum BBStatus_E - outcome of insert_item.
+ */
+typedef enum
+{
+	bbInsertOk_e = 0,			// inserted
+	bbInsertOverwrote_e = 1,	// inserted in place of the oldest item, which is lost (bbPolicyDropOldest_e)
+	bbInsertDropped_e = 2,		// not inserted - the buffer was full (bbPolicyDropNewest_e/bbPolicySample_e)
+	bbInsertTimeout_e = 3,		// not inserted - no free slot within the timeout (bbPolicyTimeout_e)
+	bbInsertError_e = 4,		// abnormal behaviour (a reserved slot was not empty), a Log message was issued
+	bbInsertSpooled_e = 5		// appended to the overflow spool - it reaches the buffer after the items before it
+} BBStatus_E;
+
+
+/*
+ Structure BBPolicyStats_T - backpressure counters of a buffer.
+ */
+typedef struct
+{
+	UInt32 drops;				// items dropped - bbInsertDropped_e
+	UInt32 timeouts;			// inserts given up - bbInsertTimeout_e
+	UInt32 overwrites;			// items lost to bbInsertOverwrote_e
+} BBPolicyStats_T;
+
+
+/*
+ Structure BBIsrStats_T - counters of the inserts from interrupt context (try_insert_item, main.c),
+ written by the one inserting ISR only.
+ */
+typedef struct
+{
+	UInt32 inserts;				// items inserted
+	UInt32 overflows;			// items lost - no free slot, or the mutex was busy (busy included)
+	UInt32 busy;				// items lost because a Task held the mutex (bbEngineLocked_e)
+} BBIsrStats_T;
+
+
+/*
+ Structure BBLanes_T - the lane state of a bbEngineLanes_e buffer - lane 0 is the routine lane,
+ lanes - 1 the most urgent. Taken from a static pool of BB_MAX_LANE_BUFFERS objects by
+ BoundedBuffer_createLanes, so the buffers of the other engines don't carry it.
+ */
+typedef struct
+{
+	MpmcRing_T ring[BB_MAX_LANES];
+	Semaphore_Handle empty[BB_MAX_LANES];	// free slots of every lane
+	Semaphore_Struct emptyObj[BB_MAX_LANES];
+	UInt starveQuota;			// items taken in a row from above a waiting lower lane, 0 - no limit
+	volatile UInt highStreak;	// current such run
+	UInt32 taken[BB_MAX_LANES];	// items removed from every lane
+	UInt32 starvePromotions;	// items taken from a low lane because of starveQuota
+} BBLanes_T;
+
+
+/*
+ Structure BoundedBuffer_T - one bounded buffer with its own storage and synchronization.
+ */
+typedef struct
+{
+	BBEngine_E engine;
+	Int capacity;				// number of slots, a power of two
+	Int mask;					// capacity - 1
+
+	/* locked engine - the former buffer/in/out/count globals */
+	volatile Int *storage;		// an empty slot holds -1
+	volatile Int in;			// next empty slot
+	volatile Int out;			// next full slot
+	volatile Int count;			// number of full slots
+
+	/* ring engines */
+	SpscRing_T spsc;
+	MpmcRing_T mpmc;
+
+	RingTag_T *tags;			// latency tag of every slot (all engines), NULL without LATENCY_TRACE
+
+	/* priority lanes engine */
+	Int lanes;					// 1 for the other engines
+	BBLanes_T *laneState;		// bbEngineLanes_e only, NULL otherwise
+	Semaphore_Handle *laneEmpty;	// free slots of every lane - &emptySlots for the other engines, emptySlots == laneEmpty[0]
+	UInt32 cellWaits;			// ring cells a token holder found claimed but not published yet
+
+	/* backpressure */
+	BBPolicy_E policy;
+	UInt policyParam;			// timeout ticks (bbPolicyTimeout_e) or N (bbPolicySample_e)
+	UInt sampleCount;			// items arriving while full since the last one kept (bbPolicySample_e), under Hwi_disable
+	BBPolicyStats_T policyStats;
+	BBIsrStats_T isrStats;
+
+	Semaphore_Handle emptySlots;
+	Semaphore_Handle fullSlots;
+	Semaphore_Handle mutex;		// BB_MUTEX_PI 0, NULL otherwise
+	GateMutexPri_Handle gate;	// BB_MUTEX_PI 1, NULL otherwise
+	Semaphore_Struct emptySlotsObj;
+	Semaphore_Struct fullSlotsObj;
+	Semaphore_Struct mutexObj;
+	GateMutexPri_Struct gateObj;
+} BoundedBuffer_T;
+
+typedef BoundedBuffer_T *BoundedBuffer_Handle;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: BoundedBuffer_Handle BoundedBuffer_create(BBEngine_E engine, Int capacity)
+
+ Takes a buffer object and its storage from the static pools and initialises an empty buffer:
+ every slot -1 (locked engine) or an empty ring, emptySlots = capacity, fullSlots = 0 and
+ a free mutex. Called from main before BIOS_start. Returns NULL (and issues a Log message) if the
+ capacity is not a power of two or a pool is exhausted.
+ */
+BoundedBuffer_Handle BoundedBuffer_create(BBEngine_E engine, Int capacity);
+
+/*
+ Function: BoundedBuffer_Handle BoundedBuffer_createLanes(Int lanes, Int capacity, UInt starveQuota)
+
+ Creates a bbEngineLanes_e buffer: "lanes" (1, 2 or 4) lanes of capacity / lanes slots each -
+ the per-lane capacity must be a power of two - with laneEmpty[l] = capacity / lanes and
+ fullSlots = 0. Returns NULL (and issues a Log message) on a bad geometry or exhausted pool -
+ BB_MAX_LANE_BUFFERS lanes buffers at most.
+ */
+BoundedBuffer_Handle BoundedBuffer_createLanes(Int lanes, Int capacity, UInt starveQuota);
+
+/*
+ Function: Void BoundedBuffer_setPolicy(BoundedBuffer_Handle bb, BBPolicy_E policy, UInt param)
+
+ Sets the backpressure policy of bb - param is the timeout in Clock ticks (bbPolicyTimeout_e)
+ or N (bbPolicySample_e, keep every N-th item), ignored otherwise. bbPolicyDropOldest_e would
+ make the producer a second consumer of a SPSC ring, so a SPSC buffer gets bbPolicyDropNewest_e
+ instead (with a Log message). bbPolicySpool_e takes the high-water mark as param (0 or more
+ than the capacity - the capacity) and initialises the spool (Spool_init); there is one spool,
+ and it keeps neither lanes nor the single producer of a SPSC ring, so a second spool buffer, a
+ lanes or a SPSC buffer gets bbPolicyBlock_e instead (with a Log message). Call it before the
+ producers run; buffers start with bbPolicyBlock_e.
+ */
+Void BoundedBuffer_setPolicy(BoundedBuffer_Handle bb, BBPolicy_E policy, UInt param);
+
+/*
+ Function: IArg BoundedBuffer_lock(BoundedBuffer_Handle bb)
+ Function: Void BoundedBuffer_unlock(BoundedBuffer_Handle bb, IArg key)
+
+ Enter/leave the critical section of a locked engine buffer (its storage/in/out/count) - Tasks
+ only. BoundedBuffer_lock may block; a block is charged to cpuWaitMutex_e (cpuacct.h).
+ */
+IArg BoundedBuffer_lock(BoundedBuffer_Handle bb);
+Void BoundedBuffer_unlock(BoundedBuffer_Handle bb, IArg key);
+
+/*
+ Function: Bool BoundedBuffer_tryLockIsr(BoundedBuffer_Handle bb)
+ Function: Void BoundedBuffer_unlockIsr(BoundedBuffer_Handle bb)
+
+ Enter the critical section from a Hwi/Swi without waiting - FALSE if a Task holds it, and
+ always FALSE with BB_MUTEX_PI - and leave it again.
+ */
+Bool BoundedBuffer_tryLockIsr(BoundedBuffer_Handle bb);
+Void BoundedBuffer_unlockIsr(BoundedBuffer_Handle bb);
+
+/*
+ Function: BBStatus_E BoundedBuffer_reserveSlot(BoundedBuffer_Handle bb, Int lane)
+
+ The policy step of insert_item: takes a free slot token of lane "lane" (emptySlots for the
+ single-lane engines) as the policy allows. Returns
+  - bbInsertOk_e: the token is taken, insert the item and post fullSlots;
+  - bbInsertOverwrote_e: a fullSlots token is taken instead - remove the oldest item of the
+    lane (BoundedBuffer_evictOldest for the ring engines), insert the new one and post fullSlots;
+  - bbInsertDropped_e/bbInsertTimeout_e: nothing is taken, the item is not inserted.
+ The drops/timeouts are counted here, the overwrites by the caller once it did evict.
+ */
+BBStatus_E BoundedBuffer_reserveSlot(BoundedBuffer_Handle bb, Int lane);
+
+/*
+ Function: BBStatus_E BoundedBuffer_spoolItem(BoundedBuffer_Handle bb, Int item)
+
+ The spool step of insert_item for a bbPolicySpool_e buffer, before BoundedBuffer_reserveSlot.
+ Returns
+  - bbInsertSpooled_e: the buffer holds its high-water mark of items, or the spool isn't empty
+    (the item must come after the spooled ones) - the item was appended to the spool;
+  - bbInsertDropped_e: it would have been, but the spool is full - counted as a drop;
+  - bbInsertOk_e: nothing is spooled and the buffer is below the mark - insert the item as usual.
+ An empty spool below the mark is checked without the spool's lock.
+ */
+BBStatus_E BoundedBuffer_spoolItem(BoundedBuffer_Handle bb, Int item);
+
+/*
+ Function: Bool BoundedBuffer_awaitCell(BoundedBuffer_Handle bb, Int attempt)
+
+ Called by a Task that holds a fullSlots (emptySlots) token of a ring engine buffer but found
+ the head (tail) cell claimed and not published yet, before its attempt-th retry (0, 1, ...):
+ the first BB_CELL_YIELDS retries Task_yield, the later ones sleep a tick. FALSE once
+ BB_CELL_WAIT_TICKS ticks were slept - the cell is not going to be published. Tasks only.
+ */
+Bool BoundedBuffer_awaitCell(BoundedBuffer_Handle bb, Int attempt);
+
+/*
+ Function: Bool BoundedBuffer_evictOldest(BoundedBuffer_Handle bb, Int lane)
+
+ Removes and discards the oldest item of a MPMC or lanes buffer's lane, after
+ BoundedBuffer_reserveSlot returned bbInsertOverwrote_e, and counts the overwrite. Returns FALSE
+ if the lane is empty - the fullSlots token is then for an item of another lane: the caller
+ gives it back and waits for a free slot of its own lane.
+ */
+Bool BoundedBuffer_evictOldest(BoundedBuffer_Handle bb, Int lane);
+
+/*
+ Function: Int BoundedBuffer_popLane(BoundedBuffer_Handle bb, Int *item, RingTag_T *tag)
+
+ Takes one item of a lanes buffer - the caller already holds a fullSlots token - from the
+ highest non-empty lane (or the lowest, when starveQuota is reached). Returns the lane, whose
+ laneEmpty semaphore the caller posts. The token's item may still be unpublished (see above):
+ a scan that finds nothing waits with BoundedBuffer_awaitCell and scans again, and -1 is
+ returned if it gives up.
+ */
+Int BoundedBuffer_popLane(BoundedBuffer_Handle bb, Int *item, RingTag_T *tag);
+
+/*
+ Function: Int BoundedBuffer_count(BoundedBuffer_Handle bb)
+
+ Number of currently full slots - count (locked engine) or a snapshot of the ring's item count,
+ meant for Logs/statistics.
+ */
+Int BoundedBuffer_count(BoundedBuffer_Handle bb);
+
+/*
+ Function: Int BoundedBuffer_poolFree(void)
+
+ Bytes still free in the storage pool.
+ */
+Int BoundedBuffer_poolFree(void);
+
+/*
+ Function: Int BoundedBuffer_numCreated(void)
+ Function: BoundedBuffer_Handle BoundedBuffer_get(Int index)
+
+ Number of buffers created so far, and the index-th one (NULL if there is none) - for reports.
+ */
+Int BoundedBuffer_numCreated(void);
+BoundedBuffer_Handle BoundedBuffer_get(Int index);
+
+#endif /* BOUNDED_BUFFER_H_ */
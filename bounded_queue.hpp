@@ -0,0 +1,337 @@
+/*
+ * bounded_queue.hpp
+ *
+ * BoundedQueue<T, Capacity, SyncPolicy> - the bounded buffer as a header-only C++ template.
+ *
+ * insert_item/remove_item (main.c) and the engines of bounded_buffer.h are written for Int
+ * items, and the locked engine marks an empty slot with -1, so -1 can't be an item. Another
+ * item type - an ADC sample with its channel, a command structure - meant copying the code. The
+ * template takes the item type, the capacity and the synchronization as parameters:
+ *
+ *  - T: any copyable type. Occupancy is tracked by a count, not by a sentinel, so every value of
+ *    T is a legal item.
+ *  - Capacity: a compile-time constant. A power of two wraps the indices with a mask. Any other
+ *    capacity (the 10 slots of the original lab, for instance) wraps with a compare. The choice
+ *    is made at compile time (BqIndex), so neither capacity pays for the other - and there is
+ *    never a division, which the MSP430 would do in a run-time library call.
+ *  - SyncPolicy: how producers and consumers are kept apart.
+ *     - SemaphorePolicy: the lecture's algorithm, as in insert_item. emptySlots and fullSlots
+ *       counting semaphores, and a priority inheritance GateMutexPri around the indices. Tasks
+ *       block while the queue is full or empty.
+ *     - HwiPolicy: the indices are updated with interrupts masked. The queue never blocks, and
+ *       any context may call it - a Hwi feeding a Task, for instance.
+ *     - UnsyncPolicy: no synchronization, for a queue used from one context only.
+ *     - AtomicSpscPolicy: host builds only (C++11 std::atomic). A wait-free single producer/
+ *       single consumer specialization with free-running acquire/release indices, for real
+ *       host threads.
+ *
+ * Every policy provides the same small set of inline hooks (acquireSlot/releaseItem,
+ * acquireItem/releaseSlot, lock/unlock). A hook the policy doesn't need is an empty inline
+ * function, which an optimizing compiler removes.
+ *
+ * The header is C++03 - the MSP430 compiler's C++ - except for AtomicSpscPolicy, which needs
+ * C++11 and is only defined off the target. The SYS/BIOS objects are constructed by the
+ * queue's constructor, so define a queue as a static object (constructed before main) or
+ * construct it before BIOS_start - there is no heap (BIOS.heapSize = 0).
+ *
+ *   static BoundedQueue<Sample_T, 8, SemaphorePolicy> samples;
+ *   samples.push(sample);						// Task - blocks while full
+ *   static BoundedQueue<Int, 16, HwiPolicy> fromIsr;
+ *   fromIsr.tryPush(reading);					// Hwi - FALSE when full
+ *
+ * host/src/queue_bench.cpp checks and times every policy against the C rings of ring.h, on the
+ * host. Nothing here was built with the TI MSP430 compiler, which isn't part of the host
+ * build: the template's code size and cycle counts on the target are not measured, and nothing
+ * says they match insert_item/remove_item's. The application's handlers in main.c are not
+ * ported to it - their tracing, record and latency instrumentation is C.
+ */
+
+#ifndef BOUNDED_QUEUE_HPP_
+#define BOUNDED_QUEUE_HPP_
+
+extern "C" {
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/gates/GateMutexPri.h>
+}
+
+#if !defined(__MSP430__) && __cplusplus >= 201103L
+#include <atomic>
+#define BQ_HAVE_ATOMIC	1		//AtomicSpscPolicy is available
+#else
+#define BQ_HAVE_ATOMIC	0
+#endif
+
+
+//-----------------------------------------
+// Compile-time helpers
+//-----------------------------------------
+
+/*
+ BqStaticAssert<cond> - a C++03 static_assert: BqStaticAssert<false> has no definition, so
+ using it fails the build.
+ */
+template <bool Cond> struct BqStaticAssert;
+template <> struct BqStaticAssert<true> { enum { ok = 1 }; };
+
+template <unsigned N> struct BqIsPow2
+{
+	enum { value = (N != 0 && (N & (N - 1)) == 0) };
+};
+
+/*
+ BqIndex<Capacity> - the cyclic index increment: a mask for a power of two, a compare otherwise.
+ */
+template <unsigned Capacity, bool Pow2 = (BqIsPow2<Capacity>::value != 0)> struct BqIndex
+{
+	static unsigned next(unsigned i) { return (i + 1) & (Capacity - 1); }
+};
+
+template <unsigned Capacity> struct BqIndex<Capacity, false>
+{
+	static unsigned next(unsigned i) { return (i + 1 == Capacity) ? 0 : i + 1; }
+};
+
+
+//-----------------------------------------
+// Synchronization policies
+//-----------------------------------------
+
+/*
+ SemaphorePolicy - emptySlots/fullSlots counting semaphores and a GateMutexPri, like the locked
+ engine of bounded_buffer.h. Tasks only; the BIOS_NO_WAIT pends of tryPush/tryPop are Swi-safe
+ too, but the gate is not - don't call the queue from a Hwi or Swi.
+ */
+class SemaphorePolicy
+{
+public:
+	typedef IArg Key;
+	enum { blocking = 1 };
+
+	explicit SemaphorePolicy(unsigned capacity)
+	{
+		Semaphore_Params semParams;
+		GateMutexPri_Params gateParams;
+
+		Semaphore_Params_init(&semParams);
+		semParams.instance->name = "bqEmptySlots";
+		Semaphore_construct(&emptyObj, (Int)capacity, &semParams);
+		semParams.instance->name = "bqFullSlots";
+		Semaphore_construct(&fullObj, 0, &semParams);
+		GateMutexPri_Params_init(&gateParams);
+		gateParams.instance->name = "bqMutex";
+		GateMutexPri_construct(&gateObj, &gateParams);
+	}
+
+	Bool acquireSlot(UInt timeout) { return Semaphore_pend(Semaphore_handle(&emptyObj), timeout); }
+	Void releaseSlot() { Semaphore_post(Semaphore_handle(&emptyObj)); }
+	Bool acquireItem(UInt timeout) { return Semaphore_pend(Semaphore_handle(&fullObj), timeout); }
+	Void releaseItem() { Semaphore_post(Semaphore_handle(&fullObj)); }
+	Key lock() { return GateMutexPri_enter(GateMutexPri_handle(&gateObj)); }
+	Void unlock(Key key) { GateMutexPri_leave(GateMutexPri_handle(&gateObj), key); }
+
+private:
+	Semaphore_Struct emptyObj;
+	Semaphore_Struct fullObj;
+	GateMutexPri_Struct gateObj;
+};
+
+/*
+ HwiPolicy - a Hwi_disable window around every index update; never blocks, any context.
+ */
+class HwiPolicy
+{
+public:
+	typedef UInt Key;
+	enum { blocking = 0 };
+
+	explicit HwiPolicy(unsigned capacity) { (Void)capacity; }
+
+	Bool acquireSlot(UInt timeout) { (Void)timeout; return TRUE; }	// the count decides, under the lock
+	Void releaseSlot() {}
+	Bool acquireItem(UInt timeout) { (Void)timeout; return TRUE; }
+	Void releaseItem() {}
+	Key lock() { return Hwi_disable(); }
+	Void unlock(Key key) { Hwi_restore(key); }
+};
+
+/*
+ UnsyncPolicy - nothing at all: one context owns the queue (or already holds a lock around it).
+ */
+class UnsyncPolicy
+{
+public:
+	typedef UInt Key;
+	enum { blocking = 0 };
+
+	explicit UnsyncPolicy(unsigned capacity) { (Void)capacity; }
+
+	Bool acquireSlot(UInt timeout) { (Void)timeout; return TRUE; }
+	Void releaseSlot() {}
+	Bool acquireItem(UInt timeout) { (Void)timeout; return TRUE; }
+	Void releaseItem() {}
+	Key lock() { return 0; }
+	Void unlock(Key key) { (Void)key; }
+};
+
+
+//-----------------------------------------
+// BoundedQueue
+//-----------------------------------------
+
+/*
+ Class BoundedQueue<T, Capacity, SyncPolicy> - a FIFO of at most Capacity items of type T.
+
+ push/pop wait up to "timeout" Clock ticks (BIOS_WAIT_FOREVER by default) for a free slot/an
+ item with a blocking policy, and return FALSE at once with the others. tryPush/tryPop are
+ push/pop with BIOS_NO_WAIT. count() is a snapshot, for statistics.
+ */
+template <typename T, unsigned Capacity, typename SyncPolicy>
+class BoundedQueue
+{
+public:
+	enum { capacity = Capacity, isPow2 = BqIsPow2<Capacity>::value };
+
+	BoundedQueue() : in(0), out(0), used(0), sync(Capacity)
+	{
+		(Void)sizeof(BqStaticAssert<(Capacity > 0)>);
+	}
+
+	/*
+	 * Function: push
+	 * Description: append an item.
+	 * Input: const T &item, UInt timeout - Clock ticks to wait for a free slot (blocking policies).
+	 * Output: Bool - TRUE if appended, FALSE if the queue stayed full.
+	 * Algorithm: insert_item's - take a free slot (acquireSlot), store the item and advance "in"
+	 * 			  under the lock, signal the item (releaseItem). The count check under the lock
+	 * 			  is what makes the non-blocking policies safe; behind a slot token it never fails.
+	*/
+	Bool push(const T &item, UInt timeout = BIOS_WAIT_FOREVER)
+	{
+		typename SyncPolicy::Key key;
+
+		if(!sync.acquireSlot(timeout)) {
+			return FALSE;
+		}
+		key = sync.lock();
+		if(used == Capacity) {
+			sync.unlock(key);
+			sync.releaseSlot();
+			return FALSE;
+		}
+		storage[in] = item;
+		in = BqIndex<Capacity>::next(in);
+		used = used + 1;
+		sync.unlock(key);
+		sync.releaseItem();
+		return TRUE;
+	}
+
+	/*
+	 * Function: pop
+	 * Description: take the oldest item.
+	 * Input: T &item - receives the item, UInt timeout - Clock ticks to wait for one (blocking policies).
+	 * Output: Bool - TRUE if an item was taken, FALSE if the queue stayed empty.
+	 * Algorithm: mirror image of push.
+	*/
+	Bool pop(T &item, UInt timeout = BIOS_WAIT_FOREVER)
+	{
+		typename SyncPolicy::Key key;
+
+		if(!sync.acquireItem(timeout)) {
+			return FALSE;
+		}
+		key = sync.lock();
+		if(used == 0) {
+			sync.unlock(key);
+			sync.releaseItem();
+			return FALSE;
+		}
+		item = storage[out];
+		out = BqIndex<Capacity>::next(out);
+		used = used - 1;
+		sync.unlock(key);
+		sync.releaseSlot();
+		return TRUE;
+	}
+
+	Bool tryPush(const T &item) { return push(item, BIOS_NO_WAIT); }
+	Bool tryPop(T &item) { return pop(item, BIOS_NO_WAIT); }
+	unsigned count() const { return used; }
+
+private:
+	BoundedQueue(const BoundedQueue &);				// owns kernel objects - not copyable
+	BoundedQueue &operator=(const BoundedQueue &);
+
+	T storage[Capacity];
+	unsigned in;				// next free slot
+	unsigned out;				// oldest item
+	volatile unsigned used;		// number of items - no sentinel value is needed
+	SyncPolicy sync;
+};
+
+
+#if BQ_HAVE_ATOMIC
+/*
+ AtomicSpscPolicy - host only: selects the lock-free specialization below.
+ */
+struct AtomicSpscPolicy {};
+
+/*
+ BoundedQueue<T, Capacity, AtomicSpscPolicy> - wait-free single producer/single consumer queue
+ for host threads, the SpscRing_T protocol of ring.h with std::atomic: free-running indices,
+ the producer only writes "tail", the consumer only "head", and the count is tail - head. The
+ capacity must be a power of two, so the indices wrap with the mask. Never blocks.
+ */
+template <typename T, unsigned Capacity>
+class BoundedQueue<T, Capacity, AtomicSpscPolicy>
+{
+public:
+	enum { capacity = Capacity, isPow2 = 1 };
+	static_assert(BqIsPow2<Capacity>::value, "AtomicSpscPolicy needs a power of two capacity");
+
+	BoundedQueue() : head(0), tail(0) {}
+
+	Bool push(const T &item, UInt timeout = BIOS_WAIT_FOREVER)
+	{
+		unsigned t = tail.load(std::memory_order_relaxed);
+
+		(Void)timeout;
+		if(t - head.load(std::memory_order_acquire) == Capacity) {
+			return FALSE;
+		}
+		storage[t & (Capacity - 1)] = item;
+		tail.store(t + 1, std::memory_order_release);	// publishes the item
+		return TRUE;
+	}
+
+	Bool pop(T &item, UInt timeout = BIOS_WAIT_FOREVER)
+	{
+		unsigned h = head.load(std::memory_order_relaxed);
+
+		(Void)timeout;
+		if(h == tail.load(std::memory_order_acquire)) {
+			return FALSE;
+		}
+		item = storage[h & (Capacity - 1)];
+		head.store(h + 1, std::memory_order_release);	// frees the slot
+		return TRUE;
+	}
+
+	Bool tryPush(const T &item) { return push(item, BIOS_NO_WAIT); }
+	Bool tryPop(T &item) { return pop(item, BIOS_NO_WAIT); }
+	unsigned count() const { return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed); }
+
+private:
+	BoundedQueue(const BoundedQueue &) = delete;
+	BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+	T storage[Capacity];
+	alignas(64) std::atomic<unsigned> head;		// own cache lines - the two threads don't share one
+	alignas(64) std::atomic<unsigned> tail;
+};
+#endif
+
+#endif /* BOUNDED_QUEUE_HPP_ */
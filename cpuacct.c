@@ -0,0 +1,260 @@
+/*
+ * cpuacct.c
+ *
+ * Per-task CPU accounting - see cpuacct.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <xdc/runtime/Timestamp.h>
+#include <string.h>						//for memset/memcpy in CpuAcct_reset/CpuAcct_snapshot
+
+#include "cpuacct.h"
+#include "topology.h"
+
+/*
+ Same locking as the record ring (record.c): a Hwi_disable window on the target; the host's
+ emulated kernel calls the switch hook holding its lock, and runs the report with the Tasks
+ stopped.
+ */
+#if defined(__MSP430__)
+#define CPUACCT_LOCK(key)	((key) = Hwi_disable())
+#define CPUACCT_UNLOCK(key)	Hwi_restore(key)
+#else
+#define CPUACCT_LOCK(key)	((key) = 0)
+#define CPUACCT_UNLOCK(key)	((Void)(key))
+#endif
+
+#define CPUACCT_IDLE	0		//cpuAcctStats.task index of the idle loop
+
+/*
+ Enum AcctState_E - what a Task's open interval is.
+ */
+typedef enum
+{
+	acctNone_e = 0,				// not switched in yet, or terminated
+	acctRunning_e,
+	acctPreempted_e,
+	acctBlocked_e
+} AcctState_E;
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The accounting, see CpuAcctStats_T.
+ */
+CpuAcctStats_T cpuAcctStats;
+
+/*
+ Wait reason of the running Task - saved and restored by the switch hook, so each Task keeps its own.
+ */
+volatile CpuWait_E cpuAcctWait = cpuWaitOther_e;
+
+#if CPU_ACCOUNTING
+static Task_Handle acctHandle[CPUACCT_MAX_TASKS];	// the Task of every entry (none for the idle loop)
+#endif
+static UInt32 acctSince[CPUACCT_MAX_TASKS];			// Timestamp of the start of the open interval
+static UInt8 acctState[CPUACCT_MAX_TASKS];			// AcctState_E of the open interval
+static UInt8 acctWait[CPUACCT_MAX_TASKS];			// CpuWait_E saved at the switch out
+static UInt32 acctStart;							// Timestamp of CpuAcct_reset
+
+
+/*
+ * Function: CpuAcct_reset
+ * Description: clear the accounting and start a new window.
+ * Input: void
+ * Output: void
+ * Algorithm: the counters are cleared, the entries known so far kept, with their open intervals
+ * 			  restarted now - a reset from a Task keeps it accounted as running.
+*/
+Void CpuAcct_reset(void)
+{
+	Types_FreqHz freq;
+	UInt32 now = Timestamp_get32();
+	UInt16 numTasks;
+	Int i = 0;
+	UInt key;
+
+	Timestamp_getFreq(&freq);
+	CPUACCT_LOCK(key);
+	numTasks = cpuAcctStats.numTasks > 0 ? cpuAcctStats.numTasks : 1;
+	for(i = 0 ; i < numTasks ; i++) {
+		memset(cpuAcctStats.task[i].blocked, 0, sizeof(cpuAcctStats.task[i].blocked));
+		memset(cpuAcctStats.task[i].blocks, 0, sizeof(cpuAcctStats.task[i].blocks));
+		cpuAcctStats.task[i].running = 0;
+		cpuAcctStats.task[i].slices = 0;
+		cpuAcctStats.task[i].preempted = 0;
+		cpuAcctStats.task[i].preemptions = 0;
+		acctSince[i] = now;
+	}
+	memcpy(cpuAcctStats.magic, "CPUA", sizeof(cpuAcctStats.magic));
+	cpuAcctStats.freq = freq.lo;
+	cpuAcctStats.elapsed = 0;
+	cpuAcctStats.numTasks = numTasks;
+	cpuAcctStats.numWaits = CPUACCT_WAITS;
+	cpuAcctStats.task[CPUACCT_IDLE].idle = 1;
+	acctStart = now;
+	CPUACCT_UNLOCK(key);
+}
+
+Bool CpuAcct_pend(Semaphore_Handle sem, UInt timeout, CpuWait_E wait)
+{
+	Bool result;
+
+	cpuAcctWait = wait;
+	result = Semaphore_pend(sem, timeout);
+	cpuAcctWait = cpuWaitOther_e;
+	return result;
+}
+
+Void CpuAcct_sleep(UInt32 nticks)
+{
+	cpuAcctWait = cpuWaitSleep_e;
+	Task_sleep(nticks);
+	cpuAcctWait = cpuWaitOther_e;
+}
+
+#if CPU_ACCOUNTING
+/*
+ * Function: acctIndex
+ * Description: the cpuAcctStats.task entry of a Task.
+ * Input: Task_Handle task - the Task, NULL for the idle loop (host build).
+ * Output: Int - its index, CPUACCT_IDLE for the idle loop (the target's Idle Task - priority 0 -
+ * 				 and the host's NULL), -1 when the table is full.
+ * Algorithm: scan the known Tasks; a new one gets the next entry, with its topology role and id.
+*/
+static Int acctIndex(Task_Handle task)
+{
+	CpuAcctTask_T *entry;
+	Int i = 0;
+
+	if(task == NULL || Task_getPri(task) == 0) {
+		return CPUACCT_IDLE;
+	}
+	for(i = 1 ; i < cpuAcctStats.numTasks ; i++) {
+		if(acctHandle[i] == task) {
+			return i;
+		}
+	}
+	if(cpuAcctStats.numTasks >= CPUACCT_MAX_TASKS) {
+		return -1;
+	}
+	i = cpuAcctStats.numTasks;
+	entry = &cpuAcctStats.task[i];
+	acctHandle[i] = task;
+	acctState[i] = acctNone_e;
+	entry->role = (UInt8)Topology_workerRole(task);
+	entry->id = (UInt8)Topology_workerId(task);
+	entry->priority = (UInt8)Task_getPri(task);
+	cpuAcctStats.numTasks = i + 1;
+	return i;
+}
+#endif
+
+/*
+ * Function: acctCharge
+ * Description: charge time to the open interval of an entry.
+ * Input: CpuAcctTask_T *entry, Int i - the entry and its index, UInt32 delta - the time.
+ * Output: void
+ * Algorithm: running time, preempted time or blocked time of the saved wait reason, by state.
+*/
+static Void acctCharge(CpuAcctTask_T *entry, Int i, UInt32 delta)
+{
+	switch(acctState[i]) {
+	case acctRunning_e:
+		entry->running = entry->running + delta;
+		break;
+	case acctPreempted_e:
+		entry->preempted = entry->preempted + delta;
+		break;
+	case acctBlocked_e:
+		entry->blocked[acctWait[i]] = entry->blocked[acctWait[i]] + delta;
+		break;
+	default:
+		break;
+	}
+}
+
+#if CPU_ACCOUNTING
+static Void acctClose(CpuAcctTask_T *entry, Int i, UInt32 now)
+{
+	acctCharge(entry, i, now - acctSince[i]);
+	acctSince[i] = now;
+}
+#endif
+
+/*
+ * Function: CpuAcct_switchHook
+ * Description: account the switch from prev to next.
+ * Input: Task_Handle prev - the Task switched out, Task_Handle next - the Task switched in.
+ * Output: void
+ * Algorithm: close prev's running interval; prev still READY opens a preempted interval, BLOCKED
+ * 			  a blocked one under the wait reason it declared (cpuAcctWait, saved with it), anything
+ * 			  else (terminated, the idle loop) none. Close next's interval, open its running one and restore its
+ * 			  wait reason.
+*/
+Void CpuAcct_switchHook(Task_Handle prev, Task_Handle next)
+{
+#if CPU_ACCOUNTING
+	UInt32 now = Timestamp_get32();
+	CpuAcctTask_T *entry;
+	Task_Mode mode;
+	Int i = acctIndex(prev);
+
+	if(i >= 0) {
+		entry = &cpuAcctStats.task[i];
+		acctClose(entry, i, now);
+		mode = (i != CPUACCT_IDLE) ? Task_getMode(prev) : Task_Mode_INACTIVE;	// the idle loop just waits for work
+		acctWait[i] = (UInt8)cpuAcctWait;
+		if(mode == Task_Mode_READY) {
+			acctState[i] = acctPreempted_e;
+			entry->preemptions = entry->preemptions + 1;
+		} else if(mode == Task_Mode_BLOCKED) {
+			acctState[i] = acctBlocked_e;
+			entry->blocks[acctWait[i]] = entry->blocks[acctWait[i]] + 1;
+		} else {
+			acctState[i] = acctNone_e;
+		}
+	}
+	cpuAcctWait = cpuWaitOther_e;
+	i = acctIndex(next);
+	if(i >= 0) {
+		entry = &cpuAcctStats.task[i];
+		acctClose(entry, i, now);
+		acctState[i] = acctRunning_e;
+		entry->slices = entry->slices + 1;
+		cpuAcctWait = (CpuWait_E)acctWait[i];
+	}
+#else
+	(Void)prev;								// registered in empty.cfg either way
+	(Void)next;
+#endif
+}
+
+/*
+ * Function: CpuAcct_snapshot
+ * Description: a consistent, up to date copy of the accounting.
+ * Input: CpuAcctStats_T *dst - receives the copy.
+ * Output: void
+ * Algorithm: in the CPUACCT_LOCK window, copy the header and the entries in use, then charge every
+ * 			  open interval up to now in the copy - the live counters are left alone.
+*/
+Void CpuAcct_snapshot(CpuAcctStats_T *dst)
+{
+	UInt32 now;
+	Int i = 0;
+	UInt key;
+
+	CPUACCT_LOCK(key);
+	now = Timestamp_get32();
+	memcpy(dst, &cpuAcctStats, sizeof(*dst));
+	dst->elapsed = now - acctStart;
+	for(i = 0 ; i < dst->numTasks ; i++) {
+		acctCharge(&dst->task[i], i, now - acctSince[i]);
+	}
+	CPUACCT_UNLOCK(key);
+}
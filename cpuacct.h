@@ -0,0 +1,148 @@
+/*
+ * cpuacct.h
+ *
+ * Per-task CPU accounting - where the CPU time of every Task goes.
+ *
+ * UIA's load logger (LoggingSetup.loadLoggerSize = 128 in empty.cfg) holds a few seconds of
+ * coarse CPU load records and says nothing about why a Task did not run. A Task switch hook
+ * (CpuAcct_switchHook, registered by Task.addHookSet in empty.cfg) timestamps every switch and
+ * charges the time to the Task it concerns:
+ *
+ *  - running: from its switch in to its switch out (Hwi and Swi time - the Clock functions -
+ *    is charged to the Task they interrupted);
+ *  - preempted: switched out while still READY (a time-slice yield, a higher priority Task) -
+ *    the number of preemptions and the time until it ran again;
+ *  - blocked: switched out in a pend or sleep - the number of blocks and the time until it ran
+ *    again, per wait reason (CpuWait_E): the emptySlots/laneEmpty, fullSlots and mutex
+ *    semaphores of the buffers, ledSrvSchedSem, a Task_sleep of the workload, or anything else.
+ *
+ * The wait reason is whatever the blocking Task declared with CPUACCT_PEND/CPUACCT_SLEEP just
+ * before it blocked - one store, and the switch hook reads it. The idle loop is accounted as a
+ * Task of its own, so the CPU load is 1 - idle / elapsed.
+ *
+ * The counters are in Timestamp units in cpuAcctStats, a fixed-layout RAM structure that can be
+ * read with the debugger or dumped (CpuAcct_snapshot takes a consistent copy) - the 16-byte
+ * header, then numTasks CpuAcctTask_T entries, little endian; host/tools/cpu_flame.py renders
+ * a dump as a flame-style breakdown. The UInt32 counters wrap after 2^32 Timestamp counts -
+ * CpuAcct_reset starts a new window.
+ *
+ * CPU_ACCOUNTING 0 compiles the accounting out (CPUACCT_PEND/CPUACCT_SLEEP are then the plain
+ * Semaphore_pend/Task_sleep).
+ */
+
+#ifndef CPUACCT_H_
+#define CPUACCT_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#ifndef CPU_ACCOUNTING
+#define CPU_ACCOUNTING		1		//1 - account the Tasks' time in the switch hook, 0 - no accounting
+#endif
+#ifndef CPUACCT_MAX_TASKS
+#define CPUACCT_MAX_TASKS	12		//Accounted Tasks, the idle loop included - later ones are not accounted
+#endif
+
+
+/*
+ Enum CpuWait_E - why a Task blocked. Keep in sync with WAITS in host/tools/cpu_flame.py.
+ */
+typedef enum
+{
+	cpuWaitOther_e = 0,			// not declared (the trace drain Task's sleep, ...)
+	cpuWaitEmptySlots_e = 1,	// a buffer's emptySlots (or a lane's laneEmpty) - buffer full
+	cpuWaitFullSlots_e = 2,		// a buffer's fullSlots - buffer empty
+	cpuWaitMutex_e = 3,			// a buffer's mutex (locked engine)
+	cpuWaitLedSrvSched_e = 4,	// ledSrvSchedSem
+	cpuWaitSleep_e = 5,			// Task_sleep of a workload delay or stall
+	CPUACCT_WAITS = 6
+} CpuWait_E;
+
+
+/*
+ Structure CpuAcctTask_T - the accounting of one Task (Timestamp units).
+ */
+typedef struct
+{
+	UInt32 running;					// time on the CPU
+	UInt32 slices;					// switches in
+	UInt32 preempted;				// time switched out while READY
+	UInt32 preemptions;
+	UInt32 blocked[CPUACCT_WAITS];	// time switched out blocked, per wait reason
+	UInt32 blocks[CPUACCT_WAITS];	// number of blocks, per wait reason
+	UInt8 role;						// TopologyRole_E, 0 for other Tasks
+	UInt8 id;						// producer/consumer id
+	UInt8 priority;
+	UInt8 idle;						// 1 - the idle loop
+} CpuAcctTask_T;
+
+
+/*
+ Structure CpuAcctStats_T - the RAM snapshot structure.
+ */
+typedef struct
+{
+	Char magic[4];					// "CPUA"
+	UInt32 freq;					// Timestamp counts per second
+	UInt32 elapsed;					// Timestamp counts since CpuAcct_reset (brought up to date by CpuAcct_snapshot)
+	UInt16 numTasks;
+	UInt16 numWaits;				// CPUACCT_WAITS
+	CpuAcctTask_T task[CPUACCT_MAX_TASKS];
+} CpuAcctStats_T;
+
+extern CpuAcctStats_T cpuAcctStats;
+extern volatile CpuWait_E cpuAcctWait;
+
+
+/*
+ CPUACCT_PEND/CPUACCT_SLEEP - Semaphore_pend/Task_sleep with the wait reason declared.
+ */
+#if CPU_ACCOUNTING
+#define CPUACCT_PEND(sem, timeout, wait)	CpuAcct_pend((sem), (timeout), (wait))
+#define CPUACCT_SLEEP(nticks)				CpuAcct_sleep(nticks)
+#else
+#define CPUACCT_PEND(sem, timeout, wait)	Semaphore_pend((sem), (timeout))
+#define CPUACCT_SLEEP(nticks)				Task_sleep(nticks)
+#endif
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void CpuAcct_reset(void)
+
+ Clears the accounting and starts a new window. Called from main before BIOS_start, and at any
+ time from a Task.
+ */
+Void CpuAcct_reset(void);
+
+/*
+ Function: Bool CpuAcct_pend(Semaphore_Handle sem, UInt timeout, CpuWait_E wait)
+ Function: Void CpuAcct_sleep(UInt32 nticks)
+
+ Semaphore_pend/Task_sleep, a block in them charged to "wait".
+ */
+Bool CpuAcct_pend(Semaphore_Handle sem, UInt timeout, CpuWait_E wait);
+Void CpuAcct_sleep(UInt32 nticks);
+
+/*
+ Function: Void CpuAcct_switchHook(Task_Handle prev, Task_Handle next)
+
+ Task switch hook (Task.addHookSet switchFxn in empty.cfg) - closes prev's running time, opens
+ its preempted or blocked time, and closes next's.
+ */
+Void CpuAcct_switchHook(Task_Handle prev, Task_Handle next);
+
+/*
+ Function: Void CpuAcct_snapshot(CpuAcctStats_T *dst)
+
+ Copies cpuAcctStats to dst with the running Task's time and elapsed brought up to date - a
+ consistent view, taken with interrupts disabled. Call it from a Task (or with the kernel
+ stopped, like the host report).
+ */
+Void CpuAcct_snapshot(CpuAcctStats_T *dst);
+
+#endif /* CPUACCT_H_ */
@@ -0,0 +1,243 @@
+/*
+ * frame_buffer.c
+ *
+ * Zero-copy bounded buffer for large payloads - see frame_buffer.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <xdc/runtime/Log.h>
+#include <string.h>						//for memcpy in the copying API
+
+#include "frame_buffer.h"
+
+/*
+ * Function: nextSlot
+ * Description: cyclic increment of a slot index.
+ * Input: FrameBuffer_T *fb, Int idx - current index.
+ * Output: Int - idx + 1, wrapped to 0 at fb->size.
+ * Algorithm: compare instead of % - no division on the MSP430.
+*/
+static Int nextSlot(FrameBuffer_T *fb, Int idx)
+{
+	idx = idx + 1;
+	return (idx == fb->size) ? 0 : idx;
+}
+
+/*
+ * Function: postMany
+ * Description: post a counting semaphore n times with a single reschedule.
+ * Input: Semaphore_Handle sem, Int n.
+ * Output: void
+ * Algorithm: posts with the Task scheduler disabled.
+*/
+static Void postMany(Semaphore_Handle sem, Int n)
+{
+	UInt key;
+	if(n == 0) {
+		return;
+	}
+	key = Task_disable();
+	while(n > 0) {
+		Semaphore_post(sem);
+		n = n - 1;
+	}
+	Task_restore(key);
+}
+
+/*
+ * Function: FrameBuffer_init
+ * Description: initialize an empty frame buffer over caller supplied slots.
+ * Input: FrameBuffer_T *fb, Frame_T *frames - the slots, Int size - number of slots.
+ * Output: void
+ * Algorithm: mark every slot FRAME_EMPTY (like initArray did with -1) and construct the
+ * 			  counting semaphores (emptySlots = size, fullSlots = 0) and the binary mutex.
+*/
+Void FrameBuffer_init(FrameBuffer_T *fb, Frame_T *frames, Int size)
+{
+	Semaphore_Params semParams;
+	Int i = 0;
+
+	for(i = 0 ; i < size ; i++) {
+		frames[i].state = FRAME_EMPTY;
+		frames[i].len = 0;
+	}
+	fb->frames = frames;
+	fb->size = size;
+	fb->in = 0;
+	fb->out = 0;
+	fb->ready = 0;
+	fb->unpublished = 0;
+	fb->freed = 0;
+	fb->unfreed = 0;
+
+	Semaphore_Params_init(&semParams);
+	Semaphore_construct(&fb->emptySlots, size, &semParams);
+	Semaphore_construct(&fb->fullSlots, 0, &semParams);
+	semParams.mode = Semaphore_Mode_BINARY;
+	Semaphore_construct(&fb->mutex, 1, &semParams);
+}
+
+/*
+ * Function: FrameBuffer_reserve
+ * Description: reserve the next free slot for a producer to fill in place.
+ * Input: FrameBuffer_T *fb.
+ * Output: Frame_T * - the reserved slot, NULL on abnormal behavior.
+ * Algorithm: producer algorithm of insert_item, but instead of writing an item the slot at "in"
+ * 			  is marked FRAME_RESERVED and handed out; fullSlots is not posted here but by commit.
+*/
+Frame_T *FrameBuffer_reserve(FrameBuffer_T *fb)
+{
+	Frame_T *frame;
+
+	Semaphore_pend(Semaphore_handle(&fb->emptySlots), BIOS_WAIT_FOREVER);
+	Semaphore_pend(Semaphore_handle(&fb->mutex), BIOS_WAIT_FOREVER);
+	/* Critical Section */
+	frame = &fb->frames[fb->in];
+	if(frame->state != FRAME_EMPTY) {		// trying to reserve a non empty slot.
+		Log_info1("ERROR! Can't reserve a non-empty frame slot (state %d).\n", frame->state); //error log
+		/* End of Critical Section */
+		Semaphore_post(Semaphore_handle(&fb->mutex));
+		Semaphore_post(Semaphore_handle(&fb->emptySlots));
+		return NULL;
+	}
+	frame->state = FRAME_RESERVED;
+	fb->in = nextSlot(fb, fb->in);
+	fb->unpublished = fb->unpublished + 1;
+	/* End of Critical Section */
+	Semaphore_post(Semaphore_handle(&fb->mutex));
+	return frame;
+}
+
+/*
+ * Function: FrameBuffer_commit
+ * Description: publish a filled slot to the consumers.
+ * Input: FrameBuffer_T *fb, Frame_T *frame - slot returned by FrameBuffer_reserve, Int len - payload bytes.
+ * Output: void
+ * Algorithm: mark the slot FRAME_COMMITTED, then walk from "ready" over every committed slot
+ * 			  (stopping at the first one still being filled) and post fullSlots once per slot
+ * 			  walked - so the consumers only ever see slots in reservation order.
+*/
+Void FrameBuffer_commit(FrameBuffer_T *fb, Frame_T *frame, Int len)
+{
+	Int published = 0;
+
+	Semaphore_pend(Semaphore_handle(&fb->mutex), BIOS_WAIT_FOREVER);
+	/* Critical Section */
+	frame->len = len;
+	frame->state = FRAME_COMMITTED;
+	while(fb->unpublished > 0 && fb->frames[fb->ready].state == FRAME_COMMITTED) {
+		fb->ready = nextSlot(fb, fb->ready);
+		fb->unpublished = fb->unpublished - 1;
+		published = published + 1;
+	}
+	/* End of Critical Section */
+	Semaphore_post(Semaphore_handle(&fb->mutex));
+	postMany(Semaphore_handle(&fb->fullSlots), published);
+}
+
+/*
+ * Function: FrameBuffer_acquire
+ * Description: hand the oldest published slot to a consumer to read in place.
+ * Input: FrameBuffer_T *fb.
+ * Output: Frame_T * - the acquired slot, NULL on abnormal behavior.
+ * Algorithm: consumer algorithm of remove_item, but the slot at "out" is marked FRAME_ACQUIRED
+ * 			  and handed out instead of being copied; emptySlots is posted by release.
+*/
+Frame_T *FrameBuffer_acquire(FrameBuffer_T *fb)
+{
+	Frame_T *frame;
+
+	Semaphore_pend(Semaphore_handle(&fb->fullSlots), BIOS_WAIT_FOREVER);
+	Semaphore_pend(Semaphore_handle(&fb->mutex), BIOS_WAIT_FOREVER);
+	/* Critical Section */
+	frame = &fb->frames[fb->out];
+	if(frame->state != FRAME_COMMITTED) {	// trying to acquire a slot that holds no frame.
+		Log_info1("ERROR! Can't acquire an empty frame slot (state %d).\n", frame->state); //error log
+		/* End of Critical Section */
+		Semaphore_post(Semaphore_handle(&fb->mutex));
+		Semaphore_post(Semaphore_handle(&fb->fullSlots));
+		return NULL;
+	}
+	frame->state = FRAME_ACQUIRED;
+	fb->out = nextSlot(fb, fb->out);
+	fb->unfreed = fb->unfreed + 1;
+	/* End of Critical Section */
+	Semaphore_post(Semaphore_handle(&fb->mutex));
+	return frame;
+}
+
+/*
+ * Function: FrameBuffer_release
+ * Description: give a consumed slot back to the producers.
+ * Input: FrameBuffer_T *fb, Frame_T *frame - slot returned by FrameBuffer_acquire.
+ * Output: void
+ * Algorithm: mirror image of FrameBuffer_commit - mark the slot FRAME_EMPTY, walk from "freed"
+ * 			  over every released slot and post emptySlots once per slot walked.
+*/
+Void FrameBuffer_release(FrameBuffer_T *fb, Frame_T *frame)
+{
+	Int freed = 0;
+
+	Semaphore_pend(Semaphore_handle(&fb->mutex), BIOS_WAIT_FOREVER);
+	/* Critical Section */
+	frame->state = FRAME_EMPTY;
+	while(fb->unfreed > 0 && fb->frames[fb->freed].state == FRAME_EMPTY) {
+		fb->freed = nextSlot(fb, fb->freed);
+		fb->unfreed = fb->unfreed - 1;
+		freed = freed + 1;
+	}
+	/* End of Critical Section */
+	Semaphore_post(Semaphore_handle(&fb->mutex));
+	postMany(Semaphore_handle(&fb->emptySlots), freed);
+}
+
+/*
+ * Function: FrameBuffer_put
+ * Description: copying producer API.
+ * Input: FrameBuffer_T *fb, const UInt8 *src - payload, Int len - payload bytes.
+ * Output: Bool - TRUE on success, FALSE on abnormal behavior or a payload larger than a slot.
+ * Algorithm: reserve, memcpy into the slot, commit.
+*/
+Bool FrameBuffer_put(FrameBuffer_T *fb, const UInt8 *src, Int len)
+{
+	Frame_T *frame;
+
+	if(len < 0 || len > FRAME_PAYLOAD_SIZE) {
+		return FALSE;
+	}
+	frame = FrameBuffer_reserve(fb);
+	if(frame == NULL) {
+		return FALSE;
+	}
+	memcpy(frame->data, src, len);
+	FrameBuffer_commit(fb, frame, len);
+	return TRUE;
+}
+
+/*
+ * Function: FrameBuffer_get
+ * Description: copying consumer API.
+ * Input: FrameBuffer_T *fb, UInt8 *dst - receives the payload, Int max - room in dst.
+ * Output: Int - bytes copied, -1 on abnormal behavior or a negative max.
+ * Algorithm: acquire, memcpy out of the slot (truncated to max), release. A negative max is
+ * 			  rejected before the acquire, so no frame is lost to it.
+*/
+Int FrameBuffer_get(FrameBuffer_T *fb, UInt8 *dst, Int max)
+{
+	Frame_T *frame;
+	Int len;
+
+	if(max < 0) {
+		return -1;
+	}
+	frame = FrameBuffer_acquire(fb);
+	if(frame == NULL) {
+		return -1;
+	}
+	len = (frame->len < max) ? frame->len : max;
+	memcpy(dst, frame->data, len);
+	FrameBuffer_release(fb, frame);
+	return len;
+}
@@ -0,0 +1,146 @@
+/*
+ * frame_buffer.h
+ *
+ * Zero-copy bounded buffer for large payloads (sensor frames).
+ *
+ * The shared buffer in main.c carries one Int per slot, and a producer/consumer of a frame of
+ * hundreds of bytes would have to copy it into the slot and out of it again. A FrameBuffer_T
+ * instead hands out pointers straight into its own slot storage:
+ *
+ *  - producer:  frame = FrameBuffer_reserve(fb);   -> fill frame->data in place
+ *               FrameBuffer_commit(fb, frame, len);
+ *
+ *  - consumer:  frame = FrameBuffer_acquire(fb);   -> read frame->data / frame->len in place
+ *               FrameBuffer_release(fb, frame);
+ *
+ * The buffer is the same cyclic buffer as in main.c - "in" is the next slot to reserve, "out" is
+ * the next slot to acquire, and an empty slot is marked with FRAME_EMPTY (-1) exactly like an
+ * empty cell of the Int buffer. Because a slot is now owned by a task for a while (between
+ * reserve and commit, or between acquire and release), a slot also has RESERVED, COMMITTED and
+ * ACQUIRED states, and the counting semaphores only count slots that are usable IN ORDER:
+ *
+ *  - fullSlots is posted for a committed slot only once all the slots reserved before it are
+ *    committed too, so a consumer never acquires a slot that a slower producer is still filling.
+ *
+ *  - emptySlots is posted for a released slot only once all the slots acquired before it are
+ *    released too, so a producer never reserves a slot that a slower consumer is still reading.
+ *
+ * The copying API (FrameBuffer_put/FrameBuffer_get) is built on top of the same four calls, so
+ * both styles can be used on one buffer and compared.
+ */
+
+#ifndef FRAME_BUFFER_H_
+#define FRAME_BUFFER_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#ifndef FRAME_PAYLOAD_SIZE
+#define FRAME_PAYLOAD_SIZE 64	//Maximum payload bytes of a frame
+#endif
+
+//-----------------------------------------
+// Slot states (state field of Frame_T)
+//-----------------------------------------
+#define FRAME_EMPTY		(-1)	// free - same marker as an empty cell of the Int buffer
+#define FRAME_RESERVED	(-2)	// handed to a producer by FrameBuffer_reserve
+#define FRAME_COMMITTED	(-3)	// filled, waiting for a consumer
+#define FRAME_ACQUIRED	(-4)	// handed to a consumer by FrameBuffer_acquire
+
+
+/*
+ Structure Frame_T - one slot of a FrameBuffer_T: the generic payload (len bytes of data) plus
+ the slot state.
+ */
+typedef struct
+{
+	volatile Int state;
+	Int len;
+	UInt8 data[FRAME_PAYLOAD_SIZE];
+} Frame_T;
+
+
+/*
+ Structure FrameBuffer_T - a bounded buffer of Frame_T slots with its own synchronization.
+ The Frame_T storage is supplied by the caller (a static array - no heap is configured).
+ */
+typedef struct
+{
+	Frame_T *frames;
+	Int size;					// number of slots
+	Int in;						// next slot to reserve
+	Int out;					// next slot to acquire
+	Int ready;					// oldest reserved slot not yet published to consumers
+	Int unpublished;			// reserved slots not yet published to consumers
+	Int freed;					// oldest acquired slot not yet given back to producers
+	Int unfreed;				// acquired slots not yet given back to producers
+	Semaphore_Struct emptySlots;
+	Semaphore_Struct fullSlots;
+	Semaphore_Struct mutex;
+} FrameBuffer_T;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void FrameBuffer_init(FrameBuffer_T *fb, Frame_T *frames, Int size)
+
+ Initialises fb over "size" caller supplied slots - all slots are marked FRAME_EMPTY and the
+ buffer's emptySlots/fullSlots/mutex semaphores are constructed in place. Must be called
+ before BIOS_start (or before any task uses fb).
+ */
+Void FrameBuffer_init(FrameBuffer_T *fb, Frame_T *frames, Int size);
+
+/*
+ Function: Frame_T *FrameBuffer_reserve(FrameBuffer_T *fb)
+
+ Producer side. Blocks while there is no free slot, then returns a pointer to the reserved
+ slot - the producer writes its payload straight into frame->data. Returns NULL on Abnormal
+ behaviour (the slot at "in" is not FRAME_EMPTY), after issuing a Log message.
+ */
+Frame_T *FrameBuffer_reserve(FrameBuffer_T *fb);
+
+/*
+ Function: Void FrameBuffer_commit(FrameBuffer_T *fb, Frame_T *frame, Int len)
+
+ Producer side. Marks a reserved slot as filled with len bytes and publishes it (and every
+ committed slot behind it) to the consumers.
+ */
+Void FrameBuffer_commit(FrameBuffer_T *fb, Frame_T *frame, Int len);
+
+/*
+ Function: Frame_T *FrameBuffer_acquire(FrameBuffer_T *fb)
+
+ Consumer side. Blocks while there is no published slot, then returns a pointer to the oldest
+ one - the consumer reads frame->len bytes straight from frame->data. Returns NULL on Abnormal
+ behaviour (the slot at "out" is not FRAME_COMMITTED), after issuing a Log message.
+ */
+Frame_T *FrameBuffer_acquire(FrameBuffer_T *fb);
+
+/*
+ Function: Void FrameBuffer_release(FrameBuffer_T *fb, Frame_T *frame)
+
+ Consumer side. Marks an acquired slot FRAME_EMPTY and gives it (and every released slot
+ behind it) back to the producers.
+ */
+Void FrameBuffer_release(FrameBuffer_T *fb, Frame_T *frame);
+
+/*
+ Function: Bool FrameBuffer_put(FrameBuffer_T *fb, const UInt8 *src, Int len)
+
+ Copying producer API - reserve, copy len bytes (at most FRAME_PAYLOAD_SIZE) from src, commit.
+ */
+Bool FrameBuffer_put(FrameBuffer_T *fb, const UInt8 *src, Int len);
+
+/*
+ Function: Int FrameBuffer_get(FrameBuffer_T *fb, UInt8 *dst, Int max)
+
+ Copying consumer API - acquire, copy the payload (at most max bytes) to dst, release.
+ Returns the number of bytes copied, or -1 on Abnormal behaviour or a negative max (no frame
+ is taken then).
+ */
+Int FrameBuffer_get(FrameBuffer_T *fb, UInt8 *dst, Int max);
+
+#endif /* FRAME_BUFFER_H_ */
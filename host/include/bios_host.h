@@ -0,0 +1,66 @@
+/*
+ * bios_host.h - host build only
+ *
+ * Services of the emulated kernel that have no SYS/BIOS counterpart: registration of the
+ * statically configured objects (used by the host_cfg.c generated from empty.cfg), run report
+ * extensions, and the host time base.
+ */
+
+#ifndef BIOS_HOST_H_
+#define BIOS_HOST_H_
+
+#include <stdio.h>
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Clock.h>
+
+typedef Void (*HostBios_ReportFxn)(FILE *out, Double seconds);
+
+/*
+ Static objects of empty.cfg - called by the generated host_cfg.c before main() runs, so the
+ handles in xdc/cfg/global.h are usable from main() on, like on the target.
+ */
+Void HostBios_staticTask(Task_Object *obj, CString name, Task_FuncPtr fxn, Int priority,
+		SizeT stackSize, UArg arg0, UArg arg1);
+Void HostBios_staticSemaphore(Semaphore_Object *obj, CString name, Int count, Semaphore_Mode mode);
+Void HostBios_staticClock(Clock_Object *obj, CString name, Clock_FuncPtr fxn, UInt32 timeout,
+		UInt32 period, Bool startFlag, UArg arg);
+Void HostBios_staticTaskHook(Task_SwitchFxn switchFxn);
+
+/*
+ Adds a function printing extra lines (application statistics) to the run report.
+ */
+Void HostBios_addReportFxn(HostBios_ReportFxn fxn);
+
+/*
+ Record/replay of the interleaving (record_host.c). HostBios_holdTicks(TRUE): a running Task
+ takes the Clock ticks only at HostBios_tickPoint, which first raises "raise" more - so where a
+ tick lands depends on the application's progress, not on host timing (ticks raised while the
+ CPU is idle are still taken at once). HostBios_setIdleTickFxn replaces the real-time clock: fxn
+ is polled, with the kernel locked, while the CPU is idle and returns the number of ticks to
+ raise. Call both before BIOS_start. HostBios_stop ends the run early - the report follows.
+ */
+typedef UInt32 (*HostBios_IdleTickFxn)(Void);
+
+Void HostBios_holdTicks(Bool hold);
+Void HostBios_tickPoint(UInt32 raise);
+Void HostBios_setIdleTickFxn(HostBios_IdleTickFxn fxn);
+Void HostBios_stop(Void);
+
+/*
+ Monotonic host time in nanoseconds.
+ */
+UInt64 HostBios_nowNsec(Void);
+
+/*
+ Prints the GPIO part of the run report (driverlib_host.c).
+ */
+Void HostGpio_report(FILE *out, Double seconds);
+
+/*
+ Prints the Log part of the run report (log_host.c).
+ */
+Void HostLog_report(FILE *out, Double seconds);
+
+#endif /* BIOS_HOST_H_ */
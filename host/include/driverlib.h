@@ -0,0 +1,62 @@
+/*
+ * driverlib.h - host build
+ *
+ * The MSP430 DriverLib calls used by the application. Clock/watchdog set-up calls do nothing;
+ * GPIO output calls update an emulated port state and count the pin toggles, so the LED
+ * activity shows up in the run report. The FlashCtl calls program and erase the memory of
+ * HostFlash_map the way flash is - a write only clears bits, an erase sets a whole segment to
+ * 0xFF.
+ */
+
+#ifndef DRIVERLIB_H_
+#define DRIVERLIB_H_
+
+#include <stdint.h>
+
+#define GPIO_PORT_P1		1
+#define GPIO_PORT_P2		2
+#define GPIO_PORT_P3		3
+#define GPIO_PORT_P4		4
+#define GPIO_PORT_P5		5
+#define GPIO_PORT_P6		6
+#define GPIO_PORT_P7		7
+#define GPIO_PORT_P8		8
+#define GPIO_PORT_PJ		13
+
+#define GPIO_PIN0			(0x0001)
+#define GPIO_PIN1			(0x0002)
+#define GPIO_PIN2			(0x0004)
+#define GPIO_PIN3			(0x0008)
+#define GPIO_PIN4			(0x0010)
+#define GPIO_PIN5			(0x0020)
+#define GPIO_PIN6			(0x0040)
+#define GPIO_PIN7			(0x0080)
+
+#define WDT_A_BASE			0
+#define UCS_FLLREF			0x08
+#define UCS_REFOCLK_SELECT	0x20
+#define UCS_CLOCK_DIVIDER_1	0x00
+#define UCS_REFOCLK_FREQUENCY	32768
+
+void WDT_A_hold(uint16_t baseAddress);
+void UCS_initClockSignal(uint8_t selectedClockSignal, uint16_t clockSource, uint16_t clockSourceDivider);
+void UCS_initFLLSettle(uint16_t fsystem, uint16_t ratio);
+
+void GPIO_setAsOutputPin(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setOutputLowOnPin(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_setOutputHighOnPin(uint8_t selectedPort, uint16_t selectedPins);
+void GPIO_toggleOutputOnPin(uint8_t selectedPort, uint16_t selectedPins);
+uint8_t GPIO_getInputPinValue(uint8_t selectedPort, uint16_t selectedPins);
+
+void FlashCtl_eraseSegment(uint8_t *flash_ptr);
+void FlashCtl_write8(uint8_t *data_ptr, uint8_t *flash_ptr, uint16_t count);
+
+/*
+ Host only - "flash" of size bytes (a multiple of HOST_FLASH_SEGMENT), erased when new: the file
+ PC_SPOOL names, mapped shared so it outlives the run like the target's flash outlives a reset,
+ or anonymous memory without PC_SPOOL. Ends the run if it can't be mapped.
+ */
+#define HOST_FLASH_SEGMENT	512
+uint8_t *HostFlash_map(uint32_t size);
+
+#endif /* DRIVERLIB_H_ */
@@ -0,0 +1,20 @@
+/*
+ * ti/sysbios/BIOS.h - host build
+ */
+
+#ifndef TI_SYSBIOS_BIOS_H_
+#define TI_SYSBIOS_BIOS_H_
+
+#include <xdc/std.h>
+
+#define BIOS_WAIT_FOREVER	(~(UInt)0)
+#define BIOS_NO_WAIT		((UInt)0)
+
+/*
+ BIOS_start - starts the emulated kernel: the statically configured and constructed Tasks and
+ Clocks start running, and after PC_RUN_MSEC (environment, default 2000) milliseconds of wall
+ clock time the run report is printed and the process exits. Never returns.
+ */
+Void BIOS_start(Void);
+
+#endif /* TI_SYSBIOS_BIOS_H_ */
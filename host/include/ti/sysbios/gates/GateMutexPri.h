@@ -0,0 +1,47 @@
+/*
+ * ti/sysbios/gates/GateMutexPri.h - host build
+ *
+ * A priority inheritance mutex with the SYS/BIOS semantics: Tasks only, nestable by its owner;
+ * waiting Tasks are queued by priority (FIFO within a priority), the owner runs at the priority
+ * of the highest waiter until it leaves, and the gate is then handed directly to that waiter.
+ */
+
+#ifndef TI_SYSBIOS_GATES_GATEMUTEXPRI_H_
+#define TI_SYSBIOS_GATES_GATEMUTEXPRI_H_
+
+#include <xdc/std.h>
+#include <xdc/runtime/IInstance.h>
+#include <ti/sysbios/knl/Task.h>
+
+typedef struct
+{
+	xdc_runtime_IInstance_Params *instance;
+	xdc_runtime_IInstance_Params __iprms;
+} GateMutexPri_Params;
+
+typedef struct GateMutexPri_Object
+{
+	CString name;
+	Task_Object *owner;
+	Int ownerOrigPri;					// the owner's priority before any inheritance
+
+	/* emulation state */
+	Task_Object *waitHead;				// by priority, linked by waitNext
+	struct GateMutexPri_Object *allNext;	// registry, for the run report
+
+	/* statistics */
+	UInt64 enters;
+	UInt64 blocks;						// enters that had to wait
+	UInt64 inherits;					// owner priority raises
+} GateMutexPri_Object;
+
+typedef GateMutexPri_Object GateMutexPri_Struct;
+typedef GateMutexPri_Object *GateMutexPri_Handle;
+
+Void GateMutexPri_Params_init(GateMutexPri_Params *params);
+Void GateMutexPri_construct(GateMutexPri_Struct *obj, const GateMutexPri_Params *params);
+GateMutexPri_Handle GateMutexPri_handle(GateMutexPri_Struct *obj);
+IArg GateMutexPri_enter(GateMutexPri_Handle gate);
+Void GateMutexPri_leave(GateMutexPri_Handle gate, IArg key);
+
+#endif /* TI_SYSBIOS_GATES_GATEMUTEXPRI_H_ */
@@ -0,0 +1,27 @@
+/*
+ * ti/sysbios/hal/Hwi.h - host build
+ *
+ * There are no real interrupts on the host - "disabling interrupts" defers the delivery of
+ * Clock ticks (and of the other emulated interrupt sources) until Hwi_restore re-enables them.
+ * Since only one Task owns the CPU at a time, that is all a Hwi_disable()/Hwi_restore() window
+ * has to guarantee.
+ */
+
+#ifndef TI_SYSBIOS_HAL_HWI_H_
+#define TI_SYSBIOS_HAL_HWI_H_
+
+#include <xdc/std.h>
+
+typedef struct
+{
+	SizeT hwiStackPeak;
+	SizeT hwiStackSize;
+	Ptr hwiStackBase;
+} Hwi_StackInfo;
+
+UInt Hwi_disable(Void);
+UInt Hwi_enable(Void);
+Void Hwi_restore(UInt key);
+Bool Hwi_getStackInfo(Hwi_StackInfo *stkInfo, Bool computeStackDepth);
+
+#endif /* TI_SYSBIOS_HAL_HWI_H_ */
@@ -0,0 +1,72 @@
+/*
+ * ti/sysbios/hal/Timer.h - host build
+ *
+ * A periodic hardware timer interrupt (Timer_A on the target). Every timer has a host thread that
+ * raises its interrupt every "period" microseconds of wall clock time; like a Clock tick, the
+ * interrupt is taken at the next kernel call of the running Task - or immediately when no Task
+ * is running - and the timer function runs in (emulated) Hwi context: it may post semaphores and
+ * pend with BIOS_NO_WAIT, and any Task it made ready gets the CPU once it returns. A real timer
+ * has one interrupt flag, so expiries raised while the previous one was still pending are lost -
+ * they are counted as overruns in the run report. Interrupts are deferred while Hwi_disable'd.
+ */
+
+#ifndef TI_SYSBIOS_HAL_TIMER_H_
+#define TI_SYSBIOS_HAL_TIMER_H_
+
+#include <xdc/std.h>
+#include <xdc/runtime/IInstance.h>
+#include <pthread.h>
+
+#define Timer_ANY	(~0)
+
+typedef Void (*Timer_FuncPtr)(UArg arg);
+
+typedef enum
+{
+	Timer_PeriodType_MICROSECS,
+	Timer_PeriodType_COUNTS				// treated as microseconds
+} Timer_PeriodType;
+
+typedef enum
+{
+	Timer_StartMode_AUTO,				// started by BIOS_start
+	Timer_StartMode_USER				// started by Timer_start
+} Timer_StartMode;
+
+typedef struct
+{
+	xdc_runtime_IInstance_Params *instance;
+	UInt32 period;
+	Timer_PeriodType periodType;
+	Timer_StartMode startMode;
+	UArg arg;
+	xdc_runtime_IInstance_Params __iprms;
+} Timer_Params;
+
+typedef struct Timer_Object
+{
+	CString name;
+	Timer_FuncPtr fxn;
+	UArg arg;
+	UInt32 period;						// microseconds
+	Bool active;
+	Bool pending;						// the interrupt flag
+	Bool threadStarted;
+	pthread_t thread;
+	struct Timer_Object *allNext;		// registry, for the run report
+
+	/* statistics */
+	UInt64 expiries;					// interrupts taken
+	UInt64 overruns;					// expiries lost while the previous one was pending
+} Timer_Object;
+
+typedef Timer_Object Timer_Struct;
+typedef Timer_Object *Timer_Handle;
+
+Void Timer_Params_init(Timer_Params *params);
+Void Timer_construct(Timer_Struct *obj, Int id, Timer_FuncPtr tickFxn, const Timer_Params *params, Ptr eb);
+Timer_Handle Timer_handle(Timer_Struct *obj);
+Void Timer_start(Timer_Handle handle);
+Void Timer_stop(Timer_Handle handle);
+
+#endif /* TI_SYSBIOS_HAL_TIMER_H_ */
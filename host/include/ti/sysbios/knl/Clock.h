@@ -0,0 +1,55 @@
+/*
+ * ti/sysbios/knl/Clock.h - host build
+ *
+ * A host thread generates a Clock tick every Clock_tickPeriod microseconds of wall clock time
+ * (the value of Clock.tickPeriod in empty.cfg). Ticks are delivered at the next kernel call of
+ * the running Task - or immediately when no Task is running - and the Clock functions due on
+ * that tick run in (emulated) Swi context, before any Task they made ready gets the CPU.
+ */
+
+#ifndef TI_SYSBIOS_KNL_CLOCK_H_
+#define TI_SYSBIOS_KNL_CLOCK_H_
+
+#include <xdc/std.h>
+#include <xdc/runtime/IInstance.h>
+
+typedef Void (*Clock_FuncPtr)(UArg arg);
+
+typedef struct
+{
+	xdc_runtime_IInstance_Params *instance;
+	UInt32 period;
+	Bool startFlag;
+	UArg arg;
+	xdc_runtime_IInstance_Params __iprms;
+} Clock_Params;
+
+typedef struct Clock_Object
+{
+	CString name;
+	Clock_FuncPtr fxn;
+	UArg arg;
+	UInt32 timeout;
+	UInt32 period;
+	Bool active;
+	UInt32 remaining;					// ticks until the next expiry
+	struct Clock_Object *allNext;		// registry, for the run report
+	UInt64 expiries;
+} Clock_Object;
+
+typedef Clock_Object Clock_Struct;
+typedef Clock_Object *Clock_Handle;
+
+extern UInt32 Clock_tickPeriod;			// microseconds per tick
+
+Void Clock_Params_init(Clock_Params *params);
+Clock_Handle Clock_create(Clock_FuncPtr fxn, UInt timeout, const Clock_Params *params, Ptr eb);
+Void Clock_construct(Clock_Struct *obj, Clock_FuncPtr fxn, UInt timeout, const Clock_Params *params);
+Clock_Handle Clock_handle(Clock_Struct *obj);
+Void Clock_start(Clock_Handle handle);
+Void Clock_stop(Clock_Handle handle);
+Void Clock_setPeriod(Clock_Handle handle, UInt32 period);
+Void Clock_setTimeout(Clock_Handle handle, UInt32 timeout);
+UInt32 Clock_getTicks(Void);
+
+#endif /* TI_SYSBIOS_KNL_CLOCK_H_ */
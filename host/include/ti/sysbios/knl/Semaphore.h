@@ -0,0 +1,61 @@
+/*
+ * ti/sysbios/knl/Semaphore.h - host build
+ *
+ * Counting and binary semaphores with the SYS/BIOS semantics: pending Tasks are queued in FIFO
+ * order, a post readies the first one (preempting the poster if it has a higher priority), and
+ * pends with a finite timeout expire on Clock ticks.
+ */
+
+#ifndef TI_SYSBIOS_KNL_SEMAPHORE_H_
+#define TI_SYSBIOS_KNL_SEMAPHORE_H_
+
+#include <xdc/std.h>
+#include <xdc/runtime/IInstance.h>
+#include <ti/sysbios/knl/Task.h>
+
+typedef enum
+{
+	Semaphore_Mode_COUNTING,
+	Semaphore_Mode_BINARY
+} Semaphore_Mode;
+
+typedef struct
+{
+	xdc_runtime_IInstance_Params *instance;
+	Semaphore_Mode mode;
+	xdc_runtime_IInstance_Params __iprms;
+} Semaphore_Params;
+
+typedef struct Semaphore_Object
+{
+	CString name;
+	Semaphore_Mode mode;
+	Int count;
+
+	/* emulation state */
+	Task_Object *waitHead;
+	Task_Object *waitTail;
+	struct Semaphore_Object *allNext;	// registry, for the run report
+
+	/* statistics */
+	UInt64 posts;
+	UInt64 pends;
+	UInt64 blocks;						// pends that had to wait
+	UInt64 timeouts;					// pends that returned FALSE
+	UInt64 countSum;					// sum of count over all ticks, for the mean
+} Semaphore_Object;
+
+typedef Semaphore_Object Semaphore_Struct;
+typedef Semaphore_Object *Semaphore_Handle;
+
+Void Semaphore_Params_init(Semaphore_Params *params);
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *params, Ptr eb);
+Void Semaphore_construct(Semaphore_Struct *obj, Int count, const Semaphore_Params *params);
+Semaphore_Handle Semaphore_handle(Semaphore_Struct *obj);
+Bool Semaphore_pend(Semaphore_Handle sem, UInt timeout);
+Void Semaphore_post(Semaphore_Handle sem);
+Void Semaphore_reset(Semaphore_Handle sem, Int count);
+Int Semaphore_getCount(Semaphore_Handle sem);
+CString Semaphore_Handle_name(Semaphore_Handle sem);
+
+#endif /* TI_SYSBIOS_KNL_SEMAPHORE_H_ */
@@ -0,0 +1,108 @@
+/*
+ * ti/sysbios/knl/Task.h - host build
+ *
+ * Every Task runs on its own pthread, but the emulated kernel lets exactly one of them own the
+ * (single) CPU at a time - the highest priority ready Task, round robin within a priority on
+ * Task_yield - exactly like the SYS/BIOS scheduler on the MSP430. Task switches happen at kernel
+ * calls (Semaphore/Task/Clock/Hwi APIs), which is also where pending Clock ticks are delivered.
+ */
+
+#ifndef TI_SYSBIOS_KNL_TASK_H_
+#define TI_SYSBIOS_KNL_TASK_H_
+
+#include <pthread.h>
+#include <xdc/std.h>
+#include <xdc/runtime/IInstance.h>
+
+#define Task_numPriorities	16
+
+typedef Void (*Task_FuncPtr)(UArg arg0, UArg arg1);
+
+typedef enum
+{
+	Task_Mode_RUNNING,
+	Task_Mode_READY,
+	Task_Mode_BLOCKED,
+	Task_Mode_TERMINATED,
+	Task_Mode_INACTIVE
+} Task_Mode;
+
+typedef struct
+{
+	xdc_runtime_IInstance_Params *instance;
+	UArg arg0;
+	UArg arg1;
+	Int priority;
+	Ptr stack;
+	SizeT stackSize;
+	Ptr env;
+	Bool vitalTaskFlag;
+	xdc_runtime_IInstance_Params __iprms;
+} Task_Params;
+
+typedef struct
+{
+	Int priority;
+	Ptr stack;
+	SizeT stackSize;
+	Ptr env;
+	Task_Mode mode;
+	Ptr sp;
+	SizeT used;
+} Task_Stat;
+
+struct Semaphore_Object;
+
+typedef struct Task_Object
+{
+	CString name;
+	Task_FuncPtr fxn;
+	UArg arg0;
+	UArg arg1;
+	Int priority;
+	SizeT stackSize;
+	Ptr env;
+	volatile Task_Mode mode;
+
+	/* emulation state */
+	pthread_t thread;
+	pthread_cond_t cv;
+	Bool threadStarted;
+	struct Task_Object *readyNext;		// ready queue of its priority
+	struct Task_Object *waitNext;		// wait queue of pendSem
+	struct Semaphore_Object *pendSem;
+	Bool pendResult;
+	Bool timed;
+	UInt32 deadline;					// tick at which a timed pend/sleep expires
+	struct Task_Object *allNext;		// registry, for the run report
+
+	/* statistics */
+	UInt64 switchesIn;
+	UInt64 preempted;					// switched out while still ready
+	UInt64 runNsec;
+} Task_Object;
+
+typedef Task_Object Task_Struct;
+typedef Task_Object *Task_Handle;
+
+typedef Void (*Task_SwitchFxn)(Task_Handle prev, Task_Handle next);	// Task.addHookSet switchFxn
+
+Void Task_Params_init(Task_Params *params);
+Task_Handle Task_create(Task_FuncPtr fxn, const Task_Params *params, Ptr eb);
+Void Task_construct(Task_Struct *obj, Task_FuncPtr fxn, const Task_Params *params, Ptr eb);
+Task_Handle Task_handle(Task_Struct *obj);
+Task_Handle Task_self(Void);
+Void Task_yield(Void);
+Void Task_sleep(UInt32 nticks);
+Void Task_exit(Void);
+Ptr Task_getEnv(Task_Handle handle);
+Void Task_setEnv(Task_Handle handle, Ptr env);
+Int Task_getPri(Task_Handle handle);
+Int Task_setPri(Task_Handle handle, Int newpri);
+Task_Mode Task_getMode(Task_Handle handle);
+Void Task_stat(Task_Handle handle, Task_Stat *statbuf);
+UInt Task_disable(Void);
+Void Task_restore(UInt key);
+CString Task_Handle_name(Task_Handle handle);
+
+#endif /* TI_SYSBIOS_KNL_TASK_H_ */
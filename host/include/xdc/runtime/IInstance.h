@@ -0,0 +1,18 @@
+/*
+ * xdc/runtime/IInstance.h - host build
+ *
+ * The common instance parameters of every SYS/BIOS object (only the name is used here - it
+ * labels the object in the run report).
+ */
+
+#ifndef XDC_RUNTIME_IINSTANCE_H_
+#define XDC_RUNTIME_IINSTANCE_H_
+
+#include <xdc/std.h>
+
+typedef struct
+{
+	CString name;
+} xdc_runtime_IInstance_Params;
+
+#endif /* XDC_RUNTIME_IINSTANCE_H_ */
@@ -0,0 +1,38 @@
+/*
+ * xdc/runtime/Log.h - host build
+ *
+ * Log_info0..Log_info5 are counted (see the run report) and printed to stdout only when the
+ * PC_LOG environment variable is set - printing every record would dominate any benchmark.
+ * Log_error0..Log_error2 are counted the same way and always printed, to stderr.
+ */
+
+#ifndef XDC_RUNTIME_LOG_H_
+#define XDC_RUNTIME_LOG_H_
+
+#include <xdc/std.h>
+
+Void HostLog_info(CString file, Int line, CString fmt, Int nargs,
+		IArg a1, IArg a2, IArg a3, IArg a4, IArg a5);
+Void HostLog_error(CString file, Int line, CString fmt, IArg a1, IArg a2);
+
+#define Log_info0(fmt) \
+	HostLog_info(__FILE__, __LINE__, (fmt), 0, 0, 0, 0, 0, 0)
+#define Log_info1(fmt, a1) \
+	HostLog_info(__FILE__, __LINE__, (fmt), 1, (IArg)(a1), 0, 0, 0, 0)
+#define Log_info2(fmt, a1, a2) \
+	HostLog_info(__FILE__, __LINE__, (fmt), 2, (IArg)(a1), (IArg)(a2), 0, 0, 0)
+#define Log_info3(fmt, a1, a2, a3) \
+	HostLog_info(__FILE__, __LINE__, (fmt), 3, (IArg)(a1), (IArg)(a2), (IArg)(a3), 0, 0)
+#define Log_info4(fmt, a1, a2, a3, a4) \
+	HostLog_info(__FILE__, __LINE__, (fmt), 4, (IArg)(a1), (IArg)(a2), (IArg)(a3), (IArg)(a4), 0)
+#define Log_info5(fmt, a1, a2, a3, a4, a5) \
+	HostLog_info(__FILE__, __LINE__, (fmt), 5, (IArg)(a1), (IArg)(a2), (IArg)(a3), (IArg)(a4), (IArg)(a5))
+
+#define Log_error0(fmt) \
+	HostLog_error(__FILE__, __LINE__, (fmt), 0, 0)
+#define Log_error1(fmt, a1) \
+	HostLog_error(__FILE__, __LINE__, (fmt), (IArg)(a1), 0)
+#define Log_error2(fmt, a1, a2) \
+	HostLog_error(__FILE__, __LINE__, (fmt), (IArg)(a1), (IArg)(a2))
+
+#endif /* XDC_RUNTIME_LOG_H_ */
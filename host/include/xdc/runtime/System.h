@@ -0,0 +1,14 @@
+/*
+ * xdc/runtime/System.h - host build
+ *
+ * System_abort only: it prints its message and ends the process with a failure status.
+ */
+
+#ifndef XDC_RUNTIME_SYSTEM_H_
+#define XDC_RUNTIME_SYSTEM_H_
+
+#include <xdc/std.h>
+
+Void System_abort(CString str);
+
+#endif /* XDC_RUNTIME_SYSTEM_H_ */
@@ -0,0 +1,18 @@
+/*
+ * xdc/runtime/Timestamp.h - host build
+ *
+ * The timestamp counts microseconds of the host's monotonic clock (HostBios_nowNsec), so its
+ * frequency is 1 MHz - close to the target's 1 MHz SMCLK-driven Timestamp, and 32 bits last over
+ * an hour before wrapping.
+ */
+
+#ifndef XDC_RUNTIME_TIMESTAMP_H_
+#define XDC_RUNTIME_TIMESTAMP_H_
+
+#include <xdc/std.h>
+#include <xdc/runtime/Types.h>
+
+UInt32 Timestamp_get32(Void);
+Void Timestamp_getFreq(Types_FreqHz *freq);
+
+#endif /* XDC_RUNTIME_TIMESTAMP_H_ */
@@ -0,0 +1,18 @@
+/*
+ * xdc/runtime/Types.h - host build
+ *
+ * Only the types the application uses.
+ */
+
+#ifndef XDC_RUNTIME_TYPES_H_
+#define XDC_RUNTIME_TYPES_H_
+
+#include <xdc/std.h>
+
+typedef struct
+{
+	UInt32 hi;
+	UInt32 lo;
+} Types_FreqHz;
+
+#endif /* XDC_RUNTIME_TYPES_H_ */
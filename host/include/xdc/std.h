@@ -0,0 +1,58 @@
+/*
+ * xdc/std.h - host build
+ *
+ * The XDC base types used by the application sources, mapped onto the host's C types.
+ * On the MSP430 target the real XDCtools header is used (Int/UInt are 16 bit there - the
+ * application must not rely on their width).
+ */
+
+#ifndef XDC_STD_H_
+#define XDC_STD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef char				Char;
+typedef unsigned char		UChar;
+typedef short				Short;
+typedef unsigned short		UShort;
+typedef int					Int;
+typedef unsigned int		UInt;
+typedef long				Long;
+typedef unsigned long		ULong;
+typedef long long			LLong;
+typedef unsigned long long	ULLong;
+typedef float				Float;
+typedef double				Double;
+typedef size_t				SizeT;
+typedef void				Void;
+typedef void *				Ptr;
+typedef char *				String;
+typedef const char *		CString;
+typedef unsigned short		Bool;
+typedef unsigned int		Uns;
+
+typedef int8_t				Int8;
+typedef int16_t				Int16;
+typedef int32_t				Int32;
+typedef int64_t				Int64;
+typedef uint8_t				UInt8;
+typedef uint16_t			UInt16;
+typedef uint32_t			UInt32;
+typedef uint64_t			UInt64;
+typedef uint8_t				Bits8;
+typedef uint16_t			Bits16;
+typedef uint32_t			Bits32;
+
+typedef intptr_t			IArg;
+typedef uintptr_t			UArg;
+typedef int					(*Fxn)();
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+
+#endif /* XDC_STD_H_ */
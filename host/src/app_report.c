@@ -0,0 +1,469 @@
+/*
+ * app_report.c - host build only
+ *
+ * Adds the application's own counters (LED mailbox and blink engine), the per-item latency
+ * histograms (latency.h), the backpressure and priority lane counters of the buffers
+ * (bounded_buffer.h), the priority inversion probe (inversion.h), the stage graph's throughput and
+ * link depths (stage.h), the event trace counters
+ * (trace.h), the time-slice counters (timeslice.h), the per-task CPU accounting (cpuacct.h), the
+ * stack profile (stackprof.h), the microbenchmark results (microbench.h), the overflow spool's
+ * counters (spool.h) and the consumers' newest windowed statistics (winstats.h) to the run report.
+ *
+ * With PC_TRACE=<file> the trace drain Task writes every event to <file> (a TraceFileHeader_T,
+ * then the raw 8-byte events), for host/tools/trace_decode.py - or, in a build with
+ * TRACE_DUMP_SIZE > 0, the report writes traceDump there, as the debugger would save it. With PC_CPUACCT=<file> the
+ * report writes the CPU accounting snapshot to <file>, for host/tools/cpu_flame.py, and with
+ * PC_STACKPROF=<file> stackProfStats, for host/tools/stack_budget.py - the host has no stack
+ * high-water marks, so that only exercises the tool; the real dump comes from the target.
+ * PC_MICROBENCH=<file> writes microBenchStats, for host/tools/bench.py. A MICROBENCH build ends
+ * the run once the benchmark is done, so PC_RUN_MSEC only bounds it. PC_SPOOL=<file> keeps the
+ * spool's emulated flash in <file> (host/src/driverlib_host.c), so the next run recovers it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/knl/Clock.h>
+
+#include "bios_host.h"
+#include "bounded_buffer.h"
+#include "led_mailbox.h"
+#include "led_blink.h"
+#include "latency.h"
+#include "inversion.h"
+#include "stage.h"
+#include "stage_graph.h"
+#include "trace.h"
+#include "timeslice.h"
+#include "topology.h"
+#include "cpuacct.h"
+#include "stackprof.h"
+#include "microbench.h"
+#include "spool.h"
+#include "winstats.h"
+
+static Void appReport(FILE *out, Double seconds)
+{
+	(Void)seconds;
+	fprintf(out, "ledMailbox: queued %lu coalesced %lu dropped %lu fetched %lu highWater %u\n",
+			(unsigned long)ledMailboxStats.queued, (unsigned long)ledMailboxStats.coalesced,
+			(unsigned long)ledMailboxStats.dropped, (unsigned long)ledMailboxStats.fetched,
+			(unsigned)ledMailboxStats.highWater);
+	fprintf(out, "ledBlink: requests %lu toggles %lu truncated %lu\n",
+			(unsigned long)ledBlinkStats.requests, (unsigned long)ledBlinkStats.toggles,
+			(unsigned long)ledBlinkStats.truncated);
+}
+
+static Void latencyLine(FILE *out, CString who, Int id, const LatencyHist_T *hist)
+{
+	Double usec = 1e6 / (latencyStats.freq ? latencyStats.freq : 1);
+
+	if(hist->count == 0) {
+		return;
+	}
+	fprintf(out, "latency %s", who);
+	if(id >= 0) {
+		fprintf(out, " %d", id);
+	}
+	fprintf(out, ": items %lu min %.0f avg %.1f p99 <= %.0f max %.0f us\n",
+			(unsigned long)hist->count, hist->min * usec, (Double)hist->sum / hist->count * usec,
+			Latency_percentile(hist, 99) * usec, hist->max * usec);
+}
+
+static Void latencyReport(FILE *out, Double seconds)
+{
+	Int i = 0;
+
+	(Void)seconds;
+	if(!LATENCY_TRACE) {
+		return;
+	}
+	latencyLine(out, "all", -1, &latencyStats.all);
+	for(i = 0 ; i < LATENCY_MAX_IDS ; i++) {
+		latencyLine(out, "producer", i + 1, &latencyStats.producer[i]);
+	}
+	for(i = 0 ; i < LATENCY_MAX_IDS ; i++) {
+		latencyLine(out, "consumer", i + 1, &latencyStats.consumer[i]);
+	}
+	for(i = 0 ; i < LATENCY_MAX_LANES ; i++) {
+		latencyLine(out, "lane", i, &latencyStats.lane[i]);
+	}
+	latencyLine(out, "isr", -1, &latencyStats.isr);
+	for(i = 0 ; i < LATENCY_MAX_IDS ; i++) {
+		latencyLine(out, "insert", i + 1, &latencyStats.insert[i]);	// producer cycle time in insert_item
+	}
+	fprintf(out, "latency reordered: %lu\n", (unsigned long)latencyStats.reordered);
+	fprintf(out, "latency bins (2^b us):");
+	for(i = 0 ; i < LATENCY_BINS ; i++) {
+		fprintf(out, " %lu", (unsigned long)latencyStats.all.bins[i]);
+	}
+	fprintf(out, "\n");
+}
+
+static Void inversionReport(FILE *out, Double seconds)
+{
+	(Void)seconds;
+	if(!INVERSION_SCENARIO) {
+		return;
+	}
+	fprintf(out, "inversion: mutex %s, probes %lu hog bursts %lu\n", BB_MUTEX_PI ? "GateMutexPri" : "binary semaphore",
+			(unsigned long)inversionStats.probes, (unsigned long)inversionStats.bursts);
+	latencyLine(out, "probe block", -1, &inversionStats.block);
+}
+
+static Void stageReport(FILE *out, Double seconds)
+{
+	Int bottleneck = Stage_bottleneck();
+	Int s = 0;
+	Int l = 0;
+
+	if(stageStats.numStages == 0) {
+		return;
+	}
+	fprintf(out, "stages: %d stages %d links, transmitted %lu checksum %lu\n", stageStats.numStages, stageStats.numLinks,
+			(unsigned long)stageTransmitStats.items, (unsigned long)stageTransmitStats.checksum);
+	for(s = 0 ; s < stageStats.numStages ; s++) {
+		const StageDef_T *def = Stage_def(s);
+		const StageCounters_T *counters = &stageStats.stage[s];
+
+		fprintf(out, "  %-10s workers %d in %8.0f/s out %8.0f/s calls %lu%s\n", def->name, def->workers,
+				counters->itemsIn / seconds, counters->itemsOut / seconds, (unsigned long)counters->calls,
+				(s == bottleneck) ? "  <- bottleneck" : "");
+	}
+	for(l = 0 ; l < stageStats.numLinks ; l++) {
+		const StageLinkCounters_T *link = &stageStats.link[l];
+
+		fprintf(out, "  link %-10s depth mean %.2f max %d of %d\n", stageGraph.links[l].name,
+				link->samples ? (Double)link->depthSum / link->samples : 0.0, link->depthMax, link->capacity);
+	}
+}
+
+static Void bufferReport(FILE *out, Double seconds)
+{
+	BoundedBuffer_Handle bb;
+	Int b = 0;
+	Int l = 0;
+
+	(Void)seconds;
+	for(b = 0 ; b < BoundedBuffer_numCreated() ; b++) {
+		bb = BoundedBuffer_get(b);
+		fprintf(out, "backpressure %d: policy %d param %u drops %lu timeouts %lu overwrites %lu\n", b,
+				(Int)bb->policy, bb->policyParam, (unsigned long)bb->policyStats.drops,
+				(unsigned long)bb->policyStats.timeouts, (unsigned long)bb->policyStats.overwrites);
+		if(bb->isrStats.inserts != 0 || bb->isrStats.overflows != 0) {
+			fprintf(out, "isr %d: inserts %lu overflows %lu busy %lu\n", b,
+					(unsigned long)bb->isrStats.inserts, (unsigned long)bb->isrStats.overflows,
+					(unsigned long)bb->isrStats.busy);
+		}
+		if(bb->engine == bbEngineMpmc_e || bb->engine == bbEngineLanes_e) {
+			fprintf(out, "ring %d: cellWaits %lu\n", b, (unsigned long)bb->cellWaits);
+		}
+		if(bb->engine != bbEngineLanes_e) {
+			continue;
+		}
+		fprintf(out, "lanes %d: quota %u starvePromotions %lu taken", b, bb->laneState->starveQuota,
+				(unsigned long)bb->laneState->starvePromotions);
+		for(l = 0 ; l < bb->lanes ; l++) {
+			fprintf(out, " %lu", (unsigned long)bb->laneState->taken[l]);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+static Void spoolReport(FILE *out, Double seconds)
+{
+	(Void)seconds;
+	if(spoolStats.spooled == 0 && spoolStats.recovered == 0 && spoolStats.torn == 0 && spoolStats.crcErrors == 0) {
+		return;
+	}
+	fprintf(out, "spool: pending %u max %u spooled %lu unspooled %lu dropped %lu records %lu bytes %lu erases %lu\n",
+			spoolStats.pending, spoolStats.pendingMax, (unsigned long)spoolStats.spooled,
+			(unsigned long)spoolStats.unspooled, (unsigned long)spoolStats.dropped,
+			(unsigned long)spoolStats.records, (unsigned long)spoolStats.bytes, (unsigned long)spoolStats.erases);
+	fprintf(out, "spool recovery: items %lu records %lu torn %lu crcErrors %lu\n",
+			(unsigned long)spoolStats.recovered, (unsigned long)spoolStats.recoveredRecords,
+			(unsigned long)spoolStats.torn, (unsigned long)spoolStats.crcErrors);
+}
+
+static Void winStatsReport(FILE *out, Double seconds)
+{
+	static const CString units[] = {"items", "ticks"};
+	WinStatsSnapshot_T snap;
+	WinStats_Handle ws;
+	const WinStatsDef_T *def;
+	Int e = 0, w = 0, b = 0;
+
+	(Void)seconds;
+	for(e = 0 ; e < WinStats_numOpen() ; e++) {
+		ws = WinStats_get(e);
+		for(w = 0 ; w < ws->numWindows ; w++) {
+			def = ws->window[w].def;
+			if(!WinStats_read(ws, w, &snap)) {
+				continue;
+			}
+			fprintf(out, "winstats consumer %d window %d (%u x %u %s): #%lu items %lu mean %.2f var %.2f min %d max %d hist",
+					ws->owner, w, (unsigned)def->panes, (unsigned)def->paneLength, units[def->unit & 1],
+					(unsigned long)snap.window, (unsigned long)snap.acc.count, WinStats_meanQ8(&snap.acc) / 256.0,
+					WinStats_varianceQ8(&snap.acc) / 256.0, snap.acc.min, snap.acc.max);
+			for(b = 0 ; b < WINSTATS_BUCKETS ; b++) {
+				fprintf(out, " %lu", (unsigned long)snap.acc.hist[b]);
+			}
+			fprintf(out, "\n");
+		}
+	}
+}
+
+static Void timeSliceLine(FILE *out, CString name, const TimeSliceTask_T *entry)
+{
+	fprintf(out, "  %-12s %10lu %10lu %10lu %10lu\n", name, (unsigned long)entry->slices,
+			(unsigned long)entry->voluntaryBlocks, (unsigned long)entry->forcedPreemptions,
+			(unsigned long)entry->ticks);
+}
+
+static Void timeSliceReport(FILE *out, Double seconds)
+{
+	Char name[24];
+	Int i = 0;
+
+	(Void)seconds;
+	fprintf(out, "timeslice: policy %d quantum %d ticks %lu yields %lu skipped %lu idle %lu\n",
+			TIMESLICE_POLICY, TIMESLICE_QUANTUM, (unsigned long)timeSliceStats.ticks,
+			(unsigned long)timeSliceStats.yields, (unsigned long)timeSliceStats.skippedYields,
+			(unsigned long)timeSliceStats.idleTicks);
+	fprintf(out, "  %-12s %10s %10s %10s %10s\n", "task", "slices", "blocks", "preempted", "ticks");
+	for(i = 0 ; i < Topology_numTasks() ; i++) {
+		Task_Handle task = Topology_task(i);
+		snprintf(name, sizeof(name), "%s %d", Task_Handle_name(task), Topology_workerId(task));
+		timeSliceLine(out, name, &timeSliceStats.task[i]);
+	}
+	timeSliceLine(out, "other", &timeSliceStats.task[TIMESLICE_OTHER]);
+}
+
+static Void cpuAcctName(Char *name, Int size, const CpuAcctTask_T *entry)
+{
+	if(entry->idle) {
+		snprintf(name, size, "idle");
+	} else if(entry->role == topoProducer_e) {
+		snprintf(name, size, "producer %u", entry->id);
+	} else if(entry->role == topoConsumer_e) {
+		snprintf(name, size, "consumer %u", entry->id);
+	} else if(entry->role == topoStage_e) {
+		snprintf(name, size, "stage %u", entry->id);
+	} else {
+		snprintf(name, size, "pri %u", entry->priority);
+	}
+}
+
+static Void cpuAcctReport(FILE *out, Double seconds)
+{
+	static const CString waits[CPUACCT_WAITS] = {"other", "emptySlots", "fullSlots", "mutex", "ledSrvSched", "sleep"};
+	static CpuAcctStats_T snap;
+	CString path = getenv("PC_CPUACCT");
+	Double msec = 0;
+	Double busy = 0;
+	FILE *f;
+	Char name[24];
+	Int i = 0;
+	Int w = 0;
+
+	(Void)seconds;
+	if(!CPU_ACCOUNTING) {
+		return;
+	}
+	CpuAcct_snapshot(&snap);
+	msec = 1e3 / (snap.freq ? snap.freq : 1);
+	for(i = 0 ; i < snap.numTasks ; i++) {
+		busy += snap.task[i].idle ? 0 : snap.task[i].running;
+	}
+	fprintf(out, "cpu: load %.1f%% over %.0f ms, %u tasks\n", snap.elapsed ? 100.0 * busy / snap.elapsed : 0.0,
+			snap.elapsed * msec, (unsigned)snap.numTasks);
+	for(i = 0 ; i < snap.numTasks ; i++) {
+		const CpuAcctTask_T *entry = &snap.task[i];
+
+		cpuAcctName(name, sizeof(name), entry);
+		fprintf(out, "  %-12s run %5.1f%% %9.1f ms slices %lu preempted %lu/%.1f ms blocked", name,
+				snap.elapsed ? 100.0 * entry->running / snap.elapsed : 0.0, entry->running * msec,
+				(unsigned long)entry->slices, (unsigned long)entry->preemptions, entry->preempted * msec);
+		for(w = 0 ; w < CPUACCT_WAITS ; w++) {
+			if(entry->blocks[w] > 0) {
+				fprintf(out, " %s %lu/%.1f ms", waits[w], (unsigned long)entry->blocks[w], entry->blocked[w] * msec);
+			}
+		}
+		fprintf(out, "\n");
+	}
+	if(path == NULL) {
+		return;
+	}
+	f = fopen(path, "wb");
+	if(f == NULL) {
+		perror(path);
+		return;
+	}
+	fwrite(&snap, offsetof(CpuAcctStats_T, task) + snap.numTasks * sizeof(CpuAcctTask_T), 1, f);
+	fclose(f);
+}
+
+static Void microBenchReport(FILE *out, Double seconds)
+{
+	static const CString names[MICROBENCH_COUNT] = {"loop", "sem_post", "sem_pend", "sem_pend_post",
+			"sem_pingpong", "yield", "yield_switch", "task_get_env", "task_set_env", "log_info2",
+			"wrap_modulo", "wrap_mask"};
+	CString path = getenv("PC_MICROBENCH");
+	const MicroBenchResult_T *result;
+	FILE *f;
+	Int i = 0;
+
+	(Void)seconds;
+	if(!MICROBENCH) {
+		return;
+	}
+	fprintf(out, "microbench: %s, %u iterations x %u repeats, Timestamp %lu Hz\n", microBenchStats.done ? "done" : "NOT DONE",
+			MICROBENCH_ITERATIONS, MICROBENCH_REPEATS, (unsigned long)microBenchStats.freq);
+	for(i = 0 ; i < MICROBENCH_COUNT ; i++) {
+		result = &microBenchStats.result[i];
+		if(result->iterations == 0) {
+			continue;
+		}
+		fprintf(out, "  %-14s %10.1f ns/op\n", names[i],
+				1e9 * result->best / ((Double)result->iterations * (microBenchStats.freq ? microBenchStats.freq : 1)));
+	}
+	if(path == NULL) {
+		return;
+	}
+	f = fopen(path, "wb");
+	if(f == NULL) {
+		perror(path);
+		return;
+	}
+	fwrite(&microBenchStats, sizeof(microBenchStats), 1, f);
+	fclose(f);
+}
+
+static Clock_Struct microBenchDoneObj;
+
+/*
+ * Function: microBenchDoneCheck
+ * Description: Clock function of a MICROBENCH build - end the run once the benchmark is done.
+ * Input: UArg arg - unused.
+ * Output: void
+*/
+static Void microBenchDoneCheck(UArg arg)
+{
+	(Void)arg;
+	if(microBenchStats.done) {
+		HostBios_stop();
+	}
+}
+
+static Void stackProfReport(FILE *out, Double seconds)
+{
+	static const CString kinds[] = {"task", "idle", "system"};
+	CString path = getenv("PC_STACKPROF");
+	const StackProfEntry_T *entry;
+	FILE *f;
+	Int i = 0;
+
+	(Void)seconds;
+	if(!STACK_PROFILE) {
+		return;
+	}
+	StackProf_sample();
+	fprintf(out, "stack: samples %lu (the host has no high-water marks)", (unsigned long)stackProfStats.samples);
+	for(i = 0 ; i < stackProfStats.numEntries ; i++) {
+		entry = &stackProfStats.entry[i];
+		fprintf(out, " %s", kinds[entry->kind < 3 ? entry->kind : 0]);
+		if(entry->role != topoNone_e) {
+			fprintf(out, "/%s %u", entry->role == topoProducer_e ? "producer" : (entry->role == topoStage_e ? "stage" : "consumer"), entry->id);
+		} else if(entry->kind == stackTask_e) {
+			fprintf(out, "/pri %u", entry->priority);
+		}
+		fprintf(out, " %u", entry->size);
+	}
+	fprintf(out, "\n");
+	if(path == NULL) {
+		return;
+	}
+	f = fopen(path, "wb");
+	if(f == NULL) {
+		perror(path);
+		return;
+	}
+	fwrite(&stackProfStats, offsetof(StackProfStats_T, entry) + stackProfStats.numEntries * sizeof(StackProfEntry_T), 1, f);
+	fclose(f);
+}
+
+static FILE *traceFile;
+
+static Void traceFileSink(const TraceEvent_T *events, Int n)
+{
+	fwrite(events, sizeof(TraceEvent_T), n, traceFile);
+}
+
+static Void traceReport(FILE *out, Double seconds)
+{
+	(Void)seconds;
+	if(!TRACE_EVENTS) {
+		return;
+	}
+	Trace_flush();							// the events written since the drain Task's last run
+	fprintf(out, "trace: drained %lu dropped %lu drainHighWater %u dumped %u\n",
+			(unsigned long)traceStats.drained, (unsigned long)traceStats.dropped,
+			(unsigned)traceStats.drainHighWater, (unsigned)traceStats.dumped);
+	if(traceFile == NULL) {
+		return;
+	}
+#if TRACE_DUMP_SIZE
+	fwrite(&traceDump, sizeof(traceDump), 1, traceFile);
+#endif
+	fclose(traceFile);
+}
+
+static Void traceFileOpen(Void)
+{
+	CString path = getenv("PC_TRACE");
+	TraceFileHeader_T header;
+	Types_FreqHz freq;
+
+	if(path == NULL || !TRACE_EVENTS) {
+		return;
+	}
+	traceFile = fopen(path, "wb");
+	if(traceFile == NULL) {
+		perror(path);
+		return;
+	}
+	if(TRACE_DUMP_SIZE) {
+		return;								// main installs Trace_dumpSink, the report writes traceDump
+	}
+	Timestamp_getFreq(&freq);
+	memcpy(header.magic, "PCTRACE1", sizeof(header.magic));
+	header.freq = freq.lo;
+	header.ringSize = TRACE_RING_SIZE;
+	fwrite(&header, sizeof(header), 1, traceFile);
+	Trace_setSink(traceFileSink);
+}
+
+__attribute__((constructor))
+static Void appReportRegister(Void)
+{
+	HostBios_addReportFxn(appReport);
+	HostBios_addReportFxn(latencyReport);
+	HostBios_addReportFxn(bufferReport);
+	HostBios_addReportFxn(spoolReport);
+	HostBios_addReportFxn(winStatsReport);
+	HostBios_addReportFxn(inversionReport);
+	HostBios_addReportFxn(stageReport);
+	HostBios_addReportFxn(traceReport);
+	HostBios_addReportFxn(timeSliceReport);
+	HostBios_addReportFxn(cpuAcctReport);
+	HostBios_addReportFxn(stackProfReport);
+	HostBios_addReportFxn(microBenchReport);
+	if(MICROBENCH) {
+		HostBios_staticClock(&microBenchDoneObj, "microBenchDone", microBenchDoneCheck, 1, 1, TRUE, 0);
+	}
+	traceFileOpen();
+}
@@ -0,0 +1,1302 @@
+/*
+ * bios_host.c - host build only
+ *
+ * A uniprocessor emulation of the SYS/BIOS kernel services used by the application.
+ *
+ * Every Task has its own pthread, but a single kernel lock (kLock) and the "current" pointer
+ * make sure only one of them executes application code at a time: a Task that is not current
+ * waits on its own condition variable, and each kernel call ends in kLeave(), which delivers
+ * pending Clock ticks, runs the scheduler and - if the caller lost the CPU - parks it until it
+ * is scheduled again. Scheduling is strictly by priority, FIFO within a priority, exactly like
+ * the SYS/BIOS Task scheduler.
+ *
+ * A clock thread raises a tick every Clock_tickPeriod microseconds. The running Task takes the
+ * tick at its next kernel call (there is no way to interrupt a pthread between two arbitrary
+ * instructions), or the clock thread takes it itself while the CPU is idle. Clock functions run
+ * in emulated Swi context: scheduling is deferred until the last one due on the tick returns.
+ * Timer interrupts (ti/sysbios/hal/Timer.h) come from a thread per timer the same way, and their
+ * functions run in emulated Hwi context, ahead of the Clock functions.
+ *
+ * For record/replay (record_host.c) the ticks can be held: a running Task then takes them only
+ * at HostBios_tickPoint, and on a replay they come from the record instead of the clock thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/gates/GateMutexPri.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/hal/Timer.h>
+#include <xdc/runtime/Timestamp.h>
+
+#include "bios_host.h"
+
+#define HOST_RUN_MSEC_DEFAULT	2000	// run length when PC_RUN_MSEC is not set
+#define HOST_THROUGHPUT_SEM		"fullSlots"	// posts on the semaphores of this name count as produced items
+#define HOST_MAX_REPORT_FXNS	16
+#define HOST_MAX_HOOK_SETS		4
+
+UInt32 Clock_tickPeriod = 1000;			// overwritten by the generated host_cfg.c
+
+/* kernel state - everything below is protected by kLock */
+static pthread_mutex_t kLock = PTHREAD_MUTEX_INITIALIZER;
+static Task_Object *readyHead[Task_numPriorities];
+static Task_Object *readyTail[Task_numPriorities];
+static Task_Object *current;			// the Task owning the CPU, NULL when idle
+static Bool started;
+static Bool needResched;				// a reschedule was deferred (Swi context, Task_disable)
+static Bool taskLocked;
+static Bool hwiDisabled;
+static Int swiDepth;					// > 0 while a Clock or Timer function runs
+static UInt32 pendingTicks;				// ticks raised but not yet delivered
+static UInt32 ticks;
+static UInt64 runStartNsec;				// when current got the CPU
+static Bool ticksHeld;					// a running Task takes ticks at HostBios_tickPoint only
+static Bool tickPoint;					// inside HostBios_tickPoint
+static HostBios_IdleTickFxn idleTickFxn;	// replaces the real-time ticks (replay)
+
+static Task_Object *allTasks;
+static Semaphore_Object *allSems;
+static Clock_Object *allClocks;
+static Timer_Object *allTimers;
+static GateMutexPri_Object *allGates;
+
+static HostBios_ReportFxn reportFxns[HOST_MAX_REPORT_FXNS];
+static Int numReportFxns;
+
+static Task_SwitchFxn switchFxns[HOST_MAX_HOOK_SETS];	// Task.addHookSet switch hooks
+static Int numHookSets;
+
+static __thread Task_Object *selfTask;	// the Task of the calling thread, NULL on main/clock threads
+
+static pthread_mutex_t stopLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stopCv = PTHREAD_COND_INITIALIZER;
+static Bool stopRequested;				// HostBios_stop - end the run before PC_RUN_MSEC
+
+UInt64 HostBios_nowNsec(Void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (UInt64)ts.tv_sec * 1000000000ull + (UInt64)ts.tv_nsec;
+}
+
+Void HostBios_addReportFxn(HostBios_ReportFxn fxn)
+{
+	if(numReportFxns < HOST_MAX_REPORT_FXNS) {
+		reportFxns[numReportFxns++] = fxn;
+	}
+}
+
+//---------------------------------------------------------------------------
+// ready queues and scheduler
+//---------------------------------------------------------------------------
+static Void readyPush(Task_Object *task)
+{
+	Int pri = task->priority;
+
+	task->readyNext = NULL;
+	if(readyTail[pri] == NULL) {
+		readyHead[pri] = task;
+	} else {
+		readyTail[pri]->readyNext = task;
+	}
+	readyTail[pri] = task;
+}
+
+static Void readyRemove(Task_Object *task)
+{
+	Int pri = task->priority;
+	Task_Object *prev = NULL;
+	Task_Object *t = readyHead[pri];
+
+	while(t != NULL && t != task) {
+		prev = t;
+		t = t->readyNext;
+	}
+	if(t == NULL) {
+		return;
+	}
+	if(prev == NULL) {
+		readyHead[pri] = task->readyNext;
+	} else {
+		prev->readyNext = task->readyNext;
+	}
+	if(readyTail[pri] == task) {
+		readyTail[pri] = prev;
+	}
+	task->readyNext = NULL;
+}
+
+static Task_Object *highestReady(Void)
+{
+	Int pri;
+
+	for(pri = Task_numPriorities - 1 ; pri >= 0 ; pri--) {
+		if(readyHead[pri] != NULL) {
+			return readyHead[pri];
+		}
+	}
+	return NULL;
+}
+
+/*
+ Hands the CPU to the highest priority ready Task. The running Task stays at the head of its
+ ready queue when it is preempted, so it resumes before its equal priority peers.
+ */
+static Void schedule(Void)
+{
+	Task_Object *next;
+	Task_Object *prev = current;
+	UInt64 now;
+	Int i;
+
+	if(!started || swiDepth > 0 ||
+			(taskLocked && prev != NULL && prev->mode == Task_Mode_RUNNING)) {
+		needResched = TRUE;
+		return;
+	}
+	needResched = FALSE;
+
+	next = highestReady();
+	if(next == prev) {
+		return;
+	}
+
+	now = HostBios_nowNsec();
+	if(prev != NULL) {
+		prev->runNsec += now - runStartNsec;
+		if(prev->mode == Task_Mode_RUNNING) {
+			prev->mode = Task_Mode_READY;
+			prev->preempted++;
+		}
+	}
+	current = next;
+	runStartNsec = now;
+	if(next != NULL) {
+		next->mode = Task_Mode_RUNNING;
+		next->switchesIn++;
+	}
+	for(i = 0 ; i < numHookSets ; i++) {		// like SYS/BIOS: inside the scheduler, before next runs
+		switchFxns[i](prev, next);
+	}
+	if(next != NULL) {
+		pthread_cond_signal(&next->cv);
+	}
+}
+
+static Void makeReady(Task_Object *task)
+{
+	task->mode = Task_Mode_READY;
+	readyPush(task);
+}
+
+static Void waitRemove(Semaphore_Object *sem, Task_Object *task)
+{
+	Task_Object *prev = NULL;
+	Task_Object *t = sem->waitHead;
+
+	while(t != NULL && t != task) {
+		prev = t;
+		t = t->waitNext;
+	}
+	if(t == NULL) {
+		return;
+	}
+	if(prev == NULL) {
+		sem->waitHead = task->waitNext;
+	} else {
+		prev->waitNext = task->waitNext;
+	}
+	if(sem->waitTail == task) {
+		sem->waitTail = prev;
+	}
+	task->waitNext = NULL;
+}
+
+//---------------------------------------------------------------------------
+// tick delivery
+//---------------------------------------------------------------------------
+static Void runClockFxn(Clock_Object *clk)
+{
+	swiDepth++;
+	pthread_mutex_unlock(&kLock);
+	clk->fxn(clk->arg);
+	pthread_mutex_lock(&kLock);
+	swiDepth--;
+}
+
+/*
+ A Timer function runs like a Clock function - a Hwi may post and pend with BIOS_NO_WAIT only,
+ which is what swiDepth enforces in the emulation.
+ */
+static Void runTimerFxn(Timer_Object *timer)
+{
+	timer->pending = FALSE;
+	timer->expiries++;
+	swiDepth++;
+	pthread_mutex_unlock(&kLock);
+	timer->fxn(timer->arg);
+	pthread_mutex_lock(&kLock);
+	swiDepth--;
+}
+
+/*
+ Delivers the pending interrupts: the Timer functions whose interrupt is pending, then the
+ pending ticks - expires timed pends/sleeps and runs the Clock functions due.
+ */
+static Void service(Void)
+{
+	Task_Object *task;
+	Semaphore_Object *sem;
+	Clock_Object *clk;
+	Timer_Object *timer;
+
+	for(timer = allTimers ; timer != NULL && !hwiDisabled && swiDepth == 0 ; timer = timer->allNext) {
+		if(timer->pending) {
+			runTimerFxn(timer);
+		}
+	}
+	if(ticksHeld && !tickPoint && current != NULL) {
+		return;
+	}
+	while(pendingTicks > 0 && !hwiDisabled && swiDepth == 0) {
+		pendingTicks--;
+		ticks++;
+
+		for(sem = allSems ; sem != NULL ; sem = sem->allNext) {
+			sem->countSum += (sem->count > 0) ? (UInt64)sem->count : 0;
+		}
+
+		for(task = allTasks ; task != NULL ; task = task->allNext) {
+			if(task->mode == Task_Mode_BLOCKED && task->timed && task->deadline == ticks) {
+				if(task->pendSem != NULL) {
+					waitRemove(task->pendSem, task);
+					task->pendSem = NULL;
+				}
+				task->timed = FALSE;
+				task->pendResult = FALSE;
+				makeReady(task);
+				needResched = TRUE;
+			}
+		}
+
+		for(clk = allClocks ; clk != NULL ; clk = clk->allNext) {
+			if(clk->active && --clk->remaining == 0) {
+				if(clk->period != 0) {
+					clk->remaining = clk->period;
+				} else {
+					clk->active = FALSE;
+				}
+				clk->expiries++;
+				runClockFxn(clk);
+			}
+		}
+	}
+}
+
+static Void kEnter(Void)
+{
+	pthread_mutex_lock(&kLock);
+}
+
+/*
+ Ends every kernel call. On a Task thread this is the only place where the Task can lose or
+ regain the CPU: it delivers pending ticks, reschedules, and parks the thread while it is not
+ current. Calls made from a Clock function, from main() or from the clock thread just return.
+ */
+static Void kLeave(Void)
+{
+	Task_Object *self = selfTask;
+
+	if(self != NULL) {
+		for(;;) {
+			if(current == self) {
+				if(swiDepth > 0) {
+					break;					// called from a Clock function running on this thread
+				}
+				service();
+				tickPoint = FALSE;
+				if(needResched || highestReady() != self) {
+					schedule();
+				}
+				if(current == self) {
+					break;
+				}
+			}
+			pthread_cond_wait(&self->cv, &kLock);
+		}
+	}
+	pthread_mutex_unlock(&kLock);
+}
+
+//---------------------------------------------------------------------------
+// Task
+//---------------------------------------------------------------------------
+static Void *taskThread(Void *arg)
+{
+	Task_Object *task = (Task_Object *)arg;
+
+	selfTask = task;
+	kEnter();
+	kLeave();								// wait for the first time slice
+	task->fxn(task->arg0, task->arg1);
+	Task_exit();
+	return NULL;
+}
+
+static Void startThread(Task_Object *task)
+{
+	pthread_attr_t attr;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if(pthread_create(&task->thread, &attr, taskThread, task) != 0) {
+		fprintf(stderr, "bios_host: can't create the thread of Task %s\n", task->name);
+		exit(EXIT_FAILURE);
+	}
+	pthread_attr_destroy(&attr);
+	task->threadStarted = TRUE;
+}
+
+Void Task_Params_init(Task_Params *params)
+{
+	memset(params, 0, sizeof(*params));
+	params->priority = 1;
+	params->vitalTaskFlag = TRUE;
+	params->instance = &params->__iprms;
+}
+
+Void Task_construct(Task_Struct *obj, Task_FuncPtr fxn, const Task_Params *params, Ptr eb)
+{
+	Task_Params defaults;
+
+	(Void)eb;
+	if(params == NULL) {
+		Task_Params_init(&defaults);
+		params = &defaults;
+	}
+	memset(obj, 0, sizeof(*obj));
+	obj->name = (params->instance != NULL) ? params->instance->name : NULL;
+	obj->fxn = fxn;
+	obj->arg0 = params->arg0;
+	obj->arg1 = params->arg1;
+	obj->priority = params->priority;
+	obj->stackSize = params->stackSize;
+	obj->env = params->env;
+	pthread_cond_init(&obj->cv, NULL);
+
+	kEnter();
+	obj->allNext = allTasks;
+	allTasks = obj;
+	if(obj->priority < 0 || obj->priority >= Task_numPriorities) {
+		obj->mode = Task_Mode_INACTIVE;
+	} else {
+		makeReady(obj);
+	}
+	if(started) {
+		startThread(obj);
+		needResched = TRUE;
+	}
+	kLeave();
+}
+
+Task_Handle Task_create(Task_FuncPtr fxn, const Task_Params *params, Ptr eb)
+{
+	Task_Object *obj = malloc(sizeof(*obj));
+
+	if(obj == NULL) {
+		return NULL;
+	}
+	Task_construct(obj, fxn, params, eb);
+	return obj;
+}
+
+Task_Handle Task_handle(Task_Struct *obj)
+{
+	return obj;
+}
+
+Task_Handle Task_self(Void)
+{
+	return current;
+}
+
+Void Task_yield(Void)
+{
+	kEnter();
+	if(current != NULL && current->mode == Task_Mode_RUNNING) {
+		readyRemove(current);				// to the tail of its priority's ready queue
+		readyPush(current);
+		needResched = TRUE;
+	}
+	kLeave();
+}
+
+Void Task_sleep(UInt32 nticks)
+{
+	Task_Object *self = selfTask;
+
+	kEnter();
+	if(self != NULL && self == current && swiDepth == 0 && nticks != 0) {
+		readyRemove(self);
+		self->mode = Task_Mode_BLOCKED;
+		self->pendSem = NULL;
+		self->timed = TRUE;
+		self->deadline = ticks + nticks;
+		schedule();
+	}
+	kLeave();
+}
+
+Void Task_exit(Void)
+{
+	Task_Object *self = selfTask;
+
+	kEnter();
+	readyRemove(self);
+	self->mode = Task_Mode_TERMINATED;
+	schedule();
+	pthread_mutex_unlock(&kLock);
+	pthread_exit(NULL);
+}
+
+Ptr Task_getEnv(Task_Handle handle)
+{
+	return handle->env;
+}
+
+Void Task_setEnv(Task_Handle handle, Ptr env)
+{
+	handle->env = env;
+}
+
+Int Task_getPri(Task_Handle handle)
+{
+	return handle->priority;
+}
+
+/*
+ Task_setPri under kLock - also the priority inheritance of GateMutexPri.
+ */
+static Void changePri(Task_Object *task, Int newpri)
+{
+	if(task->mode == Task_Mode_READY || task->mode == Task_Mode_RUNNING) {
+		readyRemove(task);
+		task->priority = newpri;
+		readyPush(task);
+		needResched = TRUE;
+	} else {
+		task->priority = newpri;
+	}
+}
+
+Int Task_setPri(Task_Handle handle, Int newpri)
+{
+	Int oldpri;
+
+	kEnter();
+	oldpri = handle->priority;
+	changePri(handle, newpri);
+	kLeave();
+	return oldpri;
+}
+
+Task_Mode Task_getMode(Task_Handle handle)
+{
+	return handle->mode;
+}
+
+Void Task_stat(Task_Handle handle, Task_Stat *statbuf)
+{
+	statbuf->priority = handle->priority;
+	statbuf->stack = NULL;
+	statbuf->stackSize = handle->stackSize;
+	statbuf->env = handle->env;
+	statbuf->mode = handle->mode;
+	statbuf->sp = NULL;
+	statbuf->used = 0;						// host thread stacks say nothing about the target's
+}
+
+UInt Task_disable(Void)
+{
+	UInt key;
+
+	kEnter();
+	key = taskLocked;
+	taskLocked = TRUE;
+	kLeave();
+	return key;
+}
+
+Void Task_restore(UInt key)
+{
+	kEnter();
+	taskLocked = (Bool)key;
+	kLeave();
+}
+
+CString Task_Handle_name(Task_Handle handle)
+{
+	return handle->name;
+}
+
+//---------------------------------------------------------------------------
+// Semaphore
+//---------------------------------------------------------------------------
+Void Semaphore_Params_init(Semaphore_Params *params)
+{
+	memset(params, 0, sizeof(*params));
+	params->mode = Semaphore_Mode_COUNTING;
+	params->instance = &params->__iprms;
+}
+
+Void Semaphore_construct(Semaphore_Struct *obj, Int count, const Semaphore_Params *params)
+{
+	Semaphore_Params defaults;
+
+	if(params == NULL) {
+		Semaphore_Params_init(&defaults);
+		params = &defaults;
+	}
+	memset(obj, 0, sizeof(*obj));
+	obj->name = (params->instance != NULL) ? params->instance->name : NULL;
+	obj->mode = params->mode;
+	obj->count = (obj->mode == Semaphore_Mode_BINARY && count > 1) ? 1 : count;
+
+	kEnter();
+	obj->allNext = allSems;
+	allSems = obj;
+	kLeave();
+}
+
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *params, Ptr eb)
+{
+	Semaphore_Object *obj = malloc(sizeof(*obj));
+
+	(Void)eb;
+	if(obj == NULL) {
+		return NULL;
+	}
+	Semaphore_construct(obj, count, params);
+	return obj;
+}
+
+Semaphore_Handle Semaphore_handle(Semaphore_Struct *obj)
+{
+	return obj;
+}
+
+Bool Semaphore_pend(Semaphore_Handle sem, UInt timeout)
+{
+	Task_Object *self = selfTask;
+	Bool result;
+
+	kEnter();
+	sem->pends++;
+	if(sem->count > 0) {
+		sem->count--;
+		kLeave();
+		return TRUE;
+	}
+	if(timeout == BIOS_NO_WAIT || self == NULL || self != current || swiDepth > 0) {
+		sem->timeouts++;
+		kLeave();
+		return FALSE;
+	}
+
+	sem->blocks++;
+	readyRemove(self);
+	self->mode = Task_Mode_BLOCKED;
+	self->pendSem = sem;
+	self->pendResult = FALSE;
+	self->timed = (timeout != BIOS_WAIT_FOREVER);
+	self->deadline = ticks + timeout;
+	self->waitNext = NULL;
+	if(sem->waitTail == NULL) {
+		sem->waitHead = self;
+	} else {
+		sem->waitTail->waitNext = self;
+	}
+	sem->waitTail = self;
+	schedule();
+	kLeave();								// returns once posted (or timed out) and scheduled
+
+	kEnter();
+	result = self->pendResult;
+	if(!result) {
+		sem->timeouts++;
+	}
+	pthread_mutex_unlock(&kLock);
+	return result;
+}
+
+Void Semaphore_post(Semaphore_Handle sem)
+{
+	Task_Object *task;
+
+	kEnter();
+	sem->posts++;
+	task = sem->waitHead;
+	if(task != NULL) {
+		sem->waitHead = task->waitNext;
+		if(sem->waitHead == NULL) {
+			sem->waitTail = NULL;
+		}
+		task->waitNext = NULL;
+		task->pendSem = NULL;
+		task->timed = FALSE;
+		task->pendResult = TRUE;
+		makeReady(task);
+		needResched = TRUE;
+	} else if(sem->mode == Semaphore_Mode_BINARY) {
+		sem->count = 1;
+	} else {
+		sem->count++;
+	}
+	kLeave();
+}
+
+Void Semaphore_reset(Semaphore_Handle sem, Int count)
+{
+	kEnter();
+	sem->count = count;
+	kLeave();
+}
+
+Int Semaphore_getCount(Semaphore_Handle sem)
+{
+	return sem->count;
+}
+
+CString Semaphore_Handle_name(Semaphore_Handle sem)
+{
+	return sem->name;
+}
+
+//---------------------------------------------------------------------------
+// GateMutexPri
+//---------------------------------------------------------------------------
+Void GateMutexPri_Params_init(GateMutexPri_Params *params)
+{
+	memset(params, 0, sizeof(*params));
+	params->instance = &params->__iprms;
+}
+
+Void GateMutexPri_construct(GateMutexPri_Struct *obj, const GateMutexPri_Params *params)
+{
+	memset(obj, 0, sizeof(*obj));
+	obj->name = (params != NULL && params->instance != NULL) ? params->instance->name : NULL;
+
+	kEnter();
+	obj->allNext = allGates;
+	allGates = obj;
+	kLeave();
+}
+
+GateMutexPri_Handle GateMutexPri_handle(GateMutexPri_Struct *obj)
+{
+	return obj;
+}
+
+/*
+ A free gate is taken at once; the owner entering again gets a key that makes its leave a no-op.
+ Otherwise the caller is queued by priority, the owner inherits its priority if it is higher,
+ and the caller blocks until GateMutexPri_leave hands it the gate.
+ */
+IArg GateMutexPri_enter(GateMutexPri_Handle gate)
+{
+	Task_Object *self = selfTask;
+	Task_Object *prev = NULL;
+	Task_Object *t;
+
+	kEnter();
+	gate->enters++;
+	if(gate->owner == NULL) {
+		gate->owner = self;
+		gate->ownerOrigPri = (self != NULL) ? self->priority : 0;
+		kLeave();
+		return 0;
+	}
+	if(gate->owner == self) {
+		kLeave();
+		return 1;
+	}
+	if(self == NULL || self != current || swiDepth > 0) {
+		fprintf(stderr, "bios_host: GateMutexPri %s entered outside a Task\n", gate->name ? gate->name : "");
+		exit(EXIT_FAILURE);
+	}
+
+	gate->blocks++;
+	for(t = gate->waitHead ; t != NULL && t->priority >= self->priority ; t = t->waitNext) {
+		prev = t;
+	}
+	self->waitNext = t;
+	if(prev == NULL) {
+		gate->waitHead = self;
+	} else {
+		prev->waitNext = self;
+	}
+	if(gate->owner->priority < self->priority) {
+		changePri(gate->owner, self->priority);
+		gate->inherits++;
+	}
+	readyRemove(self);
+	self->mode = Task_Mode_BLOCKED;
+	self->timed = FALSE;
+	schedule();
+	kLeave();								// returns once the gate was handed over and scheduled
+	return 0;
+}
+
+Void GateMutexPri_leave(GateMutexPri_Handle gate, IArg key)
+{
+	Task_Object *next;
+
+	if(key != 0) {
+		return;								// a nested enter
+	}
+	kEnter();
+	if(gate->owner != NULL && gate->owner->priority != gate->ownerOrigPri) {
+		changePri(gate->owner, gate->ownerOrigPri);
+	}
+	next = gate->waitHead;
+	gate->owner = next;
+	if(next != NULL) {
+		gate->waitHead = next->waitNext;
+		next->waitNext = NULL;
+		gate->ownerOrigPri = next->priority;
+		makeReady(next);
+		needResched = TRUE;
+	}
+	kLeave();
+}
+
+//---------------------------------------------------------------------------
+// Clock
+//---------------------------------------------------------------------------
+Void Clock_Params_init(Clock_Params *params)
+{
+	memset(params, 0, sizeof(*params));
+	params->instance = &params->__iprms;
+}
+
+Void Clock_construct(Clock_Struct *obj, Clock_FuncPtr fxn, UInt timeout, const Clock_Params *params)
+{
+	Clock_Params defaults;
+
+	if(params == NULL) {
+		Clock_Params_init(&defaults);
+		params = &defaults;
+	}
+	memset(obj, 0, sizeof(*obj));
+	obj->name = (params->instance != NULL) ? params->instance->name : NULL;
+	obj->fxn = fxn;
+	obj->arg = params->arg;
+	obj->timeout = timeout;
+	obj->period = params->period;
+
+	kEnter();
+	obj->allNext = allClocks;
+	allClocks = obj;
+	if(params->startFlag && timeout != 0) {
+		obj->remaining = timeout;
+		obj->active = TRUE;
+	}
+	kLeave();
+}
+
+Clock_Handle Clock_create(Clock_FuncPtr fxn, UInt timeout, const Clock_Params *params, Ptr eb)
+{
+	Clock_Object *obj = malloc(sizeof(*obj));
+
+	(Void)eb;
+	if(obj == NULL) {
+		return NULL;
+	}
+	Clock_construct(obj, fxn, timeout, params);
+	return obj;
+}
+
+Clock_Handle Clock_handle(Clock_Struct *obj)
+{
+	return obj;
+}
+
+Void Clock_start(Clock_Handle handle)
+{
+	kEnter();
+	if(handle->timeout != 0) {
+		handle->remaining = handle->timeout;
+		handle->active = TRUE;
+	}
+	kLeave();
+}
+
+Void Clock_stop(Clock_Handle handle)
+{
+	kEnter();
+	handle->active = FALSE;
+	kLeave();
+}
+
+Void Clock_setPeriod(Clock_Handle handle, UInt32 period)
+{
+	handle->period = period;
+}
+
+Void Clock_setTimeout(Clock_Handle handle, UInt32 timeout)
+{
+	handle->timeout = timeout;
+}
+
+UInt32 Clock_getTicks(Void)
+{
+	return ticks;
+}
+
+//---------------------------------------------------------------------------
+// Timer
+//---------------------------------------------------------------------------
+Void Timer_Params_init(Timer_Params *params)
+{
+	memset(params, 0, sizeof(*params));
+	params->instance = &params->__iprms;
+	params->periodType = Timer_PeriodType_MICROSECS;
+	params->startMode = Timer_StartMode_AUTO;
+}
+
+/*
+ Raises the interrupt of a timer every period microseconds while it is active. A pending
+ interrupt is taken by the running Task at its next kernel call, or here while the CPU is idle.
+ */
+static Void *timerThread(Void *arg)
+{
+	Timer_Object *timer = (Timer_Object *)arg;
+	struct timespec next;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for(;;) {
+		next.tv_nsec += (long)timer->period * 1000;
+		while(next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		kEnter();
+		if(timer->active) {
+			if(timer->pending) {
+				timer->overruns++;			// one interrupt flag - this expiry is lost
+			}
+			timer->pending = TRUE;
+			if(current == NULL && swiDepth == 0) {	// idle - nobody else will take the interrupt
+				service();
+				schedule();
+			}
+		}
+		pthread_mutex_unlock(&kLock);
+	}
+	return NULL;
+}
+
+/*
+ Called holding kLock, once the timer is active and BIOS_start ran.
+ */
+static Void startTimerThread(Timer_Object *timer)
+{
+	pthread_attr_t attr;
+
+	if(timer->threadStarted || timer->period == 0) {
+		return;
+	}
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if(pthread_create(&timer->thread, &attr, timerThread, timer) != 0) {
+		fprintf(stderr, "bios_host: can't create the thread of Timer %s\n", timer->name ? timer->name : "");
+		exit(EXIT_FAILURE);
+	}
+	pthread_attr_destroy(&attr);
+	timer->threadStarted = TRUE;
+}
+
+Void Timer_construct(Timer_Struct *obj, Int id, Timer_FuncPtr tickFxn, const Timer_Params *params, Ptr eb)
+{
+	Timer_Params defaults;
+
+	(Void)id;								// Timer_ANY - every emulated timer is free
+	(Void)eb;
+	if(params == NULL) {
+		Timer_Params_init(&defaults);
+		params = &defaults;
+	}
+	memset(obj, 0, sizeof(*obj));
+	obj->name = (params->instance != NULL) ? params->instance->name : NULL;
+	obj->fxn = tickFxn;
+	obj->arg = params->arg;
+	obj->period = params->period;
+
+	kEnter();
+	obj->allNext = allTimers;
+	allTimers = obj;
+	obj->active = (params->startMode == Timer_StartMode_AUTO);
+	if(obj->active && started) {
+		startTimerThread(obj);
+	}
+	kLeave();
+}
+
+Timer_Handle Timer_handle(Timer_Struct *obj)
+{
+	return obj;
+}
+
+Void Timer_start(Timer_Handle handle)
+{
+	kEnter();
+	handle->active = TRUE;
+	if(started) {
+		startTimerThread(handle);
+	}
+	kLeave();
+}
+
+Void Timer_stop(Timer_Handle handle)
+{
+	kEnter();
+	handle->active = FALSE;
+	handle->pending = FALSE;
+	kLeave();
+}
+
+/*
+ Replay clock: no real-time ticks - while the CPU is idle, idleTickFxn says how many ticks to
+ raise (the record's idle ticks); a running Task gets its ticks at HostBios_tickPoint.
+ */
+static Void idleTickLoop(Void)
+{
+	struct timespec poll = {0, 20000};
+	UInt32 raise;
+
+	for(;;) {
+		nanosleep(&poll, NULL);
+		kEnter();
+		if(current == NULL && swiDepth == 0) {
+			raise = idleTickFxn();
+			if(raise > 0) {
+				pendingTicks += raise;
+				service();
+				schedule();
+			}
+		}
+		pthread_mutex_unlock(&kLock);
+	}
+}
+
+static Void *clockThread(Void *arg)
+{
+	struct timespec next;
+
+	(Void)arg;
+	if(idleTickFxn != NULL) {
+		idleTickLoop();
+	}
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for(;;) {
+		next.tv_nsec += (long)Clock_tickPeriod * 1000;
+		while(next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+		kEnter();
+		pendingTicks++;
+		if(current == NULL && swiDepth == 0) {	// idle - nobody else will take the tick
+			service();
+			schedule();
+		}
+		pthread_mutex_unlock(&kLock);
+	}
+	return NULL;
+}
+
+//---------------------------------------------------------------------------
+// Timestamp - microseconds, no scheduling point
+//---------------------------------------------------------------------------
+UInt32 Timestamp_get32(Void)
+{
+	return (UInt32)(HostBios_nowNsec() / 1000);
+}
+
+Void Timestamp_getFreq(Types_FreqHz *freq)
+{
+	freq->hi = 0;
+	freq->lo = 1000000;
+}
+
+//---------------------------------------------------------------------------
+// Hwi
+//---------------------------------------------------------------------------
+UInt Hwi_disable(Void)
+{
+	UInt key;
+
+	kEnter();
+	key = hwiDisabled;
+	hwiDisabled = TRUE;
+	kLeave();
+	return key;
+}
+
+UInt Hwi_enable(Void)
+{
+	UInt key;
+
+	kEnter();
+	key = hwiDisabled;
+	hwiDisabled = FALSE;
+	kLeave();								// delivers the ticks raised meanwhile
+	return key;
+}
+
+Void Hwi_restore(UInt key)
+{
+	kEnter();
+	hwiDisabled = (Bool)key;
+	kLeave();
+}
+
+Bool Hwi_getStackInfo(Hwi_StackInfo *stkInfo, Bool computeStackDepth)
+{
+	(Void)computeStackDepth;
+	stkInfo->hwiStackPeak = 0;				// no system stack - the Clock functions run on the ticking thread
+	stkInfo->hwiStackSize = 0;
+	stkInfo->hwiStackBase = NULL;
+	return FALSE;
+}
+
+//---------------------------------------------------------------------------
+// record/replay support
+//---------------------------------------------------------------------------
+Void HostBios_holdTicks(Bool hold)
+{
+	kEnter();
+	ticksHeld = hold;
+	kLeave();
+}
+
+Void HostBios_tickPoint(UInt32 raise)
+{
+	kEnter();
+	pendingTicks += raise;
+	tickPoint = TRUE;
+	kLeave();								// delivers them, and reschedules if a Clock function says so
+}
+
+Void HostBios_setIdleTickFxn(HostBios_IdleTickFxn fxn)
+{
+	idleTickFxn = fxn;
+}
+
+Void HostBios_stop(Void)
+{
+	pthread_mutex_lock(&stopLock);
+	stopRequested = TRUE;
+	pthread_cond_signal(&stopCv);
+	pthread_mutex_unlock(&stopLock);
+}
+
+//---------------------------------------------------------------------------
+// static configuration
+//---------------------------------------------------------------------------
+Void HostBios_staticTaskHook(Task_SwitchFxn switchFxn)
+{
+	if(switchFxn != NULL && numHookSets < HOST_MAX_HOOK_SETS) {
+		switchFxns[numHookSets++] = switchFxn;
+	}
+}
+
+Void HostBios_staticTask(Task_Object *obj, CString name, Task_FuncPtr fxn, Int priority,
+		SizeT stackSize, UArg arg0, UArg arg1)
+{
+	Task_Params params;
+
+	Task_Params_init(&params);
+	params.instance->name = name;
+	params.priority = priority;
+	params.stackSize = stackSize;
+	params.arg0 = arg0;
+	params.arg1 = arg1;
+	Task_construct(obj, fxn, &params, NULL);
+}
+
+Void HostBios_staticSemaphore(Semaphore_Object *obj, CString name, Int count, Semaphore_Mode mode)
+{
+	Semaphore_Params params;
+
+	Semaphore_Params_init(&params);
+	params.instance->name = name;
+	params.mode = mode;
+	Semaphore_construct(obj, count, &params);
+}
+
+Void HostBios_staticClock(Clock_Object *obj, CString name, Clock_FuncPtr fxn, UInt32 timeout,
+		UInt32 period, Bool startFlag, UArg arg)
+{
+	Clock_Params params;
+
+	Clock_Params_init(&params);
+	params.instance->name = name;
+	params.period = period;
+	params.startFlag = startFlag;
+	params.arg = arg;
+	Clock_construct(obj, fxn, timeout, &params);
+}
+
+//---------------------------------------------------------------------------
+// BIOS
+//---------------------------------------------------------------------------
+static Void report(FILE *out, Double seconds)
+{
+	Task_Object *task;
+	Semaphore_Object *sem;
+	Clock_Object *clk;
+	Timer_Object *timer;
+	GateMutexPri_Object *gate;
+	CString throughputSem = getenv("PC_THROUGHPUT_SEM");
+	UInt64 items = 0;
+	UInt64 countSum = 0;
+	Double rate, occupancy;
+	Int buffers = 0;
+	Int i;
+
+	if(throughputSem == NULL) {
+		throughputSem = HOST_THROUGHPUT_SEM;
+	}
+
+	fprintf(out, "run: %.3f s, %u ticks of %u us\n", seconds, (unsigned)ticks, (unsigned)Clock_tickPeriod);
+
+	fprintf(out, "%-16s %5s %4s %12s %12s %7s\n", "task", "arg0", "pri", "switchesIn", "preempted", "cpu%");
+	for(task = allTasks ; task != NULL ; task = task->allNext) {
+		fprintf(out, "%-16s %5lu %4d %12llu %12llu %7.2f\n", task->name ? task->name : "(task)",
+				(unsigned long)task->arg0, task->priority, (unsigned long long)task->switchesIn,
+				(unsigned long long)task->preempted, 100.0 * (Double)task->runNsec / (seconds * 1e9));
+	}
+
+	fprintf(out, "%-16s %12s %12s %12s %12s %6s %9s\n", "semaphore", "posts", "pends", "blocks", "timeouts",
+			"count", "meanCount");
+	for(sem = allSems ; sem != NULL ; sem = sem->allNext) {
+		fprintf(out, "%-16s %12llu %12llu %12llu %12llu %6d %9.2f\n", sem->name ? sem->name : "(semaphore)",
+				(unsigned long long)sem->posts, (unsigned long long)sem->pends,
+				(unsigned long long)sem->blocks, (unsigned long long)sem->timeouts, sem->count,
+				(ticks != 0) ? (Double)sem->countSum / ticks : 0.0);
+	}
+
+	fprintf(out, "%-16s %8s %12s\n", "clock", "period", "expiries");
+	for(clk = allClocks ; clk != NULL ; clk = clk->allNext) {
+		fprintf(out, "%-16s %8u %12llu\n", clk->name ? clk->name : "(clock)",
+				(unsigned)clk->period, (unsigned long long)clk->expiries);
+	}
+
+	if(allGates != NULL) {
+		fprintf(out, "%-16s %12s %12s %12s\n", "gate", "enters", "blocks", "inherits");
+	}
+	for(gate = allGates ; gate != NULL ; gate = gate->allNext) {
+		fprintf(out, "%-16s %12llu %12llu %12llu\n", gate->name ? gate->name : "(gate)",
+				(unsigned long long)gate->enters, (unsigned long long)gate->blocks,
+				(unsigned long long)gate->inherits);
+	}
+
+	if(allTimers != NULL) {
+		fprintf(out, "%-16s %8s %12s %12s\n", "timer", "period", "expiries", "overruns");
+	}
+	for(timer = allTimers ; timer != NULL ; timer = timer->allNext) {
+		fprintf(out, "%-16s %8u %12llu %12llu\n", timer->name ? timer->name : "(timer)",
+				(unsigned)timer->period, (unsigned long long)timer->expiries,
+				(unsigned long long)timer->overruns);
+	}
+
+	HostGpio_report(out, seconds);
+	HostLog_report(out, seconds);
+	for(i = 0 ; i < numReportFxns ; i++) {
+		reportFxns[i](out, seconds);
+	}
+
+	for(sem = allSems ; sem != NULL ; sem = sem->allNext) {		// summed over all the pipelines
+		if(sem->name != NULL && strcmp(sem->name, throughputSem) == 0) {
+			items += sem->posts;
+			countSum += sem->countSum;
+			buffers++;
+		}
+	}
+	if(buffers == 0) {			// no pipeline buffer (frame_bench, led_stress, queue_bench) - nothing to rate
+		return;
+	}
+	rate = (Double)items / seconds;
+	occupancy = (ticks != 0) ? (Double)countSum / ticks : 0.0;
+	fprintf(out, "throughput: %.0f items/s (%llu posts on %s)\n", rate, (unsigned long long)items, throughputSem);
+	/* Little's law: mean time in the buffer = mean number of items in it / arrival rate */
+	fprintf(out, "latency: %.1f us mean buffer residence (mean occupancy %.2f)\n",
+			(rate > 0.0) ? occupancy / rate * 1e6 : 0.0, occupancy);
+}
+
+Void BIOS_start(Void)
+{
+	Task_Object *task;
+	Timer_Object *timer;
+	pthread_t clk;
+	CString env = getenv("PC_RUN_MSEC");
+	long runMsec = (env != NULL) ? atol(env) : HOST_RUN_MSEC_DEFAULT;
+	struct timespec runTime;
+	UInt64 startNsec;
+
+	kEnter();
+	started = TRUE;
+	for(task = allTasks ; task != NULL ; task = task->allNext) {
+		if(!task->threadStarted) {
+			startThread(task);
+		}
+	}
+	for(timer = allTimers ; timer != NULL ; timer = timer->allNext) {
+		if(timer->active) {
+			startTimerThread(timer);
+		}
+	}
+	startNsec = HostBios_nowNsec();
+	schedule();
+	pthread_mutex_unlock(&kLock);
+
+	if(pthread_create(&clk, NULL, clockThread, NULL) != 0) {
+		fprintf(stderr, "bios_host: can't create the clock thread\n");
+		exit(EXIT_FAILURE);
+	}
+
+	clock_gettime(CLOCK_REALTIME, &runTime);	// stopCv's clock
+	runTime.tv_sec += runMsec / 1000;
+	runTime.tv_nsec += (runMsec % 1000) * 1000000L;
+	if(runTime.tv_nsec >= 1000000000L) {
+		runTime.tv_nsec -= 1000000000L;
+		runTime.tv_sec++;
+	}
+	pthread_mutex_lock(&stopLock);
+	while(!stopRequested && pthread_cond_timedwait(&stopCv, &stopLock, &runTime) == 0) {
+	}
+	pthread_mutex_unlock(&stopLock);
+
+	kEnter();								// freezes the kernel - no Task gets the CPU again
+	if(current != NULL) {
+		current->runNsec += HostBios_nowNsec() - runStartNsec;
+	}
+	report(stdout, (Double)(HostBios_nowNsec() - startNsec) / 1e9);
+	fflush(stdout);
+	_Exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,147 @@
+/*
+ * driverlib_host.c - host build only
+ *
+ * Emulated GPIO output ports. Every pin toggle is counted, so the LED activity of a run shows up
+ * in its report; the clock system and watchdog calls have nothing to do on the host. Emulated
+ * flash for the spool (spool.h): a memory-mapped file, programmed and erased with the FlashCtl
+ * rules.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <xdc/std.h>
+#include <driverlib.h>
+
+#include "bios_host.h"
+
+#define HOST_GPIO_PORTS	16
+#define HOST_GPIO_PINS	16
+
+static uint16_t portDir[HOST_GPIO_PORTS];
+static uint16_t portOut[HOST_GPIO_PORTS];
+static UInt64 pinToggles[HOST_GPIO_PORTS][HOST_GPIO_PINS];
+
+void WDT_A_hold(uint16_t baseAddress)
+{
+	(void)baseAddress;
+}
+
+void UCS_initClockSignal(uint8_t selectedClockSignal, uint16_t clockSource, uint16_t clockSourceDivider)
+{
+	(void)selectedClockSignal;
+	(void)clockSource;
+	(void)clockSourceDivider;
+}
+
+void UCS_initFLLSettle(uint16_t fsystem, uint16_t ratio)
+{
+	(void)fsystem;
+	(void)ratio;
+}
+
+void GPIO_setAsOutputPin(uint8_t selectedPort, uint16_t selectedPins)
+{
+	portDir[selectedPort % HOST_GPIO_PORTS] |= selectedPins;
+}
+
+void GPIO_setOutputLowOnPin(uint8_t selectedPort, uint16_t selectedPins)
+{
+	portOut[selectedPort % HOST_GPIO_PORTS] &= (uint16_t)~selectedPins;
+}
+
+void GPIO_setOutputHighOnPin(uint8_t selectedPort, uint16_t selectedPins)
+{
+	portOut[selectedPort % HOST_GPIO_PORTS] |= selectedPins;
+}
+
+void GPIO_toggleOutputOnPin(uint8_t selectedPort, uint16_t selectedPins)
+{
+	Int port = selectedPort % HOST_GPIO_PORTS;
+	Int pin;
+
+	portOut[port] ^= selectedPins;
+	for(pin = 0 ; pin < HOST_GPIO_PINS ; pin++) {
+		if(selectedPins & (1u << pin)) {
+			pinToggles[port][pin]++;
+		}
+	}
+}
+
+uint8_t GPIO_getInputPinValue(uint8_t selectedPort, uint16_t selectedPins)
+{
+	return (portOut[selectedPort % HOST_GPIO_PORTS] & selectedPins) ? 1 : 0;
+}
+
+Void HostGpio_report(FILE *out, Double seconds)
+{
+	Int port, pin;
+
+	for(port = 0 ; port < HOST_GPIO_PORTS ; port++) {
+		for(pin = 0 ; pin < HOST_GPIO_PINS ; pin++) {
+			if(pinToggles[port][pin] != 0) {
+				fprintf(out, "gpio P%d.%d: %llu toggles (%.1f/s)\n", port, pin,
+						(unsigned long long)pinToggles[port][pin], (Double)pinToggles[port][pin] / seconds);
+			}
+		}
+	}
+}
+
+/*
+ Flash erases to 0xFF and programming can only clear bits - programming a byte twice ANDs the
+ values, as on the target. The erase clears the HOST_FLASH_SEGMENT-aligned segment holding the
+ address; the mapping is page aligned, so its segments are too.
+ */
+void FlashCtl_eraseSegment(uint8_t *flash_ptr)
+{
+	uintptr_t segment = (uintptr_t)flash_ptr & ~(uintptr_t)(HOST_FLASH_SEGMENT - 1);
+
+	memset((void *)segment, 0xFF, HOST_FLASH_SEGMENT);
+}
+
+void FlashCtl_write8(uint8_t *data_ptr, uint8_t *flash_ptr, uint16_t count)
+{
+	uint16_t i;
+
+	for(i = 0 ; i < count ; i++) {
+		flash_ptr[i] &= data_ptr[i];
+	}
+}
+
+uint8_t *HostFlash_map(uint32_t size)
+{
+	const char *path = getenv("PC_SPOOL");
+	struct stat st;
+	void *flash;
+	int fd;
+
+	if(path == NULL) {
+		flash = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(flash == MAP_FAILED) {
+			fprintf(stderr, "pc_bench: can't map %u bytes of flash\n", (unsigned)size);
+			exit(EXIT_FAILURE);
+		}
+		memset(flash, 0xFF, size);
+		return (uint8_t *)flash;
+	}
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if(fd < 0 || fstat(fd, &st) != 0 || (st.st_size < size && ftruncate(fd, size) != 0)) {
+		fprintf(stderr, "pc_bench: can't open the spool file %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	flash = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(flash == MAP_FAILED) {
+		fprintf(stderr, "pc_bench: can't map the spool file %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	if(st.st_size < size) {
+		memset((uint8_t *)flash + st.st_size, 0xFF, size - st.st_size);	// the new part is erased
+	}
+	return (uint8_t *)flash;
+}
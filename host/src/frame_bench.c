@@ -0,0 +1,281 @@
+/*
+ * frame_bench.c - host build only
+ *
+ * Times the two APIs of frame_buffer.h against each other on frames of 16, 256 and 1024 bytes:
+ *
+ *  1. one Task: bursts of FB_SLOTS frames in, then FB_SLOTS frames out - no Task switch, so the
+ *     semaphore calls cost the same in both modes and the difference is the copies;
+ *  2. two Tasks: a producer and a consumer Task move FB_FRAMES frames through the FB_SLOTS slot
+ *     buffer, blocking on it - the Task switches of the emulated kernel come on top.
+ *
+ * In each phase
+ *
+ *  - copy: the producer builds the payload in its own array and FrameBuffer_put copies it into
+ *    a slot, FrameBuffer_get copies it out into the consumer's array, which checks it;
+ *  - zero-copy: the producer builds the payload straight in the slot (FrameBuffer_reserve/
+ *    commit), the consumer checks it in place (FrameBuffer_acquire/release).
+ *
+ * Both sides touch every payload byte in both modes, so the difference is the two memcpy calls
+ * of the copying API. Every byte is checked against the frame's number - a corrupt or lost frame
+ * is an error, and the bench exits with a failure status. The semaphore calls run on the host's
+ * emulated kernel, so the ns/frame are host figures: compare the modes with each other only.
+ * Run length: FB_FRAMES=<frames per size and mode> (and PC_RUN_MSEC, the emulation's limit).
+ *
+ *   cmake --build build && ./build/frame_bench
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bios_host.h"
+#include "frame_buffer.h"
+
+#define FB_SLOTS			4
+#define FB_FRAMES_DEFAULT	20000		// frames per size and mode, in each phase
+#define FB_NUM_SIZES		3
+#define FB_NUM_MODES		2			// 0 - copy, 1 - zero-copy
+#define FB_NUM_PHASES		(FB_NUM_SIZES * FB_NUM_MODES)
+
+#if FRAME_PAYLOAD_SIZE < 1024
+#error "frame_bench needs FRAME_PAYLOAD_SIZE >= 1024 (host/CMakeLists.txt)"
+#endif
+
+static const Int frameSizes[FB_NUM_SIZES] = {16, 256, 1024};
+static CString modeNames[FB_NUM_MODES] = {"copy", "zero-copy"};
+
+static FrameBuffer_T frameBuffer;
+static Frame_T frames[FB_SLOTS];
+static Task_Struct producerObj;
+static Task_Struct consumerObj;
+static Semaphore_Struct pairStart;			// posted by the producer when the one Task phases are done
+static UInt8 producerData[FRAME_PAYLOAD_SIZE];	// the copying producer's frame
+static UInt8 consumerData[FRAME_PAYLOAD_SIZE];	// the copying consumer's frame
+
+static UInt32 framesPerPhase;
+static UInt64 burstNsec[FB_NUM_PHASES];		// phase 1
+static UInt32 burstErrors[FB_NUM_PHASES];
+static UInt64 phaseEnd[FB_NUM_PHASES + 1];	// phase 2: [0] - its start, [p + 1] - end of phase p
+static UInt32 phaseErrors[FB_NUM_PHASES];
+static Int phasesDone;
+
+/*
+ * Function: fillPayload
+ * Description: the producer's work on a frame - write its len bytes.
+ * Input: UInt8 *data - the payload, Int len - bytes, UInt32 n - the frame's number.
+ * Output: void
+ * Algorithm: byte i is (n + i) & 0xFF, so a frame from another position or a torn copy shows.
+*/
+static Void fillPayload(UInt8 *data, Int len, UInt32 n)
+{
+	Int i;
+
+	for(i = 0 ; i < len ; i++) {
+		data[i] = (UInt8)(n + i);
+	}
+}
+
+/*
+ * Function: checkPayload
+ * Description: the consumer's work on a frame - read and check its bytes.
+ * Input: const UInt8 *data - the payload, Int got - its length, Int len - the expected length, UInt32 n - the expected number.
+ * Output: Bool - TRUE if the frame is the expected one, intact.
+ * Algorithm: count the bytes that differ from fillPayload's - no early exit, so the loop
+ * 			  vectorizes like the fill and the copies stay visible next to it.
+*/
+static Bool checkPayload(const UInt8 *data, Int got, Int len, UInt32 n)
+{
+	Int i, wrong = 0;
+
+	if(got != len) {
+		return FALSE;
+	}
+	for(i = 0 ; i < len ; i++) {
+		wrong += (data[i] != (UInt8)(n + i));
+	}
+	return wrong == 0;
+}
+
+/*
+ * Function: produceFrame
+ * Description: build frame n of len bytes and insert it - with a copy (mode 0) or in place.
+ * Input: Int mode, Int len, UInt32 n.
+ * Output: void - a failed reserve is logged by frame_buffer.c, and the consumer misses the frame.
+*/
+static Void produceFrame(Int mode, Int len, UInt32 n)
+{
+	Frame_T *frame;
+
+	if(mode == 0) {
+		fillPayload(producerData, len, n);
+		FrameBuffer_put(&frameBuffer, producerData, len);
+		return;
+	}
+	frame = FrameBuffer_reserve(&frameBuffer);
+	if(frame != NULL) {
+		fillPayload(frame->data, len, n);
+		FrameBuffer_commit(&frameBuffer, frame, len);
+	}
+}
+
+/*
+ * Function: consumeFrame
+ * Description: take the next frame and check it is frame n of len bytes - with a copy (mode 0) or in place.
+ * Input: Int mode, Int len, UInt32 n.
+ * Output: Bool - TRUE if it is, intact.
+*/
+static Bool consumeFrame(Int mode, Int len, UInt32 n)
+{
+	Frame_T *frame;
+	Bool ok;
+
+	if(mode == 0) {
+		return checkPayload(consumerData, FrameBuffer_get(&frameBuffer, consumerData, FRAME_PAYLOAD_SIZE), len, n);
+	}
+	frame = FrameBuffer_acquire(&frameBuffer);
+	if(frame == NULL) {
+		return FALSE;
+	}
+	ok = checkPayload(frame->data, frame->len, len, n);
+	FrameBuffer_release(&frameBuffer, frame);
+	return ok;
+}
+
+/*
+ * Function: producerTaskHandler
+ * Description: phase 1 on its own, then the producer side of phase 2.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: the phases are size-major, copy before zero-copy. Phase 1 fills all the FB_SLOTS
+ * 			  slots and empties them again, so no call blocks; then pairStart lets the consumer
+ * 			  in, and the frames of phase 2 are numbered from 0 again. The Task exits at the end.
+*/
+static Void producerTaskHandler(UArg arg0, UArg arg1)
+{
+	UInt64 start;
+	UInt32 n, f;
+	Int p, k;
+
+	(Void)arg0;
+	(Void)arg1;
+	for(p = 0 ; p < FB_NUM_PHASES ; p++) {
+		start = HostBios_nowNsec();
+		for(n = 0 ; n + FB_SLOTS <= framesPerPhase ; n += FB_SLOTS) {
+			for(k = 0 ; k < FB_SLOTS ; k++) {
+				produceFrame(p % FB_NUM_MODES, frameSizes[p / FB_NUM_MODES], n + k);
+			}
+			for(k = 0 ; k < FB_SLOTS ; k++) {
+				burstErrors[p] += !consumeFrame(p % FB_NUM_MODES, frameSizes[p / FB_NUM_MODES], n + k);
+			}
+		}
+		burstNsec[p] = HostBios_nowNsec() - start;
+	}
+
+	Semaphore_post(Semaphore_handle(&pairStart));
+	for(p = 0, n = 0 ; p < FB_NUM_PHASES ; p++) {
+		for(f = 0 ; f < framesPerPhase ; f++, n++) {
+			produceFrame(p % FB_NUM_MODES, frameSizes[p / FB_NUM_MODES], n);
+		}
+	}
+}
+
+/*
+ * Function: consumerTaskHandler
+ * Description: the consumer side of phase 2 - receive and check every frame, time every size
+ * 				and mode, stop the run after the last one.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: a phase ends when its last frame is checked - the next one starts there.
+*/
+static Void consumerTaskHandler(UArg arg0, UArg arg1)
+{
+	UInt32 n = 0, f;
+	Int p;
+
+	(Void)arg0;
+	(Void)arg1;
+	Semaphore_pend(Semaphore_handle(&pairStart), BIOS_WAIT_FOREVER);
+	phaseEnd[0] = HostBios_nowNsec();
+	for(p = 0 ; p < FB_NUM_PHASES ; p++) {
+		for(f = 0 ; f < framesPerPhase ; f++, n++) {
+			phaseErrors[p] += !consumeFrame(p % FB_NUM_MODES, frameSizes[p / FB_NUM_MODES], n);
+		}
+		phaseEnd[p + 1] = HostBios_nowNsec();
+		phasesDone = p + 1;
+	}
+	HostBios_stop();
+	Task_exit();
+}
+
+/*
+ * Function: resultLine
+ * Description: one result line - ns per frame and payload MB/s.
+ * Input: FILE *out, CString phase, Int p - size and mode, UInt32 count - frames, Double nsec - their time, UInt32 errors.
+ * Output: void
+*/
+static Void resultLine(FILE *out, CString phase, Int p, UInt32 count, Double nsec, UInt32 errors)
+{
+	fprintf(out, "frames %-8s %4d B %-9s %8.1f ns/frame %8.1f MB/s%s\n", phase, frameSizes[p / FB_NUM_MODES],
+			modeNames[p % FB_NUM_MODES], nsec / count, (Double)frameSizes[p / FB_NUM_MODES] * count / nsec * 1e3,
+			errors ? "  CORRUPT FRAMES" : "");
+}
+
+/*
+ * Function: frameReport
+ * Description: the bench's result lines, and its exit status.
+ * Input: FILE *out, Double seconds - the run report's arguments.
+ * Output: void - exits with a failure status on a corrupt frame or an unfinished run.
+*/
+static Void frameReport(FILE *out, Double seconds)
+{
+	UInt32 errors = 0;
+	Int p;
+
+	(Void)seconds;
+	fprintf(out, "frame_buffer: %lu frames per size and mode through %d slots\n",
+			(unsigned long)framesPerPhase, FB_SLOTS);
+	for(p = 0 ; p < FB_NUM_PHASES ; p++) {
+		resultLine(out, "1 task", p, framesPerPhase - framesPerPhase % FB_SLOTS, (Double)burstNsec[p], burstErrors[p]);
+		errors = errors + burstErrors[p];
+	}
+	for(p = 0 ; p < phasesDone ; p++) {
+		resultLine(out, "2 tasks", p, framesPerPhase, (Double)(phaseEnd[p + 1] - phaseEnd[p]), phaseErrors[p]);
+		errors = errors + phaseErrors[p];
+	}
+	fflush(out);
+	if(errors != 0 || phasesDone < FB_NUM_PHASES) {
+		if(phasesDone < FB_NUM_PHASES) {
+			fprintf(out, "frame_bench: run ended after %d of %d phases - raise PC_RUN_MSEC\n", phasesDone, FB_NUM_PHASES);
+			fflush(out);
+		}
+		_Exit(EXIT_FAILURE);
+	}
+}
+
+static Void construct(Task_Struct *obj, CString name, Task_FuncPtr fxn)
+{
+	Task_Params taskParams;
+
+	Task_Params_init(&taskParams);
+	taskParams.instance->name = name;
+	taskParams.priority = 1;
+	Task_construct(obj, fxn, &taskParams, NULL);
+}
+
+int main()
+{
+	CString env = getenv("FB_FRAMES");
+
+	framesPerPhase = (env != NULL && atol(env) > 0) ? (UInt32)atol(env) : FB_FRAMES_DEFAULT;
+	FrameBuffer_init(&frameBuffer, frames, FB_SLOTS);
+	Semaphore_construct(&pairStart, 0, NULL);
+	construct(&producerObj, "producer", producerTaskHandler);
+	construct(&consumerObj, "consumer", consumerTaskHandler);
+	HostBios_addReportFxn(frameReport);
+	BIOS_start();
+	return 0;
+}
@@ -0,0 +1,296 @@
+/*
+ * led_stress.c - host build only
+ *
+ * Stress test of the LED command mailbox (led_mailbox.h) from every context that posts to it:
+ *
+ *  - LS_POSTER_TASKS Tasks of priorities 1.. LS_POSTER_TASKS, each posting LS_POSTS commands of
+ *    a random LED and 1..3 blinks, yielding now and then and sleeping a tick every
+ *    LS_SLEEP_EVERY posts;
+ *  - a Clock function (Swi context) posting LS_CLOCK_POSTS commands every tick;
+ *  - a Timer function (Hwi context) posting one command every LS_TIMER_USEC microseconds;
+ *
+ * while a drain Task (priority 2, like ledSrvTask among the workers) fetches until the mailbox is
+ * empty and sleeps a tick - far slower than the posters, so the mailbox is full most of the time
+ * and every post path (queued, coalesced, dropped) runs. Every drained command is checked - a
+ * valid LED and 1..LED_MAX_COALESCED_BLINKS blinks - and once the posters are done and the
+ * mailbox is drained:
+ *
+ *  - per LED, the blinks of the drained commands add up to the blinks of every post that was
+ *    queued or coalesced - a lost, duplicated or torn command shows. The target is built with
+ *    LED_MAX_COALESCED_BLINKS raised above any sum (host/CMakeLists.txt), so no cap hides one;
+ *  - the queued/coalesced/dropped results seen by the posters add up to ledMailboxStats, and
+ *    every queued command was fetched.
+ *
+ * Any failure is reported and the run exits with a failure status. The host's emulated kernel
+ * takes interrupts and switches Tasks only at kernel calls (Hwi_disable/Hwi_restore among them),
+ * so this checks the mailbox's behaviour under every interleaving of whole calls - it can't
+ * preempt a post halfway through, as the target could without its Hwi_disable window.
+ * Run length: LS_POSTS=<posts per Task> (and PC_RUN_MSEC, the emulation's limit).
+ *
+ *   cmake --build build && ./build/led_stress
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/hal/Timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bios_host.h"
+#include "led_mailbox.h"
+#include "prng.h"
+
+#define LS_POSTER_TASKS		3
+#define LS_POSTS_DEFAULT	100000		// posts per poster Task
+#define LS_SLEEP_EVERY		256			// posts between two ticks of sleep of a poster Task
+#define LS_YIELD_EVERY		8			// posts between two yields of a poster Task
+#define LS_CLOCK_POSTS		4			// posts of the Clock function per tick
+#define LS_TIMER_USEC		100			// period of the Timer function
+#define LS_DRAIN_PRIORITY	2
+#define LS_CLOCK_POSTER		LS_POSTER_TASKS			// index of the Clock function's counts
+#define LS_TIMER_POSTER		(LS_POSTER_TASKS + 1)	// index of the Timer function's counts
+#define LS_NUM_POSTERS		(LS_POSTER_TASKS + 2)
+
+/*
+ Structure LsCounts_T - what one poster posted, as LedMailbox_post reported it.
+ */
+typedef struct
+{
+	UInt32 results[ledPostDropped_e + 1];	// by LedPostResult_E
+	UInt32 blinks[green_e + 1];				// by LED, of the queued and coalesced posts
+	Prng_T prng;
+} LsCounts_T;
+
+static LsCounts_T posters[LS_NUM_POSTERS];
+static UInt32 drainedBlinks[green_e + 1];
+static UInt32 drainedCommands;
+static UInt32 corrupt;					// drained commands with a bad LED or blink count
+static UInt32 postsPerTask;
+static Int postersDone;
+static volatile Bool isrPosting = TRUE;	// the Clock and Timer functions post until the Tasks are done
+static Bool finished;
+
+static Task_Struct posterObj[LS_POSTER_TASKS];
+static Task_Struct drainObj;
+static Clock_Struct clockObj;
+static Timer_Struct timerObj;
+
+/*
+ * Function: postOne
+ * Description: post a random command for poster "id" and count what became of it.
+ * Input: Int id - the poster's index in posters.
+ * Output: void
+*/
+static Void postOne(Int id)
+{
+	LsCounts_T *counts = &posters[id];
+	LedBlinksInfo_T cmd;
+	LedPostResult_E result;
+
+	cmd.led = (Prng_below(&counts->prng, 2) == 0) ? red_e : green_e;
+	cmd.blinksNum = 1 + (Int)Prng_below(&counts->prng, 3);
+	result = LedMailbox_post(&cmd);
+	counts->results[result] = counts->results[result] + 1;
+	if(result != ledPostDropped_e) {
+		counts->blinks[cmd.led] = counts->blinks[cmd.led] + cmd.blinksNum;
+	}
+}
+
+/*
+ * Function: posterTaskHandler
+ * Description: a poster Task - postsPerTask posts, then it reports itself done and exits.
+ * Input: UArg arg0 - its index in posters, UArg arg1 - unused.
+ * Output: void
+*/
+static Void posterTaskHandler(UArg arg0, UArg arg1)
+{
+	UInt32 n;
+	UInt key;
+
+	(Void)arg1;
+	for(n = 1 ; n <= postsPerTask ; n++) {
+		postOne((Int)arg0);
+		if(n % LS_SLEEP_EVERY == 0) {
+			Task_sleep(1);
+		} else if(n % LS_YIELD_EVERY == 0) {
+			Task_yield();
+		}
+	}
+	key = Hwi_disable();
+	postersDone = postersDone + 1;
+	Hwi_restore(key);
+	Task_exit();
+}
+
+static Void clockPoster(UArg arg)
+{
+	Int i;
+
+	(Void)arg;
+	for(i = 0 ; isrPosting && i < LS_CLOCK_POSTS ; i++) {
+		postOne(LS_CLOCK_POSTER);
+	}
+}
+
+static Void timerPoster(UArg arg)
+{
+	(Void)arg;
+	if(isrPosting) {
+		postOne(LS_TIMER_POSTER);
+	}
+}
+
+/*
+ * Function: drainAll
+ * Description: fetch and check every queued command.
+ * Input: void
+ * Output: void
+ * Algorithm: a command is corrupt if its LED is neither LED or its blinks are out of 1..cap.
+*/
+static Void drainAll(void)
+{
+	LedBlinksInfo_T cmd;
+
+	while(LedMailbox_fetch(&cmd)) {
+		drainedCommands = drainedCommands + 1;
+		if((cmd.led != red_e && cmd.led != green_e) || cmd.blinksNum < 1 ||
+				cmd.blinksNum > LED_MAX_COALESCED_BLINKS) {
+			corrupt = corrupt + 1;
+			continue;
+		}
+		drainedBlinks[cmd.led] = drainedBlinks[cmd.led] + cmd.blinksNum;
+	}
+}
+
+/*
+ * Function: drainTaskHandler
+ * Description: empty the mailbox every tick until the posters are done, then end the run.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: the Clock and Timer posters are stopped with interrupts masked, so nothing is
+ * 			  posted after the last drain.
+*/
+static Void drainTaskHandler(UArg arg0, UArg arg1)
+{
+	UInt key;
+	Bool done = FALSE;
+
+	(Void)arg0;
+	(Void)arg1;
+	while(!done) {
+		drainAll();
+		Task_sleep(1);
+		key = Hwi_disable();
+		if(postersDone == LS_POSTER_TASKS) {
+			isrPosting = FALSE;
+			done = TRUE;
+		}
+		Hwi_restore(key);
+	}
+	drainAll();
+	finished = TRUE;
+	HostBios_stop();
+	Task_exit();
+}
+
+/*
+ * Function: stressReport
+ * Description: the totals, the checks, and the exit status.
+ * Input: FILE *out, Double seconds - the run report's arguments.
+ * Output: void - exits with a failure status if a check failed or the run did not finish.
+*/
+static Void stressReport(FILE *out, Double seconds)
+{
+	UInt32 results[ledPostDropped_e + 1] = {0};
+	UInt32 blinks[green_e + 1] = {0};
+	UInt32 failures = 0;
+	Int p, r, led;
+
+	for(p = 0 ; p < LS_NUM_POSTERS ; p++) {
+		for(r = 0 ; r <= ledPostDropped_e ; r++) {
+			results[r] = results[r] + posters[p].results[r];
+		}
+		for(led = 0 ; led <= green_e ; led++) {
+			blinks[led] = blinks[led] + posters[p].blinks[led];
+		}
+	}
+	fprintf(out, "led_stress: %.2f s, posts queued %lu coalesced %lu dropped %lu (clock %lu, timer %lu), drained %lu, high water %u\n",
+			seconds, (unsigned long)results[ledPostQueued_e], (unsigned long)results[ledPostCoalesced_e],
+			(unsigned long)results[ledPostDropped_e],
+			(unsigned long)(posters[LS_CLOCK_POSTER].results[0] + posters[LS_CLOCK_POSTER].results[1] + posters[LS_CLOCK_POSTER].results[2]),
+			(unsigned long)(posters[LS_TIMER_POSTER].results[0] + posters[LS_TIMER_POSTER].results[1] + posters[LS_TIMER_POSTER].results[2]),
+			(unsigned long)drainedCommands, (unsigned)ledMailboxStats.highWater);
+	fprintf(out, "led_stress: blinks posted red %lu green %lu, drained red %lu green %lu, corrupt commands %lu\n",
+			(unsigned long)blinks[red_e], (unsigned long)blinks[green_e], (unsigned long)drainedBlinks[red_e],
+			(unsigned long)drainedBlinks[green_e], (unsigned long)corrupt);
+
+	if(!finished) {
+		fprintf(out, "led_stress: FAIL - the posters did not finish, raise PC_RUN_MSEC\n");
+		failures = failures + 1;
+	}
+	if(corrupt != 0 || blinks[red_e] != drainedBlinks[red_e] || blinks[green_e] != drainedBlinks[green_e]) {
+		fprintf(out, "led_stress: FAIL - drained commands differ from the posted ones\n");
+		failures = failures + 1;
+	}
+	if(results[ledPostQueued_e] != ledMailboxStats.queued || results[ledPostCoalesced_e] != ledMailboxStats.coalesced ||
+			results[ledPostDropped_e] != ledMailboxStats.dropped || ledMailboxStats.fetched != ledMailboxStats.queued ||
+			drainedCommands != ledMailboxStats.fetched) {
+		fprintf(out, "led_stress: FAIL - ledMailboxStats differ from the posters' results\n");
+		failures = failures + 1;
+	}
+	if(results[ledPostCoalesced_e] == 0 || results[ledPostDropped_e] == 0) {
+		fprintf(out, "led_stress: FAIL - a post path was not exercised\n");
+		failures = failures + 1;
+	}
+	fflush(out);
+	if(failures != 0) {
+		_Exit(EXIT_FAILURE);
+	}
+}
+
+int main()
+{
+	CString env = getenv("LS_POSTS");
+	Task_Params taskParams;
+	Clock_Params clockParams;
+	Timer_Params timerParams;
+	Int p;
+
+	postsPerTask = (env != NULL && atol(env) > 0) ? (UInt32)atol(env) : LS_POSTS_DEFAULT;
+	LedMailbox_init();
+	for(p = 0 ; p < LS_NUM_POSTERS ; p++) {
+		Prng_seed(&posters[p].prng, 0x1ED5 + p);
+	}
+
+	for(p = 0 ; p < LS_POSTER_TASKS ; p++) {
+		Task_Params_init(&taskParams);
+		taskParams.instance->name = "poster";
+		taskParams.priority = 1 + p;
+		taskParams.arg0 = (UArg)p;
+		Task_construct(&posterObj[p], posterTaskHandler, &taskParams, NULL);
+	}
+	Task_Params_init(&taskParams);
+	taskParams.instance->name = "drain";
+	taskParams.priority = LS_DRAIN_PRIORITY;
+	Task_construct(&drainObj, drainTaskHandler, &taskParams, NULL);
+
+	Clock_Params_init(&clockParams);
+	clockParams.instance->name = "clockPoster";
+	clockParams.period = 1;
+	clockParams.startFlag = TRUE;
+	Clock_construct(&clockObj, clockPoster, 1, &clockParams);
+
+	Timer_Params_init(&timerParams);
+	timerParams.instance->name = "timerPoster";
+	timerParams.period = LS_TIMER_USEC;
+	timerParams.periodType = Timer_PeriodType_MICROSECS;
+	timerParams.startMode = Timer_StartMode_AUTO;
+	Timer_construct(&timerObj, Timer_ANY, timerPoster, &timerParams, NULL);
+
+	HostBios_addReportFxn(stressReport);
+	BIOS_start();
+	return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * log_host.c - host build only
+ *
+ * Log_info* records are counted per call site; with PC_LOG set they are also printed, the way
+ * the ROV/System Analyzer would show them for the target. Log_error* records are counted with
+ * them and always printed, to stderr. System_abort prints its message and ends the process
+ * with a failure status, without the run report.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/Log.h>
+#include <xdc/runtime/System.h>
+
+#include "bios_host.h"
+
+#define HOST_LOG_SITES	64				// distinct Log_info call sites counted separately
+
+typedef struct
+{
+	CString file;
+	Int line;
+	CString fmt;
+	UInt64 count;
+} LogSite_T;
+
+static LogSite_T logSites[HOST_LOG_SITES];
+static Int numLogSites;
+static UInt64 logRecords;
+static Int logPrint = -1;				// -1 until PC_LOG was looked up
+
+/*
+ Only one Task (or Clock function) runs at a time, so no locking is needed here.
+ */
+Void HostLog_info(CString file, Int line, CString fmt, Int nargs,
+		IArg a1, IArg a2, IArg a3, IArg a4, IArg a5)
+{
+	Int i;
+
+	(Void)nargs;
+	logRecords++;
+	for(i = 0 ; i < numLogSites ; i++) {
+		if(logSites[i].line == line && logSites[i].file == file) {
+			break;
+		}
+	}
+	if(i == numLogSites && numLogSites < HOST_LOG_SITES) {
+		logSites[i].file = file;
+		logSites[i].line = line;
+		logSites[i].fmt = fmt;
+		numLogSites++;
+	}
+	if(i < numLogSites) {
+		logSites[i].count++;
+	}
+
+	if(logPrint < 0) {
+		logPrint = (getenv("PC_LOG") != NULL);
+	}
+	if(logPrint) {
+		printf("%s:%d: ", file, line);
+		printf(fmt, (Int)a1, (Int)a2, (Int)a3, (Int)a4, (Int)a5);
+	}
+}
+
+Void HostLog_error(CString file, Int line, CString fmt, IArg a1, IArg a2)
+{
+	HostLog_info(file, line, fmt, 2, a1, a2, 0, 0, 0);
+	if(!logPrint) {
+		fprintf(stderr, "%s:%d: ERROR: ", file, line);
+		fprintf(stderr, fmt, (Int)a1, (Int)a2);
+	}
+}
+
+Void System_abort(CString str)
+{
+	fflush(stdout);
+	fprintf(stderr, "System_abort: %s", str);
+	fflush(stderr);
+	_Exit(EXIT_FAILURE);
+}
+
+Void HostLog_report(FILE *out, Double seconds)
+{
+	Int i;
+
+	fprintf(out, "log: %llu records (%.0f/s)\n", (unsigned long long)logRecords, (Double)logRecords / seconds);
+	for(i = 0 ; i < numLogSites ; i++) {
+		CString base = strrchr(logSites[i].file, '/');
+
+		fprintf(out, "  %12llu  %s:%d\n", (unsigned long long)logSites[i].count,
+				(base != NULL) ? base + 1 : logSites[i].file, logSites[i].line);
+	}
+}
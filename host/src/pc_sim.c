@@ -0,0 +1,803 @@
+/*
+ * pc_sim.c - host build only
+ *
+ * Deterministic discrete-event simulator of the producer/consumer system, for capacity planning.
+ *
+ * pc_bench runs the real application on the pthread emulation of SYS/BIOS, so its timing is the
+ * host's, not the MSP430's. pc_sim answers "what BUFFER_SIZE, how many consumers, what time
+ * slice" for a given arrival rate without the target: it models one 8 MHz CPU in cycles, and on
+ * it
+ *
+ *  - the Tasks and Clocks of empty.cfg (sim_cfg.h, generated by gen_host_cfg.py): ledSrvTask and
+ *    its priority, the Clock tick period, timeSharingClk and ledBlinkClk;
+ *  - NUM_PRODUCERS producer and NUM_CONSUMERS consumer Tasks of WORKER_PRIORITY (topology.h),
+ *    each a loop of steps with a cycle cost - generate, pend emptySlots, pend mutex, insert, post
+ *    mutex, post fullSlots, post the LED command (and the mirror image for the consumers). With
+ *    a ring QUEUE_ENGINE the mutex steps are left out and insert/remove cost COST_RING;
+ *  - counting/binary semaphores with FIFO wait queues, a strict priority scheduler (FIFO within
+ *    a priority, a preempted Task stays at the head) and COST_SWITCH cycles per context switch;
+ *  - the Clock tick ISR (COST_TICK), every Clock function due on it (COST_CLOCK_FXN), and the
+ *    time-slice policy of tsClockHandler (TIMESLICE_POLICY/TIMESLICE_QUANTUM, timeslice.h);
+ *  - ledSrvTask serving the LED mailbox (LED_MAILBOX_SIZE commands, the rest coalesced) at
+ *    COST_LED_SERVE cycles per command, preempting the workers. The blinks themselves are timed
+ *    by ledBlinkClk (led_blink.h), so they cost ledSrvTask nothing. LED_BUSY_WAIT=1 models the
+ *    ledToggle/delay() that led_blink.h replaced instead: every command carries 1..MAX_VAL_NUM
+ *    blinks (the item's value, coalesced commands add up to LED_MAX_COALESCED_BLINKS), and
+ *    ledSrvTask spins 4 x LED_DELAY_CYCLES per blink with the workers preempted - to show what the
+ *    throughput's dependence on the blink counts was.
+ *
+ * Producers insert back to back, or - with ARRIVAL_RATE - as a Poisson process of ARRIVAL_RATE
+ * items/s each (exponential gaps, in cycles, not rounded to Clock ticks). Items are stamped when
+ * inserted and their residency recorded when removed, as LATENCY_TRACE does on the target.
+ *
+ * Every setting is a NAME=value argument; the names match the compile-time settings of main.c
+ * where there is one. The costs are rough SYS/BIOS-on-MSP430 figures - calibrate them with
+ * Timestamp measurements on the target before trusting absolute numbers. The same arguments and
+ * SEED give the same run, bit for bit.
+ *
+ *   ./build/pc_sim NUM_CONSUMERS=1 BUFFER_SIZE=8 ARRIVAL_RATE=2000 RUN_MSEC=60000
+ *
+ * The report uses the "throughput:", "latency:" and "latency all:" lines of pc_bench, so
+ * host/tools/sweep.py --sim sweeps the simulator like the real build.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <xdc/std.h>
+
+#include "prng.h"
+
+#define SIM_MAX_WORKERS		32			// producers + consumers
+#define SIM_MAX_TASKS		(SIM_MAX_WORKERS + 8)
+#define SIM_MAX_STEPS		8			// steps of a Task's loop
+#define SIM_MAX_DEPTH		1024		// BUFFER_SIZE limit
+#define SIM_MAX_MAILBOX		64			// LED_MAILBOX_SIZE limit
+#define SIM_MAX_COALESCED	32			// LED_MAX_COALESCED_BLINKS of led_mailbox.h
+#define SIM_LATENCY_US		(1 << 20)	// 1 usec latency bins, the last one collects the rest
+
+
+/*
+ Structures SimCfgTask_T/SimCfgClock_T - the empty.cfg instances, see sim_cfg.h.
+ */
+typedef struct
+{
+	CString name;
+	CString fxn;
+	Int priority;
+} SimCfgTask_T;
+
+typedef struct
+{
+	CString name;
+	CString fxn;
+	Int timeout;				// first tick
+	Int period;					// ticks, 0 - one shot
+} SimCfgClock_T;
+
+#include "sim_cfg.h"
+
+
+/*
+ Structure SimParam_T - one NAME=value setting.
+ */
+typedef struct
+{
+	CString name;
+	Long value;
+	CString help;
+} SimParam_T;
+
+enum
+{
+	pNumProducers, pNumConsumers, pBufferSize, pQueueEngine, pWorkerPriority, pTimeslicePolicy,
+	pTimesliceQuantum, pLedMailboxSize, pArrivalRate, pMclkHz, pRunMsec, pSeed, pCostGenerate,
+	pCostPend, pCostPost, pCostSwitch, pCostInsert, pCostRemove, pCostRing, pCostLedPost,
+	pCostLedServe, pCostConsume, pCostTick, pCostClockFxn, pMaxValNum, pLedBusyWait, pLedDelayCycles,
+	pNumParams
+};
+
+static SimParam_T params[pNumParams] = {
+	{"NUM_PRODUCERS", 2, "producer Tasks"},
+	{"NUM_CONSUMERS", 2, "consumer Tasks"},
+	{"BUFFER_SIZE", 16, "slots of the bounded buffer"},
+	{"QUEUE_ENGINE", 0, "0 locked (mutex steps), otherwise a lock-free ring"},
+	{"WORKER_PRIORITY", 1, "priority of the producers and consumers"},
+	{"TIMESLICE_POLICY", 1, "0 always, 1 contended, 2 budget (timeslice.h)"},
+	{"TIMESLICE_QUANTUM", 1, "Clock ticks per time slice"},
+	{"LED_MAILBOX_SIZE", 8, "queued LED commands, more are coalesced"},
+	{"ARRIVAL_RATE", 0, "items/s per producer (Poisson), 0 - back to back"},
+	{"MCLK_HZ", 8000000, "CPU cycles per second"},
+	{"RUN_MSEC", 10000, "simulated run length"},
+	{"SEED", 1, "PRNG seed of the arrivals"},
+	{"COST_GENERATE", 60, "cycles - next item of the workload"},
+	{"COST_PEND", 110, "cycles - Semaphore_pend"},
+	{"COST_POST", 100, "cycles - Semaphore_post"},
+	{"COST_SWITCH", 250, "cycles - Task context switch"},
+	{"COST_INSERT", 60, "cycles - locked engine insert critical section"},
+	{"COST_REMOVE", 60, "cycles - locked engine remove critical section"},
+	{"COST_RING", 90, "cycles - lock-free ring push/pop"},
+	{"COST_LED_POST", 90, "cycles - LedMailbox_post"},
+	{"COST_LED_SERVE", 150, "cycles - ledSrvTask per command (fetch + LedBlink_start)"},
+	{"COST_CONSUME", 0, "cycles - consumer's own work per item"},
+	{"COST_TICK", 300, "cycles - Clock tick ISR and Swi"},
+	{"COST_CLOCK_FXN", 80, "cycles - every Clock function due on a tick"},
+	{"MAX_VAL_NUM", 10, "items, and the blinks of their LED commands, are 1..MAX_VAL_NUM"},
+	{"LED_BUSY_WAIT", 0, "1 - ledSrvTask spins every blink (the old ledToggle/delay), 0 - ledBlinkClk"},
+	{"LED_DELAY_CYCLES", 1024000, "cycles - the old delay(), 4 per blink"},
+};
+
+#define P(index)	((UInt64)params[index].value)
+
+
+/*
+ Enum SimOp_E - what a step does once its cycles have run.
+ */
+typedef enum
+{
+	opGenerate_e,				// next item - a producer may sleep until it arrives
+	opPend_e,
+	opPost_e,
+	opInsert_e,
+	opRemove_e,
+	opLedPost_e,				// LED command into the mailbox, post ledSrvSchedSem
+	opLedServe_e,				// ledSrvTask - one command, loops while the mailbox is not empty
+	opWork_e
+} SimOp_E;
+
+typedef enum
+{
+	stReady_e,
+	stBlocked_e,
+	stSleeping_e
+} SimState_E;
+
+struct SimSem_T;
+
+typedef struct
+{
+	SimOp_E op;
+	struct SimSem_T *sem;
+	UInt64 cost;
+} SimStep_T;
+
+typedef struct
+{
+	CString name;
+	Int id;
+	Int priority;
+	SimState_E state;
+	const SimStep_T *steps;
+	Int numSteps;
+	Int step;
+	UInt64 remaining;			// cycles left of the current step
+	UInt64 readySeq;			// FIFO order within the priority
+	UInt64 wakeAt;				// stSleeping_e
+	UInt64 nextArrival;			// producers, ARRIVAL_RATE
+	Prng_T prng;
+	Int sliceTicks;				// timeslice.h counters
+	Int budget;
+	UInt64 cpu;
+	UInt64 switchesIn;
+	UInt64 preempted;
+	UInt64 blocks;
+} SimTask_T;
+
+typedef struct SimSem_T
+{
+	CString name;
+	Int count;
+	Bool binary;
+	SimTask_T *waiters[SIM_MAX_TASKS];	// FIFO
+	Int head;
+	Int numWaiters;
+	UInt64 posts;
+	UInt64 blocks;
+} SimSem_T;
+
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+static SimTask_T tasks[SIM_MAX_TASKS];
+static Int numTasks;
+static SimTask_T *running;				// last Task given the CPU
+static UInt64 now;						// cycles
+static UInt64 readySeq;
+
+static SimSem_T emptySlots = {"emptySlots"};
+static SimSem_T fullSlots = {"fullSlots"};
+static SimSem_T mutex = {"mutex", 0, TRUE};
+static SimSem_T ledSrvSchedSem = {"ledSrvSchedSem", 0, TRUE};
+
+static SimStep_T producerSteps[SIM_MAX_STEPS];
+static SimStep_T consumerSteps[SIM_MAX_STEPS];
+static SimStep_T ledSrvSteps[2];
+static Int numProducerSteps, numConsumerSteps;
+
+static UInt64 stamps[SIM_MAX_DEPTH];	// insertion time of the queued items, FIFO
+static Int depth, depthIn, depthOut;
+static UInt64 depthSince;
+static UInt64 depthCycles[SIM_MAX_DEPTH + 1];
+
+static UInt32 latencyBins[SIM_LATENCY_US];
+static UInt64 items, latencySum, latencyMin = ~(UInt64)0, latencyMax;
+static UInt64 ledCommands, ledCoalesced, mailbox;
+static UInt64 ledBlinks[SIM_MAX_MAILBOX];	// blinks of the queued commands, LED_BUSY_WAIT
+static Int ledHead;							// oldest queued command
+static Bool ledSpinning;					// ledSrvTask is spinning the blinks of a command
+static UInt64 ledSpinCycles;
+static UInt64 ticks, yields, skippedYields, kernelCycles, idleCycles;
+
+
+/*
+ * Function: semPend
+ * Description: Semaphore_pend(sem, BIOS_WAIT_FOREVER) by task t.
+ * Input: SimSem_T *sem, SimTask_T *t.
+ * Output: void
+ * Algorithm: take a token, or queue t and block it - the post that wakes it hands it the token.
+*/
+static Void semPend(SimSem_T *sem, SimTask_T *t)
+{
+	if(sem->count > 0) {
+		sem->count = sem->count - 1;
+		return;
+	}
+	sem->waiters[(sem->head + sem->numWaiters) % SIM_MAX_TASKS] = t;
+	sem->numWaiters = sem->numWaiters + 1;
+	sem->blocks = sem->blocks + 1;
+	t->blocks = t->blocks + 1;
+	t->state = stBlocked_e;
+}
+
+/*
+ * Function: semPost
+ * Description: Semaphore_post(sem).
+ * Input: SimSem_T *sem.
+ * Output: void
+ * Algorithm: ready the first waiter (at the tail of its priority), or add a token (at most one
+ * 			  for a binary semaphore).
+*/
+static Void semPost(SimSem_T *sem)
+{
+	SimTask_T *t;
+
+	sem->posts = sem->posts + 1;
+	if(sem->numWaiters > 0) {
+		t = sem->waiters[sem->head];
+		sem->head = (sem->head + 1) % SIM_MAX_TASKS;
+		sem->numWaiters = sem->numWaiters - 1;
+		t->state = stReady_e;
+		t->readySeq = ++readySeq;
+	} else if(!sem->binary || sem->count == 0) {
+		sem->count = sem->count + 1;
+	}
+}
+
+/*
+ * Function: setDepth
+ * Description: the number of queued items changes.
+ * Input: Int delta - +1 or -1.
+ * Output: void
+ * Algorithm: the cycles spent at the old depth go to its bucket of the distribution.
+*/
+static Void setDepth(Int delta)
+{
+	depthCycles[depth] = depthCycles[depth] + (now - depthSince);
+	depthSince = now;
+	depth = depth + delta;
+}
+
+/*
+ * Function: doStep
+ * Description: the effect of task t's current step, once its cycles have run.
+ * Input: SimTask_T *t.
+ * Output: void
+ * Algorithm: act, then move to the next step of the loop and load its cost. A pend that blocks
+ * 			  still moves on - the Task continues after the pend once a post readies it.
+*/
+static Void doStep(SimTask_T *t)
+{
+	const SimStep_T *step = &t->steps[t->step];
+	Int next = (t->step + 1 == t->numSteps) ? 0 : t->step + 1;
+	UInt64 latency, blinks;
+	Double u;
+
+	switch(step->op) {
+	case opGenerate_e:
+		if(P(pArrivalRate) > 0) {
+			u = ((Double)Prng_next(&t->prng) + 0.5) / 4294967296.0;
+			t->nextArrival = t->nextArrival + (UInt64)(-log(u) * P(pMclkHz) / P(pArrivalRate));
+			if(t->nextArrival > now) {
+				t->state = stSleeping_e;	// Task_sleep until the item arrives
+				t->wakeAt = t->nextArrival;
+			}
+		}
+		break;
+	case opPend_e:
+		semPend(step->sem, t);
+		break;
+	case opPost_e:
+		semPost(step->sem);
+		break;
+	case opInsert_e:
+		stamps[depthIn] = now;
+		depthIn = (depthIn + 1 == (Int)P(pBufferSize)) ? 0 : depthIn + 1;
+		setDepth(1);
+		break;
+	case opRemove_e:
+		latency = (now - stamps[depthOut]) * 1000000 / P(pMclkHz);	// usec
+		depthOut = (depthOut + 1 == (Int)P(pBufferSize)) ? 0 : depthOut + 1;
+		setDepth(-1);
+		items = items + 1;
+		latencySum = latencySum + latency;
+		latencyMin = (latency < latencyMin) ? latency : latencyMin;
+		latencyMax = (latency > latencyMax) ? latency : latencyMax;
+		latencyBins[(latency < SIM_LATENCY_US) ? latency : SIM_LATENCY_US - 1]++;
+		break;
+	case opLedPost_e:
+		ledCommands = ledCommands + 1;
+		blinks = P(pLedBusyWait) ? 1 + Prng_below(&t->prng, (UInt)P(pMaxValNum)) : 0;
+		if(mailbox < P(pLedMailboxSize)) {
+			ledBlinks[(ledHead + mailbox) % SIM_MAX_MAILBOX] = blinks;
+			mailbox = mailbox + 1;
+		} else {
+			ledCoalesced = ledCoalesced + 1;	// merged into a queued command - no extra work
+			blinks = blinks + ledBlinks[(ledHead + mailbox - 1) % SIM_MAX_MAILBOX];
+			ledBlinks[(ledHead + mailbox - 1) % SIM_MAX_MAILBOX] = (blinks < SIM_MAX_COALESCED) ? blinks : SIM_MAX_COALESCED;
+		}
+		semPost(&ledSrvSchedSem);
+		break;
+	case opLedServe_e:
+		if(!ledSpinning && mailbox > 0) {
+			blinks = ledBlinks[ledHead];
+			ledHead = (ledHead + 1) % SIM_MAX_MAILBOX;
+			mailbox = mailbox - 1;
+			if(blinks > 0) {					// LED_BUSY_WAIT - spin the blinks before the next command
+				ledSpinning = TRUE;
+				t->remaining = blinks * 4 * P(pLedDelayCycles);
+				ledSpinCycles = ledSpinCycles + t->remaining;
+				return;
+			}
+		}
+		ledSpinning = FALSE;
+		next = (mailbox > 0) ? t->step : 0;		// drain the mailbox, then pend again
+		break;
+	case opWork_e:
+		break;
+	}
+	t->step = next;
+	t->remaining = t->steps[next].cost;
+}
+
+/*
+ * Function: pickTask
+ * Description: the Task the scheduler runs now.
+ * Input: void
+ * Output: SimTask_T * - NULL when every Task is blocked or sleeping (idle).
+ * Algorithm: highest priority READY Task, the one that became ready first within a priority.
+*/
+static SimTask_T *pickTask(void)
+{
+	SimTask_T *best = NULL;
+	Int i = 0;
+
+	for(i = 0 ; i < numTasks ; i++) {
+		SimTask_T *t = &tasks[i];
+		if(t->state == stReady_e && (best == NULL || t->priority > best->priority
+				|| (t->priority == best->priority && t->readySeq < best->readySeq))) {
+			best = t;
+		}
+	}
+	return best;
+}
+
+/*
+ * Function: peerReady
+ * Description: is another Task of t's priority ready - tsPolicyContended_e/tsPolicyBudget_e.
+ * Input: SimTask_T *t.
+ * Output: Bool.
+ * Algorithm: linear scan.
+*/
+static Bool peerReady(SimTask_T *t)
+{
+	Int i = 0;
+
+	for(i = 0 ; i < numTasks ; i++) {
+		if(&tasks[i] != t && tasks[i].state == stReady_e && tasks[i].priority == t->priority) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Function: timeSlice
+ * Description: tsClockHandler - TimeSlice_tick on the Task the tick interrupted.
+ * Input: void
+ * Output: void
+ * Algorithm: as timeslice.c - slice ticks since switch in (or the Task's budget), and a yield
+ * 			  moves the Task behind the other READY Tasks of its priority.
+*/
+static Void timeSlice(void)
+{
+	Bool expired = FALSE;
+
+	if(running == NULL || running->state != stReady_e) {
+		return;
+	}
+	if(P(pTimeslicePolicy) == 2) {
+		running->budget = running->budget - 1;
+		if(running->budget <= 0) {
+			running->budget = running->budget + (Int)P(pTimesliceQuantum);
+			expired = TRUE;
+		}
+	} else {
+		running->sliceTicks = running->sliceTicks + 1;
+		if(running->sliceTicks >= (Int)P(pTimesliceQuantum)) {
+			running->sliceTicks = 0;
+			expired = TRUE;
+		}
+	}
+	if(!expired) {
+		return;
+	}
+	if(P(pTimeslicePolicy) == 0 || peerReady(running)) {
+		yields = yields + 1;
+		running->readySeq = ++readySeq;
+	} else {
+		skippedYields = skippedYields + 1;
+	}
+}
+
+/*
+ * Function: clockTick
+ * Description: the Clock tick interrupt.
+ * Input: void
+ * Output: void
+ * Algorithm: the ISR and every Clock function due on the tick take CPU cycles from whatever
+ * 			  runs; tsClockHandler also applies the time-slice policy.
+*/
+static Void clockTick(void)
+{
+	Int c = 0;
+	UInt64 cost = P(pCostTick);
+
+	ticks = ticks + 1;
+	for(c = 0 ; simCfgClocks[c].name != NULL ; c++) {
+		const SimCfgClock_T *clk = &simCfgClocks[c];
+		if(ticks < (UInt64)clk->timeout || (ticks != (UInt64)clk->timeout
+				&& (clk->period == 0 || (ticks - clk->timeout) % clk->period != 0))) {
+			continue;
+		}
+		cost = cost + P(pCostClockFxn);
+		if(strcmp(clk->fxn, "tsClockHandler") == 0) {
+			timeSlice();
+		}
+	}
+	now = now + cost;
+	kernelCycles = kernelCycles + cost;
+}
+
+/*
+ * Function: addStep
+ * Description: append a step to a Task loop.
+ * Input: SimStep_T *steps, Int *n, SimOp_E op, SimSem_T *sem, UInt64 cost.
+ * Output: void
+*/
+static Void addStep(SimStep_T *steps, Int *n, SimOp_E op, SimSem_T *sem, UInt64 cost)
+{
+	steps[*n].op = op;
+	steps[*n].sem = sem;
+	steps[*n].cost = cost;
+	*n = *n + 1;
+}
+
+/*
+ * Function: addTask
+ * Description: add a READY Task.
+ * Input: CString name, Int id, Int priority, const SimStep_T *steps, Int numSteps.
+ * Output: SimTask_T * - the Task.
+*/
+static SimTask_T *addTask(CString name, Int id, Int priority, const SimStep_T *steps, Int numSteps)
+{
+	SimTask_T *t = &tasks[numTasks];
+
+	numTasks = numTasks + 1;
+	memset(t, 0, sizeof(*t));
+	t->name = name;
+	t->id = id;
+	t->priority = priority;
+	t->state = stReady_e;
+	t->steps = steps;
+	t->numSteps = numSteps;
+	t->remaining = steps[0].cost;
+	t->readySeq = ++readySeq;
+	t->budget = (Int)P(pTimesliceQuantum);
+	return t;
+}
+
+/*
+ * Function: simInit
+ * Description: build the Task loops and the Tasks.
+ * Input: void
+ * Output: void
+ * Algorithm: the producer/consumer loops follow insert_item/remove_item of the configured engine;
+ * 			  the empty.cfg Tasks are added as configured (ledSrvTask is the only one modelled).
+*/
+static Void simInit(void)
+{
+	Bool locked = (P(pQueueEngine) == 0);
+	Int i = 0;
+	SimTask_T *t;
+
+	addStep(producerSteps, &numProducerSteps, opGenerate_e, NULL, P(pCostGenerate));
+	addStep(producerSteps, &numProducerSteps, opPend_e, &emptySlots, P(pCostPend));
+	if(locked) {
+		addStep(producerSteps, &numProducerSteps, opPend_e, &mutex, P(pCostPend));
+	}
+	addStep(producerSteps, &numProducerSteps, opInsert_e, NULL, locked ? P(pCostInsert) : P(pCostRing));
+	if(locked) {
+		addStep(producerSteps, &numProducerSteps, opPost_e, &mutex, P(pCostPost));
+	}
+	addStep(producerSteps, &numProducerSteps, opPost_e, &fullSlots, P(pCostPost));
+	addStep(producerSteps, &numProducerSteps, opLedPost_e, NULL, P(pCostLedPost) + P(pCostPost));
+
+	addStep(consumerSteps, &numConsumerSteps, opPend_e, &fullSlots, P(pCostPend));
+	if(locked) {
+		addStep(consumerSteps, &numConsumerSteps, opPend_e, &mutex, P(pCostPend));
+	}
+	addStep(consumerSteps, &numConsumerSteps, opRemove_e, NULL, locked ? P(pCostRemove) : P(pCostRing));
+	if(locked) {
+		addStep(consumerSteps, &numConsumerSteps, opPost_e, &mutex, P(pCostPost));
+	}
+	addStep(consumerSteps, &numConsumerSteps, opPost_e, &emptySlots, P(pCostPost));
+	addStep(consumerSteps, &numConsumerSteps, opLedPost_e, NULL, P(pCostLedPost) + P(pCostPost));
+	if(P(pCostConsume) > 0) {
+		addStep(consumerSteps, &numConsumerSteps, opWork_e, NULL, P(pCostConsume));
+	}
+
+	ledSrvSteps[0].op = opPend_e;
+	ledSrvSteps[0].sem = &ledSrvSchedSem;
+	ledSrvSteps[0].cost = P(pCostPend);
+	ledSrvSteps[1].op = opLedServe_e;
+	ledSrvSteps[1].cost = P(pCostLedServe);
+
+	emptySlots.count = (Int)P(pBufferSize);
+	mutex.count = 1;
+
+	for(i = 0 ; simCfgTasks[i].name != NULL ; i++) {
+		if(strcmp(simCfgTasks[i].fxn, "ledSrvTaskHandler") == 0) {
+			addTask(simCfgTasks[i].name, 0, simCfgTasks[i].priority, ledSrvSteps, 2);
+		} else {
+			fprintf(stderr, "pc_sim: Task %s (%s) is not modelled\n", simCfgTasks[i].name, simCfgTasks[i].fxn);
+		}
+	}
+	for(i = 0 ; i < (Int)P(pNumProducers) ; i++) {
+		t = addTask("producerTask", i + 1, (Int)P(pWorkerPriority), producerSteps, numProducerSteps);
+		Prng_seed(&t->prng, (UInt32)P(pSeed) ^ ((UInt32)(i + 1) * 0x9E3779B9u));
+	}
+	for(i = 0 ; i < (Int)P(pNumConsumers) ; i++) {
+		t = addTask("consumerTask", i + 1, (Int)P(pWorkerPriority), consumerSteps, numConsumerSteps);
+		Prng_seed(&t->prng, (UInt32)P(pSeed) ^ ((UInt32)(i + 1) * 0x85EBCA6Bu));	// the blinks of LED_BUSY_WAIT
+	}
+}
+
+/*
+ * Function: simRun
+ * Description: run the model for RUN_MSEC of simulated time.
+ * Input: void
+ * Output: void
+ * Algorithm: event loop - the next event is the end of the running Task's step, the next Clock
+ * 			  tick or the next sleeping producer's wake up, whichever comes first. Switching to
+ * 			  another Task takes COST_SWITCH cycles of kernel time first.
+*/
+static Void simRun(void)
+{
+	UInt64 tickCycles = (UInt64)SIM_CFG_TICK_PERIOD * P(pMclkHz) / 1000000;
+	UInt64 end = P(pRunMsec) * (P(pMclkHz) / 1000);
+	UInt64 nextTick = tickCycles;
+	UInt64 limit, wake;
+	SimTask_T *t;
+	Int i = 0;
+
+	while(now < end) {
+		wake = ~(UInt64)0;
+		for(i = 0 ; i < numTasks ; i++) {
+			if(tasks[i].state == stSleeping_e && tasks[i].wakeAt < wake) {
+				wake = tasks[i].wakeAt;
+			}
+		}
+		if(wake <= now || nextTick <= now) {	// timed events first - wake ups, then the tick
+			for(i = 0 ; i < numTasks ; i++) {
+				if(tasks[i].state == stSleeping_e && tasks[i].wakeAt <= now) {
+					tasks[i].state = stReady_e;
+					tasks[i].readySeq = ++readySeq;
+				}
+			}
+			if(nextTick <= now) {
+				nextTick = nextTick + tickCycles;
+				clockTick();
+			}
+			continue;
+		}
+		limit = (wake < nextTick) ? wake : nextTick;
+
+		t = pickTask();
+		if(t == NULL) {
+			idleCycles = idleCycles + (limit - now);
+			now = limit;
+			continue;
+		}
+		if(t != running) {
+			if(running != NULL && running->state == stReady_e) {
+				running->preempted = running->preempted + 1;
+			}
+			running = t;
+			t->switchesIn = t->switchesIn + 1;
+			t->sliceTicks = 0;
+			now = now + P(pCostSwitch);
+			kernelCycles = kernelCycles + P(pCostSwitch);
+			continue;				// the switch may have run into a timed event
+		}
+		if(now + t->remaining <= limit) {
+			now = now + t->remaining;
+			t->cpu = t->cpu + t->remaining;
+			doStep(t);
+		} else {
+			t->cpu = t->cpu + (limit - now);
+			t->remaining = t->remaining - (limit - now);
+			now = limit;
+		}
+	}
+	setDepth(0);
+}
+
+/*
+ * Function: percentile
+ * Description: latency percentile, to the usec.
+ * Input: Double percent.
+ * Output: UInt64 - usec.
+*/
+static UInt64 percentile(Double percent)
+{
+	UInt64 target = (UInt64)ceil(items * percent / 100.0);
+	UInt64 seen = 0;
+	UInt64 us = 0;
+
+	for(us = 0 ; us < SIM_LATENCY_US ; us++) {
+		seen = seen + latencyBins[us];
+		if(seen >= target && seen > 0) {
+			break;
+		}
+	}
+	return us;
+}
+
+/*
+ * Function: simReport
+ * Description: print the results in pc_bench's format.
+ * Input: Double hostSeconds - how long the simulation took.
+ * Output: void
+*/
+static Void simReport(Double hostSeconds)
+{
+	Double seconds = (Double)now / P(pMclkHz);
+	Double occupancy = 0.0;
+	Int i = 0;
+
+	for(i = 0 ; i <= (Int)P(pBufferSize) ; i++) {
+		occupancy = occupancy + (Double)i * depthCycles[i] / now;
+	}
+	printf("sim: %.3f s simulated in %.3f s, %llu items (%.2f M items/s of host time)\n", seconds, hostSeconds,
+			(unsigned long long)items, (hostSeconds > 0.0) ? items / hostSeconds / 1e6 : 0.0);
+	printf("config:");
+	for(i = 0 ; i < pNumParams ; i++) {
+		printf(" %s=%ld", params[i].name, params[i].value);
+	}
+	printf("\n");
+
+	printf("%-16s %5s %4s %12s %12s %12s %7s\n", "task", "id", "pri", "switchesIn", "preempted", "blocks", "cpu%");
+	for(i = 0 ; i < numTasks ; i++) {
+		printf("%-16s %5d %4d %12llu %12llu %12llu %7.2f\n", tasks[i].name, tasks[i].id, tasks[i].priority,
+				(unsigned long long)tasks[i].switchesIn, (unsigned long long)tasks[i].preempted,
+				(unsigned long long)tasks[i].blocks, 100.0 * tasks[i].cpu / now);
+	}
+	printf("cpu: kernel %.2f%% (switches and ticks) idle %.2f%%\n", 100.0 * kernelCycles / now, 100.0 * idleCycles / now);
+	printf("%-16s %12s %12s\n", "semaphore", "posts", "blocks");
+	printf("%-16s %12llu %12llu\n", emptySlots.name, (unsigned long long)emptySlots.posts, (unsigned long long)emptySlots.blocks);
+	printf("%-16s %12llu %12llu\n", fullSlots.name, (unsigned long long)fullSlots.posts, (unsigned long long)fullSlots.blocks);
+	printf("%-16s %12llu %12llu\n", mutex.name, (unsigned long long)mutex.posts, (unsigned long long)mutex.blocks);
+	printf("%-16s %12llu %12llu\n", ledSrvSchedSem.name, (unsigned long long)ledSrvSchedSem.posts,
+			(unsigned long long)ledSrvSchedSem.blocks);
+	printf("timeslice: policy %ld quantum %ld ticks %llu yields %llu skipped %llu\n", params[pTimeslicePolicy].value,
+			params[pTimesliceQuantum].value, (unsigned long long)ticks, (unsigned long long)yields,
+			(unsigned long long)skippedYields);
+	printf("ledMailbox: commands %llu coalesced %llu\n", (unsigned long long)ledCommands,
+			(unsigned long long)ledCoalesced);
+	if(P(pLedBusyWait)) {
+		printf("ledSrvTask: %.1f%% of the CPU spinning blinks\n", 100.0 * ledSpinCycles / (Double)now);
+	}
+
+	printf("depth (%% of time):");
+	for(i = 0 ; i <= (Int)P(pBufferSize) ; i++) {
+		printf(" %d:%.1f", i, 100.0 * depthCycles[i] / now);
+	}
+	printf("\n");
+	printf("throughput: %.0f items/s (%llu items removed)\n", items / seconds, (unsigned long long)items);
+	printf("latency: %.1f us mean buffer residence (mean occupancy %.2f)\n",
+			(items > 0) ? occupancy / (items / seconds) * 1e6 : 0.0, occupancy);
+	if(items > 0) {
+		printf("latency all: items %llu min %llu avg %.1f p99 <= %llu max %llu us\n", (unsigned long long)items,
+				(unsigned long long)latencyMin, (Double)latencySum / items, (unsigned long long)percentile(99.0),
+				(unsigned long long)latencyMax);
+		printf("latency percentiles: p50 %llu p90 %llu p99 %llu p99.9 %llu us\n", (unsigned long long)percentile(50.0),
+				(unsigned long long)percentile(90.0), (unsigned long long)percentile(99.0),
+				(unsigned long long)percentile(99.9));
+	}
+}
+
+/*
+ * Function: usage
+ * Description: print the settings and exit.
+ * Input: Int status - exit status.
+ * Output: void
+*/
+static Void usage(Int status)
+{
+	Int i = 0;
+
+	fprintf(stderr, "usage: pc_sim [NAME=value ...]\n");
+	for(i = 0 ; i < pNumParams ; i++) {
+		fprintf(stderr, "  %-18s %9ld  %s\n", params[i].name, params[i].value, params[i].help);
+	}
+	exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+	struct timespec start, stop;
+	Int a = 0;
+	Int i = 0;
+
+	for(a = 1 ; a < argc ; a++) {
+		const char *eq = strchr(argv[a], '=');
+		if(eq == NULL) {
+			usage(strcmp(argv[a], "-h") == 0 || strcmp(argv[a], "--help") == 0 ? 0 : 2);
+		}
+		for(i = 0 ; i < pNumParams ; i++) {
+			if(strlen(params[i].name) == (size_t)(eq - argv[a]) && strncmp(argv[a], params[i].name, eq - argv[a]) == 0) {
+				params[i].value = strtol(eq + 1, NULL, 0);
+				break;
+			}
+		}
+		if(i == pNumParams) {
+			fprintf(stderr, "pc_sim: unknown setting %s\n", argv[a]);
+			usage(2);
+		}
+	}
+	for(i = 0 ; i < pNumParams ; i++) {
+		if(params[i].value < 0) {
+			fprintf(stderr, "pc_sim: %s must not be negative\n", params[i].name);
+			return 2;
+		}
+	}
+	if(P(pBufferSize) < 1 || P(pBufferSize) > SIM_MAX_DEPTH || P(pNumProducers) + P(pNumConsumers) > SIM_MAX_WORKERS
+			|| params[pMclkHz].value < 1000 || params[pTimesliceQuantum].value < 1
+			|| P(pLedMailboxSize) > SIM_MAX_MAILBOX || params[pMaxValNum].value < 1) {
+		fprintf(stderr, "pc_sim: BUFFER_SIZE must be 1..%d, at most %d workers, MCLK_HZ >= 1000, TIMESLICE_QUANTUM >= 1, "
+				"LED_MAILBOX_SIZE <= %d, MAX_VAL_NUM >= 1\n", SIM_MAX_DEPTH, SIM_MAX_WORKERS, SIM_MAX_MAILBOX);
+		return 2;
+	}
+
+	simInit();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	simRun();
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	simReport((stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9);
+	return 0;
+}
@@ -0,0 +1,273 @@
+/*
+ * queue_bench.cpp - host build only
+ *
+ * Checks and times BoundedQueue (bounded_queue.hpp) against the C rings of ring.h:
+ *
+ *  1. single thread: bursts of 8 pushes then 8 pops through a 16 slot queue of every policy, a
+ *     10 slot queue (compare wrap instead of the mask) and a queue of structures, next to the
+ *     same loop on SpscRing_T and MpmcRing_T (queue_bench_ring.c). The items run through -1, the
+ *     locked engine's empty marker, and every pop is checked against the expected value. On the
+ *     host Hwi_disable and the Semaphore calls take the emulated kernel's lock, so their ns/op
+ *     is the emulation's cost, not the MSP430's - compare those two with each other only;
+ *  2. two host threads: a producer and a consumer on the AtomicSpscPolicy queue;
+ *  3. SYS/BIOS Tasks: a producer and a consumer Task with insert_item/remove_item's loops on a
+ *     4 slot SemaphorePolicy queue of structures, blocking while full/empty - not the handlers
+ *     of main.c, which stay in C. The run ends after QB_ITEMS items, with the kernel's run report.
+ *
+ * Any item out of order or missing is an error, and so is a phase 3 that doesn't move its
+ * QB_ITEMS items before PC_RUN_MSEC: the bench prints a FAIL line and exits with a failure
+ * status, skipping phase 3 if phase 1 or 2 failed. Run lengths: QB_ROUNDS=<bursts> (phase 1),
+ * QB_ITEMS=<items> (phases 2 and 3).
+ *
+ *   cmake --build build && ./build/queue_bench
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "bounded_queue.hpp"
+
+extern "C" {
+#include <ti/sysbios/knl/Task.h>
+#include "bios_host.h"
+
+UInt32 QueueBench_spscRing(UInt32 rounds);
+UInt32 QueueBench_mpmcRing(UInt32 rounds);
+}
+
+#define QB_ROUNDS_DEFAULT	1000000		// phase 1 bursts
+#define QB_ITEMS_DEFAULT	200000		// phase 2 and 3 items
+#define QB_BURST			8
+#define QB_KERNEL_DIVISOR	10			// the kernel call policies run a tenth of the bursts
+
+/*
+ Structure Sample_T - a structured item: any value of it is legal, there is no empty marker.
+ */
+struct Sample_T
+{
+	Int value;
+	UInt16 channel;
+};
+
+static UInt32 failures;
+
+static UInt32 envCount(CString name, UInt32 dflt)
+{
+	CString env = getenv(name);
+
+	return (env != NULL && atol(env) > 0) ? (UInt32)atol(env) : dflt;
+}
+
+static Void result(CString name, UInt32 rounds, UInt64 nsec, UInt32 errors)
+{
+	printf("%-34s %7.1f ns/op  (%lu items)%s\n", name, (Double)nsec / ((Double)rounds * QB_BURST * 2),
+			(unsigned long)rounds * QB_BURST, errors ? "  ORDER ERRORS" : "");
+	if(errors) {
+		failures = failures + 1;
+	}
+}
+
+static Sample_T makeItem(Sample_T *, Int n)
+{
+	Sample_T s;
+
+	s.value = n;
+	s.channel = (UInt16)(n & 3);
+	return s;
+}
+
+static Int makeItem(Int *, Int n) { return n; }
+static Bool sameItem(const Sample_T &a, const Sample_T &b) { return a.value == b.value && a.channel == b.channel; }
+static Bool sameItem(Int a, Int b) { return a == b; }
+
+/*
+ * Function: burstLoop
+ * Description: phase 1 on one queue type.
+ * Input: CString name - the result line's label, UInt32 rounds - bursts.
+ * Output: void
+ * Algorithm: the items count up from -QB_BURST, so the first burst holds -1; each pop must give
+ * 			  the next item. The queue is a static local, constructed once per type.
+*/
+template <typename Q, typename T>
+static Void burstLoop(CString name, UInt32 rounds)
+{
+	static Q queue;
+	UInt64 start;
+	UInt32 r, errors = 0;
+	Int i, in = -QB_BURST, out = -QB_BURST;
+	T item = T();
+
+	start = HostBios_nowNsec();
+	for(r = 0 ; r < rounds ; r++) {
+		for(i = 0 ; i < QB_BURST ; i++) {
+			errors += !queue.tryPush(makeItem((T *)0, in++));
+		}
+		for(i = 0 ; i < QB_BURST ; i++) {
+			errors += !queue.tryPop(item) || !sameItem(item, makeItem((T *)0, out++));
+		}
+	}
+	result(name, rounds, HostBios_nowNsec() - start, errors + queue.count());
+}
+
+static Void ringLoop(CString name, UInt32 (*loop)(UInt32), UInt32 rounds)
+{
+	UInt64 start = HostBios_nowNsec();
+	UInt32 errors = loop(rounds);
+
+	result(name, rounds, HostBios_nowNsec() - start, errors);
+}
+
+/*
+ * Function: threadRun
+ * Description: phase 2 - a producer and a consumer host thread on the AtomicSpscPolicy queue.
+ * Input: UInt32 items - items to transfer.
+ * Output: void
+ * Algorithm: both sides spin (yielding) on full/empty; the consumer checks the order.
+*/
+static Void threadRun(UInt32 items)
+{
+	static BoundedQueue<Int, 1024, AtomicSpscPolicy> queue;
+	UInt32 errors = 0;
+	UInt64 start;
+	Int item;
+	UInt32 n;
+
+	start = HostBios_nowNsec();
+	std::thread producer([items]() {
+		for(UInt32 p = 0 ; p < items ; p++) {
+			while(!queue.tryPush((Int)p)) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	for(n = 0 ; n < items ; n++) {
+		while(!queue.tryPop(item)) {
+			std::this_thread::yield();
+		}
+		errors += (item != (Int)n);
+	}
+	producer.join();
+	printf("%-34s %7.1f Mitems/s  (%lu items)%s\n", "threads AtomicSpsc<Int,1024>",
+			items / ((Double)(HostBios_nowNsec() - start) / 1e3), (unsigned long)items,
+			errors ? "  ORDER ERRORS" : "");
+	if(errors) {
+		failures = failures + 1;
+	}
+}
+
+
+//-----------------------------------------
+// Phase 3 - the handlers on SYS/BIOS Tasks
+//-----------------------------------------
+
+static BoundedQueue<Sample_T, 4, SemaphorePolicy> taskQueue;
+static Task_Struct producerObj;
+static Task_Struct consumerObj;
+static UInt32 taskItems;
+static UInt32 taskReceived;
+static UInt32 taskErrors;
+
+/*
+ * Function: producerTaskHandler
+ * Description: insert_item's loop on the template - push blocks while the queue is full.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: push Sample_T items counting up from -1; the policy does the blocking.
+*/
+static Void producerTaskHandler(UArg arg0, UArg arg1)
+{
+	Int n = -1;
+
+	(Void)arg0;
+	(Void)arg1;
+	while(1) {
+		taskQueue.push(makeItem((Sample_T *)0, n++));
+	}
+}
+
+/*
+ * Function: consumerTaskHandler
+ * Description: remove_item's loop on the template - pop blocks while the queue is empty.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: check every item against the expected one; end the run after taskItems.
+*/
+static Void consumerTaskHandler(UArg arg0, UArg arg1)
+{
+	Sample_T item = Sample_T();
+	Int n = -1;
+
+	(Void)arg0;
+	(Void)arg1;
+	while(1) {
+		taskErrors += !taskQueue.pop(item) || !sameItem(item, makeItem((Sample_T *)0, n++));
+		taskReceived = taskReceived + 1;
+		if(taskReceived == taskItems) {
+			HostBios_stop();
+		}
+	}
+}
+
+/*
+ * Function: taskReport
+ * Description: phase 3's result line, and the bench's exit status.
+ * Input: FILE *out, Double seconds - the run report's arguments.
+ * Output: void - exits with a failure status on an order error or an unfinished run.
+*/
+static Void taskReport(FILE *out, Double seconds)
+{
+	fprintf(out, "tasks SemaphorePolicy<Sample_T,4>: items %lu in %.3f s order errors %lu\n",
+			(unsigned long)taskReceived, seconds, (unsigned long)taskErrors);
+	if(taskErrors != 0) {
+		fprintf(out, "queue_bench: FAIL - phase 3 items out of order\n");
+	}
+	if(taskReceived < taskItems) {
+		fprintf(out, "queue_bench: FAIL - phase 3 moved %lu of %lu items, raise PC_RUN_MSEC\n",
+				(unsigned long)taskReceived, (unsigned long)taskItems);
+	}
+	fflush(out);
+	if(taskErrors != 0 || taskReceived < taskItems) {
+		_Exit(EXIT_FAILURE);
+	}
+}
+
+static Void construct(Task_Struct *obj, CString name, Task_FuncPtr fxn)
+{
+	Task_Params taskParams;
+
+	Task_Params_init(&taskParams);
+	taskParams.instance->name = name;
+	taskParams.priority = 1;
+	Task_construct(obj, fxn, &taskParams, NULL);
+}
+
+int main()
+{
+	UInt32 rounds = envCount("QB_ROUNDS", QB_ROUNDS_DEFAULT);
+	UInt32 items = envCount("QB_ITEMS", QB_ITEMS_DEFAULT);
+
+	printf("bounded_queue: bursts of %d pushes + %d pops, ns per push or pop\n", QB_BURST, QB_BURST);
+	ringLoop("C SpscRing_T[16]", QueueBench_spscRing, rounds);
+	ringLoop("C MpmcRing_T[16]", QueueBench_mpmcRing, rounds);
+	burstLoop<BoundedQueue<Int, 16, UnsyncPolicy>, Int>("BoundedQueue<Int,16,Unsync>", rounds);
+	burstLoop<BoundedQueue<Int, 10, UnsyncPolicy>, Int>("BoundedQueue<Int,10,Unsync>", rounds);
+	burstLoop<BoundedQueue<Sample_T, 16, UnsyncPolicy>, Sample_T>("BoundedQueue<Sample_T,16,Unsync>", rounds);
+	burstLoop<BoundedQueue<Int, 16, AtomicSpscPolicy>, Int>("BoundedQueue<Int,16,AtomicSpsc>", rounds);
+	burstLoop<BoundedQueue<Int, 16, HwiPolicy>, Int>("BoundedQueue<Int,16,Hwi>", rounds / QB_KERNEL_DIVISOR);
+	burstLoop<BoundedQueue<Int, 16, SemaphorePolicy>, Int>("BoundedQueue<Int,16,Semaphore>", rounds / QB_KERNEL_DIVISOR);
+	threadRun(items);
+	if(failures != 0) {
+		printf("queue_bench: FAIL - %lu queues out of order, phase 3 skipped\n", (unsigned long)failures);
+		fflush(stdout);
+		return EXIT_FAILURE;
+	}
+	fflush(stdout);
+
+	taskItems = items;
+	construct(&producerObj, "producer", producerTaskHandler);
+	construct(&consumerObj, "consumer", consumerTaskHandler);
+	HostBios_addReportFxn(taskReport);
+	BIOS_start();
+	return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * queue_bench_ring.c - host build only
+ *
+ * The C side of queue_bench: the same burst loops as queue_bench.cpp, run on the SpscRing_T and
+ * MpmcRing_T engines of ring.h. ring.h uses C11 <stdatomic.h> on the host, which a C++ file
+ * can't include, so the loops are compiled here and called through extern "C".
+ */
+
+#include <xdc/std.h>
+
+#include "ring.h"
+
+#define QB_RING_CAPACITY	16
+#define QB_BURST			8
+
+static volatile Int spscStorage[QB_RING_CAPACITY];
+static MpmcCell_T mpmcCells[QB_RING_CAPACITY];
+
+/*
+ * Function: QueueBench_spscRing
+ * Description: "rounds" bursts through a 16 slot SpscRing_T.
+ * Input: UInt32 rounds - bursts of QB_BURST pushes followed by QB_BURST pops.
+ * Output: UInt32 - items that came out of order, or didn't come out (0 is correct).
+ * Algorithm: the items are a running counter, so every pop must return the next value.
+*/
+UInt32 QueueBench_spscRing(UInt32 rounds)
+{
+	SpscRing_T ring;
+	UInt32 r, errors = 0;
+	Int i, item, in = 0, out = 0;
+
+	SpscRing_init(&ring, spscStorage, QB_RING_CAPACITY);
+	for(r = 0 ; r < rounds ; r++) {
+		for(i = 0 ; i < QB_BURST ; i++) {
+			errors += !SpscRing_push(&ring, in++);
+		}
+		for(i = 0 ; i < QB_BURST ; i++) {
+			errors += !SpscRing_pop(&ring, &item) || item != out++;
+		}
+	}
+	return errors;
+}
+
+/*
+ * Function: QueueBench_mpmcRing
+ * Description: "rounds" bursts through a 16 slot MpmcRing_T.
+ * Input: UInt32 rounds - bursts of QB_BURST pushes followed by QB_BURST pops.
+ * Output: UInt32 - items that came out of order, or didn't come out (0 is correct).
+ * Algorithm: as QueueBench_spscRing.
+*/
+UInt32 QueueBench_mpmcRing(UInt32 rounds)
+{
+	MpmcRing_T ring;
+	UInt32 r, errors = 0;
+	Int i, item, in = 0, out = 0;
+
+	MpmcRing_init(&ring, mpmcCells, QB_RING_CAPACITY);
+	for(r = 0 ; r < rounds ; r++) {
+		for(i = 0 ; i < QB_BURST ; i++) {
+			errors += !MpmcRing_push(&ring, in++);
+		}
+		for(i = 0 ; i < QB_BURST ; i++) {
+			errors += !MpmcRing_pop(&ring, &item) || item != out++;
+		}
+	}
+	return errors;
+}
@@ -0,0 +1,231 @@
+/*
+ * record_host.c - host build only
+ *
+ * Record and replay of the task interleaving (record.h).
+ *
+ * PC_RECORD=<file>: the run takes its Clock ticks at the record points only (HostBios_holdTicks),
+ * and the record ring is written to <file> - a RecordFileHeader_T, then the raw 4-byte events.
+ * In a build with RECORD_DUMP_SIZE > 0 main installs the target's Record_dumpSink instead, and
+ * the report writes recordDump to <file>, as the debugger would save it. Without PC_RECORD the
+ * events are only counted.
+ *
+ * PC_REPLAY=<file>: the run replays <file>. There are no real-time ticks: a running Task gets
+ * the recorded ticks at the point whose step they were recorded at, the idle loop gets the idle
+ * ones, and the producers' workloads get the recorded seeds. Every event the replay records is
+ * compared with the file - the first one that differs ends the replay (a divergence: a
+ * different build or settings, or a record from the target whose tick fell between two points
+ * in a way that matters), so does the end of the file. A recorded recAnomaly_e that comes round
+ * again is reported as reproduced, with its position. The record ends at the end of the file
+ * or at its first empty (recNone_e) event - the unused tail of a recordDump. Set PC_RUN_MSEC
+ * high enough for the replay to get through the file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <xdc/std.h>
+
+#include "bios_host.h"
+#include "record.h"
+
+static FILE *recordFile;
+
+static RecordEvent_T *replayEvents;		// the record being replayed
+static UInt32 replayCount;
+static UInt32 replayNext;				// index of the next event expected
+static UInt32 replayAnomalies;			// recorded anomalies reproduced
+static Bool replayDone;
+static Char replayVerdict[160];
+
+static Void recordFileSink(const RecordEvent_T *events, Int n)
+{
+	fwrite(events, sizeof(RecordEvent_T), n, recordFile);
+}
+
+/*
+ The host runs far more items per tick than the target, more than the drain Task can keep in
+ the ring - the recording run also drains it at every point. No kernel call in between, so
+ nothing else runs meanwhile.
+ */
+static Void recordPoint(Void)
+{
+	Record_flush();
+	HostBios_tickPoint(0);
+}
+
+static Void replayFinish(CString verdict)
+{
+	if(!replayDone) {
+		replayDone = TRUE;
+		snprintf(replayVerdict, sizeof(replayVerdict), "%s", verdict);
+		HostBios_stop();
+	}
+}
+
+/*
+ Ticks recorded at the current step for a running (idle: the idle loop's) Task. Several in a
+ row were taken together - a tick that made another Task run would be followed by its switch.
+ */
+static UInt32 replayTicksDue(Bool idle)
+{
+	UInt32 i = replayNext;
+
+	while(!replayDone && i < replayCount && replayEvents[i].kind == recTick_e
+			&& replayEvents[i].step == (UInt16)recordStep
+			&& (replayEvents[i].task == RECORD_IDLE) == idle) {
+		i++;
+	}
+	return i - replayNext;
+}
+
+static Void replayPoint(Void)
+{
+	UInt32 due = replayTicksDue(FALSE);
+
+	Record_flush();							// the replay records too, to compare - see recordPoint
+
+	if(due > 0) {
+		HostBios_tickPoint(due);
+	}
+}
+
+static UInt32 replayIdleTicks(Void)
+{
+	return replayTicksDue(TRUE);
+}
+
+static Void replayEvent(const RecordEvent_T *event)
+{
+	const RecordEvent_T *want;
+	Char verdict[sizeof(replayVerdict)];
+
+	if(replayDone) {
+		return;
+	}
+	want = &replayEvents[replayNext];
+	if(event->kind != want->kind || event->task != want->task || event->step != want->step) {
+		snprintf(verdict, sizeof(verdict), "diverged at event %lu - recorded kind %u task 0x%02x step %u, "
+				"replayed kind %u task 0x%02x step %u", (unsigned long)replayNext, want->kind, want->task,
+				want->step, event->kind, event->task, event->step);
+		replayFinish(verdict);
+		return;
+	}
+	if(event->kind == recAnomaly_e) {
+		replayAnomalies++;
+		fprintf(stderr, "replay: anomaly reproduced at event %lu (task 0x%02x, step %u)\n",
+				(unsigned long)replayNext, event->task, event->step);
+	}
+	replayNext++;
+	if(replayNext == replayCount) {
+		replayFinish("complete");
+	}
+}
+
+static UInt32 replayEntropy(UInt32 value)
+{
+	if(replayNext + 1 < replayCount && replayEvents[replayNext].kind == recEntropy_e
+			&& replayEvents[replayNext + 1].kind == recEntropy_e) {
+		value = replayEvents[replayNext].step | ((UInt32)replayEvents[replayNext + 1].step << 16);
+	}
+	return value;
+}
+
+static Void recordReport(FILE *out, Double seconds)
+{
+	(Void)seconds;
+	Record_flush();							// the events written since the drain Task's last run
+	fprintf(out, "record: events %lu drained %lu dropped %lu dumped %u%s\n", (unsigned long)recordStats.events,
+			(unsigned long)recordStats.drained, (unsigned long)recordStats.dropped, (unsigned)recordStats.dumped,
+			(recordStats.stopped && recordFile != NULL) ? " - the record stopped early" : "");
+	if(recordFile != NULL) {
+#if RECORD_DUMP_SIZE
+		fwrite(&recordDump, sizeof(recordDump), 1, recordFile);
+#endif
+		fclose(recordFile);
+	}
+	if(replayEvents != NULL) {
+		fprintf(out, "replay: %lu of %lu events matched, %lu anomalies reproduced - %s\n",
+				(unsigned long)replayNext, (unsigned long)replayCount, (unsigned long)replayAnomalies,
+				replayDone ? replayVerdict : "run ended first (raise PC_RUN_MSEC)");
+	}
+}
+
+static Bool readHeader(FILE *f, CString path)
+{
+	RecordFileHeader_T header;
+
+	if(fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, "PCRECRD1", sizeof(header.magic)) != 0) {
+		fprintf(stderr, "%s: not a record file\n", path);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static Void replayOpen(CString path)
+{
+	FILE *f = fopen(path, "rb");
+	long size;
+
+	if(f == NULL) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	if(!readHeader(f, path)) {
+		exit(EXIT_FAILURE);
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f) - (long)sizeof(RecordFileHeader_T);
+	fseek(f, sizeof(RecordFileHeader_T), SEEK_SET);
+	replayCount = (UInt32)(size / (long)sizeof(RecordEvent_T));
+	replayEvents = malloc((replayCount > 0 ? replayCount : 1) * sizeof(RecordEvent_T));
+	if(replayEvents == NULL || fread(replayEvents, sizeof(RecordEvent_T), replayCount, f) != replayCount) {
+		fprintf(stderr, "%s: can't read the record\n", path);
+		exit(EXIT_FAILURE);
+	}
+	fclose(f);
+	for(size = 0 ; size < (long)replayCount && replayEvents[size].kind != recNone_e ; size++) {
+	}
+	replayCount = (UInt32)size;				// a recordDump's unused tail is not part of the record
+	if(replayCount == 0) {
+		replayFinish("empty record");
+	}
+}
+
+__attribute__((constructor))
+static Void recordRegister(Void)
+{
+	static RecordHooks_T hooks;
+	CString recordPath = getenv("PC_RECORD");
+	CString replayPath = getenv("PC_REPLAY");
+	RecordFileHeader_T header;
+
+	if(!RECORD_INTERLEAVING) {
+		return;
+	}
+	HostBios_addReportFxn(recordReport);
+	if(replayPath != NULL) {
+		replayOpen(replayPath);
+		hooks.point = replayPoint;
+		hooks.event = replayEvent;
+		hooks.entropy = replayEntropy;
+		HostBios_holdTicks(TRUE);
+		HostBios_setIdleTickFxn(replayIdleTicks);
+	} else if(recordPath != NULL) {
+		recordFile = fopen(recordPath, "wb");
+		if(recordFile == NULL) {
+			perror(recordPath);
+			return;
+		}
+		if(!RECORD_DUMP_SIZE) {
+			memset(&header, 0, sizeof(header));
+			memcpy(header.magic, "PCRECRD1", sizeof(header.magic));
+			header.ringSize = RECORD_RING_SIZE;
+			fwrite(&header, sizeof(header), 1, recordFile);
+			Record_setSink(recordFileSink);
+		}
+		hooks.point = recordPoint;
+		HostBios_holdTicks(TRUE);
+	}
+	Record_setHooks(&hooks);
+}
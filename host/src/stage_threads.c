@@ -0,0 +1,324 @@
+/*
+ * stage_threads.c - host build only
+ *
+ * Runs the stage graph of stage_graph.c (the same table and stage functions as the target) with
+ * one host thread per stage worker, for scaling experiments: unlike pc_bench, whose emulated
+ * kernel runs one Task at a time, the workers here run in parallel on the host's cores. The links
+ * are plain mutex/condition variable bounded buffers - blocking on full and empty like
+ * insert_items/remove_items - and every stage and link is counted like stageStats, with the same
+ * bottleneck rule as Stage_bottleneck.
+ *
+ * Settings on the command line, NAME=value:
+ *
+ *   RUN_MSEC=2000	run length
+ *   CAPACITY=n		slots of every link (default: the table's)
+ *   <stage>=n		workers of a stage, e.g. filter=4
+ *   <stage>.batch=n	its batch (1..STAGE_MAX_BATCH)
+ *   <stage>.arg=n	its parameter, e.g. acquire.arg=0 (unpaced), filter.arg=8
+ *
+ *   ./build/pc_stages RUN_MSEC=3000 filter=2 CAPACITY=64
+ *
+ * A Clock tick a stage function asks to sleep is a millisecond here.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <xdc/std.h>
+
+#include "bios_host.h"
+#include "stage.h"
+#include "stage_graph.h"
+
+#define MAX_THREADS		64
+
+/*
+ Structure HostLink_T - a link: a mutex/condition variable bounded buffer and its depth counters.
+ */
+typedef struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t notFull;
+	pthread_cond_t notEmpty;
+	Int *slots;
+	Int capacity;
+	Int head;					// oldest item
+	Int count;
+	UInt64 samples;				// depth samples, taken by the reading stage under the lock
+	UInt64 depthSum;
+	Int depthMax;
+} HostLink_T;
+
+typedef struct
+{
+	UInt64 calls;
+	UInt64 itemsIn;
+	UInt64 itemsOut;
+} HostStageCounters_T;
+
+typedef struct
+{
+	Int stage;
+	Int id;
+} Worker_T;
+
+static StageDef_T stages[STAGE_MAX_STAGES];
+static HostLink_T links[STAGE_MAX_LINKS];
+static HostStageCounters_T counters[STAGE_MAX_STAGES];
+static volatile Int stopping;
+
+
+/*
+ * Function: linkTake
+ * Description: remove up to max items from a link, blocking while it is empty.
+ * Input: HostLink_T *link, Int *dst, Int max.
+ * Output: Int - items removed, 0 once the run is stopping.
+ * Algorithm: sample the depth, wait for an item, copy what is there up to max, signal notFull.
+*/
+static Int linkTake(HostLink_T *link, Int *dst, Int max)
+{
+	Int n = 0;
+
+	pthread_mutex_lock(&link->lock);
+	link->samples++;
+	link->depthSum += link->count;
+	if(link->count > link->depthMax) {
+		link->depthMax = link->count;
+	}
+	while(link->count == 0 && !stopping) {
+		pthread_cond_wait(&link->notEmpty, &link->lock);
+	}
+	while(n < max && link->count > 0) {
+		dst[n++] = link->slots[link->head];
+		link->head = (link->head + 1 == link->capacity) ? 0 : link->head + 1;
+		link->count--;
+	}
+	pthread_cond_broadcast(&link->notFull);
+	pthread_mutex_unlock(&link->lock);
+	return n;
+}
+
+/*
+ * Function: linkPut
+ * Description: insert n items into a link, blocking while it is full.
+ * Input: HostLink_T *link, const Int *src, Int n.
+ * Output: Int - items inserted, less than n only once the run is stopping.
+ * Algorithm: copy as much as fits, signal notEmpty, wait for room for the rest.
+*/
+static Int linkPut(HostLink_T *link, const Int *src, Int n)
+{
+	Int put = 0;
+
+	pthread_mutex_lock(&link->lock);
+	while(put < n && !stopping) {
+		while(link->count == link->capacity && !stopping) {
+			pthread_cond_wait(&link->notFull, &link->lock);
+		}
+		while(put < n && link->count < link->capacity) {
+			link->slots[(link->head + link->count) % link->capacity] = src[put++];
+			link->count++;
+		}
+		pthread_cond_broadcast(&link->notEmpty);
+	}
+	pthread_mutex_unlock(&link->lock);
+	return put;
+}
+
+/*
+ * Function: workerThread
+ * Description: stageHandler's loop (main.c) on a host thread.
+ * Input: Ptr arg - the Worker_T.
+ * Output: Ptr - NULL.
+ * Algorithm: take a batch, call the stage function, put its results, count - until stopping.
+*/
+static Ptr workerThread(Ptr arg)
+{
+	const Worker_T *worker = (const Worker_T *)arg;
+	const StageDef_T *def = &stages[worker->stage];
+	HostStageCounters_T *count = &counters[worker->stage];
+	StageCtx_T ctx;
+	Int items[STAGE_MAX_BATCH];
+	Int results[STAGE_MAX_BATCH];
+	Int taken, made, sent;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.stage = worker->stage;
+	ctx.worker = worker->id;
+	ctx.batch = def->batch;
+	ctx.arg = def->arg;
+	Prng_seed(&ctx.prng, (UInt32)HostBios_nowNsec() ^ ((UInt32)worker->stage << 8) ^ (UInt32)worker->id);
+
+	while(!stopping) {
+		taken = 0;
+		if(def->input != STAGE_NONE) {
+			taken = linkTake(&links[def->input], items, def->batch);
+			if(taken == 0) {
+				break;
+			}
+		}
+		ctx.sleep = 0;
+		made = def->fxn(&ctx, items, taken, (def->output != STAGE_NONE) ? results : NULL);
+		ctx.calls++;
+		sent = (def->output != STAGE_NONE) ? linkPut(&links[def->output], results, made) : 0;
+		__atomic_fetch_add(&count->calls, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&count->itemsIn, (UInt64)taken, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&count->itemsOut, (UInt64)sent, __ATOMIC_RELAXED);
+		if(ctx.sleep > 0) {
+			usleep(ctx.sleep * 1000);
+		}
+	}
+	return NULL;
+}
+
+static Int stageIndex(const char *name, size_t len)
+{
+	Int s = 0;
+
+	for(s = 0 ; s < stageGraph.numStages ; s++) {
+		if(strlen(stages[s].name) == len && strncmp(stages[s].name, name, len) == 0) {
+			return s;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Function: setting
+ * Description: apply one NAME=value argument.
+ * Input: const char *text - the argument, long *runMsec, Int *capacity - the global settings.
+ * Output: Bool - FALSE for an unknown name.
+ * Algorithm: RUN_MSEC and CAPACITY, else <stage>[.batch|.arg].
+*/
+static Bool setting(const char *text, long *runMsec, Int *capacity)
+{
+	const char *eq = strchr(text, '=');
+	const char *dot;
+	long value;
+	Int s;
+
+	if(eq == NULL) {
+		return FALSE;
+	}
+	value = atol(eq + 1);
+	if(strncmp(text, "RUN_MSEC=", 9) == 0) {
+		*runMsec = value;
+		return TRUE;
+	}
+	if(strncmp(text, "CAPACITY=", 9) == 0) {
+		*capacity = (Int)value;
+		return value > 0;
+	}
+	dot = memchr(text, '.', eq - text);
+	s = stageIndex(text, (dot != NULL ? dot : eq) - text);
+	if(s < 0) {
+		return FALSE;
+	}
+	if(dot == NULL) {
+		stages[s].workers = (Int)value;
+	} else if(strncmp(dot, ".batch=", 7) == 0 && value >= 1 && value <= STAGE_MAX_BATCH) {
+		stages[s].batch = (Int)value;
+	} else if(strncmp(dot, ".arg=", 5) == 0) {
+		stages[s].arg = (UArg)value;
+	} else {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * Function: occupancy
+ * Description: mean fill of a link, 0..1 - as in stage.c.
+ * Input: Int l - link index or STAGE_NONE, Double none - the value for STAGE_NONE.
+ * Output: Double - the occupancy, -1 without samples.
+*/
+static Double occupancy(Int l, Double none)
+{
+	if(l == STAGE_NONE) {
+		return none;
+	}
+	if(links[l].samples == 0) {
+		return -1.0;
+	}
+	return (Double)links[l].depthSum / links[l].samples / links[l].capacity;
+}
+
+int main(int argc, char *argv[])
+{
+	static pthread_t threads[MAX_THREADS];
+	static Worker_T workers[MAX_THREADS];
+	long runMsec = 2000;
+	Int capacity = 0;
+	Int numThreads = 0;
+	Int bottleneck = -1;
+	Double best = 0.0;
+	Double seconds, in, out;
+	UInt64 start;
+	Int i, s, l, w;
+
+	memcpy(stages, stageGraph.stages, stageGraph.numStages * sizeof(StageDef_T));
+	for(i = 1 ; i < argc ; i++) {
+		if(!setting(argv[i], &runMsec, &capacity)) {
+			fprintf(stderr, "pc_stages: bad setting %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+	for(l = 0 ; l < stageGraph.numLinks ; l++) {
+		links[l].capacity = (capacity > 0) ? capacity : stageGraph.links[l].capacity;
+		links[l].slots = malloc(links[l].capacity * sizeof(Int));
+		pthread_mutex_init(&links[l].lock, NULL);
+		pthread_cond_init(&links[l].notFull, NULL);
+		pthread_cond_init(&links[l].notEmpty, NULL);
+	}
+
+	start = HostBios_nowNsec();
+	for(s = 0 ; s < stageGraph.numStages ; s++) {
+		for(w = 0 ; w < stages[s].workers && numThreads < MAX_THREADS ; w++) {
+			workers[numThreads].stage = s;
+			workers[numThreads].id = numThreads + 1;
+			if(pthread_create(&threads[numThreads], NULL, workerThread, &workers[numThreads]) != 0) {
+				fprintf(stderr, "pc_stages: can't create a worker thread\n");
+				return EXIT_FAILURE;
+			}
+			numThreads++;
+		}
+	}
+	usleep(runMsec * 1000);
+	stopping = TRUE;
+	for(l = 0 ; l < stageGraph.numLinks ; l++) {
+		pthread_mutex_lock(&links[l].lock);
+		pthread_cond_broadcast(&links[l].notFull);
+		pthread_cond_broadcast(&links[l].notEmpty);
+		pthread_mutex_unlock(&links[l].lock);
+	}
+	for(i = 0 ; i < numThreads ; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	seconds = (Double)(HostBios_nowNsec() - start) / 1e9;
+
+	for(s = 0 ; s < stageGraph.numStages ; s++) {
+		in = occupancy(stages[s].input, 1.0);
+		out = occupancy(stages[s].output, 0.0);
+		if(in >= 0.0 && out >= 0.0 && (bottleneck < 0 || in - out > best)) {
+			bottleneck = s;
+			best = in - out;
+		}
+	}
+	printf("run: %.3f s, %d worker threads on %ld cpus\n", seconds, numThreads, sysconf(_SC_NPROCESSORS_ONLN));
+	printf("stages: %d stages %d links, transmitted %lu checksum %lu\n", stageGraph.numStages, stageGraph.numLinks,
+			(unsigned long)stageTransmitStats.items, (unsigned long)stageTransmitStats.checksum);
+	for(s = 0 ; s < stageGraph.numStages ; s++) {
+		printf("  %-10s workers %d batch %d arg %lu in %10.0f/s out %10.0f/s calls %llu%s\n", stages[s].name,
+				stages[s].workers, stages[s].batch, (unsigned long)stages[s].arg, counters[s].itemsIn / seconds,
+				counters[s].itemsOut / seconds, (unsigned long long)counters[s].calls,
+				(s == bottleneck) ? "  <- bottleneck" : "");
+	}
+	for(l = 0 ; l < stageGraph.numLinks ; l++) {
+		printf("  link %-10s depth mean %.2f max %d of %d\n", stageGraph.links[l].name,
+				links[l].samples ? (Double)links[l].depthSum / links[l].samples : 0.0, links[l].depthMax,
+				links[l].capacity);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""Microbenchmark and regression suite of the producer/consumer hot path, as JSON.
+
+Two parts:
+
+  - primitives (microbench.h): Semaphore_post/pend uncontended and contended (ping-pong), Task_yield
+    alone and with a Task switch, Task_getEnv/Task_setEnv, Log_info2 and the % and mask index
+    wraps. They are timed with the Timestamp module, as the best of MICROBENCH_REPEATS runs. On
+    the host the tool builds pc_bench with MICROBENCH=1 and runs it until the benchmark is done -
+    about 2.6 s with the default --iterations 20000 here, growing with --iterations - with
+    --microbench-msec only as a limit: a run cut short by it fails. For the target, save
+    microBenchStats from the memory browser once its "done" field is 1 and pass the file
+    with --dump. The target's Timestamp runs at the CPU clock, so counts_per_op are cycles;
+  - paths: the whole producer -> buffer -> consumer path, for 1..4 producers and as many consumers,
+    on every --engines engine. Each is a pc_bench build like sweep.py's points, and its cost is
+    1e9 / throughput ns per item. The paths are host only.
+
+  host/tools/bench.py --out bench.json                          # measure, write JSON
+  host/tools/bench.py --out new.json --baseline bench.json      # ... and compare
+  host/tools/bench.py --dump mb.bin --out target.json           # decode a target dump
+  host/tools/bench.py --compare new.json --baseline bench.json  # compare two files only
+
+A comparison fails (exit status 1) when a metric got slower than its baseline by more than
+--threshold percent and by more than --min-delta-ns. The second condition keeps primitives of
+a nanosecond or two, which are at the resolution of the host's 1 MHz Timestamp, from failing on
+noise. Metrics missing on one side are listed, but don't fail the comparison.
+"""
+
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+
+import sweep
+
+HEADER = struct.Struct("<4sIHH")
+RESULT = struct.Struct("<II")
+
+# MicroBenchId_E in microbench.h
+PRIMITIVES = ["loop", "sem_post", "sem_pend", "sem_pend_post", "sem_pingpong", "yield", "yield_switch",
+              "task_get_env", "task_set_env", "log_info2", "wrap_modulo", "wrap_mask"]
+
+ENGINES = {0: "locked", 1: "spsc", 2: "mpmc", 3: "lanes"}
+
+
+def decode_dump(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a microbench header" % path)
+    magic, freq, count, done = HEADER.unpack_from(data, 0)
+    if magic != b"MBEN":
+        sys.exit("%s: not a microbench dump (magic %r)" % (path, magic))
+    if not done:
+        sys.exit("%s: the benchmark was not done" % path)
+    if len(data) < HEADER.size + count * RESULT.size:
+        sys.exit("%s: truncated - %d results expected" % (path, count))
+    primitives = {}
+    iterations = 0
+    for i in range(min(count, len(PRIMITIVES))):
+        iterations, best = RESULT.unpack_from(data, HEADER.size + i * RESULT.size)
+        if iterations == 0:
+            continue
+        per_op = best / iterations
+        primitives[PRIMITIVES[i]] = {"counts_per_op": round(per_op, 3), "ns_per_op": round(per_op * 1e9 / freq, 2)}
+    return {"timestamp_hz": freq, "iterations": iterations, "primitives": primitives}
+
+
+def dump_done(path):
+    with open(path, "rb") as f:
+        data = f.read(HEADER.size)
+    return len(data) == HEADER.size and HEADER.unpack(data)[3] != 0
+
+
+def host_primitives(args):
+    build = os.path.join(args.build_root, "microbench")
+    dump = os.path.join(build, "microbench.bin")
+    defines = ["MICROBENCH=1", "MICROBENCH_ITERATIONS=%d" % args.iterations]
+    subprocess.run(["cmake", "-S", sweep.HOST_DIR, "-B", build, "-DPC_DEFINES=" + ";".join(defines)],
+                   check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(["cmake", "--build", build, "--target", "pc_bench"], check=True, stdout=subprocess.DEVNULL)
+    if os.path.exists(dump):
+        os.remove(dump)
+    env = dict(os.environ, PC_RUN_MSEC=str(args.microbench_msec), PC_MICROBENCH=dump)
+    subprocess.run([os.path.join(build, "pc_bench")], check=True, env=env, stdout=subprocess.DEVNULL)
+    if not os.path.exists(dump) or not dump_done(dump):
+        sys.exit("the host microbenchmark did not finish in --microbench-msec %d - raise it" % args.microbench_msec)
+    return decode_dump(dump)
+
+
+def host_paths(args):
+    paths = {}
+    for engine in args.engines:
+        for n in args.workers:
+            if not sweep.fits(engine, n, n, args.size):
+                continue
+            point = argparse.Namespace(engine=engine, sim=False, define=[], run_msec=args.run_msec,
+                                       build_root=os.path.join(args.build_root, "engine%d" % engine))
+            throughput = sweep.run_point(point, n, n, args.size, [])[0]
+            name = "%s_n%d_m%d" % (ENGINES.get(engine, str(engine)), n, n)
+            paths[name] = {"items_per_s": throughput,
+                           "ns_per_item": round(1e9 / throughput, 1) if throughput else None}
+            print("  path %-16s %10d items/s %10.1f ns/item" % (name, throughput, 1e9 / throughput if throughput else 0))
+            sys.stdout.flush()
+    return paths
+
+
+def show_primitives(results):
+    for name, value in results["primitives"].items():
+        print("  primitive %-14s %10.1f ns/op %10.3f counts/op" % (name, value["ns_per_op"], value["counts_per_op"]))
+    sys.stdout.flush()
+
+
+def metrics(results):
+    found = {}
+    for name, value in results.get("primitives", {}).items():
+        if name != "loop":
+            found["primitive " + name] = value["ns_per_op"]
+    for name, value in results.get("paths", {}).items():
+        if value.get("ns_per_item") is not None:
+            found["path " + name] = value["ns_per_item"]
+    return found
+
+
+def compare(current, baseline, threshold, min_delta):
+    now = metrics(current)
+    base = metrics(baseline)
+    regressions = 0
+    print("%-32s %12s %12s %8s" % ("metric (ns)", "baseline", "current", "change"))
+    for name in sorted(set(now) | set(base)):
+        if name not in now or name not in base:
+            print("%-32s %12s %12s %8s  %s" % (name, base.get(name, "-"), now.get(name, "-"), "", "missing"))
+            continue
+        change = (now[name] - base[name]) / base[name] * 100 if base[name] else 0.0
+        regressed = change > threshold and now[name] - base[name] > min_delta
+        regressions += regressed
+        print("%-32s %12.1f %12.1f %+7.1f%%%s" % (name, base[name], now[name], change,
+                                                  "  REGRESSION" if regressed else ""))
+    print("%d regression(s) beyond %.0f%% and %.1f ns" % (regressions, threshold, min_delta))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--out", help="write the results to this JSON file")
+    parser.add_argument("--baseline", help="compare the results with this JSON file")
+    parser.add_argument("--compare", help="don't measure - compare this JSON file with --baseline")
+    parser.add_argument("--dump", help="decode this target microBenchStats dump instead of measuring")
+    parser.add_argument("--threshold", type=float, default=20.0, help="percent slower that fails (default 20)")
+    parser.add_argument("--min-delta-ns", type=float, default=2.0, help="ns slower that fails (default 2)")
+    parser.add_argument("--iterations", type=int, default=20000, help="MICROBENCH_ITERATIONS of the host build")
+    parser.add_argument("--microbench-msec", type=int, default=60000,
+                        help="limit of the host microbenchmark's run, which ends when it is done (default 60000)")
+    parser.add_argument("--engines", type=sweep.int_list, default=[0, 2], help="QUEUE_ENGINEs of the paths")
+    parser.add_argument("--workers", type=sweep.int_list, default=[1, 2, 3, 4], help="producers (= consumers) of the paths")
+    parser.add_argument("--size", type=int, default=16, help="BUFFER_SIZE of the paths")
+    parser.add_argument("--run-msec", type=int, default=1000, help="run length of every path")
+    parser.add_argument("--no-paths", action="store_true", help="measure the primitives only")
+    parser.add_argument("--build-root", default="_bench", help="build directories")
+    args = parser.parse_args()
+
+    if args.compare:
+        if not args.baseline:
+            sys.exit("--compare needs --baseline")
+        with open(args.compare) as f:
+            results = json.load(f)
+    elif args.dump:
+        results = dict(schema=1, platform="target", **decode_dump(args.dump))
+        show_primitives(results)
+        results["paths"] = {}
+    else:
+        results = dict(schema=1, platform="host", **host_primitives(args))
+        show_primitives(results)
+        results["paths"] = {} if args.no_paths else host_paths(args)
+
+    if args.out:
+        with open(args.out, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if compare(results, baseline, args.threshold, args.min_delta_ns):
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
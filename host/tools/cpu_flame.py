@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Render a CPU accounting snapshot (cpuacct.h) as a flame-style breakdown of where the time went.
+
+The snapshot is a 16 byte header ("CPUA", Timestamp frequency, elapsed counts, task count, wait
+reason count) followed by one 68-byte little endian CpuAcctTask_T per task: running, slices,
+preempted, preemptions (u32), blocked time and block count per wait reason (u32 each), then
+role, id, priority and idle (u8). Dump it with PC_CPUACCT on the host, or save cpuAcctStats
+(after CpuAcct_snapshot) from the target's memory browser.
+
+  PC_CPUACCT=cpu.bin ./build/pc_bench
+  host/tools/cpu_flame.py cpu.bin
+  host/tools/cpu_flame.py cpu.bin --folded | flamegraph.pl > cpu.svg
+
+The default output is an icicle chart - every frame one bar as wide as its share of the elapsed
+time, its children below it: the tasks, then running / preempted / blocked, then the wait
+reasons. --folded writes the collapsed stacks ("task;state;reason microseconds") for
+flamegraph.pl or speedscope. A task's running + preempted + blocked covers the time since it
+first ran, so the frames of a task are wider than its CPU share; the "running" frames of all
+tasks add up to the elapsed time.
+"""
+
+import argparse
+import struct
+import sys
+
+HEADER = struct.Struct("<4sIIHH")
+
+# CpuWait_E in cpuacct.h
+WAITS = ["other", "emptySlots", "fullSlots", "mutex", "ledSrvSched", "sleep"]
+
+# TopologyRole_E in topology.h
+ROLES = {1: "producer", 2: "consumer", 3: "stage"}
+
+# the other tasks of empty.cfg and main.c, by priority
+PRIORITIES = {3: "ledSrvTask", 2: "traceDrain"}
+
+
+def read_snapshot(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a CPU accounting header" % path)
+    magic, freq, elapsed, num_tasks, num_waits = HEADER.unpack_from(data, 0)
+    if magic != b"CPUA":
+        sys.exit("%s: not a CPU accounting snapshot (magic %r)" % (path, magic))
+    task = struct.Struct("<4I%dI%dI4B" % (num_waits, num_waits))
+    if len(data) < HEADER.size + num_tasks * task.size:
+        sys.exit("%s: truncated - %d tasks expected" % (path, num_tasks))
+    tasks = []
+    for i in range(num_tasks):
+        fields = task.unpack_from(data, HEADER.size + i * task.size)
+        running, slices, preempted, preemptions = fields[:4]
+        blocked = fields[4:4 + num_waits]
+        blocks = fields[4 + num_waits:4 + 2 * num_waits]
+        role, ident, priority, idle = fields[4 + 2 * num_waits:]
+        tasks.append({
+            "name": task_name(role, ident, priority, idle),
+            "running": running, "slices": slices,
+            "preempted": preempted, "preemptions": preemptions,
+            "blocked": blocked, "blocks": blocks,
+        })
+    return freq or 1, elapsed, tasks
+
+
+def task_name(role, ident, priority, idle):
+    if idle:
+        return "idle"
+    if role in ROLES:
+        return "%s %d" % (ROLES[role], ident)
+    return PRIORITIES.get(priority, "pri %d" % priority)
+
+
+def wait_name(w):
+    return WAITS[w] if w < len(WAITS) else "wait%d" % w
+
+
+def frames(tasks):
+    """Yields (stack, counts, calls) for every leaf frame."""
+    for t in tasks:
+        yield [t["name"], "running"], t["running"], t["slices"]
+        yield [t["name"], "preempted"], t["preempted"], t["preemptions"]
+        for w, (counts, calls) in enumerate(zip(t["blocked"], t["blocks"])):
+            yield [t["name"], "blocked", wait_name(w)], counts, calls
+
+
+def folded(tasks, freq, out):
+    for stack, counts, _ in frames(tasks):
+        usec = counts * 1000000 // freq
+        if usec > 0:
+            out.write("%s %d\n" % (";".join(stack), usec))
+
+
+def tree(tasks):
+    """Nested {name: [counts, calls, children]} of the frames."""
+    root = [0, 0, {}]
+    for stack, counts, calls in frames(tasks):
+        if counts == 0 and calls == 0:
+            continue
+        node = root
+        for name in stack:
+            node = node[2].setdefault(name, [0, 0, {}])
+            node[0] += counts
+        node[1] += calls
+    return root
+
+
+def icicle(tasks, freq, elapsed, width, out):
+    root = tree(tasks)
+    scale = max(elapsed, 1)
+    busy = sum(t["running"] for t in tasks if t["name"] != "idle")
+    out.write("elapsed %.1f ms, load %.1f%%\n" % (elapsed * 1e3 / freq, 100.0 * busy / scale))
+
+    def walk(name, node, depth):
+        counts, calls, children = node
+        bar = "#" * max(1, int(round(width * counts / scale))) if counts else ""
+        label = "%s%s" % ("  " * depth, name)
+        extra = " x%d" % calls if calls else ""
+        out.write("%-28s %6.1f%% %10.1f ms%-10s |%s\n" % (label, 100.0 * counts / scale, counts * 1e3 / freq,
+                                                         extra, bar))
+        for child in sorted(children, key=lambda c: -children[c][0]):
+            walk(child, children[child], depth + 1)
+
+    for name in sorted(root[2], key=lambda c: -root[2][c][2].get("running", [0])[0]):
+        walk(name, root[2][name], 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("snapshot", help="CPU accounting snapshot (PC_CPUACCT dump)")
+    parser.add_argument("--folded", action="store_true", help="write collapsed stacks for flamegraph.pl")
+    parser.add_argument("--width", type=int, default=50, help="bar width of 100%% of the elapsed time")
+    args = parser.parse_args()
+
+    freq, elapsed, tasks = read_snapshot(args.snapshot)
+    if args.folded:
+        folded(tasks, freq, sys.stdout)
+    else:
+        icicle(tasks, freq, elapsed, args.width, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
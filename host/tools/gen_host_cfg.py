@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Generate the host build's static configuration from empty.cfg.
+
+XDCtools turns empty.cfg into xdc/cfg/global.h plus the statically allocated kernel objects.
+This script does the same for the host emulation (host/src/bios_host.c): it reads the
+Task/Semaphore/Clock instances, the Task hook sets and Clock.tickPeriod, and writes
+
+  <out>/xdc/cfg/global.h   extern declarations of the Program.global handles
+  <out>/host_cfg.c         the objects, and a constructor registering them before main()
+  <out>/sim_cfg.h          the Task and Clock instances as tables for the simulator (pc_sim.c)
+
+Only the subset of the .cfg language the project uses is understood - parameter objects
+created with `new <Module>.Params()`, plain assignments to their fields,
+`Program.global.<name> = <Module>.create(...)` and `Task.addHookSet({switchFxn: ...})`.
+Anything else is ignored.
+
+usage: gen_host_cfg.py <empty.cfg> <out dir>
+"""
+
+import os
+import re
+import sys
+
+MODULES = ("Task", "Semaphore", "Clock")
+
+PARAMS_RE = re.compile(r"var\s+(\w+)\s*=\s*new\s+(\w+)\.Params\s*\(\s*\)\s*;")
+FIELD_RE = re.compile(r"(\w+)\.(instance\.name|\w+)\s*=\s*([^;]+);")
+CREATE_RE = re.compile(r"Program\.global\.(\w+)\s*=\s*(\w+)\.create\s*\(([^;]*)\)\s*;")
+TICK_RE = re.compile(r"Clock\.tickPeriod\s*=\s*(\d+)\s*;")
+HOOKSET_RE = re.compile(r"Task\.addHookSet\s*\(\s*\{([^}]*)\}\s*\)\s*;")
+SWITCH_FXN_RE = re.compile(r"switchFxn\s*:\s*['\"]&?(\w+)['\"]")
+
+
+def strip_comments(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    return re.sub(r"//[^\n]*", "", text)
+
+
+def value(expr):
+    expr = expr.strip()
+    if expr.startswith('"'):
+        return expr.strip('"')
+    if expr in ("true", "false"):
+        return expr == "true"
+    if expr == "null":
+        return None
+    if expr.endswith("Mode_BINARY"):
+        return "Semaphore_Mode_BINARY"
+    if expr.endswith("Mode_COUNTING"):
+        return "Semaphore_Mode_COUNTING"
+    return int(expr, 0)
+
+
+def parse(path):
+    with open(path) as f:
+        text = strip_comments(f.read())
+
+    params = {}
+    for var, module in PARAMS_RE.findall(text):
+        params[var] = {"module": module}
+    for var, field, expr in FIELD_RE.findall(text):
+        if var in params:
+            params[var][field] = value(expr)
+
+    tick = TICK_RE.search(text)
+    hooks = []
+    for body in HOOKSET_RE.findall(text):
+        switch = SWITCH_FXN_RE.search(body)
+        if switch:
+            hooks.append(switch.group(1))
+    objects = []
+    for name, module, args in CREATE_RE.findall(text):
+        if module not in MODULES:
+            continue
+        args = [a.strip() for a in args.split(",")]
+        obj = {"name": name, "module": module}
+        obj.update(params.get(args[-1], {}))
+        if module == "Task":
+            obj["fxn"] = args[0].strip('"').lstrip("&")
+        elif module == "Semaphore":
+            obj["count"] = value(args[0])
+        else:
+            obj["fxn"] = args[0].strip('"').lstrip("&")
+            obj["timeout"] = value(args[1])
+        objects.append(obj)
+    return objects, hooks, int(tick.group(1)) if tick else 1000
+
+
+def emit(objects, hooks, tick_period, cfg_name, out_dir):
+    os.makedirs(os.path.join(out_dir, "xdc", "cfg"), exist_ok=True)
+    banner = "/*\n * Generated by host/tools/gen_host_cfg.py from %s - do not edit.\n */\n\n" % cfg_name
+
+    with open(os.path.join(out_dir, "xdc", "cfg", "global.h"), "w") as h:
+        h.write(banner)
+        h.write("#ifndef XDC_CFG_GLOBAL_H_\n#define XDC_CFG_GLOBAL_H_\n\n")
+        h.write("#include <xdc/std.h>\n")
+        for module in MODULES:
+            h.write("#include <ti/sysbios/knl/%s.h>\n" % module)
+        h.write("\n")
+        for obj in objects:
+            h.write("extern const %s_Handle %s;\n" % (obj["module"], obj["name"]))
+        h.write("\n#endif /* XDC_CFG_GLOBAL_H_ */\n")
+
+    with open(os.path.join(out_dir, "host_cfg.c"), "w") as c:
+        c.write(banner)
+        c.write("#include <xdc/std.h>\n#include <xdc/cfg/global.h>\n\n#include \"bios_host.h\"\n\n")
+        fxns = []
+        for obj in objects:
+            if "fxn" in obj and obj["fxn"] not in fxns:
+                fxns.append(obj["fxn"])
+        for fxn in fxns + hooks:
+            c.write("extern Void %s();\n" % fxn)
+        c.write("\n")
+        for obj in objects:
+            c.write("static %s_Object %s_obj;\n" % (obj["module"], obj["name"]))
+            c.write("const %s_Handle %s = &%s_obj;\n" % (obj["module"], obj["name"], obj["name"]))
+        c.write("\n__attribute__((constructor))\nstatic Void hostCfgInit(Void)\n{\n")
+        c.write("\tClock_tickPeriod = %d;\n" % tick_period)
+        for hook in hooks:
+            c.write("\tHostBios_staticTaskHook((Task_SwitchFxn)%s);\n" % hook)
+        for obj in objects:
+            label = '"%s"' % obj.get("instance.name", obj["name"])
+            if obj["module"] == "Task":
+                c.write("\tHostBios_staticTask(&%s_obj, %s, (Task_FuncPtr)%s, %d, %d, %d, %d);\n" % (
+                    obj["name"], label, obj["fxn"], obj.get("priority", 1), obj.get("stackSize", 0),
+                    obj.get("arg0", 0), obj.get("arg1", 0)))
+            elif obj["module"] == "Semaphore":
+                c.write("\tHostBios_staticSemaphore(&%s_obj, %s, %d, %s);\n" % (
+                    obj["name"], label, obj["count"] or 0, obj.get("mode", "Semaphore_Mode_COUNTING")))
+            else:
+                c.write("\tHostBios_staticClock(&%s_obj, %s, (Clock_FuncPtr)%s, %d, %d, %s, %d);\n" % (
+                    obj["name"], label, obj["fxn"], obj["timeout"], obj.get("period", 0),
+                    "TRUE" if obj.get("startFlag", False) else "FALSE", obj.get("arg", 0)))
+        c.write("}\n")
+
+    with open(os.path.join(out_dir, "sim_cfg.h"), "w") as h:
+        h.write(banner)
+        h.write("/* included by host/src/pc_sim.c once SimCfgTask_T/SimCfgClock_T are defined */\n\n")
+        h.write("#define SIM_CFG_TICK_PERIOD %d\n\n" % tick_period)
+        h.write("static const SimCfgTask_T simCfgTasks[] = {\n")
+        for obj in objects:
+            if obj["module"] == "Task":
+                h.write('\t{"%s", "%s", %d},\n' % (obj.get("instance.name", obj["name"]), obj["fxn"],
+                                                   obj.get("priority", 1)))
+        h.write("\t{NULL, NULL, 0}\n};\n\n")
+        h.write("static const SimCfgClock_T simCfgClocks[] = {\n")
+        for obj in objects:
+            if obj["module"] == "Clock" and obj.get("startFlag", False):
+                h.write('\t{"%s", "%s", %d, %d},\n' % (obj.get("instance.name", obj["name"]), obj["fxn"],
+                                                       obj["timeout"], obj.get("period", 0)))
+        h.write("\t{NULL, NULL, 0, 0}\n};\n")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().splitlines()[-1])
+    objects, hooks, tick_period = parse(sys.argv[1])
+    emit(objects, hooks, tick_period, os.path.basename(sys.argv[1]), sys.argv[2])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""RAM budget of the target build and recommended stack sizes from the stack high-water marks.
+
+Reads the linker output of the CCS build - the .map file or the _linkInfo.xml next to it in
+Debug/ - for the RAM region, what every output and input section takes of it, and the static
+Task stacks of empty.cfg. With --watermarks, a dump of stackProfStats (stackprof.h) saved from
+the target's memory after a representative run, it also gives every stack's high-water mark and a
+recommended size, the settings to change and the RAM they free.
+
+  host/tools/stack_budget.py Debug/
+  host/tools/stack_budget.py Debug/RT_FinProj_Part1_HadadYanousYazdiKaduri.map --watermarks stk.bin
+
+The watermark dump is a 12 byte header ("STKP", samples, entry count) followed by 8-byte little
+endian entries: size, peak (u16), kind, role, id, priority (u8). A recommended size is the peak
+plus --margin percent, at least --guard bytes more, rounded up to --align. A stack whose peak is
+0 was never measured (the host build, or a Task that has not run) and gets no recommendation.
+Freed bytes are also shown as buffer slots of --slot-bytes each (an MPMC cell plus its latency
+tag), the RAM a bigger BUFFER_SIZE/BB_POOL_SIZE needs per slot.
+"""
+
+import argparse
+import collections
+import glob
+import os
+import re
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+HEADER = struct.Struct("<4sIHH")
+ENTRY = struct.Struct("<HHBBBB")
+
+# StackKind_E in stackprof.h
+KINDS = {0: "task", 1: "idle", 2: "system"}
+
+# TopologyRole_E in topology.h
+ROLES = {1: "producer", 2: "consumer", 3: "stage"}
+
+# the other tasks of empty.cfg and main.c, by priority
+PRIORITIES = {3: "ledSrvTask", 2: "traceDrain"}
+
+# where every kind of stack is sized
+SETTINGS = {
+    "worker": "WORKER_STACK_SIZE (main.c)",
+    "ledSrvTask": "task2Params.stackSize (empty.cfg)",
+    "traceDrain": "TRACE_DRAIN_STACK_SIZE (trace.h)",
+    "idle": "Task.idleTaskStackSize (empty.cfg)",
+    "system": "Program.stack (empty.cfg)",
+}
+
+STACK_SECTIONS = re.compile(r"taskStackSection|topologyStacks|drainStack|^\.stack$")
+TASK_STACK_SYMBOL = re.compile(r"^_?ti_sysbios_knl_Task_Instance_State_(\d+)_stack__A$")
+
+Section = collections.namedtuple("Section", "name origin size inputs")
+Input = collections.namedtuple("Input", "name obj origin size")
+
+
+def parse_map(path):
+    """Returns (regions {name: (origin, length, used)}, [Section], {symbol: address})."""
+    regions, sections, symbols = {}, [], {}
+    part, pending = None, None
+    region_re = re.compile(r"^\s+(\w+)\s+([0-9a-f]{8})\s+([0-9a-f]{8})\s+([0-9a-f]{8})\s+([0-9a-f]{8})\s+\w+")
+    out_re = re.compile(r"^(\S+)?\s+\d+\s+([0-9a-f]{8})\s+([0-9a-f]{8})\s*(\w+)?\s*$")
+    in_re = re.compile(r"^\s+([0-9a-f]{8})\s+([0-9a-f]{8})\s+(.*?)\s*$")
+    sym_re = re.compile(r"^([0-9a-f]{8})\s+(\S+)\s*$")
+    with open(path, errors="replace") as f:
+        for line in f:
+            if line.startswith("MEMORY CONFIGURATION"):
+                part = "memory"
+            elif line.startswith("SECTION ALLOCATION MAP"):
+                part = "sections"
+            elif line.startswith("LINKER GENERATED"):
+                part = None
+            elif line.startswith("GLOBAL SYMBOLS"):
+                part = "symbols"
+            elif part == "memory":
+                m = region_re.match(line)
+                if m:
+                    regions[m.group(1)] = tuple(int(v, 16) for v in m.group(2, 3, 4))
+            elif part == "sections":
+                m = out_re.match(line)
+                if m and (m.group(1) or pending):
+                    name = m.group(1) if m.group(1) and m.group(1) != "*" else pending
+                    sections.append(Section(name, int(m.group(2), 16), int(m.group(3), 16), []))
+                    pending = None
+                    continue
+                m = in_re.match(line)
+                if m and sections:
+                    text = m.group(3)
+                    name = re.search(r"\(([^)]*)\)\s*$", text)
+                    obj = text[:name.start()].split(":")[-1].strip() if name else ""
+                    sections[-1].inputs.append(Input(name.group(1) if name else text, obj,
+                                                     int(m.group(1), 16), int(m.group(2), 16)))
+                    continue
+                if re.match(r"^\S+\s*$", line):
+                    pending = line.strip()
+            elif part == "symbols":
+                m = sym_re.match(line)
+                if m:
+                    symbols[m.group(2)] = int(m.group(1), 16)
+    return regions, sections, symbols
+
+
+def parse_link_info(path):
+    """The same as parse_map, from the _linkInfo.xml."""
+    root = ET.parse(path).getroot()
+    files = {f.get("id"): f.findtext("name", "") for f in root.iter("input_file")}
+    components = {}
+    for oc in root.iter("object_component"):
+        ref = oc.find("input_file_ref")
+        components[oc.get("id")] = Input(oc.findtext("name", ""), files.get(ref.get("idref"), "") if ref is not None else "",
+                                         int(oc.findtext("run_address", "0"), 0), int(oc.findtext("size", "0"), 0))
+    sections = []
+    for group in root.iter("logical_group"):
+        if group.find("contents/logical_group_ref") is not None:
+            continue                            # a group of output sections (DATA_GROUP) - they are listed themselves
+        inputs = [components[r.get("idref")] for r in group.iter("object_component_ref") if r.get("idref") in components]
+        sections.append(Section(group.findtext("name", ""), int(group.findtext("run_address", "0"), 0),
+                                int(group.findtext("size", "0"), 0), inputs))
+    regions = {}
+    for area in root.iter("memory_area"):
+        regions[area.findtext("name", "")] = (int(area.findtext("origin", "0"), 0), int(area.findtext("length", "0"), 0),
+                                              int(area.findtext("used_space", "0"), 0))
+    symbols = {s.findtext("name", ""): int(s.findtext("value", "0"), 0) for s in root.iter("symbol")}
+    return regions, sections, symbols
+
+
+def find_link_output(path):
+    if not os.path.isdir(path):
+        return path
+    found = glob.glob(os.path.join(path, "*_linkInfo.xml")) or glob.glob(os.path.join(path, "*.map"))
+    if not found:
+        sys.exit("%s: no .map or _linkInfo.xml" % path)
+    return found[0]
+
+
+def static_task_stacks(sections, symbols):
+    """{Task instance index: size} of the empty.cfg Tasks, from their stack symbols."""
+    starts = sorted((addr, int(m.group(1))) for name, addr in symbols.items() for m in [TASK_STACK_SYMBOL.match(name)] if m)
+    if not starts:
+        return {}
+    end = max(i.origin + i.size for s in sections for i in s.inputs if i.name.endswith("taskStackSection")) \
+        if any(i.name.endswith("taskStackSection") for s in sections for i in s.inputs) else starts[-1][0]
+    bounds = [addr for addr, _ in starts[1:]] + [end]
+    return {index: bound - addr for (addr, index), bound in zip(starts, bounds)}
+
+
+def read_watermarks(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a stack profile header" % path)
+    magic, samples, count, _ = HEADER.unpack_from(data, 0)
+    if magic != b"STKP":
+        sys.exit("%s: not a stack profile (magic %r)" % (path, magic))
+    if len(data) < HEADER.size + count * ENTRY.size:
+        sys.exit("%s: truncated - %d entries expected" % (path, count))
+    entries = [ENTRY.unpack_from(data, HEADER.size + i * ENTRY.size) for i in range(count)]
+    return samples, entries
+
+
+def stack_name(kind, role, ident, priority):
+    if kind != 0:
+        return KINDS.get(kind, "kind%d" % kind)
+    if role in ROLES:
+        return "%s %d" % (ROLES[role], ident)
+    return PRIORITIES.get(priority, "pri %d" % priority)
+
+
+def setting(name):
+    return SETTINGS["worker"] if name.split()[0] in ROLES.values() else SETTINGS.get(name, "-")
+
+
+def recommend(peak, margin, guard, align):
+    size = max(peak + peak * margin // 100, peak + guard)
+    return (size + align - 1) // align * align
+
+
+def ram_report(regions, sections, stacks, top, out):
+    ram = regions.get("RAM")
+    if ram is None:
+        sys.exit("no RAM region in the linker output")
+    origin, length, used = ram
+    out.write("RAM %#06x-%#06x: %d bytes, %d used, %d free\n\n" % (origin, origin + length, length, used, length - used))
+    in_ram = [s for s in sections if origin <= s.origin < origin + length and s.size > 0]
+    out.write("%-56s %8s %6s\n" % ("section", "bytes", "RAM%"))
+    for s in sorted(in_ram, key=lambda s: -s.size):
+        out.write("%-56s %8d %5.1f%%\n" % (s.name, s.size, 100.0 * s.size / length))
+        inputs = sorted((i for i in s.inputs if i.size > 0), key=lambda i: -i.size)
+        for i in inputs[:top]:
+            label = i.name if not i.obj else "%s (%s)" % (i.name, i.obj)
+            mark = "  <- stacks" if STACK_SECTIONS.search(i.name.split(":")[-1]) else ""
+            out.write("  %-54s %8d %5.1f%%%s\n" % (label[:54], i.size, 100.0 * i.size / length, mark))
+        if len(inputs) > top:
+            rest = sum(i.size for i in inputs[top:])
+            out.write("  %-54s %8d %5.1f%%\n" % ("(%d more)" % (len(inputs) - top), rest, 100.0 * rest / length))
+    if stacks:
+        out.write("\nstatic Task stacks (empty.cfg): %s\n" % ", ".join("#%d %d" % item for item in sorted(stacks.items())))
+    return length - used
+
+
+def stack_report(samples, entries, args, free, out):
+    out.write("\nstack high-water marks (%d samples)\n" % samples)
+    out.write("%-14s %6s %6s %5s %6s %7s  %s\n" % ("stack", "size", "peak", "use%", "recomm", "saving", "setting"))
+    saved = 0
+    workers = []
+    for size, peak, kind, role, ident, priority in entries:
+        name = stack_name(kind, role, ident, priority)
+        if size == 0 or peak == 0:
+            out.write("%-14s %6s %6s %5s %6s %7s  %s\n" % (name, size or "-", "-", "-", "-", "-", setting(name)))
+            continue
+        rec = recommend(peak, args.margin, args.guard, args.align)
+        flag = "  OVERFLOW RISK" if peak >= size else ""
+        out.write("%-14s %6d %6d %4.0f%% %6d %7d  %s%s\n" % (name, size, peak, 100.0 * peak / size, rec, size - rec,
+                                                           setting(name), flag))
+        if role in ROLES:
+            workers.append((size, rec))
+        else:
+            saved += size - rec
+    if workers:
+        worker_rec = max(rec for _, rec in workers)     # one WORKER_STACK_SIZE for all of them
+        saved += sum(size for size, _ in workers) - len(workers) * worker_rec
+        out.write("\nWORKER_STACK_SIZE=%d TOPOLOGY_STACK_POOL_SIZE=%d (the largest worker recommendation, %d workers)\n"
+                  % (worker_rec, len(workers) * worker_rec, len(workers)))
+    out.write("frees %d bytes of RAM - %d more buffer slots at %d bytes each, %d bytes free after\n"
+              % (saved, max(saved, 0) // args.slot_bytes, args.slot_bytes, free + saved))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("link", help="the .map or _linkInfo.xml, or the Debug/ directory holding them")
+    parser.add_argument("--watermarks", help="stackProfStats dump (stackprof.h)")
+    parser.add_argument("--margin", type=int, default=25, help="headroom above the peak, percent")
+    parser.add_argument("--guard", type=int, default=64, help="least headroom above the peak, bytes")
+    parser.add_argument("--align", type=int, default=16, help="recommended sizes are multiples of this")
+    parser.add_argument("--slot-bytes", type=int, default=24, help="RAM of one more buffer slot")
+    parser.add_argument("--top", type=int, default=8, help="input sections listed per output section")
+    args = parser.parse_args()
+
+    path = find_link_output(args.link)
+    regions, sections, symbols = (parse_link_info if path.endswith(".xml") else parse_map)(path)
+    out = sys.stdout
+    out.write("%s\n" % path)
+    free = ram_report(regions, sections, static_task_stacks(sections, symbols), args.top, out)
+    if args.watermarks:
+        samples, entries = read_watermarks(args.watermarks)
+        stack_report(samples, entries, args, free, out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Throughput/latency sweep of the producer/consumer topology on the host build.
+
+Builds pc_bench once per (producers N, consumers M, buffer size) point - the topology and the
+buffer size are compile-time settings of main.c - runs it, and collects the items/s throughput,
+the mean buffer residence time (Little's law, from the report's "latency:" line), the p99
+item latency (latency.h, the "latency all:" line), the worst producer's p99 time in insert_item
+(the "latency insert" lines) and the items lost to the backpressure policy (bounded_buffer.h,
+drops + timeouts + overwrites of the "backpressure" lines). items/s counts the items insert_item
+accepted, so with overwrites it includes the items overwritten later.
+
+  host/tools/sweep.py --producers 1,2,4 --consumers 1,2,4 --sizes 4,8,16 --csv sweep.csv
+
+--axis adds any other compile-time setting as a sweep dimension, e.g. the time-slice quantum
+and policy (timeslice.h):
+
+  host/tools/sweep.py --producers 2 --consumers 2 --sizes 16 \
+      --axis TIMESLICE_QUANTUM=1,2,4,8 --axis TIMESLICE_POLICY=0,1,2
+
+or the backpressure policies under a consumer that stalls 20 ticks every 64 items:
+
+  host/tools/sweep.py --producers 2 --consumers 1 --sizes 16 --engine 2 \
+      --define CONSUMER_STALL_EVERY=64 --axis BACKPRESSURE_POLICY=0,1,2,3,4
+
+--sim runs the discrete-event simulator (host/src/pc_sim.c) instead of building pc_bench for
+every point - the settings become its NAME=value arguments and --run-msec is simulated time, so
+a sweep takes seconds:
+
+  host/tools/sweep.py --sim --producers 2 --consumers 1,2,3 --sizes 4,8,16,32 \
+      --define ARRIVAL_RATE=800 --axis TIMESLICE_QUANTUM=1,2,4
+
+Buffer sizes must be powers of two (bounded_buffer.h), and the SPSC engine (--engine 1) needs
+one producer and one consumer - points that don't fit are skipped.
+"""
+
+import argparse
+import csv
+import itertools
+import os
+import re
+import subprocess
+import sys
+
+HOST_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WORKER_STACK_SIZE = 700     # main.c default, sizes the topology's stack pool
+
+THROUGHPUT_RE = re.compile(r"^throughput: (\d+) items/s", re.M)
+LATENCY_RE = re.compile(r"^latency: ([\d.]+) us", re.M)
+P99_RE = re.compile(r"^latency all: .* p99 <= (\d+) ", re.M)
+INSERT_P99_RE = re.compile(r"^latency insert \d+: .* p99 <= (\d+) ", re.M)
+LOST_RE = re.compile(r"^backpressure \d+: .* drops (\d+) timeouts (\d+) overwrites (\d+)", re.M)
+
+
+def int_list(text):
+    return [int(v) for v in text.split(",") if v]
+
+
+def axis(text):
+    name, _, values = text.partition("=")
+    if not name or not values:
+        raise argparse.ArgumentTypeError("expected NAME=v1,v2,...")
+    return name, int_list(values)
+
+
+def fits(engine, producers, consumers, size):
+    if size <= 0 or size & (size - 1):
+        return False
+    if engine == 1 and (producers != 1 or consumers != 1):
+        return False
+    return True
+
+
+def build_sim(args):
+    build = os.path.join(args.build_root, "sim")
+    subprocess.run(["cmake", "-S", HOST_DIR, "-B", build], check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(["cmake", "--build", build, "--target", "pc_sim"], check=True, stdout=subprocess.DEVNULL)
+    return os.path.join(build, "pc_sim")
+
+
+def run_sim(args, producers, consumers, size, extra):
+    settings = [
+        "QUEUE_ENGINE=%d" % args.engine,
+        "NUM_PRODUCERS=%d" % producers,
+        "NUM_CONSUMERS=%d" % consumers,
+        "BUFFER_SIZE=%d" % size,
+        "RUN_MSEC=%d" % args.run_msec,
+    ]
+    settings += ["%s=%d" % item for item in extra]
+    settings += args.define
+    return subprocess.run([args.sim] + settings, check=True, stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout
+
+
+def parse_report(out):
+    throughput = THROUGHPUT_RE.search(out)
+    latency = LATENCY_RE.search(out)
+    p99 = P99_RE.search(out)
+    insert_p99 = max([int(v) for v in INSERT_P99_RE.findall(out)] or [0])
+    lost = sum(int(v) for counts in LOST_RE.findall(out) for v in counts)
+    return (int(throughput.group(1)) if throughput else 0,
+            float(latency.group(1)) if latency else 0.0,
+            int(p99.group(1)) if p99 else 0, insert_p99, lost)
+
+
+def run_point(args, producers, consumers, size, extra):
+    if args.sim:
+        return parse_report(run_sim(args, producers, consumers, size, extra))
+    defines = [
+        "QUEUE_ENGINE=%d" % args.engine,
+        "NUM_PRODUCERS=%d" % producers,
+        "NUM_CONSUMERS=%d" % consumers,
+        "BUFFER_SIZE=%d" % size,
+        "TOPOLOGY_MAX_TASKS=%d" % (producers + consumers),
+        "TOPOLOGY_STACK_POOL_SIZE=%d" % ((producers + consumers) * WORKER_STACK_SIZE),
+        "BB_POOL_SIZE=%d" % (size * 24),  # an MPMC cell plus a latency tag per slot
+    ]
+    defines += ["%s=%d" % item for item in extra]
+    defines += args.define
+
+    build = os.path.join(args.build_root, "n%d_m%d_b%d" % (producers, consumers, size)
+                         + "".join("_%s%d" % (name.lower(), v) for name, v in extra))
+    subprocess.run(["cmake", "-S", HOST_DIR, "-B", build, "-DPC_DEFINES=" + ";".join(defines)],
+                   check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(["cmake", "--build", build], check=True, stdout=subprocess.DEVNULL)
+
+    env = dict(os.environ, PC_RUN_MSEC=str(args.run_msec))
+    out = subprocess.run([os.path.join(build, "pc_bench")], check=True, env=env,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    return parse_report(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--producers", type=int_list, default=[1, 2, 4])
+    parser.add_argument("--consumers", type=int_list, default=[1, 2, 4])
+    parser.add_argument("--sizes", type=int_list, default=[4, 8, 16, 32])
+    parser.add_argument("--engine", type=int, default=0, help="QUEUE_ENGINE (0 locked, 1 SPSC, 2 MPMC)")
+    parser.add_argument("--run-msec", type=int, default=1000, help="run length of every point")
+    parser.add_argument("--axis", type=axis, action="append", default=[],
+                        help="extra sweep dimension NAME=v1,v2,... (a compile definition)")
+    parser.add_argument("--define", action="append", default=[], help="extra compile definition")
+    parser.add_argument("--build-root", default="_sweep", help="build directories of the points")
+    parser.add_argument("--csv", help="write the results to this file")
+    parser.add_argument("--sim", action="store_true", help="run the simulator pc_sim instead of pc_bench")
+    args = parser.parse_args()
+    if args.sim:
+        args.sim = build_sim(args)
+
+    names = [name for name, _ in args.axis]
+    results = []
+    print("%4s %4s %6s" % ("N", "M", "size") + "".join(" %8s" % n.split("_")[-1][:8] for n in names)
+          + " %12s %12s %10s %10s %8s" % ("items/s", "latency_us", "p99_us", "ins_p99", "lost"))
+    for producers in args.producers:
+        for consumers in args.consumers:
+            for size in args.sizes:
+                if not fits(args.engine, producers, consumers, size):
+                    continue
+                for values in itertools.product(*[v for _, v in args.axis]):
+                    extra = list(zip(names, values))
+                    measured = run_point(args, producers, consumers, size, extra)
+                    results.append((producers, consumers, size) + values + measured)
+                    print("%4d %4d %6d" % (producers, consumers, size) + "".join(" %8d" % v for v in values)
+                          + " %12d %12.1f %10d %10d %8d" % measured)
+                    sys.stdout.flush()
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["producers", "consumers", "size"] + names + ["items_per_s", "latency_us", "p99_us",
+                                                                       "insert_p99_us", "lost"])
+            writer.writerows(results)
+
+    if results:
+        best = max(results, key=lambda r: (r[-5], -r[-4]))
+        print("best: N=%d M=%d size=%d" % best[:3]
+              + "".join(" %s=%d" % item for item in zip(names, best[3:-5]))
+              + " - %d items/s, %.1f us, p99 %d us" % best[-5:-2])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Decode a binary event trace dump (trace.h) into a readable timeline and summary counts.
+
+The dump is a 16 byte header ("PCTRACE1", Timestamp frequency, ring size) followed by 8-byte
+little endian events: event id (u8), task (u8: role << 6 | id), item (i16), tick (u32).
+
+The target's traceDump (trace.h), saved from the CCS memory browser, is the same format with
+a tail of empty events, which are skipped.
+
+  PC_TRACE=trace.bin ./build/pc_bench
+  host/tools/trace_decode.py trace.bin --limit 40
+  host/tools/trace_decode.py trace.bin --summary
+"""
+
+import argparse
+import collections
+import struct
+import sys
+
+HEADER = struct.Struct("<8sII")
+EVENT = struct.Struct("<BBhI")
+
+# TraceEventId_E in trace.h
+EVENTS = {
+    1: "insert",
+    2: "remove",
+    3: "insert_batch",
+    4: "remove_batch",
+    5: "drop",
+    6: "spool",
+    7: "unspool",
+}
+BATCH_EVENTS = (3, 4)
+
+# TopologyRole_E in topology.h
+ROLES = {0: "task", 1: "producer", 2: "consumer", 3: "stage"}
+
+
+def task_name(task):
+    role, ident = task >> 6, task & 0x3F
+    if role == 0 and ident == 0:
+        return "other"
+    return "%s %d" % (ROLES.get(role, "role%d" % role), ident)
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a trace header" % path)
+    magic, freq, ring_size = HEADER.unpack_from(data, 0)
+    if magic != b"PCTRACE1":
+        sys.exit("%s: not a trace dump (magic %r)" % (path, magic))
+    body = data[HEADER.size:]
+    usable = len(body) - len(body) % EVENT.size
+    events = [EVENT.unpack_from(body, off) for off in range(0, usable, EVENT.size)]
+    return freq or 1, ring_size, [e for e in events if e[0] != 0]  # 0 - traceNone_e, a dump's unused tail
+
+
+def unwrap(events):
+    """Yields (event, task, item, tick) with the 32 bit tick made monotonic across wraps."""
+    base, last = 0, None
+    for event, task, item, tick in events:
+        if last is not None and tick < last and last - tick > 0x80000000:
+            base += 1 << 32
+        last = tick
+        yield event, task, item, base + tick
+
+
+def timeline(freq, events, limit, out):
+    start = None
+    previous = None
+    for count, (event, task, item, tick) in enumerate(unwrap(events)):
+        if limit and count >= limit:
+            break
+        start = tick if start is None else start
+        delta = 0 if previous is None else tick - previous
+        previous = tick
+        what = "items" if event in BATCH_EVENTS else "item"
+        out.write("%12.1f us  +%8.1f  %-12s %-13s %s %d\n" % (
+            (tick - start) * 1e6 / freq, delta * 1e6 / freq, task_name(task),
+            EVENTS.get(event, "event%d" % event), what, item))
+
+
+def summary(freq, ring_size, events, out):
+    per_event = collections.Counter()
+    per_task = collections.Counter()
+    items = collections.Counter()
+    ticks = []
+    for event, task, item, tick in unwrap(events):
+        per_event[event] += 1
+        per_task[(task, event)] += 1
+        items[event] += item if event in BATCH_EVENTS else 1
+        ticks.append(tick)
+
+    span = (ticks[-1] - ticks[0]) / freq if len(ticks) > 1 else 0.0
+    out.write("events: %d over %.3f s (ring %d events, %d Hz timestamp)\n" % (len(events), span, ring_size, freq))
+    for event in sorted(per_event):
+        rate = items[event] / span if span > 0 else 0.0
+        out.write("  %-13s %10d events %10d items %12.0f items/s\n" % (
+            EVENTS.get(event, "event%d" % event), per_event[event], items[event], rate))
+    out.write("per task:\n")
+    for (task, event), n in sorted(per_task.items()):
+        out.write("  %-12s %-13s %10d\n" % (task_name(task), EVENTS.get(event, "event%d" % event), n))
+    gaps = [b - a for a, b in zip(ticks, ticks[1:])]
+    if gaps:
+        gaps.sort()
+        out.write("gap between events: median %.1f us, p99 %.1f us, max %.1f us\n" % (
+            gaps[len(gaps) // 2] * 1e6 / freq, gaps[min(len(gaps) - 1, len(gaps) * 99 // 100)] * 1e6 / freq,
+            gaps[-1] * 1e6 / freq))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("dump", help="trace dump written by a trace sink (PC_TRACE on the host)")
+    parser.add_argument("--limit", type=int, default=0, help="timeline events to print (0 - all)")
+    parser.add_argument("--summary", action="store_true", help="print only the summary counts")
+    args = parser.parse_args()
+
+    freq, ring_size, events = read_trace(args.dump)
+    try:
+        if not args.summary:
+            timeline(freq, events, args.limit, sys.stdout)
+            sys.stdout.write("\n")
+        summary(freq, ring_size, events, sys.stdout)
+    except BrokenPipeError:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,131 @@
+/*
+ * inversion.c
+ *
+ * Priority inversion scenario - see inversion.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "inversion.h"
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The scenario's measurements, see InversionStats_T.
+ */
+InversionStats_T inversionStats;
+
+#if INVERSION_SCENARIO
+static Task_Struct hogTaskObj;
+static Task_Struct probeTaskObj;
+static UInt32 hogStack[INVERSION_STACK_SIZE / sizeof(UInt32)];
+static UInt32 probeStack[INVERSION_STACK_SIZE / sizeof(UInt32)];
+static UInt32 hogCounts;			// INVERSION_HOG_USEC in Timestamp ticks
+
+
+/*
+ * Function: hogTaskHandler
+ * Description: the medium priority Task - CPU bursts that have nothing to do with the buffer.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: sleep INVERSION_HOG_TICKS, then spin on Timestamp for hogCounts. The spin yields
+ * 			  on every round: without another Task of its priority that gives nothing away on
+ * 			  the target, but it is a scheduling point for the host build, whose Tasks are
+ * 			  preempted at kernel calls only - so the probe still wakes up during a burst.
+*/
+static Void hogTaskHandler(UArg arg0, UArg arg1)
+{
+	UInt32 start;
+
+	(Void)arg0;
+	(Void)arg1;
+	while(1) {
+		Task_sleep(INVERSION_HOG_TICKS);
+		start = Timestamp_get32();
+		while(Timestamp_get32() - start < hogCounts) {
+			Task_yield();
+		}
+		inversionStats.bursts = inversionStats.bursts + 1;
+	}
+}
+
+/*
+ * Function: probeTaskHandler
+ * Description: the high priority Task - times its wait for the buffer's mutex.
+ * Input: UArg arg0 - the BoundedBuffer_Handle, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: sleep INVERSION_PROBE_TICKS, then Timestamp around BoundedBuffer_lock; the critical
+ * 			  section itself only reads count. The wait goes into the block histogram.
+*/
+static Void probeTaskHandler(UArg arg0, UArg arg1)
+{
+	BoundedBuffer_Handle bb = (BoundedBuffer_Handle)arg0;
+	volatile Int count;
+	UInt32 start, waited;
+	IArg key;
+
+	(Void)arg1;
+	while(1) {
+		Task_sleep(INVERSION_PROBE_TICKS);
+		start = Timestamp_get32();
+		key = BoundedBuffer_lock(bb);
+		waited = Timestamp_get32() - start;
+		count = bb->count;
+		BoundedBuffer_unlock(bb, key);
+		(Void)count;
+		Latency_histAdd(&inversionStats.block, waited);
+		inversionStats.probes = inversionStats.probes + 1;
+	}
+}
+
+static Task_Handle construct(Task_Struct *obj, CString name, Task_FuncPtr fxn, Int priority,
+		UInt32 *stack, SizeT stackSize, UArg arg0)
+{
+	Task_Params taskParams;
+
+	Task_Params_init(&taskParams);
+	taskParams.instance->name = name;
+	taskParams.priority = priority;
+	taskParams.stack = (Ptr)stack;
+	taskParams.stackSize = stackSize;
+	taskParams.arg0 = arg0;
+	Task_construct(obj, fxn, &taskParams, NULL);
+	return Task_handle(obj);
+}
+#endif
+
+/*
+ * Function: Inversion_start
+ * Description: set up the priority inversion scenario.
+ * Input: BoundedBuffer_Handle bb - the probed buffer, Task_Handle *hog, Task_Handle *probe -
+ * 		  receive the Tasks.
+ * Output: void
+ * Algorithm: clear the statistics, convert the burst length to Timestamp ticks once, and
+ * 			  Task_construct both Tasks from their static objects and stacks.
+*/
+Void Inversion_start(BoundedBuffer_Handle bb, Task_Handle *hog, Task_Handle *probe)
+{
+	Types_FreqHz freq;
+
+	Timestamp_getFreq(&freq);
+	inversionStats.freq = freq.lo;
+	inversionStats.probes = 0;
+	inversionStats.bursts = 0;
+	Latency_histReset(&inversionStats.block);
+	*hog = NULL;
+	*probe = NULL;
+#if INVERSION_SCENARIO
+	hogCounts = (UInt32)((UInt64)freq.lo * INVERSION_HOG_USEC / 1000000);
+	*hog = construct(&hogTaskObj, "hog", hogTaskHandler, INVERSION_HOG_PRIORITY,
+			hogStack, sizeof(hogStack), 0);
+	*probe = construct(&probeTaskObj, "probe", probeTaskHandler, INVERSION_PROBE_PRIORITY,
+			probeStack, sizeof(probeStack), (UArg)bb);
+#else
+	(Void)bb;
+#endif
+}
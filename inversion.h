@@ -0,0 +1,85 @@
+/*
+ * inversion.h
+ *
+ * Priority inversion scenario - the worst-case time a high priority Task waits for a buffer's
+ * mutex while low priority workers use it and medium priority work competes for the CPU.
+ *
+ * Three priority levels:
+ *
+ *  - low: the producers and consumers (WORKER_PRIORITY), entering the buffer's critical section
+ *    for every item;
+ *  - medium: the hog Task (INVERSION_HOG_PRIORITY), which wakes every INVERSION_HOG_TICKS and
+ *    keeps the CPU busy for INVERSION_HOG_USEC - unrelated work, e.g. a filter running on a block
+ *    of samples;
+ *  - high: the probe Task (INVERSION_PROBE_PRIORITY), which wakes every INVERSION_PROBE_TICKS
+ *    and enters the same critical section (BoundedBuffer_lock), timing how long it waited.
+ *
+ * When the hog wakes up while a worker holds the mutex, the worker is preempted inside its
+ * critical section. With the binary semaphore mutex (BB_MUTEX_PI 0) a probe arriving meanwhile
+ * waits for the rest of the hog's burst, although the hog never touches the buffer. With the
+ * GateMutexPri (BB_MUTEX_PI 1) the worker inherits the probe's priority, finishes its critical
+ * section ahead of the hog, and the probe waits for a critical section at most. inversionStats
+ * holds the probe's blocking time histogram (Timestamp ticks, like latency.h); build the
+ * scenario with both BB_MUTEX_PI values to compare the worst cases.
+ *
+ * The Tasks use static objects and stacks. INVERSION_SCENARIO 0 (the default) leaves them out.
+ */
+
+#ifndef INVERSION_H_
+#define INVERSION_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "bounded_buffer.h"
+#include "latency.h"
+
+#ifndef INVERSION_SCENARIO
+#define INVERSION_SCENARIO			0		//1 - run the hog and probe Tasks against pipeline 0's mutex, 0 - no scenario
+#endif
+#ifndef INVERSION_HOG_PRIORITY
+#define INVERSION_HOG_PRIORITY		2		//Medium - above the workers, below the probe
+#endif
+#ifndef INVERSION_PROBE_PRIORITY
+#define INVERSION_PROBE_PRIORITY	4		//High - above every other Task
+#endif
+#ifndef INVERSION_HOG_TICKS
+#define INVERSION_HOG_TICKS			10		//Clock ticks the hog sleeps between two bursts
+#endif
+#ifndef INVERSION_HOG_USEC
+#define INVERSION_HOG_USEC			3000	//Length of a hog burst
+#endif
+#ifndef INVERSION_PROBE_TICKS
+#define INVERSION_PROBE_TICKS		7		//Clock ticks the probe sleeps between two probes
+#endif
+#define INVERSION_STACK_SIZE		256		//Bytes of the static stack of each Task
+
+
+/*
+ Structure InversionStats_T - the scenario's measurements, readable in RAM (inversionStats).
+ */
+typedef struct
+{
+	UInt32 freq;				// Timestamp ticks per second
+	UInt32 probes;				// critical sections entered by the probe
+	UInt32 bursts;				// hog bursts run
+	LatencyHist_T block;		// the probe's wait for the mutex, Timestamp ticks
+} InversionStats_T;
+
+extern InversionStats_T inversionStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Inversion_start(BoundedBuffer_Handle bb, Task_Handle *hog, Task_Handle *probe)
+
+ Clears inversionStats and constructs the hog and probe Tasks, the probe working on bb (a locked
+ engine buffer). Their handles are returned in *hog and *probe (NULL without INVERSION_SCENARIO).
+ Called from main before BIOS_start.
+ */
+Void Inversion_start(BoundedBuffer_Handle bb, Task_Handle *hog, Task_Handle *probe);
+
+#endif /* INVERSION_H_ */
@@ -0,0 +1,246 @@
+/*
+ * latency.c
+ *
+ * Per-item end-to-end latency tracing - see latency.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <string.h>						//for memset in Latency_init
+
+#include "latency.h"
+#include "topology.h"
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ Latency statistics, see LatencyStats_T.
+ */
+LatencyStats_T latencyStats;
+
+#define LATENCY_ISR_SEQ	(LATENCY_MAX_IDS + 1)	//nextSeq/lastSeq entry of LATENCY_ISR_SOURCE
+
+/*
+ Next sequence number of every producer id (written by that producer only) and the last one
+ seen by the consumers (written with interrupts masked).
+ */
+static UInt16 nextSeq[LATENCY_ISR_SEQ + 1];
+static UInt16 lastSeq[LATENCY_ISR_SEQ + 1];
+
+
+/*
+ * Function: Latency_init
+ * Description: clear the statistics and the sequence numbers.
+ * Input: void
+ * Output: void
+ * Algorithm: every histogram empty (min starts at the largest value), freq from Timestamp.
+*/
+Void Latency_init(void)
+{
+	Types_FreqHz freq;
+	Int i = 0;
+
+	memset(&latencyStats, 0, sizeof(latencyStats));
+	latencyStats.all.min = ~(UInt32)0;
+	for(i = 0 ; i < LATENCY_MAX_IDS ; i++) {
+		latencyStats.producer[i].min = ~(UInt32)0;
+		latencyStats.consumer[i].min = ~(UInt32)0;
+		latencyStats.insert[i].min = ~(UInt32)0;
+	}
+	for(i = 0 ; i < LATENCY_MAX_LANES ; i++) {
+		latencyStats.lane[i].min = ~(UInt32)0;
+	}
+	latencyStats.isr.min = ~(UInt32)0;
+	for(i = 0 ; i <= LATENCY_ISR_SEQ ; i++) {
+		nextSeq[i] = 0;
+		lastSeq[i] = (UInt16)-1;
+	}
+	Timestamp_getFreq(&freq);
+	latencyStats.freq = freq.lo;
+}
+
+/*
+ * Function: Latency_stamp
+ * Description: stamp an item being inserted.
+ * Input: RingTag_T *tag - receives the stamp, Int lane - the item's priority lane.
+ * Output: void
+ * Algorithm: the producer id comes from the calling Task's topology env; only that producer
+ * 			  touches its nextSeq entry, so no locking is needed.
+*/
+Void Latency_stamp(RingTag_T *tag, Int lane)
+{
+	Int id = Topology_workerId(Task_self());
+
+	tag->stamp = Timestamp_get32();
+	tag->source = (UInt8)id;
+	tag->lane = (UInt8)lane;
+	if(id > LATENCY_MAX_IDS) {
+		id = 0;							// untracked ids share entry 0
+	}
+	tag->seq = nextSeq[id];
+	nextSeq[id] = nextSeq[id] + 1;
+}
+
+Void Latency_stampIsr(RingTag_T *tag, Int lane)
+{
+	tag->stamp = Timestamp_get32();
+	tag->source = LATENCY_ISR_SOURCE;
+	tag->lane = (UInt8)lane;
+	tag->seq = nextSeq[LATENCY_ISR_SEQ];
+	nextSeq[LATENCY_ISR_SEQ] = nextSeq[LATENCY_ISR_SEQ] + 1;
+}
+
+/*
+ * Function: histAdd
+ * Description: add one latency to a histogram.
+ * Input: LatencyHist_T *hist, UInt32 ticks - the latency, Int bin - its bin.
+ * Output: void
+ * Algorithm: called with interrupts masked - a handful of additions and compares.
+*/
+static Void histAdd(LatencyHist_T *hist, UInt32 ticks, Int bin)
+{
+	hist->count = hist->count + 1;
+	hist->sum = hist->sum + ticks;
+	if(ticks < hist->min) {
+		hist->min = ticks;
+	}
+	if(ticks > hist->max) {
+		hist->max = ticks;
+	}
+	hist->bins[bin] = hist->bins[bin] + 1;
+}
+
+/*
+ * Function: binOf
+ * Description: histogram bin of a latency.
+ * Input: UInt32 ticks.
+ * Output: Int - the position of the highest set bit, 0 for 0 and 1.
+ * Algorithm: shift until nothing is left, at most LATENCY_BINS - 1 times.
+*/
+static Int binOf(UInt32 ticks)
+{
+	Int bin = 0;
+	UInt32 v = ticks >> 1;
+
+	while(v != 0 && bin < LATENCY_BINS - 1) {
+		v = v >> 1;
+		bin = bin + 1;
+	}
+	return bin;
+}
+
+/*
+ * Function: Latency_record
+ * Description: record the residency of an item just removed.
+ * Input: const RingTag_T *tag - the item's stamp.
+ * Output: void
+ * Algorithm: latency = now - stamp (unsigned, so the 32 bit Timestamp wrap is harmless), its bin
+ * 			  is the position of the highest set bit - both computed before masking interrupts;
+ * 			  the four histograms and the sequence check are then updated in one short
+ * 			  Hwi_disable window, as several consumers may record at once.
+*/
+Void Latency_record(const RingTag_T *tag)
+{
+	UInt32 ticks = Timestamp_get32() - tag->stamp;
+	Int consumer = Topology_workerId(Task_self());
+	Int producer = tag->source;
+	Int bin = binOf(ticks);
+	UInt key;
+
+	key = Hwi_disable();
+	histAdd(&latencyStats.all, ticks, bin);
+	if(producer >= 1 && producer <= LATENCY_MAX_IDS) {
+		histAdd(&latencyStats.producer[producer - 1], ticks, bin);
+	} else if(producer == LATENCY_ISR_SOURCE) {
+		histAdd(&latencyStats.isr, ticks, bin);
+		producer = LATENCY_ISR_SEQ;
+	} else {
+		producer = 0;
+	}
+	if(consumer >= 1 && consumer <= LATENCY_MAX_IDS) {
+		histAdd(&latencyStats.consumer[consumer - 1], ticks, bin);
+	}
+	if(tag->lane < LATENCY_MAX_LANES) {
+		histAdd(&latencyStats.lane[tag->lane], ticks, bin);
+	}
+	if(tag->seq != (UInt16)(lastSeq[producer] + 1)) {
+		latencyStats.reordered = latencyStats.reordered + 1;
+	}
+	lastSeq[producer] = tag->seq;
+	Hwi_restore(key);
+}
+
+UInt32 Latency_now(void)
+{
+	return Timestamp_get32();
+}
+
+/*
+ * Function: Latency_recordInsert
+ * Description: record how long the calling producer spent in insert_item.
+ * Input: UInt32 start - Latency_now() before the call.
+ * Output: void
+ * Algorithm: as Latency_record, into the producer's insert histogram only.
+*/
+Void Latency_recordInsert(UInt32 start)
+{
+	UInt32 ticks = Timestamp_get32() - start;
+	Int producer = Topology_workerId(Task_self());
+	Int bin = binOf(ticks);
+	UInt key;
+
+	if(producer < 1 || producer > LATENCY_MAX_IDS) {
+		return;
+	}
+	key = Hwi_disable();
+	histAdd(&latencyStats.insert[producer - 1], ticks, bin);
+	Hwi_restore(key);
+}
+
+Void Latency_histReset(LatencyHist_T *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+	hist->min = ~(UInt32)0;
+}
+
+Void Latency_histAdd(LatencyHist_T *hist, UInt32 ticks)
+{
+	Int bin = binOf(ticks);
+	UInt key;
+
+	key = Hwi_disable();
+	histAdd(hist, ticks, bin);
+	Hwi_restore(key);
+}
+
+/*
+ * Function: Latency_percentile
+ * Description: percentile of a histogram, to bin resolution.
+ * Input: const LatencyHist_T *hist, Int percent - 1..100.
+ * Output: UInt32 - upper bound of the percentile's bin in ticks (at most hist->max).
+ * Algorithm: walk the bins until their running count reaches percent% of all samples.
+*/
+UInt32 Latency_percentile(const LatencyHist_T *hist, Int percent)
+{
+	UInt32 target = (UInt32)(((UInt64)hist->count * percent + 99) / 100);
+	UInt32 seen = 0;
+	UInt32 bound = 0;
+	Int bin = 0;
+
+	if(hist->count == 0) {
+		return 0;
+	}
+	for(bin = 0 ; bin < LATENCY_BINS ; bin++) {
+		seen = seen + hist->bins[bin];
+		if(seen >= target) {
+			break;
+		}
+	}
+	bound = (bin >= 31) ? ~(UInt32)0 : (((UInt32)2 << bin) - 1);
+	return (bound < hist->max) ? bound : hist->max;
+}
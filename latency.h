@@ -0,0 +1,165 @@
+/*
+ * latency.h
+ *
+ * Per-item end-to-end latency tracing - how long an item sits in a bounded buffer.
+ *
+ * insert_item stamps every item with a RingTag_T (see ring.h): the Timestamp_get32() value at
+ * insertion, the producer id and the producer's sequence number of the item. The tag travels
+ * with the item in the buffer (a parallel tag array - the items themselves are unchanged), and
+ * remove_item hands it to Latency_record, which adds the queue residency (now - stamp) to:
+ *
+ *  - the histogram of the producer that inserted the item;
+ *  - the histogram of the consumer that removed it;
+ *  - the histogram of its priority lane (bounded_buffer.h - urgent items overtaking routine ones);
+ *  - the histogram of all items.
+ *
+ * A histogram (LatencyHist_T) keeps count/min/max/sum and LATENCY_BINS power-of-two bins, so
+ * min/avg/max are exact and percentiles (p99) are known to within a factor of two - enough to
+ * tell a tail caused by a Clock tick (timeSharingClk time slicing, 500 usec) from one caused by
+ * ledSrvTask preemption. Everything is in the fixed RAM structure latencyStats, in Timestamp
+ * ticks (latencyStats.freq per second), readable from ROV/the memory browser on the target and
+ * printed by the host build's run report.
+ *
+ * The producers' side is traced too: LATENCY_INSERT_BEGIN/END around an insert_item call add
+ * the time the producer spent in it - its wait for a slot under the buffer's backpressure
+ * policy (bounded_buffer.h) - to the histogram of that producer's insert cycle.
+ *
+ * Items inserted from an interrupt (try_insert_item, main.c) have no producer Task: the ISR
+ * stamps them with Latency_stampIsr - source LATENCY_ISR_SOURCE, their own sequence numbers and
+ * their own "isr" histogram.
+ *
+ * Ids above LATENCY_MAX_IDS are only counted in the "all" histogram. LATENCY_TRACE 0 compiles
+ * the stamping and recording out.
+ */
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <xdc/std.h>
+#include "ring.h"
+
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE		1		//1 - stamp and record every item, 0 - no latency tracing
+#endif
+#ifndef LATENCY_MAX_IDS
+#define LATENCY_MAX_IDS		4		//Producer/consumer ids (1..LATENCY_MAX_IDS) with their own histogram
+#endif
+#ifndef LATENCY_MAX_LANES
+#define LATENCY_MAX_LANES	4		//Priority lanes (0..LATENCY_MAX_LANES-1) with their own histogram
+#endif
+#define LATENCY_BINS		24		//bins[b] counts latencies of [2^b, 2^(b+1)) ticks, bins[0] also 0
+#define LATENCY_ISR_SOURCE	0xFF	//RingTag_T source of the items inserted from an interrupt
+
+/*
+ LATENCY_STAMP/LATENCY_RECORD - what insert_item/remove_item call, nothing when LATENCY_TRACE is 0
+ except that a stamp still clears the tag - the rings copy it whether or not they keep tags.
+ */
+#if LATENCY_TRACE
+#define LATENCY_STAMP(tag, lane)	Latency_stamp((tag), (lane))
+#define LATENCY_STAMP_ISR(tag, lane)	Latency_stampIsr((tag), (lane))
+#define LATENCY_RECORD(tag)		Latency_record(tag)
+#define LATENCY_INSERT_BEGIN(start)	((start) = Latency_now())
+#define LATENCY_INSERT_END(start)	Latency_recordInsert(start)
+#else
+#define LATENCY_STAMP(t, l)		((t)->stamp = 0, (t)->seq = 0, (t)->source = 0, (t)->lane = (UInt8)(l))
+#define LATENCY_STAMP_ISR(t, l)	LATENCY_STAMP((t), (l))
+#define LATENCY_RECORD(tag)		((Void)(tag))
+#define LATENCY_INSERT_BEGIN(start)	((Void)(start))
+#define LATENCY_INSERT_END(start)	((Void)(start))
+#endif
+
+
+/*
+ Structure LatencyHist_T - latency histogram, in Timestamp ticks.
+ */
+typedef struct
+{
+	UInt32 count;
+	UInt32 min;
+	UInt32 max;
+	UInt64 sum;					// for the average
+	UInt32 bins[LATENCY_BINS];
+} LatencyHist_T;
+
+
+/*
+ Structure LatencyStats_T - all the latency statistics, readable in RAM (latencyStats).
+ */
+typedef struct
+{
+	UInt32 freq;								// Timestamp ticks per second
+	UInt32 reordered;							// items recorded out of their producer's sequence (consumers racing, lanes)
+	LatencyHist_T all;
+	LatencyHist_T producer[LATENCY_MAX_IDS];	// [id - 1]
+	LatencyHist_T consumer[LATENCY_MAX_IDS];	// [id - 1]
+	LatencyHist_T lane[LATENCY_MAX_LANES];		// [lane]
+	LatencyHist_T isr;							// items inserted from an interrupt
+	LatencyHist_T insert[LATENCY_MAX_IDS];		// [producer id - 1], time spent in insert_item
+} LatencyStats_T;
+
+extern LatencyStats_T latencyStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Latency_init(void)
+
+ Clears latencyStats and the sequence numbers. Called from main before BIOS_start.
+ */
+Void Latency_init(void);
+
+/*
+ Function: Void Latency_stamp(RingTag_T *tag, Int lane)
+
+ Fills the tag of an item being inserted by the calling producer Task into priority lane "lane":
+ timestamp, producer id (from its topology env), lane and the producer's next sequence number.
+ */
+Void Latency_stamp(RingTag_T *tag, Int lane);
+
+/*
+ Function: Void Latency_stampIsr(RingTag_T *tag, Int lane)
+
+ Latency_stamp for an item inserted from an interrupt - Task_self() is then whichever Task was
+ interrupted, so the source is LATENCY_ISR_SOURCE. Only one interrupt may insert.
+ */
+Void Latency_stampIsr(RingTag_T *tag, Int lane);
+
+/*
+ Function: Void Latency_record(const RingTag_T *tag)
+
+ Records the residency of an item just removed by the calling consumer Task.
+ */
+Void Latency_record(const RingTag_T *tag);
+
+/*
+ Function: UInt32 Latency_now(void)
+ Function: Void Latency_recordInsert(UInt32 start)
+
+ Latency_now is the current Timestamp; Latency_recordInsert adds (now - start) to the insert
+ histogram of the calling producer Task.
+ */
+UInt32 Latency_now(void);
+Void Latency_recordInsert(UInt32 start);
+
+/*
+ Function: UInt32 Latency_percentile(const LatencyHist_T *hist, Int percent)
+
+ Upper bound (in ticks) of the bin holding the "percent" percentile of hist - e.g. 99 for p99.
+ Clamped to hist->max. Returns 0 for an empty histogram.
+ */
+UInt32 Latency_percentile(const LatencyHist_T *hist, Int percent);
+
+/*
+ Function: Void Latency_histReset(LatencyHist_T *hist)
+ Function: Void Latency_histAdd(LatencyHist_T *hist, UInt32 ticks)
+
+ The histograms for other measurements (the mutex blocking time of inversion.h, ...): empty one,
+ add a value in Timestamp ticks to one - in a short Hwi_disable window, from any Task.
+ */
+Void Latency_histReset(LatencyHist_T *hist);
+Void Latency_histAdd(LatencyHist_T *hist, UInt32 ticks);
+
+#endif /* LATENCY_H_ */
@@ -0,0 +1,141 @@
+/*
+ * led_blink.c
+ *
+ * Non-blocking, Clock driven LED blink engine - see led_blink.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <driverlib.h>
+
+#include "led_blink.h"
+
+#define LED_TOGGLE_PERIOD_CLKS	((LED_TOGGLE_PERIOD_MSEC * 2) / LED_BLINK_CLK_PERIOD)	// 2 Clock ticks per msec
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ Port/pin of every LED_E value (red_e, green_e).
+ */
+static const struct
+{
+	uint8_t port;
+	uint16_t pin;
+} ledPins[LED_NUM] =
+{
+	{ GPIO_PORT_P1, GPIO_PIN0 },	// red_e
+	{ GPIO_PORT_P4, GPIO_PIN7 }		// green_e
+};
+
+/*
+ Blink state machine of every LED_E value.
+ */
+static LedBlinkState_T ledState[LED_NUM];
+
+/*
+ Blink engine counters, see LedBlinkStats_T.
+ */
+volatile LedBlinkStats_T ledBlinkStats;
+
+
+/*
+ * Function: LedBlink_init
+ * Description: reset all LED state machines and counters.
+ * Input: void
+ * Output: void
+ * Algorithm: every LED idle (no toggles remaining) with the default toggle period.
+*/
+Void LedBlink_init(void)
+{
+	Int i = 0;
+	for(i = 0 ; i < LED_NUM ; i++) {
+		ledState[i].remaining = 0;
+		ledState[i].phase = 0;
+		ledState[i].period = LED_TOGGLE_PERIOD_CLKS;
+	}
+	ledBlinkStats.requests = 0;
+	ledBlinkStats.toggles = 0;
+	ledBlinkStats.truncated = 0;
+}
+
+/*
+ * Function: LedBlink_start
+ * Description: queue blinks on a LED without waiting for them.
+ * Input: LED_E led - green_e/red_e, Int blinksNum - number of blinks.
+ * Output: void
+ * Algorithm: with interrupts masked (the Clock handler updates the same state) add 2 toggles per
+ * 			  blink to the LED's remaining toggles (capped). An idle LED gets its first toggle half
+ * 			  a period from now - the first delay() of ledToggle.
+*/
+Void LedBlink_start(LED_E led, Int blinksNum)
+{
+	LedBlinkState_T *state;
+	Int toggles = 2 * blinksNum;	// Run 2 times - 1 for turn off/on and 1 for turn on/off.
+	UInt key;
+
+	if(led >= LED_NUM || toggles <= 0) {
+		return;
+	}
+	state = &ledState[led];
+
+	key = Hwi_disable();
+	ledBlinkStats.requests++;
+	if(state->remaining == 0) {
+		state->phase = (state->period / 2) > 0 ? (state->period / 2) : 1;
+	}
+	if(state->remaining + toggles > LED_MAX_PENDING_TOGGLES) {
+		ledBlinkStats.truncated += state->remaining + toggles - LED_MAX_PENDING_TOGGLES;
+		toggles = LED_MAX_PENDING_TOGGLES - state->remaining;
+	}
+	state->remaining = state->remaining + toggles;
+	Hwi_restore(key);
+}
+
+/*
+ * Function: LedBlink_busy
+ * Description: is the LED still blinking.
+ * Input: LED_E led.
+ * Output: Bool - TRUE while toggles remain.
+ * Algorithm: a single Int read is atomic.
+*/
+Bool LedBlink_busy(LED_E led)
+{
+	return (led < LED_NUM && ledState[led].remaining > 0) ? TRUE : FALSE;
+}
+
+/*
+ * Function: LedBlink_clockHandler
+ * Description: ledBlinkClk handler - one step of every LED state machine.
+ * Input: UArg arg0 - not used.
+ * Output: void
+ * Algorithm: for every LED with toggles remaining count its phase down, and when it reaches 0
+ * 			  toggle the pin and reload the phase with the period; after the last toggle drive the
+ * 			  pin low (like ledToggle did - ensure the LED is turned off when finish blinking).
+*/
+Void LedBlink_clockHandler(UArg arg0)
+{
+	Int i = 0;
+	UInt key;
+
+	for(i = 0 ; i < LED_NUM ; i++) {
+		LedBlinkState_T *state = &ledState[i];
+		if(state->remaining == 0) {
+			continue;
+		}
+		key = Hwi_disable();
+		state->phase = state->phase - 1;
+		if(state->phase <= 0) {
+			state->phase = state->period;
+			state->remaining = state->remaining - 1;
+			ledBlinkStats.toggles++;
+			if(state->remaining == 0) {
+				GPIO_setOutputLowOnPin(ledPins[i].port, ledPins[i].pin);
+			} else {
+				GPIO_toggleOutputOnPin(ledPins[i].port, ledPins[i].pin);
+			}
+		}
+		Hwi_restore(key);
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * led_blink.h
+ *
+ * Non-blocking, Clock driven LED blink engine.
+ *
+ * ledToggle used to blink a LED by spinning in delay() (__delay_cycles) between toggles - inside
+ * ledSrvTask, the highest priority Task in the system - so the whole producer/consumer pipeline
+ * stood still for as long as the LED was blinking.
+ *
+ * The blink engine keeps a small state machine per LED instead:
+ *
+ *  - remaining: toggles still to be done (2 per blink - ON and OFF);
+ *  - phase:     ledBlinkClk periods left until the next toggle;
+ *  - period:    ledBlinkClk periods between two toggles.
+ *
+ * LedBlink_start only adds toggles to the LED's state machine and returns immediately, and the
+ * ledBlinkClk Clock object (see empty.cfg) runs LedBlink_clockHandler every LED_BLINK_CLK_PERIOD
+ * Clock ticks, which counts the phases down and toggles the pins. The blink timing is the same as
+ * ledToggle's: half a toggle period, toggle, half a toggle period, ... and the LED is driven low
+ * once its last toggle is done.
+ *
+ * A LED that is asked to blink while it is still blinking just gets the new toggles appended,
+ * up to LED_MAX_PENDING_TOGGLES - toggles above that are dropped and counted in
+ * ledBlinkStats.truncated, so a LED service that cannot keep up never builds an unbounded
+ * backlog.
+ */
+
+#ifndef LED_BLINK_H_
+#define LED_BLINK_H_
+
+#include <xdc/std.h>
+#include "led_mailbox.h"
+
+#define LED_BLINK_CLK_PERIOD	20		//ledBlinkClk period in Clock ticks (500 usec) - 10 msec resolution (MUST match empty.cfg)
+#define LED_TOGGLE_PERIOD_MSEC	1000	//Time between two toggles of a LED (the two 1/2 second delays of ledToggle)
+#define LED_MAX_PENDING_TOGGLES	64		//Upper bound of the toggles queued for one LED
+#define LED_NUM					2		//Number of LED_E values
+
+
+/*
+ Structure LedBlinkState_T - the blink state machine of one LED.
+ */
+typedef struct
+{
+	volatile Int remaining;		// toggles still to be done
+	volatile Int phase;			// ledBlinkClk periods until the next toggle
+	Int period;					// ledBlinkClk periods between two toggles
+} LedBlinkState_T;
+
+
+/*
+ Structure LedBlinkStats_T - blink engine counters, readable in RAM (ledBlinkStats).
+ */
+typedef struct
+{
+	UInt32 requests;		// LedBlink_start calls
+	UInt32 toggles;			// pin toggles done by the Clock handler
+	UInt32 truncated;		// toggles dropped because of LED_MAX_PENDING_TOGGLES
+} LedBlinkStats_T;
+
+extern volatile LedBlinkStats_T ledBlinkStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void LedBlink_init(void)
+
+ Resets the state machines (all LEDs idle, toggle period LED_TOGGLE_PERIOD_MSEC) and counters.
+ Called from main before BIOS_start.
+ */
+Void LedBlink_init(void);
+
+/*
+ Function: Void LedBlink_start(LED_E led, Int blinksNum)
+
+ Queues blinksNum blinks on "led" and returns immediately. May be called from Task or Swi
+ context (ledSrvTask calls it for every command fetched from the LED mailbox).
+ */
+Void LedBlink_start(LED_E led, Int blinksNum);
+
+/*
+ Function: Bool LedBlink_busy(LED_E led)
+
+ Returns TRUE while "led" still has toggles to do.
+ */
+Bool LedBlink_busy(LED_E led);
+
+/*
+ Function: Void LedBlink_clockHandler(UArg arg0)
+
+ The handler function of the ledBlinkClk Clock object (Swi context) - advances every LED's
+ state machine by one ledBlinkClk period.
+ */
+Void LedBlink_clockHandler(UArg arg0);
+
+#endif /* LED_BLINK_H_ */
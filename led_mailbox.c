@@ -0,0 +1,123 @@
+/*
+ * led_mailbox.c
+ *
+ * Bounded, non-blocking LED command mailbox - see led_mailbox.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "led_mailbox.h"
+
+#if (LED_MAILBOX_SIZE & (LED_MAILBOX_SIZE - 1)) != 0
+#error "LED_MAILBOX_SIZE must be a power of two"
+#endif
+
+#define LED_MAILBOX_MASK (LED_MAILBOX_SIZE - 1)
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The queued commands, and the free running indices of the oldest queued command (head) and of
+ the next free entry (tail) - the number of queued commands is always tail - head.
+ */
+static LedBlinksInfo_T mailbox[LED_MAILBOX_SIZE];
+static UInt head = 0;
+static UInt tail = 0;
+
+/*
+ Mailbox counters, see LedMailboxStats_T.
+ */
+volatile LedMailboxStats_T ledMailboxStats;
+
+
+/*
+ * Function: LedMailbox_init
+ * Description: empty the mailbox and clear its counters.
+ * Input: void
+ * Output: void
+ * Algorithm: head == tail means empty.
+*/
+Void LedMailbox_init(void)
+{
+	head = 0;
+	tail = 0;
+	ledMailboxStats.queued = 0;
+	ledMailboxStats.coalesced = 0;
+	ledMailboxStats.dropped = 0;
+	ledMailboxStats.fetched = 0;
+	ledMailboxStats.highWater = 0;
+}
+
+/*
+ * Function: LedMailbox_post
+ * Description: queue a LED command by value, never blocking.
+ * Input: const LedBlinksInfo_T *cmd - the command (copied).
+ * Output: LedPostResult_E - queued, coalesced or dropped.
+ * Algorithm: with interrupts masked - if there is a free entry copy the command to it, otherwise
+ * 			  search the queued commands from the newest one for the same LED and add the blinks
+ * 			  to it (capped), otherwise drop it. Counters are updated inside the same window.
+*/
+LedPostResult_E LedMailbox_post(const LedBlinksInfo_T *cmd)
+{
+	LedPostResult_E result = ledPostDropped_e;
+	UInt key = Hwi_disable();
+	UInt used = tail - head;
+
+	if(used < LED_MAILBOX_SIZE) {
+		mailbox[tail & LED_MAILBOX_MASK] = *cmd;
+		tail = tail + 1;
+		used = used + 1;
+		if(used > ledMailboxStats.highWater) {
+			ledMailboxStats.highWater = used;
+		}
+		ledMailboxStats.queued++;
+		result = ledPostQueued_e;
+	} else {
+		UInt pos = tail;
+		while(pos != head) {
+			LedBlinksInfo_T *queued;
+			pos = pos - 1;
+			queued = &mailbox[pos & LED_MAILBOX_MASK];
+			if(queued->led == cmd->led) {
+				queued->blinksNum = queued->blinksNum + cmd->blinksNum;
+				if(queued->blinksNum > LED_MAX_COALESCED_BLINKS) {
+					queued->blinksNum = LED_MAX_COALESCED_BLINKS;
+				}
+				result = ledPostCoalesced_e;
+				break;
+			}
+		}
+		if(result == ledPostCoalesced_e) {
+			ledMailboxStats.coalesced++;
+		} else {
+			ledMailboxStats.dropped++;
+		}
+	}
+	Hwi_restore(key);
+	return result;
+}
+
+/*
+ * Function: LedMailbox_fetch
+ * Description: take the oldest queued LED command.
+ * Input: LedBlinksInfo_T *cmd - receives the command.
+ * Output: Bool - FALSE if the mailbox is empty, TRUE otherwise.
+ * Algorithm: copy and advance head with interrupts masked (post may coalesce into that entry).
+*/
+Bool LedMailbox_fetch(LedBlinksInfo_T *cmd)
+{
+	Bool fetched = FALSE;
+	UInt key = Hwi_disable();
+
+	if(head != tail) {
+		*cmd = mailbox[head & LED_MAILBOX_MASK];
+		head = head + 1;
+		ledMailboxStats.fetched++;
+		fetched = TRUE;
+	}
+	Hwi_restore(key);
+	return fetched;
+}
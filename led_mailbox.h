@@ -0,0 +1,111 @@
+/*
+ * led_mailbox.h
+ *
+ * Bounded, non-blocking LED command mailbox between the producer/consumer tasks and ledSrvTask.
+ *
+ * Producers/consumers used to hand ledSrvTask a pointer to a LedBlinksInfo_T living on their own
+ * stack, through ledSrvTask's Env, inside the setLedEnvMutex critical section. That serialized
+ * every item on setLedEnvMutex, and the pointed-to structure could be rewritten by its owner
+ * before ledSrvTask got to read it.
+ *
+ * The mailbox instead holds LED_MAILBOX_SIZE LedBlinksInfo_T commands COPIED BY VALUE. Posting a
+ * command never blocks:
+ *
+ *  - if there is room, the command is queued;
+ *  - if the mailbox is full, the command is coalesced into the newest queued command for the
+ *    same LED (the blinks are added up, capped at LED_MAX_COALESCED_BLINKS);
+ *  - if there is no queued command for that LED either, the command is dropped.
+ *
+ * Every case is counted in ledMailboxStats, so the pipeline keeps running at full rate while the
+ * LED service falls behind, and the counters show by how much.
+ *
+ * The mailbox ring is only touched inside a Hwi_disable()/Hwi_restore() window of a few
+ * instructions (copying one 2-field command), so LedMailbox_post may be called from Task, Swi or
+ * Hwi context.
+ */
+
+#ifndef LED_MAILBOX_H_
+#define LED_MAILBOX_H_
+
+#include <xdc/std.h>
+
+#ifndef LED_MAILBOX_SIZE
+#define LED_MAILBOX_SIZE 8				//Number of queued LED commands - MUST be a power of two
+#endif
+#ifndef LED_MAX_COALESCED_BLINKS
+#define LED_MAX_COALESCED_BLINKS 32		//Upper bound of the blinks of one coalesced command
+#endif
+
+
+//LED_E enum - denoting all possible LEDs in the system
+typedef enum
+{
+	red_e,
+	green_e
+} LED_E;
+
+
+/*
+ Structure LedBlinksInfo_T - one LED blinking command: which LED ("led" - producerTask uses
+ green_e, consumerTask uses red_e) and how many times it should blink ("blinksNum").
+ Commands are copied into the mailbox, so the caller's instance may be reused immediately.
+ */
+typedef struct
+{
+	LED_E led;
+	Int blinksNum;
+}LedBlinksInfo_T;
+
+
+//LedPostResult_E enum - what LedMailbox_post did with a command
+typedef enum
+{
+	ledPostQueued_e,
+	ledPostCoalesced_e,
+	ledPostDropped_e
+} LedPostResult_E;
+
+
+/*
+ Structure LedMailboxStats_T - mailbox counters, readable in RAM (ledMailboxStats).
+ */
+typedef struct
+{
+	UInt32 queued;			// commands queued
+	UInt32 coalesced;		// commands merged into a queued command because the mailbox was full
+	UInt32 dropped;			// commands lost because the mailbox was full
+	UInt32 fetched;			// commands handed to ledSrvTask
+	UInt highWater;			// maximum number of queued commands seen
+} LedMailboxStats_T;
+
+extern volatile LedMailboxStats_T ledMailboxStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void LedMailbox_init(void)
+
+ Empties the mailbox and clears ledMailboxStats. Called from main before BIOS_start.
+ */
+Void LedMailbox_init(void);
+
+/*
+ Function: LedPostResult_E LedMailbox_post(const LedBlinksInfo_T *cmd)
+
+ Copies *cmd into the mailbox (or coalesces/drops it, see above). Never blocks. The caller is
+ expected to post ledSrvSchedSem afterwards to release ledSrvTask.
+ */
+LedPostResult_E LedMailbox_post(const LedBlinksInfo_T *cmd);
+
+/*
+ Function: Bool LedMailbox_fetch(LedBlinksInfo_T *cmd)
+
+ ledSrvTask side. Copies the oldest queued command to *cmd and removes it - returns FALSE if
+ the mailbox is empty.
+ */
+Bool LedMailbox_fetch(LedBlinksInfo_T *cmd);
+
+#endif /* LED_MAILBOX_H_ */
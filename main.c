@@ -5,15 +5,33 @@
 #include <xdc/std.h>  						//mandatory - have to include first, for BIOS types
 #include <ti/sysbios/BIOS.h> 				//mandatory - if you call APIs like BIOS_start()
 #include <xdc/runtime/Log.h>				//needed for any Log_info() call
+#include <xdc/runtime/System.h>				//System_abort of a failed start-up
 #include <xdc/cfg/global.h> 				//header file for statically defined objects/handles
+#include <ti/sysbios/hal/Timer.h>			//Timer_A interrupt of the ISR producer (samplerIsr)
 
 
 //-----------------------------------------
 // MSP430 Header Files
 //-----------------------------------------
 #include <driverlib.h>
-#include <stdlib.h>						//for using rand and srand function
-#include <time.h>						//for time(0) used in srand function
+
+#include "bounded_buffer.h"				//bounded buffer objects (locked/SPSC/MPMC engines)
+#include "led_mailbox.h"				//LED command mailbox to ledSrvTask
+#include "led_blink.h"					//Clock driven LED blink engine
+#include "topology.h"					//runtime producer/consumer Tasks
+#include "latency.h"						//per-item latency stamping/histograms
+#include "trace.h"						//binary event trace of the hot path
+#include "timeslice.h"					//time-slicing policy of tsClockHandler
+#include "workload.h"					//per-producer PRNG and workload generators
+#include "record.h"						//record of the task interleaving, for host replay
+#include "cpuacct.h"						//per-task CPU accounting
+#include "stackprof.h"					//stack high-water marks
+#include "inversion.h"					//priority inversion scenario (hog and probe Tasks)
+#include "stage.h"						//multi-stage pipelines (stage graph workers)
+#include "stage_graph.h"					//acquire -> filter -> aggregate -> transmit graph
+#include "microbench.h"					//microbenchmarks of the RTOS primitives
+#include "spool.h"						//overflow spool of a buffer, in flash
+#include "winstats.h"					//windowed statistics of the consumed items
 
 //-----------------------------------------
 // MSP430 MCLK frequency settings
@@ -27,60 +45,186 @@
 					GPIO_PIN4|GPIO_PIN5|GPIO_PIN6|GPIO_PIN7
 
 
-#define BUFFER_SIZE 10  //Size of the shared buffer
-#define MAX_VAL_NUM 10 //Maximum value of randomly generated produced item!
+#ifndef BUFFER_SIZE
+#define BUFFER_SIZE 16  //Size of every pipeline's bounded buffer - MUST be a power of two (index masking instead of %)
+#endif
+#ifndef MAX_VAL_NUM
+#define MAX_VAL_NUM 10 //Maximum value of randomly generated produced item! - also the blinks of its LED commands
+#endif
+
+#if (BUFFER_SIZE & (BUFFER_SIZE - 1)) != 0
+#error "BUFFER_SIZE must be a power of two"
+#endif
+
+//-----------------------------------------
+// Bounded buffer queue engine selection (BBEngine_E values, see bounded_buffer.h)
+//-----------------------------------------
+#define QUEUE_ENGINE_LOCKED	0	// storage guarded by emptySlots/mutex/fullSlots (4 semaphore ops per item)
+#define QUEUE_ENGINE_SPSC	1	// wait-free SPSC ring - valid ONLY with one producerTask and one consumerTask!
+#define QUEUE_ENGINE_MPMC	2	// lock-free MPMC ring (per-slot sequence numbers), any number of tasks
+#define QUEUE_ENGINE_LANES	3	// NUM_LANES MPMC priority lanes, highest non-empty lane first
+
+#ifndef QUEUE_ENGINE
+#define QUEUE_ENGINE QUEUE_ENGINE_LOCKED
+#endif
+
+#ifndef NUM_LANES
+#define NUM_LANES 2				//Priority lanes of a QUEUE_ENGINE_LANES buffer (1, 2 or 4) - lane 0 routine, the rest urgent
+#endif
+#ifndef LANE_STARVE_QUOTA
+#define LANE_STARVE_QUOTA 8		//Urgent items taken in a row before a waiting lower lane is served (0 - strict priority)
+#endif
+#ifndef LANE_URGENT_PERCENT
+#define LANE_URGENT_PERCENT 10	//Percentage of the produced items sent to an urgent lane (1..NUM_LANES-1)
+#endif
+
+#ifndef BACKPRESSURE_POLICY
+#define BACKPRESSURE_POLICY 0	//BBPolicy_E of every buffer - 0 block, 1 timeout, 2 drop newest, 3 drop oldest, 4 sample, 5 spool (pipeline 0)
+#endif
+#ifndef BACKPRESSURE_PARAM
+#define BACKPRESSURE_PARAM 4	//Timeout in Clock ticks (1), keep every BACKPRESSURE_PARAM-th item while full (4), or the high-water mark in items (5)
+#endif
+#ifndef CONSUMER_STALL_EVERY
+#define CONSUMER_STALL_EVERY 0	//Benchmark - every consumer stalls after this many items (0 - never)
+#endif
+#ifndef CONSUMER_STALL_TICKS
+#define CONSUMER_STALL_TICKS 20	//Benchmark - Clock ticks of every consumer stall
+#endif
+
+#ifndef PRODUCER_BATCH_SIZE
+#define PRODUCER_BATCH_SIZE 1	//Items generated per producer burst - > 1 makes producerHandler use insert_items
+#endif
+#ifndef CONSUMER_BATCH_SIZE
+#define CONSUMER_BATCH_SIZE 1	//Max items taken per consumer call - > 1 makes consumerHandler use remove_items
+#endif
+
+//-----------------------------------------
+// Producer/consumer topology (created by main, see topology.h)
+//-----------------------------------------
+#ifndef NUM_PIPELINES
+#define NUM_PIPELINES 1		//Independent pipelines - each has its own bounded buffer, producers and consumers
+#endif
+#ifndef NUM_PRODUCERS
+#define NUM_PRODUCERS 2		//producerHandler Tasks per pipeline, ids 1..NUM_PRODUCERS
+#endif
+#ifndef NUM_CONSUMERS
+#define NUM_CONSUMERS 2		//consumerHandler Tasks per pipeline, ids 1..NUM_CONSUMERS
+#endif
+#ifndef WORKER_PRIORITY
+#define WORKER_PRIORITY 1	//Priority of the producers and consumers (below ledSrvTask's 3)
+#endif
+#ifndef WORKER_STACK_SIZE
+#define WORKER_STACK_SIZE 700	//Stack bytes of every producer and consumer
+#endif
+#ifndef STAGE_GRAPH
+#define STAGE_GRAPH 0		//1 - run stageGraph (stage_graph.h) instead of the producer/consumer pipelines
+#endif
+//-----------------------------------------
+// Producer workload (see workload.h)
+//-----------------------------------------
+#ifndef WORKLOAD_KIND
+#define WORKLOAD_KIND 0		//WorkloadKind_E - 0 uniform, 1 bursty, 2 Poisson arrivals, 3 replay of workloadTable
+#endif
+#ifndef WORKLOAD_BURST_LEN
+#define WORKLOAD_BURST_LEN 8	//Items per burst (bursty)
+#endif
+#ifndef WORKLOAD_BURST_GAP
+#define WORKLOAD_BURST_GAP 4	//Clock ticks between bursts (bursty)
+#endif
+#ifndef WORKLOAD_MEAN_GAP
+#define WORKLOAD_MEAN_GAP 2		//Mean Clock ticks between items (Poisson)
+#endif
+//-----------------------------------------
+// Interrupt-driven producer (see try_insert_item, samplerIsr)
+//-----------------------------------------
+#ifndef ISR_PRODUCER_HZ
+#define ISR_PRODUCER_HZ 0		//Rate of the Timer_A sampler ISR inserting into pipeline 0 (0 - no ISR producer)
+#endif
+#define ISR_SAMPLE_BITS 10		//Resolution of the sampler's "ADC" readings
+
+#ifndef TRACE_DRAIN_PRIORITY
+#define TRACE_DRAIN_PRIORITY 2	//Priority of the trace drain Task - above the workers (it can't go below them), below ledSrvTask
+#endif
+
+#if PRODUCER_BATCH_SIZE > 1 && BACKPRESSURE_POLICY != 0
+#error "insert_items always blocks - the backpressure policies need PRODUCER_BATCH_SIZE 1"
+#endif
+#if QUEUE_ENGINE == QUEUE_ENGINE_SPSC && (NUM_PRODUCERS != 1 || NUM_CONSUMERS != 1)
+#error "QUEUE_ENGINE_SPSC needs NUM_PRODUCERS == 1 and NUM_CONSUMERS == 1"
+#endif
+#if INVERSION_SCENARIO && QUEUE_ENGINE != QUEUE_ENGINE_LOCKED
+#error "INVERSION_SCENARIO probes the mutex of the locked engine"
+#endif
+#if ISR_PRODUCER_HZ != 0 && QUEUE_ENGINE == QUEUE_ENGINE_LOCKED && BB_MUTEX_PI
+#error "a GateMutexPri can't be entered from an ISR - BB_MUTEX_PI 0 or a ring engine for the ISR producer"
+#endif
+#if QUEUE_ENGINE == QUEUE_ENGINE_SPSC && ISR_PRODUCER_HZ != 0
+#error "the ISR producer would be a second producer of the SPSC ring"
+#endif
+#if STAGE_GRAPH && (INVERSION_SCENARIO || ISR_PRODUCER_HZ != 0)
+#error "INVERSION_SCENARIO and the ISR producer work on pipeline 0, which STAGE_GRAPH doesn't create"
+#endif
+#if MICROBENCH && (STAGE_GRAPH || INVERSION_SCENARIO || ISR_PRODUCER_HZ != 0)
+#error "MICROBENCH runs alone - no STAGE_GRAPH, INVERSION_SCENARIO or ISR producer"
+#endif
+#if STAGE_GRAPH && STAGE_ENGINE == QUEUE_ENGINE_SPSC && STAGE_FILTER_WORKERS != 1
+#error "SPSC links need one worker per stage"
+#endif
+#if !STAGE_GRAPH && !MICROBENCH && NUM_PIPELINES > BB_MAX_BUFFERS
+#error "every pipeline needs a buffer object - NUM_PIPELINES > BB_MAX_BUFFERS"
+#endif
+#if !STAGE_GRAPH && !MICROBENCH && QUEUE_ENGINE == QUEUE_ENGINE_LANES && NUM_PIPELINES > BB_MAX_LANE_BUFFERS
+#error "every lanes pipeline needs a lane state object - NUM_PIPELINES > BB_MAX_LANE_BUFFERS"
+#endif
+
+/*
+ Bytes of BB_POOL_SIZE the buffer of every pipeline takes, rounded like poolAlloc (bounded_buffer.c)
+ rounds them: the slots (Int, or MPMC cells) plus a RingTag_T per slot with LATENCY_TRACE.
+ */
+#define PIPELINE_POOL_ALIGN(bytes)	(((bytes) + sizeof(UInt32) - 1) / sizeof(UInt32) * sizeof(UInt32))
+#define PIPELINE_POOL_BLOCK(slots, cell)	(PIPELINE_POOL_ALIGN((slots) * sizeof(cell)) + \
+		LATENCY_TRACE * PIPELINE_POOL_ALIGN((slots) * sizeof(RingTag_T)))
+#if QUEUE_ENGINE == QUEUE_ENGINE_LANES
+#define PIPELINE_POOL_BYTES	(NUM_LANES * PIPELINE_POOL_BLOCK(BUFFER_SIZE / NUM_LANES, MpmcCell_T))
+#elif QUEUE_ENGINE == QUEUE_ENGINE_MPMC
+#define PIPELINE_POOL_BYTES	PIPELINE_POOL_BLOCK(BUFFER_SIZE, MpmcCell_T)
+#else
+#define PIPELINE_POOL_BYTES	PIPELINE_POOL_BLOCK(BUFFER_SIZE, Int)
+#endif
+
+/*
+ The preprocessor has no sizeof, so this check is a typedef: an array of negative size - the
+ compiler's error names pipelineBuffersExceedBbPoolSize - when the pipelines' buffers don't fit
+ BB_POOL_SIZE. Lower BUFFER_SIZE or NUM_PIPELINES, or raise BB_POOL_SIZE.
+ */
+typedef char pipelineBuffersExceedBbPoolSize[(STAGE_GRAPH || MICROBENCH ||
+		NUM_PIPELINES * PIPELINE_POOL_BYTES <= BB_POOL_SIZE) ? 1 : -1];
 
 //-----------------------------------------
 // additional defines
 //-----------------------------------------
-#define GREEN_LED GPIO_PORT_P4,GPIO_PIN7
-#define RED_LED GPIO_PORT_P1,GPIO_PIN0
+// GREEN_LED (P4.7) / RED_LED (P1.0) pins are mapped from LED_E in led_blink.c
 
 //-----------------------------------------
 // Prototypes
 //-----------------------------------------
 
 
-//LED_E enum - denoting all possible LEDs in the system
-typedef enum
-{
-	red_e,
-	green_e
-} LED_E;
-
-
-/*
- Structure LedBlinksInfo_T, so that each of the producerTask and consumerTask can define
- a local instance of this (each one in its own context function!) and fill it accordingly.
- This Structure is used, in order to communicate between the producerTask/consumerTask and
- the ledSrvTask (which provides LED blinking services) - each one of the
- producerTask/consumerTask fills it with the appropriate LED blinking specification
- (after producing/consuming an item) and "send" it to ledSrvTask. Well, it is not really a
- "sending" operation, but using the ability BIOS is providing us to set/get the Env (Environment)
- of a Task, using Task_setEnv and Task_getEnv API functions (see API Documentation) - recall,
- setting the Task Env is merely giving it a generic pointer (of type Ptr - which is simply a
- void * pointer - hence generic, which could be a pointer to anything!) to some data. The Task
- whose Env was set can then get this Env data pointer using Task_getEnv API function (and cast
- the pointer appropriately!) and then read the data!
-
- In this case, producerTask/consumerTask fills a local copy of this structure with the
- appropriate LED blinking specification (after producing/consuming an item) and then sending
- the pointer to this structure to ledSrvTask using Task_setEnv API function.
- Then, when ledSrvTask gets to run, it simply reads this Env pointer using Task_getEnv API
- function (casting the result, of course, to type LedBlinksInfo_T *).
- The LED blinking specification is simple:
+/*
+ LED_E and LedBlinksInfo_T (the LED blinking specification producerTask/consumerTask send to
+ ledSrvTask) are defined in led_mailbox.h - the specification is simple:
 
  	 - producerTask fills the "led" field to be green_e whereas consumerTask fills
  	   the led field to be red_e.
 
  	 - the "blinksNum" is to be filled with the number of Blinks the LED (specified in the
  	   field "led") should be blinked.
+
+ The specification is no longer "sent" by pointing ledSrvTask's Env at the sender's local
+ structure (which serialized every item on the setLedEnvMutex Mutex Semaphore, and let the
+ sender overwrite its structure before ledSrvTask read it) - it is copied by value into the
+ non-blocking LED command mailbox, see requestLedBlinks.
  */
-typedef struct
-{
-	LED_E led;
-	Int blinksNum;
-}LedBlinksInfo_T;
 
 
 //The usual hardware_init function
@@ -88,12 +232,15 @@ void hardware_init(void);
 
 
 /*
- Function: Bool insert_item(Int item)
+ Function: BBStatus_E insert_item(BoundedBuffer_Handle bb, Int item)
 
  This function is called from the producerTask (after producerTask generated a random number
  in the value between 1 and MAX_VAL_NUM). This function receives the produced item in the
  parameter "item" and updates it in the shared buffer "buffer".
 
+ The shared buffer is the BoundedBuffer_T "bb" (see bounded_buffer.h) - below, "buffer", "in"
+ and "count" are its storage/in/count fields, and emptySlots/mutex/fullSlots its semaphores.
+
  Several guidelines:
 
  1) This function needs to synchronize the access to the shared data using the semaphores:
@@ -130,14 +277,55 @@ void hardware_init(void);
          do that!);
        - issue a Log message - outputting the value of the currently produced item and the
          up-to-dated number of items in the buffer (i.e. the value of "count" global variable).
+         This is now a binary traceInsert_e event, written after the critical section (trace.h).
 
     3) Then, release the Semaphores (according to the Algorithm in the lecture notes) and
        return TRUE.
+
+ TRUE/FALSE are now the BBStatus_E values bbInsertOk_e/bbInsertError_e (bounded_buffer.h). The
+ pend on emptySlots no longer has to wait forever - it follows the buffer's backpressure policy
+ (BACKPRESSURE_POLICY), which may also give the item up (bbInsertDropped_e, bbInsertTimeout_e)
+ or store it in place of the oldest one (bbInsertOverwrote_e), so a stalled consumer does not
+ stall the producers. With bbPolicySpool_e the item may also go to the overflow spool in flash
+ instead (bbInsertSpooled_e, spool.h), from where remove_item moves it into the buffer later.
  */
-Bool insert_item(Int item);
+BBStatus_E insert_item(BoundedBuffer_Handle bb, Int item);
 
 /*
- Function: Bool remove_item(Int *item);
+ Function: BBStatus_E insert_item_lane(BoundedBuffer_Handle bb, Int item, Int lane)
+
+ insert_item into priority lane "lane" (0 routine, higher more urgent) - insert_item is lane 0.
+ With QUEUE_ENGINE_LANES the item waits only for the free slots of its own lane (laneEmpty) and
+ remove_item takes it ahead of every item of a lower lane - a lane the buffer doesn't have is
+ taken as lane 0. With the other engines the lane is only recorded in the item's latency tag, so
+ the lanes can be compared against a single FIFO.
+ */
+BBStatus_E insert_item_lane(BoundedBuffer_Handle bb, Int item, Int lane);
+
+/*
+ Function: BBStatus_E try_insert_item(BoundedBuffer_Handle bb, Int item)
+ Function: BBStatus_E try_insert_item_lane(BoundedBuffer_Handle bb, Int item, Int lane)
+
+ insert_item for an interrupt handler (Hwi) or a Swi: it never blocks - every pend is a
+ BIOS_NO_WAIT one - so an ISR can hand its data straight to the consumer Tasks, with the
+ fullSlots post waking them once the ISR returns. Returns bbInsertOk_e, or bbInsertDropped_e
+ when the item could not be inserted at once: no free slot (the buffer is full - overflow), or,
+ with the locked engine, the mutex held by the Task the interrupt preempted (it can't be waited
+ for - that Task only runs again after the ISR). The locked engine needs the binary semaphore
+ mutex (BB_MUTEX_PI 0) - a GateMutexPri can't be entered from an ISR. The backpressure policy of the buffer does not
+ apply. Every outcome is counted in bb->isrStats, which only the inserting ISR writes - one ISR
+ per buffer. The ring engines push lock-free, and are safe against the Tasks they interrupt;
+ the SPSC ring is not, as the ISR is a second producer.
+
+ The ISR's items are stamped as LATENCY_ISR_SOURCE (latency.h). They are neither traced
+ (trace.h attributes events to Task_self(), the interrupted Task) nor recorded (record.h) -
+ a run with an ISR producer can't be replayed.
+ */
+BBStatus_E try_insert_item(BoundedBuffer_Handle bb, Int item);
+BBStatus_E try_insert_item_lane(BoundedBuffer_Handle bb, Int item, Int lane);
+
+/*
+ Function: Bool remove_item(BoundedBuffer_Handle bb, Int *item);
 
  This function is called from the consumerTask. This function receives an address of a locally
  defined variable in a certain consumerTask and "consumes" the next available item
@@ -147,6 +335,9 @@ Bool insert_item(Int item);
  verify your program works generically without doing any changes (apart from configuring in GUI
  the two additional producerTask/consumerTask).
 
+ As in insert_item, "buffer", "out" and "count" below are the storage/out/count fields of the
+ BoundedBuffer_T "bb", and fullSlots/mutex/emptySlots its semaphores.
+
 
  Several guidelines:
 
@@ -184,32 +375,89 @@ Bool insert_item(Int item);
          do that!);
        - issue a Log message - outputting the value of the currently consumed item and the
          up-to-dated number of items in the buffer (i.e. the value of "count" global variable).
+         This is now a binary traceRemove_e event, written after the critical section (trace.h).
 
 
     3) Then, release the Semaphores (according to the Algorithm in the lecture notes) and
        return TRUE.
+
+ A bbPolicySpool_e buffer is first topped up from the overflow spool: before it waits for an
+ item, remove_item moves the oldest spooled items into the free slots (spool.h).
  */
-Bool remove_item(Int *item);
+Bool remove_item(BoundedBuffer_Handle bb, Int *item);
+
+
+/*
+ Function: Int insert_items(BoundedBuffer_Handle bb, const Int *src, Int n, BBStatus_E *status)
+
+ Batched version of insert_item - inserts up to n items from src into the shared buffer, in order.
+
+ A producer generating a burst of items pays the synchronization cost once per burst rather than
+ once per item:
+
+  1) It blocks on emptySlots only until at least ONE slot is free, then takes as many of the
+     remaining free slots as it can (up to n) without blocking (BIOS_NO_WAIT pends never
+     reschedule, so they cost a fraction of a blocking pend).
+
+  2) All the reserved slots are filled inside ONE mutex critical section (buffer engine) as one
+     contiguous run starting at "in" - the run is split in two at most, where it wraps around at
+     BUFFER_SIZE. With a ring engine each slot is pushed lock-free instead.
+
+  3) fullSlots is posted once per inserted item, but with the Task scheduler disabled - so the
+     consumers are made ready all at once and there is a single reschedule for the whole run.
+
+ Returns the number of items actually inserted (0..n) - the caller calls it again with the rest
+ of its burst. Those items are in the buffer whatever *status says, so they must not be inserted
+ again. *status (if status is not NULL) is bbInsertOk_e, or bbInsertError_e on Abnormal behaviour
+ (a reserved slot was not empty, i.e. buffer[in] is NOT -1) - the items before that slot are
+ inserted, a Log message is issued and the unused slots are given back to emptySlots.
+ */
+Int insert_items(BoundedBuffer_Handle bb, const Int *src, Int n, BBStatus_E *status);
+
+/*
+ Function: Int remove_items(BoundedBuffer_Handle bb, Int *dst, Int max, Bool *ok)
+
+ Batched version of remove_item - removes up to max items (at least one, blocks until there is
+ one) from the shared buffer into dst, in FIFO order, in one critical section with the same
+ wrap-around handling as insert_items.
+
+ Returns the number of items actually removed (0..max) - they are out of the buffer, so the
+ caller consumes them whatever *ok says. *ok (if ok is not NULL) is FALSE on Abnormal behaviour
+ (an "available" slot held -1) - the items before that slot are removed, a Log message is issued
+ and the unused items are given back to fullSlots.
+ */
+Int remove_items(BoundedBuffer_Handle bb, Int *dst, Int max, Bool *ok);
+
+
+/*
+ Function: void requestLedBlinks(LED_E led, Int blinksNum)
+
+ Sections B & C of producerHandler/consumerHandler below, shared by both of them: copies the
+ LED blinking specification into the LED command mailbox and posts ledSrvSchedSem to release
+ ledSrvTask. Never blocks - if ledSrvTask fell behind and the mailbox is full, the command is
+ coalesced into a queued one for the same LED or dropped (and counted in ledMailboxStats), so
+ the producer/consumer keeps running at full rate.
+ */
+void requestLedBlinks(LED_E led, Int blinksNum);
 
 
 /*
  Function: producerHandler(UArg arg0, UArg arg1)
 
- This is the handler function for the producerTask (producerTask1) and for all other
- producerTasks added to the system (in this case: producerTask2).
+ This is the handler function of every producerTask - main creates NUM_PRODUCERS of them at
+ runtime (Topology_createUniform, see topology.h).
 
  This function implements the producer behaviour and provides the infrastructure for the
  producer to run forever! Therefore, this function runs in while(TRUE) loop.
  Remember, it must also:
 
-  1) Define a local structure of type LedBlinksInfo_T;
-
-  2) Recall, arg0 of this function holds the unique producerID (you gave it in GUI definition).
+  1) Recall, arg0 of this function holds the unique producerID (1..NUM_PRODUCERS, set by the topology).
 
 
  Then the while(TRUE) loop. Every iteration in this loop should perform the following:
 
- 1) Generate a random number between 1 and MAX_VAL_NUM;
+ 1) Generate a random number between 1 and MAX_VAL_NUM - taken from the producer's own
+    workload generator (workload.h), not from srand(time(0))/rand() on every iteration;
 
  2) Send this number to insert_item function call. Recall, insert_item is the function that
     implements the producer algorithm for 1 item (as defined in the lecture notes) in the
@@ -223,27 +471,19 @@ Bool remove_item(Int *item);
 
  3) If no abnormal behaviour:
 
-  	A. Issue a Log message outputting the producerID and the value of the item produced;
+  	A. Issue a Log message outputting the producerID and the value of the item produced -
+  	   covered by insert_item's trace event, which carries the producer id and the item;
 
-  	B. Set the Env of ledSrvTask (using Task_setEnv API function) to send it the up-to-dated
-  	   data for the Led Blink (i.e. sending it a pointer to the local LedBlinksInfo_T structure
-  	   that you must also update it with the proper information before that!)
+  	B. Send ledSrvTask the LED blinking specification for the item (copied by value into the
+  	   LED command mailbox - see requestLedBlinks).
 
   	C. Release ledSrvTask to work (by posting the Scheduling Constraint Semaphore
   	   ledSrvSchedSem, which ledSrvTask pends on).
 
   	Now, since ledSrvTask is the highest priority Task in the system, it will immediately get
-  	to run and blink the appropriate Led (according to the specification you updated in
-  	LedBlinksInfo_T structure and sent it to ledSrvTask's Env).
-
-  	However, what happens if current Task yielded (by timeSharingClk), just after setting the
-  	ledSrvTask's Env, but before posting ledSrvSchedSem (i.e. before releasing ledSrvTask)???
-  	Some other producerTask/consumerTask may set ledSrvTask's Env with their data -
-  	running over the data set by current Task...!!! Reminds you of something???
-  	Indeed, this is RACE CONDITION!!!
-
-  	This means that the ENTIRE CODE in sections B & C above is a CRITICAL SECTION!!!! It must,
-  	therefore, be protected by a Mutex Semaphore (we named this Mutex Semaphore: setLedEnvMutex).
+  	to run and blink the appropriate Led. Since the specification is a copy queued in the
+  	mailbox, nothing another producerTask/consumerTask does in between can run over it - so
+  	sections B & C are no longer a critical section and need no Mutex Semaphore.
 
   4) Go back to the beginning of the while(TRUE) loop;
  */
@@ -253,16 +493,14 @@ void producerHandler(UArg arg0, UArg arg1);
 /*
  Function: consumerHandler(UArg arg0, UArg arg1)
 
- This is the handler function for the consumerTask (consumerTask1) and for all other
- consumerTasks added to the system (in this case: consumerTask2).
+ This is the handler function of every consumerTask - main creates NUM_CONSUMERS of them at
+ runtime (Topology_createUniform, see topology.h).
 
  This function implements the consumer behaviour and provides the infrastructure for the
  consumer to run forever! Therefore, this function runs in while(TRUE) loop.
  Remember, it must also:
 
-  1) Define a local structure of type LedBlinksInfo_T;
-
-  2) Recall, arg0 of this function holds the unique consumerID (you gave it in GUI definition).
+  1) Recall, arg0 of this function holds the unique consumerID (1..NUM_CONSUMERS, set by the topology).
      
 
  Then the while(TRUE) loop. Every iteration in this loop should perform the following:
@@ -279,33 +517,39 @@ void producerHandler(UArg arg0, UArg arg1);
 
  3) If no abnormal behaviour:
 
-  	A. Issue a Log message outputting the consumerID and the value of the item consumed;
+  	A. Issue a Log message outputting the consumerID and the value of the item consumed -
+  	   covered by remove_item's trace event, which carries the consumer id and the item;
 
-  	B. Set the Env of ledSrvTask (using Task_setEnv API function) to send it the up-to-dated
-  	   data for the Led Blink (i.e. sending it a pointer to the local LedBlinksInfo_T structure
-  	   that you must also update it with the proper information before that!)
+  	B. Send ledSrvTask the LED blinking specification for the item (copied by value into the
+  	   LED command mailbox - see requestLedBlinks).
 
   	C. Release ledSrvTask to work (by posting the Scheduling Constraint Semaphore
   	   ledSrvSchedSem, which ledSrvTask pends on).
 
   	Now, since ledSrvTask is the highest priority Task in the system, it will immediately get
-  	to run and blink the appropriate Led (according to the specification you updated in
-  	LedBlinksInfo_T structure and sent it to ledSrvTask's Env).
-
-  	However, what happens if current Task yielded (by timeSharingClk), just after setting the
-  	ledSrvTask's Env, but before posting ledSrvSchedSem (i.e. before releasing ledSrvTask)???
-  	Some other producerTask/consumerTask may set ledSrvTask's Env with their data -
-  	running over the data set by current Task...!!! Reminds you of something???
-  	Indeed, this is RACE CONDITION!!!
-
-  	This means that the ENTIRE CODE in sections B & C above is a CRITICAL SECTION!!!! It must,
-  	therefore, be protected by a Mutex Semaphore (we named this Mutex Semaphore: setLedEnvMutex).
+  	to run and blink the appropriate Led. Since the specification is a copy queued in the
+  	mailbox, nothing another producerTask/consumerTask does in between can run over it - so
+  	sections B & C are no longer a critical section and need no Mutex Semaphore.
 
   4) Go back to the beginning of the while(TRUE) loop;
  */
 void consumerHandler(UArg arg0, UArg arg1);
 
 
+/*
+ Function: stageHandler(UArg arg0, UArg arg1)
+
+ The handler function of every worker of a multi-stage pipeline (stage.h) - with STAGE_GRAPH,
+ main creates them from the stageGraph table (Stage_create). arg0 is the worker's topology id,
+ arg1 its stage index. The loop is the consumer's and the producer's in one: remove up to the
+ stage's batch from its input link with remove_items (a source has none), run the stage function
+ on them, and insert_items its results into the output link (a sink has none) - blocking on
+ either side like the producers and consumers, so a slow stage backs the flow up to the source.
+ A remove_items/insert_items failure is logged with the worker's id, as in the handlers above.
+ */
+void stageHandler(UArg arg0, UArg arg1);
+
+
 /*
  Function: ledSrvTaskHandler(void)
 
@@ -314,15 +558,14 @@ void consumerHandler(UArg arg0, UArg arg1);
  ledSrvSchedSem) - it will occupy the CPU exclusively! The role of this Task is to wait on the
  Scheduling Constraint Semaphore, ledSrvSchedSem, and whenever an event is posted it should:
 
-  - Read its own (SELF!!) environment data, in order to get the Led blinking specification (Recall:
-    consumerTask/producerTask updated ledSrvTask's Env with this specification, just before
-    posting ledSrvSchedSem). This is done by calling Task_getEnv API function on SELF (Recall: the
-    return value of Task_getEnv is of type Ptr (defined in BIOS as void *) - this should be
-    casted to LedBlinksInfo_T *, in this case).
+  - Fetch the queued Led blinking specifications from the LED command mailbox (Recall:
+    consumerTask/producerTask queued a copy of the specification, just before posting
+    ledSrvSchedSem). ledSrvSchedSem is a binary semaphore, so several posts may be folded into
+    one - ledSrvTask therefore drains ALL the queued commands on every wake-up.
 
-  - Blink the Led, according to the Led specification set by consumerTask/producerTask to
-   ledSrvTask's Env - this is, in fact, done by simply calling ledToggle function with the
-   parameters corresponding to the Led specification read from ledSrvTask's own Env!
+  - Blink the Led, according to each fetched specification - this is, in fact, done by simply
+   calling LedBlink_start with the parameters corresponding to the Led specification - which
+   returns at once, the blinking itself is timed by the ledBlinkClk Clock object!
 
   - get back to pend on ledSrvSchedSem Scheduling Constraint Semaphore.
 
@@ -334,39 +577,12 @@ void ledSrvTaskHandler(void);
 
 
 /*
- Function: void ledToggle(uint8_t selectedPort, uint16_t selectedPins, int times)
-
- This function is very similar to what you implemented in Lab 1: gets LED Port/Pin and times
- and toggles the corresponding LED times times.
-
- As you recall, a delay of 1/2 a second should be set between ON/OFF states of the Led.
- Note, in this project, you must use the delay function "delay" implemented here - see below
- (This delay function is similar to what you used in Lab 3, only that in this project, the Clock
- Module is set to tick every 500 microseconds, so the ~1/2 second delay value here is set with
- respect to 500 microseconds Clock tick - different to that in Lab3!).
-
- Recall, "delay" function consumes CPU Cycles for 1/2 second. You must use this function in the
- ledToggle function, rather than Task_sleep function, because Task_sleep function blocks on a
- timer for N milliseconds, and while blocking, another Task (with highest priority in the
- Ready Queue) gets to run, until Task unblocks from sleep! In this project, if you get
- ledSrvTask to release the CPU - you break the system requirements - and might get into
- trouble!!! Therefore, you have no choice, but to use a non-blocking delay here!
+ ledToggle/delay (which blinked the LED by consuming CPU Cycles for 1/2 second between ON/OFF
+ states - inside ledSrvTask, the highest priority Task, stopping the whole system meanwhile) are
+ replaced by the Clock driven blink engine in led_blink.h: ledSrvTask only queues the blinks
+ (LedBlink_start) and returns to pend on ledSrvSchedSem, and the ledBlinkClk Clock object
+ toggles the LED pins with the same 1/2 second timing.
  */
-void ledToggle(uint8_t selectedPort, uint16_t selectedPins, int times);
-
-
-/*
- Function: void delay(void)
-
- The delay function, used in lab 3. This function consumes CPU Cycles for 1/2 second.
- You must use this function in the LED toggling function, rather than Task_sleep function,
- because Task_sleep function blocks on a timer for N milliseconds, and while blocking, another
- Task (with highest priority in the Ready Queue) gets to run, until Task unblocks from sleep!
- In this project, if you get ledSrvTask to release the CPU - you break the system requirements
- - and might get into trouble!!! Therefore, you have no choice, but to use a non-blocking
- delay here!
- */
-void delay(void);
 
 
 /*
@@ -383,15 +599,21 @@ void tsClockHandler(void);
 
 
 /*
- Function: initArray(volatile Int *arr, Int size)
+ Function: void samplerIsr(UArg arg)
 
- This function initialises the shared buffer array to hold -1 in ALL its cells.
- Recall, -1 marks an empty cell in the shared buffer! Therefore, initially ALL cells are empty!
+ The Timer_A interrupt handler of the ISR producer - main creates its Timer with a period of
+ 1/ISR_PRODUCER_HZ seconds when ISR_PRODUCER_HZ is not 0. Every interrupt "samples" a 10 bit
+ reading (a stand-in for the ADC12 result register), scales it to an item of 1..MAX_VAL_NUM like
+ the producers' and try_insert_items it into the buffer given as arg - pipeline 0. A full buffer loses the sample (bbInsertDropped_e, counted in the
+ buffer's isrStats), exactly what happens to a sample the firmware doesn't pick up in time.
+ */
+void samplerIsr(UArg arg);
 
- Of course, this function must be invoked from main function to initialise the shared
- buffer array - before BIOS kernel objects start running!
+
+/*
+ The former initArray (-1 in ALL the cells of the shared buffer array, called from main) is
+ done by BoundedBuffer_create for every buffer it creates.
  */
-void initArray(volatile Int *arr, Int size);
 
 
 
@@ -401,27 +623,37 @@ void initArray(volatile Int *arr, Int size);
 
 
 /*
- The shared buffer array.
+ The bounded buffer of every pipeline - its producers and consumers get the handle as arg1.
  */
-volatile Int buffer[BUFFER_SIZE];
+BoundedBuffer_Handle pipelineBuffers[NUM_PIPELINES];
 
+#if ISR_PRODUCER_HZ
 /*
- This global variable always manages the next empty slot in the shared buffer - see the
- description of the functions: insert_item & remove_item.
+ The Timer of samplerIsr (Timer_ANY - a Timer_A instance the Clock module doesn't use).
  */
-volatile Int in = 0;
+static Timer_Struct samplerTimerObj;
+#endif
 
 /*
- This global variable always manages the next full slot in the shared buffer - see the
- description of the functions: insert_item & remove_item.
+ Traffic replayed by the producers with WORKLOAD_KIND 3 - (item, ticks to wait before it). Replace
+ it with a recorded trace to reproduce a field load.
  */
-volatile Int out = 0;
+static const WorkloadStep_T workloadTable[] = {
+	{3, 0}, {7, 0}, {1, 0}, {9, 2}, {4, 0}, {4, 0}, {0, 5}, {8, 0},
+	{2, 1}, {6, 0}, {5, 0}, {5, 0}, {1, 3}, {9, 0}, {7, 0}, {3, 8}
+};
 
+#if WINSTATS
 /*
- This global variable always manages the count of current full slots in the shared buffer -
- see the description of the functions: insert_item & remove_item.
+ Windows of every consumer's statistics (winstats.h): the last 64 items, tumbling, and the last
+ second, sliding every 250 ms (4 panes of 500 ticks at the 500 usec Clock tick). Buckets 2 wide
+ from 0, so items up to MAX_VAL_NUM fill the first six.
  */
-volatile Int count = 0;
+static const WinStatsDef_T consumerWindows[] = {
+	{winStatsCount_e, 1, 64, 0, 1},
+	{winStatsTicks_e, 4, 500, 0, 1}
+};
+#endif
 
 
 //---------------------------------------------------------------------------
@@ -432,8 +664,70 @@ void main(void)
 	/*
 	 Remember to do all necessary initialisations here.
 	 */
-	Semaphore_reset(emptySlots, BUFFER_SIZE);	// initialize the semaphore value to the buffer size, so it will behave in a generic way, means if buffer size changes so as the emptySlots semaphore initial value.
-	initArray(buffer, BUFFER_SIZE);				// initialize the bounded buffer's cells to -1 which means empty array
+#if !STAGE_GRAPH && !MICROBENCH
+	Int p = 0;
+#endif
+	Task_Handle hogTask, probeTask;
+
+
+	LedMailbox_init();							// empty LED command mailbox to ledSrvTask
+	LedBlink_init();							// all LEDs idle - ledBlinkClk does the blinking
+	Latency_init();								// empty latency histograms (latency.h)
+	WinStats_init();							// empty pool of the consumers' statistics engines (winstats.h)
+	Trace_init();								// empty event trace ring (trace.h)
+#if TRACE_DUMP_SIZE
+	Trace_setSink(Trace_dumpSink);				// the first events into traceDump, for the debugger
+#endif
+	TimeSlice_init();							// time-slice counters and budgets (timeslice.h)
+	Record_init();								// empty interleaving record (record.h)
+#if RECORD_DUMP_SIZE
+	Record_setSink(Record_dumpSink);			// the record into recordDump, for a host replay
+#endif
+	CpuAcct_reset();							// empty per-task CPU accounting (cpuacct.h)
+	StackProf_init();							// empty stack high-water marks (stackprof.h)
+	StackProf_watch(ledSrvTask);
+#if TRACE_EVENTS || RECORD_INTERLEAVING || STACK_PROFILE
+	StackProf_watch(Trace_createDrainTask(TRACE_DRAIN_PRIORITY, TRACE_DRAIN_STACK_SIZE));	// empties the trace and record rings every TRACE_DRAIN_TICKS
+#endif
+
+#if MICROBENCH
+	StackProf_watch(MicroBench_start());		// the primitives' microbenchmarks on a quiet system, instead of the pipelines
+#elif STAGE_GRAPH
+	Stage_create(&stageGraph, stageHandler);	// links and workers of the stage graph, instead of the pipelines
+#else
+	for(p = 0 ; p < NUM_PIPELINES ; p++) {
+#if QUEUE_ENGINE == QUEUE_ENGINE_LANES
+		pipelineBuffers[p] = BoundedBuffer_createLanes(NUM_LANES, BUFFER_SIZE, LANE_STARVE_QUOTA);	// BUFFER_SIZE / NUM_LANES slots per lane
+#else
+		pipelineBuffers[p] = BoundedBuffer_create((BBEngine_E)QUEUE_ENGINE, BUFFER_SIZE);	// empty buffer (-1 in all cells), emptySlots = BUFFER_SIZE
+#endif
+		if(pipelineBuffers[p] == NULL) {
+			Log_error1("No bounded buffer for pipeline %d - BoundedBuffer_create logged why.\n", p); //error log
+			System_abort("pipeline buffer not created\n");
+		}
+		BoundedBuffer_setPolicy(pipelineBuffers[p], (BBPolicy_E)BACKPRESSURE_POLICY, BACKPRESSURE_PARAM);
+		Topology_createUniform(producerHandler, NUM_PRODUCERS,	// producer/consumer Tasks, no longer static in empty.cfg
+				consumerHandler, NUM_CONSUMERS, WORKER_PRIORITY, WORKER_STACK_SIZE, (UArg)pipelineBuffers[p]);
+	}
+#endif
+	if(pipelineBuffers[0] != NULL) {
+		Inversion_start(pipelineBuffers[0], &hogTask, &probeTask);	// no Tasks without INVERSION_SCENARIO
+		StackProf_watch(hogTask);
+		StackProf_watch(probeTask);
+	}
+#if ISR_PRODUCER_HZ
+	if(pipelineBuffers[0] != NULL) {
+		Timer_Params timerParams;
+
+		Timer_Params_init(&timerParams);
+		timerParams.instance->name = "samplerTimer";
+		timerParams.period = 1000000 / ISR_PRODUCER_HZ;	// microseconds
+		timerParams.periodType = Timer_PeriodType_MICROSECS;
+		timerParams.startMode = Timer_StartMode_AUTO;		// runs from BIOS_start on
+		timerParams.arg = (UArg)pipelineBuffers[0];
+		Timer_construct(&samplerTimerObj, Timer_ANY, samplerIsr, &timerParams, NULL);
+	}
+#endif
 
 	hardware_init();							// init hardware via Xware
 
@@ -484,111 +778,739 @@ void hardware_init(void)					//called by main
 
 /*
  * Function: insert_item
- * Description: insert item into the buffer.
- * Input: Int item - hold the random integer sent by the producerHandler.
- * Output: Bool - return true if succesfuly insert and item which is a normal behavior, false otherwise which is abnormal behavior of the system.
- * Algorithm: Works as the producer algorithm work as given in lecture 8 page 63 but in such manner that it returns true if succesfuly inserts an
- * 			  item which is a normal behavior and issue a log about it and release semaphores, false otherwise which is abnormal behavior of the
- * 			  system and issue a log about it and release all "taken" semaphores.
+ * Description: insert item into the routine lane (0) of the bounded buffer bb.
+ * Input: BoundedBuffer_Handle bb - the pipeline's buffer, Int item - the item.
+ * Output: BBStatus_E - see insert_item_lane.
+ * Algorithm: insert_item_lane(bb, item, 0).
+*/
+BBStatus_E insert_item(BoundedBuffer_Handle bb, Int item) {
+	return insert_item_lane(bb, item, 0);
+}
+
+/*
+ * Function: pushCell
+ * Description: push an item into an MPMC ring the caller holds a free slot token of.
+ * Input: BoundedBuffer_Handle bb - the buffer, MpmcRing_T *ring - its ring or lane, Int item, const RingTag_T *tag.
+ * Output: Bool - FALSE only if the free cell never came (an anomaly).
+ * Algorithm: the token may stand for a cell a preempted consumer claimed but did not hand back yet (see
+ * 			  bounded_buffer.h) - wait for it with BoundedBuffer_awaitCell and push again.
+*/
+static Bool pushCell(BoundedBuffer_Handle bb, MpmcRing_T *ring, Int item, const RingTag_T *tag) {
+	Int attempt = 0;
+
+	while(!MpmcRing_pushTagged(ring, item, tag)) {
+		if(!BoundedBuffer_awaitCell(bb, attempt)) {
+			return FALSE;
+		}
+		attempt = attempt + 1;
+	}
+	return TRUE;
+}
+
+/*
+ * Function: popCell
+ * Description: pop an item from an MPMC ring the caller holds an item token of.
+ * Input: BoundedBuffer_Handle bb - the buffer, MpmcRing_T *ring - its ring, Int *item, RingTag_T *tag - receive the item.
+ * Output: Bool - FALSE only if the item never got published (an anomaly).
+ * Algorithm: mirror image of pushCell - the token's cell may be claimed by a preempted producer that did
+ * 			  not publish it yet.
 */
-Bool insert_item(Int item) {
+static Bool popCell(BoundedBuffer_Handle bb, MpmcRing_T *ring, Int *item, RingTag_T *tag) {
+	Int attempt = 0;
+
+	while(!MpmcRing_popTagged(ring, item, tag)) {
+		if(!BoundedBuffer_awaitCell(bb, attempt)) {
+			return FALSE;
+		}
+		attempt = attempt + 1;
+	}
+	return TRUE;
+}
+
+/*
+ * Function: storeItem
+ * Description: the second half of insert_item_lane - store an item in the free slot reserved for it.
+ * Input: BoundedBuffer_Handle bb - the buffer, Int item - the item, Int lane - its lane (clamped),
+ * 		  BBStatus_E status - the reservation, bbInsertOk_e or bbInsertOverwrote_e.
+ * Output: BBStatus_E - status, or bbInsertError_e on abnormal behavior of the system.
+ * Algorithm: the ring engines push the item lock-free (waiting for a claimed cell, pushCell), the locked engine
+ * 			  stores it in the critical section -
+ * 			  discarding the oldest item first for bbInsertOverwrote_e. The item is stamped (latency.h) as it is
+ * 			  stored, then fullSlots is posted. Also how remove_item moves spooled items back into the buffer.
+*/
+static BBStatus_E storeItem(BoundedBuffer_Handle bb, Int item, Int lane, BBStatus_E status) {
+	RingTag_T tag;
+	IArg key;						// of the mutex (locked engine)
+	Int slots = (bb->engine == bbEngineLanes_e) ? lane : 0;	// the lane whose free slot the item took
+
+	if(bb->engine != bbEngineLocked_e) {
+		Bool pushed;
+		LATENCY_STAMP(&tag, lane);		// stamped once the slot is ours - the wait for it is not residency
+		if(bb->engine == bbEngineSpsc_e) {
+			pushed = SpscRing_pushTagged(&bb->spsc, item, &tag);
+		} else if(bb->engine == bbEngineMpmc_e) {
+			pushed = pushCell(bb, &bb->mpmc, item, &tag);
+		} else {
+			pushed = pushCell(bb, &bb->laneState->ring[lane], item, &tag);
+		}
+		RECORD_POINT();
+		if(!pushed) {					// emptySlots promised a free slot - abnormal behaviour.
+			Log_info1("ERROR! Can't insert an item into full ring lane %d.\n", slots); //error log
+			RECORD_ANOMALY();
+			Semaphore_post(bb->laneEmpty[slots]); // give the unused slot back
+			return bbInsertError_e;
+		}
+		Semaphore_post(bb->fullSlots); // post fullSlots Counting Sem - one readiness signal for all the lanes
+		return status;
+	}
+
 	/* Semaphores pend */
-	Semaphore_pend(emptySlots, BIOS_WAIT_FOREVER); // pend emptySlots Counting Sem
-	Semaphore_pend(mutex, BIOS_WAIT_FOREVER); // pend Mutex Sem
+	key = BoundedBuffer_lock(bb); // pend Mutex (priority inheritance gate, see bounded_buffer.h)
+	RECORD_POINT();
 
 	/* Critical Section */
-	if(buffer[in] != -1) { 			// if trying to insert item into non empty slot.
+	if(status == bbInsertOverwrote_e && bb->storage[bb->out] != -1) {	// overwrite - discard the oldest item to free its slot
+		bb->storage[bb->out] = -1;
+		bb->out = (bb->out + 1) & bb->mask;
+		bb->count = bb->count - 1;
+		bb->policyStats.overwrites = bb->policyStats.overwrites + 1;	// written inside the mutex only
+	}
+	if(bb->storage[bb->in] != -1) { 			// if trying to insert item into non empty slot.
 		Log_info0("ERROR! Can't insert an item into a non-empty slot.\n"); //error log
+		RECORD_ANOMALY();
 		/* End of Critical Section */
-		Semaphore_post(mutex); // post Mutex Sem
-		Semaphore_post(fullSlots); // post fullSlots Counting Sem
-		return FALSE;
+		BoundedBuffer_unlock(bb, key); // post Mutex
+		Semaphore_post(bb->fullSlots); // post fullSlots Counting Sem
+		return bbInsertError_e;
 	} else {
-		count = (count + 1);
-		buffer[in] = item;
-		in = (in + 1)%BUFFER_SIZE; // cyclic buffer implementation so the next in won't surpass the index boundry of the buffer.
-		Log_info2("Success! buffer produced item is: %d, number of currently full slots is: %d\n", item, count); //success log
+		bb->count = (bb->count + 1);
+		bb->storage[bb->in] = item;
+		if(bb->tags != NULL) {
+			LATENCY_STAMP(&bb->tags[bb->in], lane);
+		}
+		bb->in = (bb->in + 1) & bb->mask; // cyclic buffer - the capacity is a power of two, so masking replaces % (no division on the MSP430).
+		RECORD_POINT();
 		/* End of Critical Section */
-		Semaphore_post(mutex); // post Mutex Sem
-		Semaphore_post(fullSlots); // post fullSlots Counting Sem
-		return TRUE;
+		BoundedBuffer_unlock(bb, key); // post Mutex
+		Semaphore_post(bb->fullSlots); // post fullSlots Counting Sem
+		return status;
+	}
+}
+
+/*
+ * Function: insert_item_lane
+ * Description: insert item into priority lane "lane" of the bounded buffer bb.
+ * Input: BoundedBuffer_Handle bb - the pipeline's buffer, Int item - hold the random integer sent by the producerHandler.
+ * Output: BBStatus_E - bbInsertOk_e/bbInsertOverwrote_e if succesfuly inserted, bbInsertSpooled_e if spooled,
+ * 		   bbInsertDropped_e/bbInsertTimeout_e if the buffer's backpressure policy gave the item up, bbInsertError_e on
+ * 		   abnormal behavior of the system.
+ * Algorithm: Works as the producer algorithm work as given in lecture 8 page 63 but in such manner that it returns OK if succesfuly inserts an
+ * 			  item which is a normal behavior and issue a log about it and release semaphores, an error otherwise which is abnormal behavior of the
+ * 			  system and issue a log about it and release all "taken" semaphores.
+ * 			  The pend on emptySlots is BoundedBuffer_reserveSlot, which blocks, times out, drops or hands over an item
+ * 			  to overwrite as the buffer's policy says (bounded_buffer.h) - the oldest item is then discarded before the new
+ * 			  one is stored, and the fullSlots token taken for it is posted back as usual.
+ * 			  With a ring engine the mutex is not used at all - emptySlots/fullSlots are only used to block while the ring
+ * 			  is full, and the slot itself is claimed lock-free by the ring engine (see ring.h).
+ * 			  The item is stamped with its insertion time, producer and lane (latency.h) in the same step as it is stored.
+ * 			  A lanes buffer reserves a slot of the item's own lane (laneEmpty) and pushes into the lane's MPMC ring.
+ * 			  A bbPolicySpool_e buffer first offers the item to the spool (BoundedBuffer_spoolItem), which takes it above
+ * 			  the high-water mark - the buffer is then not waited for at all.
+ * 			  RECORD_POINTs between the steps place the recorded ticks for a replay (record.h).
+ * 			  The store itself is storeItem.
+*/
+BBStatus_E insert_item_lane(BoundedBuffer_Handle bb, Int item, Int lane) {
+	BBStatus_E status;
+	Int slots = 0;					// the lane whose free slots the item takes - 0 but for a lanes buffer
+
+	if(bb->engine == bbEngineLanes_e) {
+		lane = (lane >= 0 && lane < bb->lanes) ? lane : 0;	// a lane the buffer doesn't have is routine - it never jumps the queue
+		slots = lane;
+	}
+	RECORD_POINT();
+	if(bb->policy == bbPolicySpool_e) {
+		status = BoundedBuffer_spoolItem(bb, item);	// above the high-water mark, or behind spooled items - to the spool
+		if(status != bbInsertOk_e) {
+			TRACE_EVENT((status == bbInsertSpooled_e) ? traceSpool_e : traceDrop_e, item);
+			return status;
+		}
+		RECORD_POINT();
+	}
+	status = BoundedBuffer_reserveSlot(bb, slots);	// pend emptySlots Counting Sem, as the backpressure policy allows
+	RECORD_POINT();
+	if(status == bbInsertDropped_e || status == bbInsertTimeout_e) {
+		TRACE_EVENT(traceDrop_e, item);	// counted in bb->policyStats
+		return status;
+	}
+	if(status == bbInsertOverwrote_e && bb->engine != bbEngineLocked_e && !BoundedBuffer_evictOldest(bb, slots)) {
+		Semaphore_post(bb->fullSlots);	// the item token stands for another lane's item - give it back
+		CPUACCT_PEND(bb->laneEmpty[slots], BIOS_WAIT_FOREVER, cpuWaitEmptySlots_e);	// and wait for a slot of our own lane
+		status = bbInsertOk_e;
+		RECORD_POINT();
+	}
+
+	status = storeItem(bb, item, lane, status);
+	if(status != bbInsertError_e) {
+		TRACE_EVENT(traceInsert_e, item); // success trace event, replaces the formatted success Log
+	}
+	return status;
+}
+
+/*
+ * Function: try_insert_item
+ * Description: insert item into the routine lane (0) of bb from an ISR, without blocking.
+ * Input: BoundedBuffer_Handle bb - the buffer, Int item - the item.
+ * Output: BBStatus_E - see try_insert_item_lane.
+ * Algorithm: try_insert_item_lane(bb, item, 0).
+*/
+BBStatus_E try_insert_item(BoundedBuffer_Handle bb, Int item) {
+	return try_insert_item_lane(bb, item, 0);
+}
+
+/*
+ * Function: try_insert_item_lane
+ * Description: insert item into priority lane "lane" of bb from a Hwi/Swi, without blocking.
+ * Input: BoundedBuffer_Handle bb - the buffer, Int item - the item, Int lane - its lane.
+ * Output: BBStatus_E - bbInsertOk_e if inserted, bbInsertDropped_e if there was no free slot or
+ * 		   the mutex was busy, bbInsertError_e on abnormal behavior of the system.
+ * Algorithm: insert_item_lane with BIOS_NO_WAIT pends: take a free slot token of the lane - none
+ * 			  is an overflow. A ring engine then pushes the item lock-free; the locked engine
+ * 			  tries the mutex - busy means a Task was preempted inside its critical section, so
+ * 			  the slot token is given back and the item dropped. Then post fullSlots, which
+ * 			  readies a waiting consumer; SYS/BIOS runs it once the ISR returns.
+ * 			  No RECORD_POINT/TRACE_EVENT - see the prototype.
+*/
+BBStatus_E try_insert_item_lane(BoundedBuffer_Handle bb, Int item, Int lane) {
+	RingTag_T tag;
+	Int slots = 0;					// the lane whose free slots the item takes - 0 but for a lanes buffer
+
+	if(bb->engine == bbEngineLanes_e) {
+		lane = (lane >= 0 && lane < bb->lanes) ? lane : 0;
+		slots = lane;
+	}
+	if(!Semaphore_pend(bb->laneEmpty[slots], BIOS_NO_WAIT)) {	// full - an ISR can't wait for a slot
+		bb->isrStats.overflows = bb->isrStats.overflows + 1;
+		return bbInsertDropped_e;
+	}
+
+	if(bb->engine != bbEngineLocked_e) {
+		Bool pushed;
+		LATENCY_STAMP_ISR(&tag, lane);
+		if(bb->engine == bbEngineSpsc_e) {
+			pushed = SpscRing_pushTagged(&bb->spsc, item, &tag);
+		} else if(bb->engine == bbEngineMpmc_e) {
+			pushed = MpmcRing_pushTagged(&bb->mpmc, item, &tag);
+		} else {
+			pushed = MpmcRing_pushTagged(&bb->laneState->ring[lane], item, &tag);
+		}
+		if(!pushed) {					// the interrupted Task claimed the free cell and did not hand it back yet
+			Semaphore_post(bb->laneEmpty[slots]); // give the slot back - an ISR can't wait for the cell
+			bb->isrStats.busy = bb->isrStats.busy + 1;
+			bb->isrStats.overflows = bb->isrStats.overflows + 1;
+			return bbInsertDropped_e;
+		}
+		bb->isrStats.inserts = bb->isrStats.inserts + 1;
+		Semaphore_post(bb->fullSlots); // ready a consumer - it runs when the ISR returns
+		return bbInsertOk_e;
+	}
+
+	if(!BoundedBuffer_tryLockIsr(bb)) {	// the interrupted Task is in the critical section (or BB_MUTEX_PI)
+		Semaphore_post(bb->emptySlots);				// give the slot back
+		bb->isrStats.busy = bb->isrStats.busy + 1;
+		bb->isrStats.overflows = bb->isrStats.overflows + 1;
+		return bbInsertDropped_e;
 	}
+	/* Critical Section */
+	if(bb->storage[bb->in] != -1) {
+		Log_info0("ERROR! ISR can't insert an item into a non-empty slot.\n"); //error log
+		/* End of Critical Section */
+		BoundedBuffer_unlockIsr(bb);
+		Semaphore_post(bb->fullSlots);
+		return bbInsertError_e;
+	}
+	bb->count = (bb->count + 1);
+	bb->storage[bb->in] = item;
+	if(bb->tags != NULL) {
+		LATENCY_STAMP_ISR(&bb->tags[bb->in], lane);
+	}
+	bb->in = (bb->in + 1) & bb->mask;
+	/* End of Critical Section */
+	BoundedBuffer_unlockIsr(bb);
+	bb->isrStats.inserts = bb->isrStats.inserts + 1;
+	Semaphore_post(bb->fullSlots);
+	return bbInsertOk_e;
+}
+
+/*
+ * Function: refillFromSpool
+ * Description: move the oldest spooled items of a bbPolicySpool_e buffer into its free slots.
+ * Input: BoundedBuffer_Handle bb - the buffer.
+ * Output: void
+ * Algorithm: nothing to do while the spool is empty - checked without the lock. Otherwise, under the spool's lock,
+ * 			  as long as there is a spooled item and a free slot (a BIOS_NO_WAIT pend on emptySlots): store the
+ * 			  oldest item as insert_item would (storeItem), and only then take it out of the spool - so a producer
+ * 			  finding the spool empty knows its spooled items are already in the buffer, ahead of its next one.
+*/
+static void refillFromSpool(BoundedBuffer_Handle bb) {
+	IArg key;
+	Int item;
+
+	if(Spool_pending() == 0) {
+		return;
+	}
+	key = Spool_lock();
+	while(Spool_peek(&item) && RECORD_PEND(bb->emptySlots, BIOS_NO_WAIT)) {
+		if(storeItem(bb, item, 0, bbInsertOk_e) == bbInsertError_e) {
+			break;
+		}
+		Spool_advance();
+		TRACE_EVENT(traceUnspool_e, item);
+	}
+	Spool_unlock(key);
 }
 
 /*
  * Function: remove_item
- * Description: removes an item from the bounded buffer.
- * Input: pointer to int which it name is item and will hold removed item.
+ * Description: removes an item from the bounded buffer bb.
+ * Input: BoundedBuffer_Handle bb - the pipeline's buffer, pointer to int which it name is item and will hold removed item.
  * Output: Bool - TRUE or FALSE depend on the if the buffer in this place eg. out is == -1 if yes
  * 		   then FALSE, TRUE otherwise.
  * Algorithm: pended on mutex and fullSlots semaphores, then when enter the critic sec. check if buffer
  * 			  in the current out position is empty if it is can't consume return FALSE issue compitable
  * 			  Log msg and post mutex and fullSlots.
+ * 			  With a ring engine the mutex is not used at all - emptySlots/fullSlots are only used to block while the ring
+ * 			  is empty, and the item itself is taken lock-free by the ring engine (see ring.h) - after waiting for a
+ * 			  cell that a preempted producer claimed but did not publish yet (popCell, bounded_buffer.h).
+ * 			  The item's tag is taken with it, and its latency is recorded after the critical section.
+ * 			  A lanes buffer takes the item of the highest non-empty lane (BoundedBuffer_popLane) and
+ * 			  frees a slot of that lane.
+ * 			  A bbPolicySpool_e buffer is topped up from the spool first (refillFromSpool).
+ * 			  RECORD_POINTs between the steps place the recorded ticks for a replay (record.h).
 */
-Bool remove_item(Int *item) {
+Bool remove_item(BoundedBuffer_Handle bb, Int *item) {
+	RingTag_T tag;
+	IArg key;						// of the mutex (locked engine)
+
+	if(bb->policy == bbPolicySpool_e) {
+		refillFromSpool(bb);		// the spooled items come before anything inserted later
+	}
+
+	if(bb->engine == bbEngineLanes_e) {
+		Int lane;
+		RECORD_POINT();
+		CPUACCT_PEND(bb->fullSlots, BIOS_WAIT_FOREVER, cpuWaitFullSlots_e); // blocks only while every lane is empty
+		RECORD_POINT();
+		lane = BoundedBuffer_popLane(bb, item, &tag);
+		RECORD_POINT();
+		if(lane < 0) {					// the token's item was never published - abnormal behaviour.
+			Log_info0("ERROR! Can't remove an item from the empty lanes.\n"); //error log
+			RECORD_ANOMALY();
+			Semaphore_post(bb->fullSlots);  // give the unused item token back
+			return FALSE;
+		}
+		Semaphore_post(bb->laneEmpty[lane]); // post the lane's empty slots Counting Sem
+		LATENCY_RECORD(&tag);
+		TRACE_EVENT(traceRemove_e, *item);
+		return TRUE;
+	}
+
+	if(bb->engine != bbEngineLocked_e) {
+		Bool popped;
+		RECORD_POINT();
+		CPUACCT_PEND(bb->fullSlots, BIOS_WAIT_FOREVER, cpuWaitFullSlots_e); // blocks only while the ring is empty
+		RECORD_POINT();
+		if(bb->engine == bbEngineSpsc_e) {
+			popped = SpscRing_popTagged(&bb->spsc, item, &tag);
+		} else {
+			popped = popCell(bb, &bb->mpmc, item, &tag);	// waits while the token's cell is claimed, not published
+		}
+		RECORD_POINT();
+		if(!popped) {					// fullSlots promised an item - abnormal behaviour.
+			Log_info0("ERROR! Can't remove an item from an empty ring.\n"); //error log
+			RECORD_ANOMALY();
+			Semaphore_post(bb->fullSlots);  // give the unused item token back
+			return FALSE;
+		}
+		Semaphore_post(bb->emptySlots); // post emptySlots Counting Sem
+		LATENCY_RECORD(&tag);
+		TRACE_EVENT(traceRemove_e, *item); // success trace event, replaces the formatted success Log
+		return TRUE;
+	}
+
 	/* Semaphores pend */
-	Semaphore_pend(fullSlots, BIOS_WAIT_FOREVER); // pend emptySlots Counting Sem
-	Semaphore_pend(mutex, BIOS_WAIT_FOREVER); // pend Mutex Sem
+	RECORD_POINT();
+	CPUACCT_PEND(bb->fullSlots, BIOS_WAIT_FOREVER, cpuWaitFullSlots_e); // pend emptySlots Counting Sem
+	RECORD_POINT();
+	key = BoundedBuffer_lock(bb); // pend Mutex (priority inheritance gate, see bounded_buffer.h)
+	RECORD_POINT();
 
 	/* Critical Section */
-	if(buffer[out] == -1) { 			// if trying to remove item from an empty slot.
+	if(bb->storage[bb->out] == -1) { 			// if trying to remove item from an empty slot.
 		Log_info0("ERROR! Can't remove an item from an empty slot.\n"); //error log
+		RECORD_ANOMALY();
 		/* End of Critical Section */
 
-		Semaphore_post(mutex); // post Mutex Sem
-		Semaphore_post(emptySlots); // post emptySlots Counting Sem
+		BoundedBuffer_unlock(bb, key); // post Mutex
+		Semaphore_post(bb->emptySlots); // post emptySlots Counting Sem
 		return FALSE;
 	} else {
-		count = (count - 1);
-		*item = buffer[out];
-		buffer[out] = -1;
-		out = (out + 1)%BUFFER_SIZE; // cyclic buffer implementation so the next in won't surpass the index boundry of the buffer.
-		Log_info2("Success! buffer consumed item is: %d, number of currently full slots is: %d\n", *item, count); //success log
+		bb->count = (bb->count - 1);
+		*item = bb->storage[bb->out];
+		bb->storage[bb->out] = -1;
+		if(bb->tags != NULL) {
+			tag = bb->tags[bb->out];
+		}
+		bb->out = (bb->out + 1) & bb->mask; // cyclic buffer - the capacity is a power of two, so masking replaces % (no division on the MSP430).
+		RECORD_POINT();
 		/* End of Critical Section */
 
-		Semaphore_post(mutex); // post Mutex Sem
-		Semaphore_post(emptySlots); // post emptySlots Counting Sem
+		BoundedBuffer_unlock(bb, key); // post Mutex
+		Semaphore_post(bb->emptySlots); // post emptySlots Counting Sem
+		LATENCY_RECORD(&tag);
+		TRACE_EVENT(traceRemove_e, *item); // success trace event, outside the critical section
 		return TRUE;
 	}
 }
 
+/*
+ * Function: acquireSlots
+ * Description: reserve between 1 and max tokens of a counting semaphore (emptySlots/fullSlots).
+ * Input: Semaphore_Handle sem - the counting semaphore, Int max - the maximum number of tokens wanted,
+ * 		  CpuWait_E wait - what a block on sem is charged to (cpuacct.h).
+ * Output: Int - the number of tokens taken (at least 1).
+ * Algorithm: one blocking pend for the first token, then non-blocking pends for as many of the
+ * 			  remaining tokens as are currently available.
+*/
+static Int acquireSlots(Semaphore_Handle sem, Int max, CpuWait_E wait) {
+	Int taken = 1;
+	CPUACCT_PEND(sem, BIOS_WAIT_FOREVER, wait); // block until at least one token
+	RECORD_POINT();
+	while(taken < max && RECORD_PEND(sem, BIOS_NO_WAIT)) {
+		taken = taken + 1;
+	}
+	return taken;
+}
+
+/*
+ * Function: releaseSlots
+ * Description: give n tokens to a counting semaphore (emptySlots/fullSlots).
+ * Input: Semaphore_Handle sem - the counting semaphore, Int n - number of tokens.
+ * Output: void
+ * Algorithm: the posts are done with the Task scheduler disabled, so every task made ready by
+ * 			  them is scheduled once, when Task_restore is called, and not once per post.
+*/
+static void releaseSlots(Semaphore_Handle sem, Int n) {
+	UInt key = Task_disable();
+	while(n > 0) {
+		Semaphore_post(sem);
+		n = n - 1;
+	}
+	Task_restore(key);
+}
+
+/*
+ * Function: insert_items
+ * Description: insert up to n items into the bounded buffer bb with one reservation and one critical section.
+ * Input: BoundedBuffer_Handle bb - the pipeline's buffer, const Int *src - the items, Int n - number of items in src,
+ * 		  BBStatus_E *status - receives bbInsertOk_e, or bbInsertError_e on abnormal behavior (may be NULL).
+ * Output: Int - number of items inserted (0..n), on abnormal behavior too.
+ * Algorithm: reserve k slots (acquireSlots on emptySlots), then in one mutex critical section copy
+ * 			  the k items as a run starting at "in" - the run is split into [in, capacity) and
+ * 			  [0, rest) when it wraps, so there is no index wrap per item - then post k fullSlots at once.
+ * 			  Ring engines push the k items lock-free instead of the critical section, a lanes buffer
+ * 			  into its routine lane 0 (whose laneEmpty is emptySlots).
+*/
+Int insert_items(BoundedBuffer_Handle bb, const Int *src, Int n, BBStatus_E *status) {
+	RingTag_T tag;
+	IArg key;						// of the mutex (locked engine)
+	Int reserved, inserted = 0;
+
+	if(status != NULL) {
+		*status = bbInsertOk_e;
+	}
+	if(n <= 0) {
+		return 0;
+	}
+	RECORD_POINT();
+	reserved = acquireSlots(bb->emptySlots, n, cpuWaitEmptySlots_e);
+
+	if(bb->engine == bbEngineSpsc_e) {
+		while(inserted < reserved) {
+			LATENCY_STAMP(&tag, 0);
+			if(!SpscRing_pushTagged(&bb->spsc, src[inserted], &tag)) {
+				break;
+			}
+			inserted = inserted + 1;
+		}
+	} else if(bb->engine == bbEngineMpmc_e || bb->engine == bbEngineLanes_e) {
+		MpmcRing_T *ring = (bb->engine == bbEngineLanes_e) ? &bb->laneState->ring[0] : &bb->mpmc;
+		while(inserted < reserved) {
+			LATENCY_STAMP(&tag, 0);
+			if(!pushCell(bb, ring, src[inserted], &tag)) {
+				break;
+			}
+			inserted = inserted + 1;
+		}
+	} else {
+		Int idx, end;
+		key = BoundedBuffer_lock(bb); // pend Mutex (priority inheritance gate, see bounded_buffer.h)
+		RECORD_POINT();
+		/* Critical Section */
+		idx = bb->in;
+		while(inserted < reserved) {
+			end = idx + (reserved - inserted);	// contiguous run up to the wrap point
+			if(end > bb->capacity) {
+				end = bb->capacity;
+			}
+			while(idx < end && bb->storage[idx] == -1) {
+				bb->storage[idx] = src[inserted];
+				if(bb->tags != NULL) {
+					LATENCY_STAMP(&bb->tags[idx], 0);
+				}
+				idx = idx + 1;
+				inserted = inserted + 1;
+			}
+			if(idx < end) {		// trying to insert item into non empty slot.
+				break;
+			}
+			idx = idx & bb->mask;
+		}
+		bb->in = idx & bb->mask;
+		bb->count = bb->count + inserted;
+		RECORD_POINT();
+		/* End of Critical Section */
+		BoundedBuffer_unlock(bb, key); // post Mutex
+	}
+
+	RECORD_POINT();
+	if(inserted < reserved) {
+		Log_info2("ERROR! Can't insert an item into a non-empty slot, %d of %d reserved slots used.\n", inserted, reserved); //error log
+		RECORD_ANOMALY();
+		releaseSlots(bb->emptySlots, reserved - inserted);	// give the unused slots back
+		if(status != NULL) {
+			*status = bbInsertError_e;
+		}
+	}
+	if(inserted > 0) {
+		releaseSlots(bb->fullSlots, inserted);
+		TRACE_EVENT(traceInsertBatch_e, inserted); // success trace event
+	}
+	return inserted;			// the inserted items are committed even on abnormal behavior
+}
+
+/*
+ * Function: remove_items
+ * Description: remove up to max items from the bounded buffer bb with one reservation and one critical section.
+ * Input: BoundedBuffer_Handle bb - the pipeline's buffer, Int *dst - receives the items, Int max - room in dst,
+ * 		  Bool *ok - receives FALSE on abnormal behavior, TRUE otherwise (may be NULL).
+ * Output: Int - number of items removed (0..max), on abnormal behavior too.
+ * Algorithm: mirror image of insert_items - reserve k items on fullSlots, copy the run starting
+ * 			  at "out" (marking every consumed cell -1) in one critical section, post k emptySlots.
+ * 			  Every item's latency is recorded as it is taken. A lanes buffer takes the items lane by lane
+ * 			  with BoundedBuffer_popLane and frees the slots of the lanes they came from. A bbPolicySpool_e
+ * 			  buffer is topped up from the spool first, as in remove_item.
+*/
+Int remove_items(BoundedBuffer_Handle bb, Int *dst, Int max, Bool *ok) {
+	RingTag_T tag;
+	IArg key;						// of the mutex (locked engine)
+	Int reserved, removed = 0;
+
+	if(ok != NULL) {
+		*ok = TRUE;
+	}
+	if(max <= 0) {
+		return 0;
+	}
+	if(bb->policy == bbPolicySpool_e) {
+		refillFromSpool(bb);
+	}
+	RECORD_POINT();
+	reserved = acquireSlots(bb->fullSlots, max, cpuWaitFullSlots_e);
+
+	if(bb->engine == bbEngineSpsc_e) {
+		while(removed < reserved && SpscRing_popTagged(&bb->spsc, &dst[removed], &tag)) {
+			LATENCY_RECORD(&tag);
+			removed = removed + 1;
+		}
+	} else if(bb->engine == bbEngineMpmc_e) {
+		while(removed < reserved && popCell(bb, &bb->mpmc, &dst[removed], &tag)) {
+			LATENCY_RECORD(&tag);
+			removed = removed + 1;
+		}
+	} else if(bb->engine == bbEngineLanes_e) {
+		Int freed[BB_MAX_LANES] = {0};
+		Int l;
+		while(removed < reserved) {	// every reserved token is a claimed cell - popLane waits for it to be published
+			l = BoundedBuffer_popLane(bb, &dst[removed], &tag);
+			if(l < 0) {
+				break;
+			}
+			freed[l] = freed[l] + 1;
+			LATENCY_RECORD(&tag);
+			removed = removed + 1;
+		}
+		for(l = 0 ; l < bb->lanes ; l++) {
+			if(freed[l] > 0) {
+				releaseSlots(bb->laneEmpty[l], freed[l]);
+			}
+		}
+		if(removed < reserved) {	// a token's item was never published - abnormal behaviour.
+			Log_info2("ERROR! Can't remove an item from the empty lanes, %d of %d reserved items removed.\n", removed, reserved); //error log
+			RECORD_ANOMALY();
+			releaseSlots(bb->fullSlots, reserved - removed);	// give the unused items back
+			if(ok != NULL) {
+				*ok = FALSE;
+			}
+		}
+		if(removed > 0) {
+			TRACE_EVENT(traceRemoveBatch_e, removed);
+		}
+		return removed;
+	} else {
+		Int idx, end;
+		key = BoundedBuffer_lock(bb); // pend Mutex (priority inheritance gate, see bounded_buffer.h)
+		RECORD_POINT();
+		/* Critical Section */
+		idx = bb->out;
+		while(removed < reserved) {
+			end = idx + (reserved - removed);	// contiguous run up to the wrap point
+			if(end > bb->capacity) {
+				end = bb->capacity;
+			}
+			while(idx < end && bb->storage[idx] != -1) {
+				dst[removed] = bb->storage[idx];
+				bb->storage[idx] = -1;
+				if(bb->tags != NULL) {
+					LATENCY_RECORD(&bb->tags[idx]);	// one short Hwi window per item, no copy of the tags
+				}
+				idx = idx + 1;
+				removed = removed + 1;
+			}
+			if(idx < end) {		// trying to remove item from an empty slot.
+				break;
+			}
+			idx = idx & bb->mask;
+		}
+		bb->out = idx & bb->mask;
+		bb->count = bb->count - removed;
+		RECORD_POINT();
+		/* End of Critical Section */
+		BoundedBuffer_unlock(bb, key); // post Mutex
+	}
+
+	RECORD_POINT();
+	if(removed < reserved) {
+		Log_info2("ERROR! Can't remove an item from an empty slot, %d of %d reserved items removed.\n", removed, reserved); //error log
+		RECORD_ANOMALY();
+		releaseSlots(bb->fullSlots, reserved - removed);	// give the unused items back
+		if(ok != NULL) {
+			*ok = FALSE;
+		}
+	}
+	if(removed > 0) {
+		releaseSlots(bb->emptySlots, removed);
+		TRACE_EVENT(traceRemoveBatch_e, removed); // success trace event
+	}
+	return removed;				// the removed items are out of the buffer even on abnormal behavior
+}
+
+/*
+ * Function: initWorkload
+ * Description: set up a producer's workload generator as selected by WORKLOAD_KIND.
+ * Input: Workload_T *workload, Int producerId.
+ * Output: void
+ * Algorithm: dispatch to the Workload_init* function of the kind, with the WORKLOAD_* parameters.
+*/
+static void initWorkload(Workload_T *workload, Int producerId) {
+	switch(WORKLOAD_KIND) {
+	case wlBursty_e:
+		Workload_initBursty(workload, producerId, MAX_VAL_NUM, WORKLOAD_BURST_LEN, WORKLOAD_BURST_GAP);
+		break;
+	case wlPoisson_e:
+		Workload_initPoisson(workload, producerId, MAX_VAL_NUM, WORKLOAD_MEAN_GAP);
+		break;
+	case wlReplay_e:
+		Workload_initReplay(workload, producerId, workloadTable, sizeof(workloadTable) / sizeof(workloadTable[0]));
+		break;
+	default:
+		Workload_initUniform(workload, producerId, MAX_VAL_NUM);
+		break;
+	}
+}
+
 /*
  * Function: producerHandler
  * Description: generic producer which for every module which is a producer use it.
- * Input: UArg arg0 - holds the producer unique id , UArg arg1 - nothing set to 0.
+ * Input: UArg arg0 - holds the producer unique id , UArg arg1 - the pipeline's BoundedBuffer_Handle.
  * Output: void
  * Algorithm: structure of PLPE - prolog loop process epilog. while(1) loop to make this task run forever to simulate time sharing
  * 			  system which we are not allowed to assume any timings about threads. the algo set the struct and items to init in the
- * 			  start of his context, sets green_led, producerId, ledBlinksInfo then while loop forever, define and init int variable
- * 			  named randNum using rand() functions to hold the value of the random item to be insert into the buffer, check success insert operation if TRUE issue Logs
- * 			  and wait to enter critical section for ledBlinking service then post it to make so LedSrvTask in RQ preemt the running
+ * 			  start of his context, sets green_led, producerId and its own workload generator (seeded once, see workload.h), then
+ * 			  while loop forever, take the next item from the workload, send LANE_URGENT_PERCENT of the items to an urgent lane,
+ * 			  sleep the ticks the workload asks for before it, check success insert operation if TRUE issue Logs
+ * 			  and queue the ledBlinking request to the LED mailbox then post it to make so LedSrvTask in RQ preemt the running
  * 			  task, and blink, Otherwise issue suitable Log of fail and continue to next iteration.
  *
 */
 void producerHandler(UArg arg0, UArg arg1) {
 	/* Prolog */
-	LedBlinksInfo_T ledBlinksInfo;
 	int producerId = (int)arg0;
+	BoundedBuffer_Handle bb = (BoundedBuffer_Handle)arg1;	// the pipeline's bounded buffer
+	Workload_T workload;		// this producer's generator and PRNG state
+	UInt delay;
+
+#if PRODUCER_BATCH_SIZE > 1
+	Int burst[PRODUCER_BATCH_SIZE];
+#else
+	UInt32 insertStart = 0;		// Latency_now() before an insert_item call
+#endif
+
+	initWorkload(&workload, producerId);	// seeded once, from the producer id and the timestamp
 
 	while(1) {
 		/*Process*/
-		srand(time(0)); // set the seed to be timer(0).
-		int randNum = (rand()%MAX_VAL_NUM); // generate random number between 0 to MAX_VAL_NUM.
-		Bool success = insert_item(randNum); // insert item to the bounded buffer.
-		if(success) {
-			Log_info2("The producer task with id = %d successfuly inserted the item = %d to the buffer.\n", producerId, randNum); //success log
-			ledBlinksInfo.blinksNum = randNum;  // init struct member blinkNum to be according to the randNum variable.
-			ledBlinksInfo.led = green_e;		// init struct member led to be according to the correct LED_E enum green_e/red_e.
-			Semaphore_pend(setLedEnvMutex, BIOS_WAIT_FOREVER); // pend setLedEnvMutex Sem
-			/* Cricital Section */
-			Task_setEnv(ledSrvTask, (Ptr)&ledBlinksInfo); //set the task enviorments of ledSrvTask for internally thread communication in the system.
-			Semaphore_post(ledSrvSchedSem); // post ledSrvSchedSem
-			/* End of Critical Section */
-			Semaphore_post(setLedEnvMutex); // post setLedEnvMutex Sem
-		} else {
+#if PRODUCER_BATCH_SIZE > 1
+		Int i, produced = 0;
+		UInt wait = 0;
+		for(i = 0 ; i < PRODUCER_BATCH_SIZE ; i++) {
+			burst[i] = Workload_next(&workload, &delay); // generate a burst of items between 0 to MAX_VAL_NUM.
+			wait = wait + delay;
+		}
+		if(wait > 0) {
+			CPUACCT_SLEEP(wait);		// the burst is complete when its last item arrives
+		}
+		while(produced < PRODUCER_BATCH_SIZE) {
+			BBStatus_E status;
+			Int inserted = insert_items(bb, &burst[produced], PRODUCER_BATCH_SIZE - produced, &status); // insert as much of the burst as fits.
+			for(i = produced ; i < produced + inserted ; i++) {
+				requestLedBlinks(green_e, burst[i]);	// inserted - even if the rest failed
+			}
+			produced = produced + inserted;
+			if(status != bbInsertOk_e) {
+				Log_info1("ERROR! Producer task with id = %d failed to insert an item to the buffer.\n", producerId); //error log
+				break;			// the rest of the burst is lost, the inserted items are not sent twice
+			}
+		}
+#else
+		int randNum = Workload_next(&workload, &delay); // generate random number between 0 to MAX_VAL_NUM.
+		Int lane = 0;
+		if(NUM_LANES > 1 && Prng_below(&workload.prng, 100) < LANE_URGENT_PERCENT) {
+			lane = 1 + (Int)Prng_below(&workload.prng, NUM_LANES - 1);	// an urgent item
+		}
+		if(delay > 0) {
+			CPUACCT_SLEEP(delay);		// the workload's inter-arrival time
+		}
+		LATENCY_INSERT_BEGIN(insertStart);
+		BBStatus_E status = insert_item_lane(bb, randNum, lane); // insert item to the bounded buffer.
+		LATENCY_INSERT_END(insertStart);	// the producer's cycle time under backpressure
+		if(status == bbInsertOk_e || status == bbInsertOverwrote_e || status == bbInsertSpooled_e) {
+			requestLedBlinks(green_e, randNum);
+		} else if(status == bbInsertError_e) {
 			Log_info1("ERROR! Producer task with id = %d failed to insert an item to the buffer.\n", producerId); //error log
 			continue;
 		}
+		// a dropped or timed out item is counted in the buffer's policyStats - go on with the next one
+#endif
 	}
 	/* Epilog */
 }
@@ -597,109 +1519,183 @@ void producerHandler(UArg arg0, UArg arg1) {
  * Function: consumerHandler
  * Description: generic consumer which for every module who use it with additional blinking
  * 				mechanism and struct to hold information.
- * Input: UArg arg0 - holds the consumer unique id , UArg arg1 - nothing set to 0.
+ * Input: UArg arg0 - holds the consumer unique id , UArg arg1 - the pipeline's BoundedBuffer_Handle.
  * Output: void.
  * Algorithm: structure of PLPE - prolog loop process epilog. while(1) loop to make this task run forever to simulate time sharing
  * 			  system which we are not allowed to assume any timings about threads. the algo set the struct and items to init in the
- * 			  start of his context, sets red_led, consumerId, ledBlinksInfo then while loop forever, define and init int variable
+ * 			  start of his context, sets red_led, consumerId then while loop forever, define and init int variable
  * 			  named item to hold the value of the item removed from the buffer, check success remove operation if TRUE issue Logs
- * 			  and wait to enter critical section for ledBlinking service then post it to make so LedSrvTask in RQ preemt the running
+ * 			  and queue the ledBlinking request to the LED mailbox then post it to make so LedSrvTask in RQ preemt the running
  * 			  task, and blink, Otherwise issue suitable Log of fail and continue to next iteration.
+ * 			  With CONSUMER_STALL_EVERY the consumer also sleeps CONSUMER_STALL_TICKS after every CONSUMER_STALL_EVERY items - a
+ * 			  stalled consumer for the backpressure benchmark (BACKPRESSURE_POLICY).
+ * 			  Every removed item (a batch at once) is added to the consumer's windowed statistics engine (winstats.h).
 */
 void consumerHandler(UArg arg0, UArg arg1) {
 	/* Prolog */
-	LedBlinksInfo_T ledBlinksInfo;
 	int consumerId = (int)arg0;
+	BoundedBuffer_Handle bb = (BoundedBuffer_Handle)arg1;	// the pipeline's bounded buffer
+
+#if CONSUMER_BATCH_SIZE > 1
+	Int items[CONSUMER_BATCH_SIZE];
+#endif
+#if CONSUMER_STALL_EVERY > 0
+	Int untilStall = CONSUMER_STALL_EVERY;	// items left before the next benchmark stall
+#endif
+#if WINSTATS
+	WinStats_Handle stats = WinStats_open(consumerWindows, sizeof(consumerWindows) / sizeof(consumerWindows[0]), consumerId);
+#endif
 
 	while(1) {
 		/* Process */
+#if CONSUMER_BATCH_SIZE > 1
+		Int i;
+		Bool ok;
+		Int removed = remove_items(bb, items, CONSUMER_BATCH_SIZE, &ok);	// remove whatever is available, up to a full batch.
+		if(removed > 0) {				// consumed even if the rest of the batch failed
+			WINSTATS_ADD_BATCH(stats, items, removed);
+			for(i = 0 ; i < removed ; i++) {
+				requestLedBlinks(red_e, items[i]);
+			}
+		}
+		if(!ok) {
+			Log_info1("ERROR! Consumer task with id = %d failed to remove an item from the buffer.\n", consumerId); //error log
+		}
+		if(removed == 0) {
+			continue;
+		}
+#if CONSUMER_STALL_EVERY > 0
+		untilStall = untilStall - removed;
+#endif
+#else
 		int item = 0;						// define new variable to hold the removed item
-		Bool success = remove_item(&item);	// remove an item from the bounded buffer.
+		Bool success = remove_item(bb, &item);	// remove an item from the bounded buffer.
 		if(success) {
-			Log_info2("The consumer task with id = %d successfuly removed the item = %d from the buffer.\n", consumerId, item); //success log
-			ledBlinksInfo.blinksNum = item;  	// init struct member blinkNum to be according to the item variable.
-			ledBlinksInfo.led = red_e;		// init struct member led to be according to the correct LED_E enum green_e/red_e.
-			Semaphore_pend(setLedEnvMutex, BIOS_WAIT_FOREVER); // pend setLedEnvMutex Sem
-			/* Cricital Section */
-			Task_setEnv(ledSrvTask, (Ptr)&ledBlinksInfo); //set the task enviorments of ledSrvTask for internally thread communication in the system.
-			Semaphore_post(ledSrvSchedSem); // post ledSrvSchedSem
-			/* End of Critical Section */
-			Semaphore_post(setLedEnvMutex); // post setLedEnvMutex Sem
+			WINSTATS_ADD(stats, item);
+			requestLedBlinks(red_e, item);
 		} else {
 			Log_info1("ERROR! Consumer task with id = %d failed to remove an item from the buffer.\n", consumerId); //error log
 			continue;
 		}
+#if CONSUMER_STALL_EVERY > 0
+		untilStall = untilStall - 1;
+#endif
+#endif
+#if CONSUMER_STALL_EVERY > 0
+		if(untilStall <= 0) {
+			CPUACCT_SLEEP(CONSUMER_STALL_TICKS);	// benchmark - a consumer stuck, e.g. behind ledSrvTask's blinking
+			untilStall = CONSUMER_STALL_EVERY;
+		}
+#endif
+	}
+	/* Epilog */
+}
+
+/*
+ * Function: stageHandler
+ * Description: generic worker of a multi-stage pipeline stage.
+ * Input: UArg arg0 - the worker's topology id, UArg arg1 - the stage index in stageGraph.
+ * Output: void
+ * Algorithm: PLPE like the producer and consumer. Prolog - look up the stage's links and prepare
+ * 			  the worker's StageCtx_T. Loop - sample the input link's depth, remove_items up to
+ * 			  the batch (a source skips this), call the stage function, insert_items all its
+ * 			  results (in as many calls as the free slots take), count the call, and sleep if the
+ * 			  stage function asked for it (a paced source).
+*/
+void stageHandler(UArg arg0, UArg arg1) {
+	/* Prolog */
+	Int workerId = (Int)arg0;
+	Int stage = (Int)arg1;
+	const StageDef_T *def = Stage_def(stage);
+	BoundedBuffer_Handle in = Stage_input(stage);		// NULL for a source
+	BoundedBuffer_Handle out = Stage_output(stage);	// NULL for a sink
+	StageCtx_T ctx;
+	Int items[STAGE_MAX_BATCH];
+	Int results[STAGE_MAX_BATCH];
+
+	Stage_initCtx(&ctx, stage, workerId);
+
+	while(1) {
+		/* Process */
+		Int taken = 0, made = 0, sent = 0, inserted = 0;
+		Bool ok = TRUE;
+		BBStatus_E status = bbInsertOk_e;
+		if(in != NULL) {
+			Stage_sample(stage);
+			taken = remove_items(in, items, def->batch, &ok);	// whatever is available, up to a batch.
+			if(!ok) {
+				Log_info1("ERROR! Stage worker with id = %d failed to remove an item from its input.\n", workerId); //error log
+			}
+			if(taken == 0) {
+				continue;
+			}
+		}
+		ctx.sleep = 0;
+		made = def->fxn(&ctx, items, taken, (out != NULL) ? results : NULL);
+		ctx.calls = ctx.calls + 1;
+		while(out != NULL && sent < made) {
+			inserted = insert_items(out, &results[sent], made - sent, &status);	// as much as fits, blocking for the rest.
+			sent = sent + inserted;
+			if(status != bbInsertOk_e) {
+				Log_info1("ERROR! Stage worker with id = %d failed to insert an item to its output.\n", workerId); //error log
+				break;
+			}
+		}
+		Stage_account(stage, taken, sent);
+		if(ctx.sleep > 0) {
+			CPUACCT_SLEEP(ctx.sleep);	// a paced source
+		}
 	}
 	/* Epilog */
 }
 
+/*
+ * Function: requestLedBlinks
+ * Description: hand a LED blinking specification to ledSrvTask (sections B & C of the handlers).
+ * Input: LED_E led - green_e/red_e, Int blinksNum - number of blinks.
+ * Output: void
+ * Algorithm: copy the specification into the LED command mailbox (never blocks - a full mailbox
+ * 			  coalesces or drops it, see led_mailbox.h) and post ledSrvSchedSem.
+*/
+void requestLedBlinks(LED_E led, Int blinksNum) {
+	LedBlinksInfo_T ledBlinksInfo;
+	ledBlinksInfo.blinksNum = blinksNum;	// init struct member blinkNum.
+	ledBlinksInfo.led = led;				// init struct member led to be according to the correct LED_E enum green_e/red_e.
+	if(LedMailbox_post(&ledBlinksInfo) != ledPostDropped_e) {
+		Semaphore_post(ledSrvSchedSem); // post ledSrvSchedSem
+	}
+}
+
 /*
  * Function: ledSrvTaskHandler
  * Description: Serves as the ledSrvTask Handle ISR function and his goal to make led blinks according to
  * 				the info sent by the other tasks.
  * Input: void.
  * Output: void.
- * Algorithm: Retrieve data from the task enviorment, data about the blinksNum and led type: green/red,
+ * Algorithm: Retrieve data from the LED command mailbox, data about the blinksNum and led type: green/red,
  * 			  Implements PLPE (Prolog, Loop, Process, Epilog) Structure,
  * 			  while loop  for ever,
  * 			  inside loop - semaphore pend on ledSrvSchedSem to conditionally ulitize the highest priority
  * 			  task (ledSrvTask) in the system,
- * 			  in proccess means currently running preemt other tasks call ledToggle which make the led blink
- * 			  according to the data from the ledBlinksInfo.
+ * 			  in proccess means currently running preemt other tasks, drain the mailbox and call LedBlink_start
+ * 			  for each fetched command which queue the led blinks according to the data from ledBlinksInfo
+ * 			  (non-blocking - ledSrvTask gives the CPU back right away).
 */
 void ledSrvTaskHandler(void) {
 	/* Prolog */
+	LedBlinksInfo_T ledBlinksInfo;
 
 	while(1) {
-		Semaphore_pend(ledSrvSchedSem, BIOS_WAIT_FOREVER); // pend on ledSrvSchedSem
-		LedBlinksInfo_T *ledBlinksInfo = (LedBlinksInfo_T *)Task_getEnv(Task_self()); // cast because pointer returned is of type Ptr which is void* in TI-RTOS
+		CPUACCT_PEND(ledSrvSchedSem, BIOS_WAIT_FOREVER, cpuWaitLedSrvSched_e); // pend on ledSrvSchedSem
 
 		/* Process */
-		if(ledBlinksInfo->led == green_e) {
-			ledToggle(GREEN_LED, ledBlinksInfo->blinksNum);
-		} else if (ledBlinksInfo->led == red_e) {
-			ledToggle(RED_LED, ledBlinksInfo->blinksNum);
+		while(LedMailbox_fetch(&ledBlinksInfo)) {	// several posts may have folded into one - drain all
+			LedBlink_start(ledBlinksInfo.led, ledBlinksInfo.blinksNum);
 		}
 	}
 	/* Epilog */
 }
 
-/*
- * Function: delay
- * Description : make delay, cpu burning cycles.
- * Input:  uint8_t selectedPort - pass ports, uint16_t selectedPins - pass pins, int times - holds number
- * 		   of how many times the led will blink.
- * Output: void.
- * Algorithm:  A simple use of API function _delay_cycles and pass the right amount of CPU cycles according to
- * 			   tick resolution and clock ticks period to set it as defined in the project instructions.
-*/
-void delay(void)
-{
-	// ~1/2 second delay providing Clock Module is set to tick every 500 microseconds
-	// (i.e every 1/2 milisecond, rather than every 1 milisecond).
-	__delay_cycles(1024000);
-}
-
-/*
- * Function: ledToggle
- * Description : make the correct led blinks.
- * Input:  uint8_t selectedPort - pass ports, uint16_t selectedPins - pass pins, int times - holds number
- * 		   of how many times the led will blink.
- * Output: void.
- * Algorithm:  A simple for loop that for each index places until times variable value multiply by 2 call
- * 			   delay, call toggle led output pin function with port pins arguments and delay again to
- * 			   create the wrtie timing for the led to blink.
-*/
-void ledToggle(uint8_t selectedPort, uint16_t selectedPins, int times) {
-	int i = 0;
-	for(i = 0 ; i < 2*times ; i = i + 1) {	// Run 2 times - 1 for turn off/on and 1 for turn on/off.
-		delay(); // 1/2 sec delay, consuming CPU cycles.
-		GPIO_toggleOutputOnPin(selectedPort, selectedPins);
-		delay(); // 1/2 sec delay, consuming CPU cycles.
-	}
-	GPIO_setOutputLowOnPin(selectedPort, selectedPins); //Ensure the LED is turned off when finish blinking.
-}
-
 /*
  * Function: tsClockHandler
  * Description: Elapse every 1/2 miliseconds and yield the currently running task to simulate time sharing system. Doing short "jobs"
@@ -707,22 +1703,27 @@ void ledToggle(uint8_t selectedPort, uint16_t selectedPins, int times) {
  * 				running task/thread.
  * Input: void
  * Output: void
- * Algorithm: Use the function Task_yield() according to the settings provided by the clock module - period in clock ticks and etc.
+ * Algorithm: TimeSlice_tick decides whether to Task_yield() - every TIMESLICE_QUANTUM ticks, and (by default) only when another
+ * 			  Task of the same priority is ready to take the CPU (see timeslice.h).
 */
 void tsClockHandler(void) {
-	Task_yield();
+	RECORD_TICK();			// the tick's position in the interleaving (record.h)
+	TimeSlice_tick();
 }
 
 /*
- * Function: initArray
- * Description : Initializes all the elements in a given array to -1.
- * Input:  an array arr of type Int and its size also Int.
+ * Function: samplerIsr
+ * Description: Timer_A interrupt of the ISR producer - one sample into the buffer per interrupt.
+ * Input: UArg arg - the BoundedBuffer_Handle of pipeline 0.
  * Output: void
- * Algorithm:  A simple for loop that for each index places -1 in its value.
+ * Algorithm: the reading is a free running 10 bit counter (a saw tooth signal), scaled to
+ * 			  1..MAX_VAL_NUM with a multiply and a shift (no division); try_insert_item never
+ * 			  blocks and counts a lost sample in the buffer's isrStats.
 */
-void initArray(volatile Int *arr, Int size) {
-	int i = 0;
-	for(i = 0 ; i < size ; i++) {
-		arr[i] = -1;
-	}
+void samplerIsr(UArg arg) {
+	static UInt reading = 0;
+	Int item = 1 + (Int)(((UInt32)reading * MAX_VAL_NUM) >> ISR_SAMPLE_BITS);
+
+	reading = (reading + 1) & ((1 << ISR_SAMPLE_BITS) - 1);
+	try_insert_item((BoundedBuffer_Handle)arg, item);
 }
@@ -0,0 +1,310 @@
+/*
+ * microbench.c
+ *
+ * Microbenchmarks of the RTOS primitives - see microbench.h for the full description.
+ */
+
+#include <string.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/Log.h>
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#include "microbench.h"
+
+#define MICROBENCH_CAPACITY		16		// capacity of the index wrap loops
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The results, see MicroBenchStats_T.
+ */
+MicroBenchStats_T microBenchStats;
+
+#if MICROBENCH
+static Task_Struct benchTaskObj;
+static Task_Struct pingTaskObj;
+static Task_Struct yieldTaskObj;
+static UInt32 benchStack[MICROBENCH_STACK_SIZE / sizeof(UInt32)];
+static UInt32 pingStack[MICROBENCH_STACK_SIZE / sizeof(UInt32)];
+static UInt32 yieldStack[MICROBENCH_STACK_SIZE / sizeof(UInt32)];
+static Semaphore_Struct benchSemObj;	// the uncontended semaphore
+static Semaphore_Struct pingSemObj;		// bench -> ping partner
+static Semaphore_Struct pongSemObj;		// ping partner -> bench
+static Semaphore_Struct yieldSemObj;	// wakes the yield partner
+static volatile Bool yielding;			// the yield partner yields back while TRUE
+static volatile Bool finished;			// the partners return
+static volatile UInt32 sink;			// every loop stores here, so no loop is optimized away
+static volatile Int capacity = MICROBENCH_CAPACITY;	// a run-time capacity, as bb->capacity
+
+
+/*
+ * Function: pingTaskHandler
+ * Description: the ping-pong partner - answers every post of pingSem with a post of pongSem.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: pend pingSem, post pongSem, until finished.
+*/
+static Void pingTaskHandler(UArg arg0, UArg arg1)
+{
+	(Void)arg0;
+	(Void)arg1;
+	while(1) {
+		Semaphore_pend(Semaphore_handle(&pingSemObj), BIOS_WAIT_FOREVER);
+		if(finished) {
+			return;
+		}
+		Semaphore_post(Semaphore_handle(&pongSemObj));
+	}
+}
+
+/*
+ * Function: yieldTaskHandler
+ * Description: the yield partner - yields the CPU straight back while yielding is set.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: blocked on yieldSem between the measurements, so it is only ready during one.
+*/
+static Void yieldTaskHandler(UArg arg0, UArg arg1)
+{
+	(Void)arg0;
+	(Void)arg1;
+	while(1) {
+		Semaphore_pend(Semaphore_handle(&yieldSemObj), BIOS_WAIT_FOREVER);
+		if(finished) {
+			return;
+		}
+		while(yielding) {
+			Task_yield();
+		}
+	}
+}
+
+/*
+ * Function: measure
+ * Description: one measurement of a primitive.
+ * Input: MicroBenchId_E id - the primitive, UInt32 n - operations.
+ * Output: UInt32 - Timestamp counts of the n operations.
+ * Algorithm: one plain loop per primitive - the dispatch is outside the timed part. Every loop
+ * 			  body stores to sink, the empty loop (mbLoop_e) included, so the loop overhead is
+ * 			  the same everywhere. The yield partner is woken (and given the CPU once) before
+ * 			  its loop starts, and sent back to its semaphore after it ends.
+*/
+static UInt32 measure(MicroBenchId_E id, UInt32 n)
+{
+	Semaphore_Handle sem = Semaphore_handle(&benchSemObj);
+	Semaphore_Handle ping = Semaphore_handle(&pingSemObj);
+	Semaphore_Handle pong = Semaphore_handle(&pongSemObj);
+	Task_Handle self = Task_self();
+	Ptr env = Task_getEnv(self);
+	UInt32 start = 0;
+	UInt32 end = 0;
+	UInt32 i = 0;
+	Int idx = 0;
+	Int mask = MICROBENCH_CAPACITY - 1;
+
+	switch(id) {
+	case mbLoop_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			sink = i;
+		}
+		end = Timestamp_get32();
+		break;
+	case mbSemPost_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Semaphore_post(sem);
+			sink = i;
+		}
+		end = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Semaphore_pend(sem, BIOS_NO_WAIT);		// back to 0, untimed
+		}
+		break;
+	case mbSemPend_e:
+		for(i = 0 ; i < n ; i++) {
+			Semaphore_post(sem);					// n available counts, untimed
+		}
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			sink = Semaphore_pend(sem, BIOS_WAIT_FOREVER);
+		}
+		end = Timestamp_get32();
+		break;
+	case mbSemPendPost_e:
+		Semaphore_post(sem);
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			sink = Semaphore_pend(sem, BIOS_WAIT_FOREVER);
+			Semaphore_post(sem);
+		}
+		end = Timestamp_get32();
+		Semaphore_pend(sem, BIOS_NO_WAIT);
+		break;
+	case mbSemPingPong_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Semaphore_post(ping);
+			sink = Semaphore_pend(pong, BIOS_WAIT_FOREVER);
+		}
+		end = Timestamp_get32();
+		break;
+	case mbYield_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Task_yield();
+			sink = i;
+		}
+		end = Timestamp_get32();
+		break;
+	case mbYieldSwitch_e:
+		yielding = TRUE;
+		Semaphore_post(Semaphore_handle(&yieldSemObj));
+		Task_yield();								// the partner leaves its pend, untimed
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Task_yield();
+			sink = i;
+		}
+		end = Timestamp_get32();
+		yielding = FALSE;
+		Task_yield();								// the partner goes back to its pend
+		break;
+	case mbTaskGetEnv_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			sink = (UInt32)(IArg)Task_getEnv(self);
+		}
+		end = Timestamp_get32();
+		break;
+	case mbTaskSetEnv_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Task_setEnv(self, env);
+			sink = i;
+		}
+		end = Timestamp_get32();
+		break;
+	case mbLogInfo2_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			Log_info2("microbench %d %d\n", (IArg)i, (IArg)idx);
+			sink = i;
+		}
+		end = Timestamp_get32();
+		break;
+	case mbWrapModulo_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			idx = (idx + 1) % capacity;
+			sink = idx;
+		}
+		end = Timestamp_get32();
+		break;
+	case mbWrapMask_e:
+		start = Timestamp_get32();
+		for(i = 0 ; i < n ; i++) {
+			idx = (idx + 1) & mask;
+			sink = idx;
+		}
+		end = Timestamp_get32();
+		break;
+	default:
+		break;
+	}
+	return end - start;
+}
+
+/*
+ * Function: benchTaskHandler
+ * Description: run every microbenchmark once.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: MICROBENCH_REPEATS measurements of every primitive, keep the fewest counts, set
+ * 			  done and let the partners return.
+*/
+static Void benchTaskHandler(UArg arg0, UArg arg1)
+{
+	Int id = 0;
+	Int r = 0;
+	UInt32 ticks;
+	MicroBenchResult_T *result;
+
+	(Void)arg0;
+	(Void)arg1;
+	for(id = 0 ; id < MICROBENCH_COUNT ; id++) {
+		result = &microBenchStats.result[id];
+		result->iterations = MICROBENCH_ITERATIONS;
+		result->best = ~(UInt32)0;
+		for(r = 0 ; r < MICROBENCH_REPEATS ; r++) {
+			ticks = measure((MicroBenchId_E)id, MICROBENCH_ITERATIONS);
+			if(ticks < result->best) {
+				result->best = ticks;
+			}
+		}
+	}
+	microBenchStats.done = 1;
+	finished = TRUE;
+	Semaphore_post(Semaphore_handle(&pingSemObj));
+	Semaphore_post(Semaphore_handle(&yieldSemObj));
+}
+
+static Void construct(Task_Struct *obj, CString name, Task_FuncPtr fxn, UInt32 *stack, SizeT stackSize)
+{
+	Task_Params taskParams;
+
+	Task_Params_init(&taskParams);
+	taskParams.instance->name = name;
+	taskParams.priority = MICROBENCH_PRIORITY;
+	taskParams.stack = (Ptr)stack;
+	taskParams.stackSize = stackSize;
+	Task_construct(obj, fxn, &taskParams, NULL);
+}
+
+static Void constructSem(Semaphore_Struct *obj, CString name)
+{
+	Semaphore_Params semParams;
+
+	Semaphore_Params_init(&semParams);
+	semParams.instance->name = name;
+	Semaphore_construct(obj, 0, &semParams);		// counting, empty
+}
+#endif
+
+/*
+ * Function: MicroBench_start
+ * Description: set up the microbenchmarks.
+ * Input: void
+ * Output: Task_Handle - the benchmark Task, NULL without MICROBENCH.
+ * Algorithm: clear the results, construct the semaphores (all empty) and the three Tasks -
+ * 			  the benchmark Task first, so it is the first of its priority to run.
+*/
+Task_Handle MicroBench_start(void)
+{
+	Types_FreqHz freq;
+
+	memset(&microBenchStats, 0, sizeof(microBenchStats));
+	memcpy(microBenchStats.magic, "MBEN", sizeof(microBenchStats.magic));
+	Timestamp_getFreq(&freq);
+	microBenchStats.freq = freq.lo;
+	microBenchStats.count = MICROBENCH_COUNT;
+#if MICROBENCH
+	constructSem(&benchSemObj, "mbSem");
+	constructSem(&pingSemObj, "mbPingSem");
+	constructSem(&pongSemObj, "mbPongSem");
+	constructSem(&yieldSemObj, "mbYieldSem");
+	construct(&benchTaskObj, "microbench", benchTaskHandler, benchStack, sizeof(benchStack));
+	construct(&pingTaskObj, "mbPing", pingTaskHandler, pingStack, sizeof(pingStack));
+	construct(&yieldTaskObj, "mbYield", yieldTaskHandler, yieldStack, sizeof(yieldStack));
+	return Task_handle(&benchTaskObj);
+#else
+	return NULL;
+#endif
+}
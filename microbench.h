@@ -0,0 +1,106 @@
+/*
+ * microbench.h
+ *
+ * Microbenchmarks of the RTOS primitives insert_item, remove_item and the handlers are built from.
+ *
+ * With MICROBENCH 1 main starts a benchmark Task instead of the producer/consumer pipelines. It
+ * times every primitive of MicroBenchId_E over MICROBENCH_ITERATIONS operations with the Timestamp
+ * module - on the MSP430 the CPU clock, so the results are cycles - and keeps the best of
+ * MICROBENCH_REPEATS measurements, which leaves out the runs a Clock tick or a Task switch fell
+ * into. The primitives:
+ *
+ *  - the empty measurement loop (subtract it from the others for the primitive alone);
+ *  - Semaphore_post, Semaphore_pend of an available count, and the pair (uncontended);
+ *  - a semaphore ping-pong with a partner Task of the same priority - every round two pends that
+ *    block, two posts that wake the other Task and two Task switches (contended);
+ *  - Task_yield with no other Task ready, and with a partner Task that yields back - tsClockHandler's
+ *    time-slice yield, which costs two Task switches per round;
+ *  - Task_getEnv/Task_setEnv (Topology_workerId, on every latency stamp);
+ *  - Log_info2 (the handlers' error path and every Log of the original handlers);
+ *  - the cyclic index increment with % of a run-time capacity and with a mask - the MSP430 has no
+ *    divide instruction, % is a run-time library call.
+ *
+ * The results are in microBenchStats, a fixed-layout RAM structure - a 12-byte header ("MBEN",
+ * Timestamp frequency, number of results, done flag) and MICROBENCH_COUNT (iterations, best)
+ * pairs, little endian. Save it from the target's memory browser once "done" is 1, or dump it
+ * with PC_MICROBENCH=<file> on the host; host/tools/bench.py turns it into JSON next to the
+ * end-to-end paths and compares the JSON with a stored baseline.
+ */
+
+#ifndef MICROBENCH_H_
+#define MICROBENCH_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#ifndef MICROBENCH
+#define MICROBENCH				0		//1 - run the microbenchmarks instead of the producer/consumer pipelines
+#endif
+#ifndef MICROBENCH_ITERATIONS
+#define MICROBENCH_ITERATIONS	1000	//Operations per measurement - at most 65535, the sem_pend measurement posts as many counts first
+#endif
+#ifndef MICROBENCH_REPEATS
+#define MICROBENCH_REPEATS		8		//Measurements per primitive - the best one is kept
+#endif
+#ifndef MICROBENCH_PRIORITY
+#define MICROBENCH_PRIORITY		4		//Priority of the benchmark Task and its partners - above every other Task
+#endif
+#define MICROBENCH_STACK_SIZE	512		//Bytes of the static stack of each Task
+
+
+/*
+ Enum MicroBenchId_E - the measured primitives. Keep in sync with PRIMITIVES in host/tools/bench.py.
+ */
+typedef enum
+{
+	mbLoop_e = 0,				// empty measurement loop
+	mbSemPost_e = 1,			// Semaphore_post, nobody waiting
+	mbSemPend_e = 2,			// Semaphore_pend of an available count
+	mbSemPendPost_e = 3,		// pend + post, uncontended
+	mbSemPingPong_e = 4,		// round trip to a partner Task through two semaphores
+	mbYield_e = 5,				// Task_yield, no other Task ready
+	mbYieldSwitch_e = 6,		// Task_yield to a partner Task and back
+	mbTaskGetEnv_e = 7,
+	mbTaskSetEnv_e = 8,
+	mbLogInfo2_e = 9,
+	mbWrapModulo_e = 10,		// idx = (idx + 1) % capacity
+	mbWrapMask_e = 11,			// idx = (idx + 1) & mask
+	MICROBENCH_COUNT = 12
+} MicroBenchId_E;
+
+
+/*
+ Structure MicroBenchStats_T - the results, readable in RAM (microBenchStats).
+ */
+typedef struct
+{
+	UInt32 iterations;			// operations measured
+	UInt32 best;				// Timestamp counts of the best measurement
+} MicroBenchResult_T;
+
+typedef struct
+{
+	Char magic[4];				// "MBEN"
+	UInt32 freq;				// Timestamp counts per second
+	UInt16 count;				// MICROBENCH_COUNT
+	UInt16 done;				// 1 - all the results are in
+	MicroBenchResult_T result[MICROBENCH_COUNT];
+} MicroBenchStats_T;
+
+extern MicroBenchStats_T microBenchStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Task_Handle MicroBench_start(void)
+
+ Clears microBenchStats and constructs the benchmark Task and its two partners (static objects and
+ stacks). Returns the benchmark Task (NULL without MICROBENCH). Called from main before
+ BIOS_start; the benchmark runs once and its Tasks then terminate.
+ */
+Task_Handle MicroBench_start(void);
+
+#endif /* MICROBENCH_H_ */
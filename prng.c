@@ -0,0 +1,57 @@
+/*
+ * prng.c
+ *
+ * Small per-task pseudo random number generator - see prng.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+
+#include "prng.h"
+
+
+/*
+ * Function: Prng_seed
+ * Description: seed a generator.
+ * Input: Prng_T *prng, UInt32 seed.
+ * Output: void
+ * Algorithm: the murmur3 finalizer scrambles the seed (every input bit affects every state bit),
+ * 			  a zero result - the one state xorshift never leaves - is replaced by a constant.
+*/
+Void Prng_seed(Prng_T *prng, UInt32 seed)
+{
+	seed = seed ^ (seed >> 16);
+	seed = seed * 0x85EBCA6Bu;
+	seed = seed ^ (seed >> 13);
+	seed = seed * 0xC2B2AE35u;
+	seed = seed ^ (seed >> 16);
+	prng->state = (seed != 0) ? seed : 0x9E3779B9u;
+}
+
+/*
+ * Function: Prng_next
+ * Description: next number of the sequence.
+ * Input: Prng_T *prng.
+ * Output: UInt32 - the number.
+ * Algorithm: xorshift32 - x ^= x << 13; x ^= x >> 17; x ^= x << 5.
+*/
+UInt32 Prng_next(Prng_T *prng)
+{
+	UInt32 x = prng->state;
+
+	x = x ^ (x << 13);
+	x = x ^ (x >> 17);
+	x = x ^ (x << 5);
+	prng->state = x;
+	return x;
+}
+
+UInt Prng_below(Prng_T *prng, UInt bound)
+{
+	return (UInt)(((Prng_next(prng) >> 16) * (UInt32)(bound & 0xFFFF)) >> 16);
+}
+
+UInt32 Prng_entropy(void)
+{
+	return Timestamp_get32();
+}
@@ -0,0 +1,69 @@
+/*
+ * prng.h
+ *
+ * Small per-task pseudo random number generator.
+ *
+ * producerHandler used to call srand(time(0)) and then rand() on every iteration: time() and the
+ * reseed are costly libc calls in the producer hot path, rand() has one hidden global state
+ * shared by all the producers, and reseeding with the same second every loop made the producers
+ * emit long runs of identical values. A Prng_T is a 32 bit xorshift generator (Marsaglia's
+ * 13/17/5 triple, period 2^32 - 1) owned by one Task:
+ *
+ *  - seeded once, from the producer id mixed with an entropy source (Prng_entropy);
+ *  - a handful of shifts and XORs per number, no division and no locking;
+ *  - Prng_below maps a number to [0, bound) with a multiply instead of %, since the MSP430 has a
+ *    hardware multiplier but no divide instruction.
+ */
+
+#ifndef PRNG_H_
+#define PRNG_H_
+
+#include <xdc/std.h>
+
+
+/*
+ Structure Prng_T - the generator state, never 0.
+ */
+typedef struct
+{
+	UInt32 state;
+} Prng_T;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Prng_seed(Prng_T *prng, UInt32 seed)
+
+ Seeds the generator. The seed is scrambled first (nearby seeds - producer ids 1, 2, ... - give
+ unrelated sequences) and a zero state is avoided.
+ */
+Void Prng_seed(Prng_T *prng, UInt32 seed);
+
+/*
+ Function: UInt32 Prng_next(Prng_T *prng)
+
+ Next 32 bit pseudo random number.
+ */
+UInt32 Prng_next(Prng_T *prng);
+
+/*
+ Function: UInt Prng_below(Prng_T *prng, UInt bound)
+
+ Pseudo random number in [0, bound), bound at most 65535 - the top 16 bits of Prng_next scaled
+ by bound with one 16x16 bit multiply.
+ */
+UInt Prng_below(Prng_T *prng, UInt bound);
+
+/*
+ Function: UInt32 Prng_entropy(void)
+
+ A seed that differs between runs and between calls - the free running Timestamp counter, whose
+ low bits depend on everything that ran since reset (interrupt timing, blocking, clock jitter).
+ Call it from a Task, once BIOS_start has started the timer.
+ */
+UInt32 Prng_entropy(void);
+
+#endif /* PRNG_H_ */
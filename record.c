@@ -0,0 +1,290 @@
+/*
+ * record.c
+ *
+ * Record of the task interleaving - see record.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <string.h>						//for memset/memcpy in Record_init
+
+#include "record.h"
+#include "topology.h"
+
+#define RECORD_MASK	(RECORD_RING_SIZE - 1)
+
+/*
+ The ring is written from Tasks, from the tick's Swi and from the switch hook. On the target a
+ short Hwi_disable window makes a write atomic. The host's emulated kernel runs one Task,
+ Clock function or scheduler call at a time, and calls the switch hook holding its lock - where
+ Hwi_disable, itself a kernel call, would deadlock.
+ */
+#if defined(__MSP430__)
+#define RECORD_LOCK(key)	((key) = Hwi_disable())
+#define RECORD_UNLOCK(key)	Hwi_restore(key)
+#else
+#define RECORD_LOCK(key)	((key) = 0)
+#define RECORD_UNLOCK(key)	((Void)(key))
+#endif
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ Recorder counters, see RecordStats_T.
+ */
+RecordStats_T recordStats;
+
+/*
+ RECORD_POINTs passed so far - the position of the events.
+ */
+volatile UInt recordStep;
+
+#if RECORD_DUMP_SIZE
+/*
+ The target's dump area, in USB RAM - NOLOAD, so Record_init fills in the header.
+ */
+#if defined(__MSP430__)
+#pragma DATA_SECTION(recordDump, ".dumpram")
+#endif
+RecordDump_T recordDump;
+static Bool dumpFrozen;				// full, or holds an anomaly
+#endif
+
+static RecordEvent_T recordRing[RECORD_RING_SIZE];
+static volatile UInt recordTail;	// next position to write
+static volatile UInt recordHead;	// next position to drain (drainer only)
+static Record_SinkFxn recordSink = NULL;
+static RecordHooks_T recordHooks;
+
+
+/*
+ * Function: Record_init
+ * Description: empty the ring and clear the counters and the step.
+ * Input: void
+ * Output: void
+ * Algorithm: memset of the counters, indices to 0. The dump area gets its header and is emptied.
+*/
+Void Record_init(void)
+{
+#if RECORD_DUMP_SIZE
+	memset(&recordDump, 0, sizeof(recordDump));
+	memcpy(recordDump.header.magic, "PCRECRD1", sizeof(recordDump.header.magic));
+	recordDump.header.ringSize = RECORD_RING_SIZE;
+	dumpFrozen = FALSE;
+#endif
+	memset(&recordStats, 0, sizeof(recordStats));
+	recordStep = 0;
+	recordTail = 0;
+	recordHead = 0;
+}
+
+/*
+ * Function: taskId
+ * Description: the RecordEvent_T task byte of a Task.
+ * Input: Task_Handle task - the Task, NULL for the idle loop (host build).
+ * Output: UInt8 - its topology index, 0x40 | priority for the other Tasks, RECORD_IDLE for the
+ * 				   idle loop (the target's Idle Task - priority 0 - and the host's NULL).
+ * Algorithm: scan the (at most TOPOLOGY_MAX_TASKS) topology Tasks. The ids are the same on the
+ * 			  target and the host as long as the topology is created in the same order and the
+ * 			  other Tasks have distinct priorities.
+*/
+static UInt8 taskId(Task_Handle task)
+{
+	Int i = 0;
+
+	if(task == NULL || Task_getPri(task) == 0) {
+		return RECORD_IDLE;
+	}
+	for(i = 0 ; i < Topology_numTasks() ; i++) {
+		if(Topology_task(i) == task) {
+			return (UInt8)i;
+		}
+	}
+	return (UInt8)(0x40 | (Task_getPri(task) & 0x3F));
+}
+
+/*
+ * Function: recordWrite
+ * Description: append one event to the ring.
+ * Input: RecordKind_E kind, UInt8 task, UInt16 step - the event's fields.
+ * Output: void
+ * Algorithm: in the RECORD_LOCK window: once stopped, drop; a full ring drops the event and
+ * 			  stops the recording, so what was recorded stays a gap-free prefix of the run.
+ * 			  Otherwise store at the tail and advance it. The harness' event hook sees the
+ * 			  event after the window.
+*/
+static Void recordWrite(RecordKind_E kind, UInt8 task, UInt16 step)
+{
+	RecordEvent_T event;
+	UInt key;
+
+	event.kind = (UInt8)kind;
+	event.task = task;
+	event.step = step;
+
+	RECORD_LOCK(key);
+	if(recordStats.stopped || (UInt)(recordTail - recordHead) >= RECORD_RING_SIZE) {
+		recordStats.stopped = TRUE;
+		recordStats.dropped = recordStats.dropped + 1;
+		RECORD_UNLOCK(key);
+		return;
+	}
+	recordRing[recordTail & RECORD_MASK] = event;
+	recordTail = recordTail + 1;
+	recordStats.events = recordStats.events + 1;
+	RECORD_UNLOCK(key);
+
+	if(recordHooks.event != NULL) {
+		recordHooks.event(&event);
+	}
+}
+
+Void Record_event(RecordKind_E kind)
+{
+	recordWrite(kind, taskId(Task_self()), (UInt16)recordStep);
+}
+
+Void Record_tick(void)
+{
+	recordWrite(recTick_e, taskId(Task_self()), (UInt16)recordStep);
+}
+
+Bool Record_pend(Bool result)
+{
+	if(!result) {
+		recordWrite(recPendFail_e, taskId(Task_self()), (UInt16)recordStep);
+	}
+	return result;
+}
+
+/*
+ * Function: Record_entropy
+ * Description: record a workload seed.
+ * Input: UInt32 value - the Prng_entropy value.
+ * Output: UInt32 - the seed to use: value, or the replayed one (harness entropy hook).
+ * Algorithm: two recEntropy_e events, low 16 bits first.
+*/
+UInt32 Record_entropy(UInt32 value)
+{
+	UInt8 task = taskId(Task_self());
+
+	if(recordHooks.entropy != NULL) {
+		value = recordHooks.entropy(value);
+	}
+	recordWrite(recEntropy_e, task, (UInt16)(value & 0xFFFF));
+	recordWrite(recEntropy_e, task, (UInt16)(value >> 16));
+	return value;
+}
+
+Void Record_point(void)
+{
+	recordStep = recordStep + 1;
+	if(recordHooks.point != NULL) {
+		recordHooks.point();
+	}
+}
+
+/*
+ * Function: Record_switchHook
+ * Description: record the switch to next.
+ * Input: Task_Handle prev - the Task switched out (unused), Task_Handle next - the Task switched in.
+ * Output: void
+ * Algorithm: one recSwitch_e event - the replay checks its own switches against them.
+*/
+Void Record_switchHook(Task_Handle prev, Task_Handle next)
+{
+	(Void)prev;
+#if RECORD_INTERLEAVING
+	recordWrite(recSwitch_e, taskId(next), (UInt16)recordStep);
+#else
+	(Void)next;								// registered in empty.cfg either way
+#endif
+}
+
+/*
+ * Function: Record_drain
+ * Description: move the oldest events from the ring to dst.
+ * Input: RecordEvent_T *dst - receives the events, Int max - room in dst.
+ * Output: Int - number of events moved.
+ * Algorithm: copy from the head up to the tail; the head is advanced once they are copied, so a
+ * 			  writer never overwrites an event being drained.
+*/
+Int Record_drain(RecordEvent_T *dst, Int max)
+{
+	UInt pos = recordHead;
+	Int n = 0;
+
+	while(n < max && pos != recordTail) {
+		dst[n] = recordRing[pos & RECORD_MASK];
+		pos = pos + 1;
+		n = n + 1;
+	}
+	recordHead = pos;
+	return n;
+}
+
+Void Record_setSink(Record_SinkFxn fxn)
+{
+	recordSink = fxn;
+}
+
+/*
+ * Function: Record_dumpSink
+ * Description: the RAM dump sink - append the events to recordDump.
+ * Input: const RecordEvent_T *events, Int n - the drained events.
+ * Output: void
+ * Algorithm: copy until recordDump is full or an anomaly was copied, then stop the recording:
+ * 			  the dump is a gap-free prefix of the run that ends at the anomaly, and nothing after
+ * 			  it would be kept anyway.
+*/
+Void Record_dumpSink(const RecordEvent_T *events, Int n)
+{
+#if RECORD_DUMP_SIZE
+	Int i = 0;
+
+	for(i = 0 ; i < n && !dumpFrozen ; i++) {
+		recordDump.events[recordStats.dumped] = events[i];
+		recordStats.dumped = recordStats.dumped + 1;
+		if(recordStats.dumped == RECORD_DUMP_SIZE || events[i].kind == recAnomaly_e) {
+			dumpFrozen = TRUE;
+			recordStats.stopped = TRUE;		// a Bool store - recordWrite sees it in its next window
+		}
+	}
+#else
+	(Void)events;
+	(Void)n;
+#endif
+}
+
+Void Record_setHooks(const RecordHooks_T *hooks)
+{
+	if(hooks != NULL) {
+		recordHooks = *hooks;
+	} else {
+		memset(&recordHooks, 0, sizeof(recordHooks));
+	}
+}
+
+/*
+ * Function: Record_flush
+ * Description: drain the whole ring into the sink.
+ * Input: void
+ * Output: void
+ * Algorithm: RECORD_DRAIN_BATCH events at a time, until the ring is empty.
+*/
+Void Record_flush(void)
+{
+	RecordEvent_T batch[RECORD_DRAIN_BATCH];
+	Int n = 0;
+
+	do {
+		n = Record_drain(batch, RECORD_DRAIN_BATCH);
+		if(n > 0 && recordSink != NULL) {
+			recordSink(batch, n);
+		}
+		recordStats.drained = recordStats.drained + n;
+	} while(n == RECORD_DRAIN_BATCH);
+}
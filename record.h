@@ -0,0 +1,291 @@
+/*
+ * record.h
+ *
+ * Record of the task interleaving - what it takes to replay a run on the host.
+ *
+ * The "Can't insert an item into a non-empty slot"/"Can't remove an item from an empty slot"
+ * paths of insert_item/remove_item fire rarely, and by the time they do, the interleaving of
+ * the producers and consumers that led there is gone. The recorder keeps it: every decision of
+ * the run that does not follow from the code and its data goes into a ring of 4-byte
+ * RecordEvent_T events -
+ *
+ *  - recTick_e: a Clock tick (tsClockHandler), with the record step it arrived at - the only
+ *    asynchronous event of the application, and the cause of every preemption;
+ *  - recSwitch_e: a Task switch (the Record_switchHook switch hook), to check the replay against;
+ *  - recPendFail_e: a timed or non-blocking pend that got no token (RECORD_PEND);
+ *  - recEntropy_e: the Prng_entropy seed of a producer's workload, 16 bits per event;
+ *  - recAnomaly_e: one of the ERROR paths of the buffer code was taken.
+ *
+ * The record step (recordStep) counts the RECORD_POINTs passed by all the Tasks - the points
+ * sit between the shared-state accesses of insert_item/remove_item and their batch versions,
+ * so "tick at step N" places a preemption between two of those accesses. On the target a tick
+ * lands anywhere between point N and point N + 1, and the replay moves it to point N - the
+ * buffer state is the same at both places, only Task-local work differs.
+ *
+ * Cost: a RECORD_POINT is one increment, an event a handful of instructions in a Hwi_disable
+ * window - cheap enough to leave RECORD_INTERLEAVING on in production builds. The ring is
+ * emptied by the trace drain Task (trace.h) into a sink (Record_setSink); when it is full the
+ * recording stops for good (recordStats.stopped) - a record with a hole can't be replayed, one
+ * that ends early can, up to its end. So the ring must hold every event of one drain period:
+ * the drain Task (TRACE_DRAIN_PRIORITY, above the workers) runs every TRACE_DRAIN_TICKS tick,
+ * and RECORD_RING_SIZE is sized for the events of a tick with margin - the host, whose Tasks
+ * run far more items per tick than the MSP430, needs the larger ring.
+ *
+ * On the target main installs Record_dumpSink, which copies the events into recordDump - a RAM
+ * dump area in the MSP430F5529's USB RAM (the .dumpram section, next to the trace's traceDump):
+ * a RecordFileHeader_T, then the first RECORD_DUMP_SIZE events of the run. It freezes when it is
+ * full, or after the first recAnomaly_e - the end of what a replay needs - and the recording
+ * stops with it (recordStats.stopped), so the recorder costs nothing more. To replay a device run:
+ * halt it in CCS once recordStats shows the anomaly (or the dump full), save recordDump from the
+ * memory browser as a binary file - sizeof(RecordFileHeader_T) + 4 x recordStats.dumped bytes,
+ * or all of it: a replay ends at the first empty event - and run PC_REPLAY=<file> on a host
+ * build with the target's settings. A record starts at reset, so RAM bounds it to the first
+ * RECORD_DUMP_SIZE events - a few ticks of the run: an anomaly that comes later is counted, but
+ * not replayable.
+ *
+ * The host build records with PC_RECORD=<file> and replays with PC_REPLAY=<file> (see
+ * host/src/record_host.c): the replay runs the same insert_item/remove_item/handler code,
+ * raises every recorded tick at its step instead of on the host clock, feeds the recorded
+ * seeds to the workloads, and checks every event the run records against the file - it reports
+ * the first divergence, or that the recorded anomaly was reproduced. A replay needs a build with
+ * the same settings as the recording.
+ *
+ * RECORD_INTERLEAVING 0 compiles the recorder out.
+ */
+
+#ifndef RECORD_H_
+#define RECORD_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#ifndef RECORD_INTERLEAVING
+#define RECORD_INTERLEAVING	1		//1 - record the interleaving into the record ring, 0 - no recording
+#endif
+#ifndef RECORD_RING_SIZE
+#if defined(__MSP430__)
+#define RECORD_RING_SIZE	128		//Events in the ring, a power of two - a tick's worth on the target
+#else
+#define RECORD_RING_SIZE	1024	//The host runs ~250 events per 1 ms tick between two drains
+#endif
+#endif
+#define RECORD_DRAIN_BATCH	16		//Events handed to the sink per call
+#ifndef RECORD_DUMP_SIZE
+#if defined(__MSP430__)
+#define RECORD_DUMP_SIZE	320		//Events of recordDump, the target's sink - in USB RAM next to traceDump
+#else
+#define RECORD_DUMP_SIZE	0		//No recordDump - the host writes PC_RECORD files
+#endif
+#endif
+#define RECORD_IDLE			0xFF	//RecordEvent_T task of the idle loop
+
+#if (RECORD_RING_SIZE & (RECORD_RING_SIZE - 1)) != 0
+#error "RECORD_RING_SIZE must be a power of two"
+#endif
+
+
+/*
+ Enum RecordKind_E - the recorded events.
+ */
+typedef enum
+{
+	recNone_e = 0,
+	recSwitch_e = 1,			// task = the Task switched in
+	recTick_e = 2,				// task = the Task the tick interrupted
+	recPendFail_e = 3,			// task = the Task whose pend returned FALSE
+	recEntropy_e = 4,			// step = 16 bits of a Prng_entropy seed, low half first
+	recAnomaly_e = 5			// task = the Task that took an ERROR path
+} RecordKind_E;
+
+
+/*
+ Structure RecordEvent_T - one 4-byte record event.
+ */
+typedef struct
+{
+	UInt8 kind;					// RecordKind_E
+	UInt8 task;					// topology index, 0x40 | priority for other Tasks, RECORD_IDLE
+	UInt16 step;				// recordStep when it happened (the seed bits for recEntropy_e)
+} RecordEvent_T;
+
+
+/*
+ Structure RecordFileHeader_T - first 16 bytes of a record dump.
+ */
+typedef struct
+{
+	Char magic[8];				// "PCRECRD1"
+	UInt32 ringSize;			// RECORD_RING_SIZE
+	UInt32 reserved;
+} RecordFileHeader_T;
+
+
+/*
+ Structure RecordStats_T - recorder counters (RAM, readable from ROV/the memory browser).
+ */
+typedef struct
+{
+	UInt32 events;				// events written
+	UInt32 drained;				// events handed to the sink (or discarded without one)
+	UInt32 dropped;				// events lost to a full ring - the recording stopped at the first
+	Bool stopped;
+	UInt dumped;				// events in recordDump
+} RecordStats_T;
+
+extern RecordStats_T recordStats;
+extern volatile UInt recordStep;
+
+
+#if RECORD_DUMP_SIZE
+/*
+ Structure RecordDump_T - the target's RAM dump area: a record file as PC_REPLAY reads it.
+ */
+typedef struct
+{
+	RecordFileHeader_T header;
+	RecordEvent_T events[RECORD_DUMP_SIZE];	// the first recordStats.dumped are valid, the rest are 0
+} RecordDump_T;
+
+extern RecordDump_T recordDump;
+#endif
+
+
+/*
+ Type Record_SinkFxn - receives the drained events, called from the drain Task.
+ */
+typedef Void (*Record_SinkFxn)(const RecordEvent_T *events, Int n);
+
+
+/*
+ Structure RecordHooks_T - host replay/record harness (record_host.c), NULL members are skipped.
+ The target sets none.
+ */
+typedef struct
+{
+	Void (*point)(Void);						// after every RECORD_POINT - where the host takes its ticks
+	Void (*event)(const RecordEvent_T *event);	// after every event written
+	UInt32 (*entropy)(UInt32 value);			// may replace a seed before it is recorded
+} RecordHooks_T;
+
+
+/*
+ RECORD_POINT - a record step, RECORD_PEND - a Semaphore_pend whose failure is recorded,
+ RECORD_RESULT - the same for the result of a pend made by other means (CPUACCT_PEND), RECORD_ANOMALY - an ERROR path, RECORD_TICK - a Clock tick, RECORD_ENTROPY - a seed. On the
+ target RECORD_POINT is a single increment; the host build calls Record_point, so the harness
+ can act at the point.
+ */
+#if RECORD_INTERLEAVING
+#if defined(__MSP430__)
+#define RECORD_POINT()				(recordStep = recordStep + 1)
+#else
+#define RECORD_POINT()				Record_point()
+#endif
+#define RECORD_PEND(sem, timeout)	Record_pend(Semaphore_pend((sem), (timeout)))
+#define RECORD_RESULT(result)		Record_pend(result)
+#define RECORD_ANOMALY()			Record_event(recAnomaly_e)
+#define RECORD_TICK()				Record_tick()
+#define RECORD_ENTROPY(value)		Record_entropy(value)
+#else
+#define RECORD_POINT()
+#define RECORD_PEND(sem, timeout)	Semaphore_pend((sem), (timeout))
+#define RECORD_RESULT(result)		(result)
+#define RECORD_ANOMALY()
+#define RECORD_TICK()
+#define RECORD_ENTROPY(value)		(value)
+#endif
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Record_init(void)
+
+ Empties the ring, clears recordStats and recordStep. Called from main before BIOS_start.
+ */
+Void Record_init(void);
+
+/*
+ Function: Void Record_event(RecordKind_E kind)
+
+ Records an event of the calling Task (or of the Task a Swi/Hwi interrupted) at the current
+ step. Never blocks; safe from Task, Swi and Hwi context and from a switch hook.
+ */
+Void Record_event(RecordKind_E kind);
+
+/*
+ Function: Void Record_tick(void)
+
+ Records a Clock tick - called first thing in tsClockHandler, which runs on every tick.
+ */
+Void Record_tick(void);
+
+/*
+ Function: Bool Record_pend(Bool result)
+
+ Records a recPendFail_e when result (of a Semaphore_pend) is FALSE, and returns result.
+ */
+Bool Record_pend(Bool result);
+
+/*
+ Function: UInt32 Record_entropy(UInt32 value)
+
+ Records a Prng_entropy seed (two recEntropy_e events) and returns it - the replay's seed
+ instead, on a replay.
+ */
+UInt32 Record_entropy(UInt32 value);
+
+/*
+ Function: Void Record_point(void)
+
+ RECORD_POINT of the host build - the increment, then the harness' point hook.
+ */
+Void Record_point(void);
+
+/*
+ Function: Void Record_switchHook(Task_Handle prev, Task_Handle next)
+
+ Task switch hook (Task.addHookSet switchFxn in empty.cfg) - records the switch to next.
+ */
+Void Record_switchHook(Task_Handle prev, Task_Handle next);
+
+/*
+ Function: Int Record_drain(RecordEvent_T *dst, Int max)
+
+ Moves up to max events, oldest first, from the ring to dst and returns how many. Single
+ drainer only - the drain Task, or the host report once the Tasks are stopped.
+ */
+Int Record_drain(RecordEvent_T *dst, Int max);
+
+/*
+ Function: Void Record_setSink(Record_SinkFxn fxn)
+
+ Sets the function the drain Task hands the events to (NULL - count and discard them).
+ */
+Void Record_setSink(Record_SinkFxn fxn);
+
+/*
+ Function: Void Record_dumpSink(const RecordEvent_T *events, Int n)
+
+ The RAM dump sink (RECORD_DUMP_SIZE > 0): appends the events to recordDump, and freezes it -
+ and stops the recording - when it is full or holds a recAnomaly_e.
+ */
+Void Record_dumpSink(const RecordEvent_T *events, Int n);
+
+/*
+ Function: Void Record_setHooks(const RecordHooks_T *hooks)
+
+ Installs the host harness hooks (NULL - none). Call it before BIOS_start.
+ */
+Void Record_setHooks(const RecordHooks_T *hooks);
+
+/*
+ Function: Void Record_flush(void)
+
+ Drains the whole ring into the sink. Called by the trace drain Task, and by the host report.
+ */
+Void Record_flush(void);
+
+#endif /* RECORD_H_ */
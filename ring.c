@@ -0,0 +1,271 @@
+/*
+ * ring.c
+ *
+ * Lock-free SPSC and MPMC ring buffer engines - see ring.h for the full description.
+ */
+
+#include "ring.h"
+#if RING_CLAIM_YIELD
+#include <ti/sysbios/knl/Task.h>
+#define CLAIM_YIELD()	Task_yield()	// the window between a claim and its publication, see ring.h
+#else
+#define CLAIM_YIELD()
+#endif
+
+/*
+ * Function: SpscRing_init
+ * Description: initialize an empty single-producer/single-consumer ring.
+ * Input: SpscRing_T *ring - the ring, volatile Int *storage - capacity items, UInt capacity - power of two.
+ * Output: void
+ * Algorithm: head == tail == 0 means empty, mask is used instead of % on every access.
+*/
+Void SpscRing_init(SpscRing_T *ring, volatile Int *storage, UInt capacity)
+{
+	RING_STORE_RELAXED(&ring->head, 0);
+	RING_STORE_RELAXED(&ring->tail, 0);
+	ring->mask = capacity - 1;
+	ring->storage = storage;
+	ring->tags = NULL;
+}
+
+/*
+ * Function: SpscRing_setTags
+ * Description: give the ring a latency tag per slot.
+ * Input: SpscRing_T *ring, RingTag_T *tags - capacity tags (the capacity of SpscRing_init), or NULL for none.
+ * Output: void
+ * Algorithm: a plain store, no barrier - call it after SpscRing_init and before the first push or pop.
+*/
+Void SpscRing_setTags(SpscRing_T *ring, RingTag_T *tags)
+{
+	ring->tags = tags;
+}
+
+/*
+ * Function: SpscRing_push
+ * Description: append an item (producer side only).
+ * Input: SpscRing_T *ring, Int item.
+ * Output: Bool - FALSE if the ring is full, TRUE otherwise.
+ * Algorithm: the producer owns tail, so it reads it relaxed; head is read with acquire so the
+ * 			  slot freed by the consumer is really free, then the item is written and tail is
+ * 			  published with release so the consumer never sees the index before the item.
+*/
+Bool SpscRing_push(SpscRing_T *ring, Int item)
+{
+	return SpscRing_pushTagged(ring, item, NULL);
+}
+
+/*
+ * Function: SpscRing_pushTagged
+ * Description: append an item and its tag (producer side only).
+ * Input: SpscRing_T *ring, Int item, const RingTag_T *tag - may be NULL.
+ * Output: Bool - FALSE if the ring is full, TRUE otherwise.
+ * Algorithm: as SpscRing_push - the tag is stored next to the item, before tail is published.
+*/
+Bool SpscRing_pushTagged(SpscRing_T *ring, Int item, const RingTag_T *tag)
+{
+	UInt tail = RING_LOAD_RELAXED(&ring->tail);
+	UInt head = RING_LOAD_ACQUIRE(&ring->head);
+
+	if((UInt)(tail - head) > ring->mask) {	// tail - head == capacity - ring is full
+		return FALSE;
+	}
+	ring->storage[tail & ring->mask] = item;
+	if(tag != NULL && ring->tags != NULL) {
+		ring->tags[tail & ring->mask] = *tag;
+	}
+	RING_STORE_RELEASE(&ring->tail, tail + 1);
+	return TRUE;
+}
+
+/*
+ * Function: SpscRing_pop
+ * Description: remove the oldest item (consumer side only).
+ * Input: SpscRing_T *ring, Int *item - receives the removed item.
+ * Output: Bool - FALSE if the ring is empty, TRUE otherwise.
+ * Algorithm: mirror image of SpscRing_push - the consumer owns head.
+*/
+Bool SpscRing_pop(SpscRing_T *ring, Int *item)
+{
+	return SpscRing_popTagged(ring, item, NULL);
+}
+
+/*
+ * Function: SpscRing_popTagged
+ * Description: remove the oldest item and its tag (consumer side only).
+ * Input: SpscRing_T *ring, Int *item - receives the item, RingTag_T *tag - receives its tag, may be NULL.
+ * Output: Bool - FALSE if the ring is empty, TRUE otherwise.
+ * Algorithm: as SpscRing_pop - the tag is read before head frees the slot.
+*/
+Bool SpscRing_popTagged(SpscRing_T *ring, Int *item, RingTag_T *tag)
+{
+	UInt head = RING_LOAD_RELAXED(&ring->head);
+	UInt tail = RING_LOAD_ACQUIRE(&ring->tail);
+
+	if(head == tail) {						// ring is empty
+		return FALSE;
+	}
+	*item = ring->storage[head & ring->mask];
+	if(tag != NULL && ring->tags != NULL) {
+		*tag = ring->tags[head & ring->mask];
+	}
+	RING_STORE_RELEASE(&ring->head, head + 1);
+	return TRUE;
+}
+
+/*
+ * Function: SpscRing_count
+ * Description: number of items currently in the ring (snapshot).
+ * Input: SpscRing_T *ring.
+ * Output: UInt - tail - head.
+ * Algorithm: free running indices, unsigned difference handles the wrap.
+*/
+UInt SpscRing_count(SpscRing_T *ring)
+{
+	return (UInt)(RING_LOAD_ACQUIRE(&ring->tail) - RING_LOAD_ACQUIRE(&ring->head));
+}
+
+/*
+ * Function: MpmcRing_init
+ * Description: initialize an empty multi-producer/multi-consumer ring.
+ * Input: MpmcRing_T *ring, MpmcCell_T *cells - capacity cells, UInt capacity - power of two.
+ * Output: void
+ * Algorithm: cell i gets sequence number i, i.e. it is free for the producer at position i.
+*/
+Void MpmcRing_init(MpmcRing_T *ring, MpmcCell_T *cells, UInt capacity)
+{
+	UInt i = 0;
+	for(i = 0 ; i < capacity ; i++) {
+		RING_STORE_RELAXED(&cells[i].seq, i);
+		cells[i].item = -1;
+	}
+	RING_STORE_RELAXED(&ring->head, 0);
+	RING_STORE_RELAXED(&ring->tail, 0);
+	ring->mask = capacity - 1;
+	ring->cells = cells;
+	ring->tags = NULL;
+}
+
+/*
+ * Function: MpmcRing_setTags
+ * Description: give the ring a latency tag per cell.
+ * Input: MpmcRing_T *ring, RingTag_T *tags - capacity tags (the capacity of MpmcRing_init), or NULL for none.
+ * Output: void
+ * Algorithm: a plain store, no barrier - call it after MpmcRing_init and before the first push or pop.
+*/
+Void MpmcRing_setTags(MpmcRing_T *ring, RingTag_T *tags)
+{
+	ring->tags = tags;
+}
+
+/*
+ * Function: MpmcRing_push
+ * Description: append an item, any number of concurrent producers.
+ * Input: MpmcRing_T *ring, Int item.
+ * Output: Bool - FALSE if the ring is full, TRUE otherwise.
+ * Algorithm: look at the cell of the current tail position: seq == pos means the cell is free
+ * 			  for this lap - try to claim the position with a CAS on tail; seq < pos means the
+ * 			  consumer of the previous lap did not free it yet - the ring is full; seq > pos means
+ * 			  another producer already claimed this position - reload tail and retry.
+ * 			  Once claimed, the item is written and the cell is published with seq = pos + 1.
+*/
+Bool MpmcRing_push(MpmcRing_T *ring, Int item)
+{
+	return MpmcRing_pushTagged(ring, item, NULL);
+}
+
+/*
+ * Function: MpmcRing_pushTagged
+ * Description: append an item and its tag, any number of concurrent producers.
+ * Input: MpmcRing_T *ring, Int item, const RingTag_T *tag - may be NULL.
+ * Output: Bool - FALSE if the ring is full, TRUE otherwise.
+ * Algorithm: as MpmcRing_push - the tag of the claimed position is written before the cell's
+ * 			  seq publishes it.
+*/
+Bool MpmcRing_pushTagged(MpmcRing_T *ring, Int item, const RingTag_T *tag)
+{
+	MpmcCell_T *cell;
+	UInt pos = RING_LOAD_RELAXED(&ring->tail);
+
+	while(1) {
+		cell = &ring->cells[pos & ring->mask];
+		UInt seq = RING_LOAD_ACQUIRE(&cell->seq);
+		Int dif = (Int)(seq - pos);
+		if(dif == 0) {
+			if(ringCas(&ring->tail, pos, pos + 1)) {
+				break;
+			}
+		} else if(dif < 0) {
+			return FALSE;
+		}
+		pos = RING_LOAD_RELAXED(&ring->tail);
+	}
+
+	CLAIM_YIELD();
+	cell->item = item;
+	if(tag != NULL && ring->tags != NULL) {
+		ring->tags[pos & ring->mask] = *tag;
+	}
+	RING_STORE_RELEASE(&cell->seq, pos + 1);
+	return TRUE;
+}
+
+/*
+ * Function: MpmcRing_pop
+ * Description: remove the oldest item, any number of concurrent consumers.
+ * Input: MpmcRing_T *ring, Int *item - receives the removed item.
+ * Output: Bool - FALSE if the ring is empty, TRUE otherwise.
+ * Algorithm: mirror image of MpmcRing_push - a cell holding an item for position pos has
+ * 			  seq == pos + 1; after reading the item the cell is handed to the producer of the
+ * 			  next lap with seq = pos + capacity.
+*/
+Bool MpmcRing_pop(MpmcRing_T *ring, Int *item)
+{
+	return MpmcRing_popTagged(ring, item, NULL);
+}
+
+/*
+ * Function: MpmcRing_popTagged
+ * Description: remove the oldest item and its tag, any number of concurrent consumers.
+ * Input: MpmcRing_T *ring, Int *item - receives the item, RingTag_T *tag - receives its tag, may be NULL.
+ * Output: Bool - FALSE if the ring is empty, TRUE otherwise.
+ * Algorithm: as MpmcRing_pop - the tag is read before the cell is handed to the next lap.
+*/
+Bool MpmcRing_popTagged(MpmcRing_T *ring, Int *item, RingTag_T *tag)
+{
+	MpmcCell_T *cell;
+	UInt pos = RING_LOAD_RELAXED(&ring->head);
+
+	while(1) {
+		cell = &ring->cells[pos & ring->mask];
+		UInt seq = RING_LOAD_ACQUIRE(&cell->seq);
+		Int dif = (Int)(seq - (pos + 1));
+		if(dif == 0) {
+			if(ringCas(&ring->head, pos, pos + 1)) {
+				break;
+			}
+		} else if(dif < 0) {
+			return FALSE;
+		}
+		pos = RING_LOAD_RELAXED(&ring->head);
+	}
+
+	CLAIM_YIELD();
+	*item = cell->item;
+	if(tag != NULL && ring->tags != NULL) {
+		*tag = ring->tags[pos & ring->mask];
+	}
+	RING_STORE_RELEASE(&cell->seq, pos + ring->mask + 1);
+	return TRUE;
+}
+
+/*
+ * Function: MpmcRing_count
+ * Description: number of claimed positions (snapshot, for Logs/statistics).
+ * Input: MpmcRing_T *ring.
+ * Output: UInt - tail - head.
+ * Algorithm: free running indices, unsigned difference handles the wrap.
+*/
+UInt MpmcRing_count(MpmcRing_T *ring)
+{
+	return (UInt)(RING_LOAD_ACQUIRE(&ring->tail) - RING_LOAD_ACQUIRE(&ring->head));
+}
@@ -0,0 +1,267 @@
+/*
+ * ring.h
+ *
+ * Lock-free ring buffer engines for the shared producer/consumer buffer.
+ *
+ * Two engines are provided behind the same push/pop style API:
+ *
+ *  - SpscRing_T: a wait-free single-producer/single-consumer ring. The producer only ever
+ *    writes "tail" and the consumer only ever writes "head", so no atomic read-modify-write
+ *    is needed at all - only ordered loads/stores of the two indices.
+ *
+ *  - MpmcRing_T: a bounded multi-producer/multi-consumer ring. Every slot carries its own
+ *    sequence number, which tells a producer whether the slot is free for the current lap and
+ *    a consumer whether the slot was already filled for the current lap. Producers (and
+ *    consumers) only race on a single compare-and-swap of the tail (head) index, and never on
+ *    the slots themselves.
+ *
+ * The engines never block - push returns FALSE when the ring is full and pop returns FALSE
+ * when the ring is empty. Blocking on full/empty is left to the caller (see insert_item and
+ * remove_item in main.c, which keep the emptySlots/fullSlots counting semaphores for that, but
+ * no longer need the mutex semaphore).
+ *
+ * Indices are free running and are masked on every access, so the capacity MUST be a power of
+ * two (and must not exceed half of the index range, i.e. 32768 on the MSP430 16 bit UInt).
+ *
+ * Every item may carry a RingTag_T (a timestamp, a sequence number, the id of its source and its
+ * priority lane - see latency.h) in a parallel tag array given with SpscRing_setTags/MpmcRing_setTags. The tag is
+ * written and read together with the item, inside the same publication, so the *Tagged calls
+ * deliver it to exactly the consumer that gets the item.
+ *
+ * Portability: on the MSP430 target (__MSP430__) there is a single CPU core, 16 bit loads and
+ * stores are atomic and volatile accesses are not reordered by the compiler, so ordered index
+ * loads/stores are plain volatile accesses and the MPMC compare-and-swap is done inside a
+ * few-instructions Hwi_disable()/Hwi_restore() window. On a host build the same code uses C11
+ * <stdatomic.h> acquire/release operations, so the engines can be built as a plain host
+ * library (pthreads producers/consumers) and benchmarked against the semaphore path.
+ *
+ * The host's emulated kernel only switches Tasks at kernel calls, so it never preempts a Task
+ * between an MPMC claim and its publication, as a Clock tick can on the target.
+ * RING_CLAIM_YIELD 1 yields there, to exercise that window (BoundedBuffer_awaitCell) on the host.
+ */
+
+#ifndef RING_H_
+#define RING_H_
+
+#include <xdc/std.h>
+
+#ifndef RING_CLAIM_YIELD
+#define RING_CLAIM_YIELD	0		//Testing - 1: MPMC push/pop Task_yield between claiming a cell and publishing it
+#endif
+
+//-----------------------------------------
+// Atomic index type and ordered index accesses (target vs. host) - shared with the other
+// lock-free structures built on the same index protocol (trace.h) and the seqlock of winstats.h
+//-----------------------------------------
+#if defined(__MSP430__)
+#include <ti/sysbios/hal/Hwi.h>		// Hwi_disable/Hwi_restore for the single-core CAS
+
+typedef volatile UInt RingIndex_T;
+
+#define RING_LOAD_RELAXED(p)		(*(p))
+#define RING_LOAD_ACQUIRE(p)		(*(p))
+#define RING_STORE_RELEASE(p, v)	(*(p) = (v))
+#define RING_STORE_RELAXED(p, v)	(*(p) = (v))
+#define RING_FENCE_RELEASE()		((Void)0)	// one core - volatile accesses stay in program order
+#define RING_FENCE_ACQUIRE()		((Void)0)
+
+/*
+ * Function: ringCas
+ * Description: compare-and-swap of a ring index on the single-core MSP430.
+ * Input: RingIndex_T *p - the index, UInt expected - value it must hold, UInt desired - new value.
+ * Output: Bool - TRUE if *p held expected and was replaced by desired, FALSE otherwise.
+ * Algorithm: the MSP430 has no CAS instruction, so the compare and the store are done with
+ * 			  interrupts masked - a window of a handful of instructions, shorter than any
+ * 			  Semaphore_pend/post, and safe from Task, Swi and Hwi context alike.
+*/
+static inline Bool ringCas(RingIndex_T *p, UInt expected, UInt desired)
+{
+	UInt key = Hwi_disable();
+	Bool swapped = (*p == expected);
+	if(swapped) {
+		*p = desired;
+	}
+	Hwi_restore(key);
+	return swapped;
+}
+
+#else
+#include <stdatomic.h>
+
+typedef atomic_uint RingIndex_T;
+
+#define RING_LOAD_RELAXED(p)		atomic_load_explicit((p), memory_order_relaxed)
+#define RING_LOAD_ACQUIRE(p)		atomic_load_explicit((p), memory_order_acquire)
+#define RING_STORE_RELEASE(p, v)	atomic_store_explicit((p), (v), memory_order_release)
+#define RING_STORE_RELAXED(p, v)	atomic_store_explicit((p), (v), memory_order_relaxed)
+#define RING_FENCE_RELEASE()		atomic_thread_fence(memory_order_release)
+#define RING_FENCE_ACQUIRE()		atomic_thread_fence(memory_order_acquire)
+
+static inline Bool ringCas(RingIndex_T *p, UInt expected, UInt desired)
+{
+	return atomic_compare_exchange_weak_explicit(p, &expected, desired,
+			memory_order_relaxed, memory_order_relaxed) ? TRUE : FALSE;
+}
+
+#endif
+
+
+/*
+ Structure RingTag_T - per item metadata carried along with the item (latency stamping).
+ */
+typedef struct
+{
+	UInt32 stamp;				// Timestamp_get32() at insertion
+	UInt16 seq;					// sequence number of the item at its source
+	UInt8 source;				// id of the producer that inserted it
+	UInt8 lane;					// priority lane of the item (bounded_buffer.h), 0 - routine
+} RingTag_T;
+
+
+/*
+ Structure SpscRing_T - wait-free single-producer/single-consumer ring of Int items.
+
+ "tail" is the free-running index of the next slot to be written (written by the producer
+ only), "head" is the free-running index of the next slot to be read (written by the consumer
+ only). The number of items in the ring is always (tail - head).
+ */
+typedef struct
+{
+	RingIndex_T head;
+	RingIndex_T tail;
+	UInt mask;					// capacity - 1
+	volatile Int *storage;		// capacity Int items
+	RingTag_T *tags;			// capacity tags, or NULL
+} SpscRing_T;
+
+
+/*
+ Structure MpmcCell_T - one slot of the MPMC ring: the stored item plus its sequence number.
+ A slot whose seq equals the producer position is free for that lap, a slot whose seq equals
+ the consumer position + 1 holds an item for that lap.
+ */
+typedef struct
+{
+	RingIndex_T seq;
+	volatile Int item;
+} MpmcCell_T;
+
+
+/*
+ Structure MpmcRing_T - bounded multi-producer/multi-consumer ring of Int items.
+ */
+typedef struct
+{
+	RingIndex_T head;			// next position to consume (CAS'ed by consumers)
+	RingIndex_T tail;			// next position to produce (CAS'ed by producers)
+	UInt mask;					// capacity - 1
+	MpmcCell_T *cells;			// capacity cells
+	RingTag_T *tags;			// capacity tags (indexed like cells), or NULL
+} MpmcRing_T;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void SpscRing_init(SpscRing_T *ring, volatile Int *storage, UInt capacity)
+
+ Initialises an empty SPSC ring over caller supplied storage of "capacity" Int items.
+ capacity must be a power of two.
+ */
+Void SpscRing_init(SpscRing_T *ring, volatile Int *storage, UInt capacity);
+
+/*
+ Function: Bool SpscRing_push(SpscRing_T *ring, Int item)
+
+ Must only be called by the single producer. Returns FALSE (and does nothing) if the ring is
+ full, TRUE otherwise. Never blocks and never retries - wait-free.
+ */
+Bool SpscRing_push(SpscRing_T *ring, Int item);
+
+/*
+ Function: Bool SpscRing_pop(SpscRing_T *ring, Int *item)
+
+ Must only be called by the single consumer. Returns FALSE (and does nothing) if the ring is
+ empty, TRUE otherwise (the oldest item is copied to *item). Wait-free.
+ */
+Bool SpscRing_pop(SpscRing_T *ring, Int *item);
+
+/*
+ Function: Void SpscRing_setTags(SpscRing_T *ring, RingTag_T *tags)
+
+ Gives the ring a parallel array of tags - from then on SpscRing_pushTagged and
+ SpscRing_popTagged carry a RingTag_T with every item. The array must have "capacity" entries
+ (the capacity of SpscRing_init), NULL for none. Call it after SpscRing_init and before the
+ first push or pop - it is a plain store, not published to a running producer or consumer.
+ */
+Void SpscRing_setTags(SpscRing_T *ring, RingTag_T *tags);
+
+/*
+ Function: Bool SpscRing_pushTagged(SpscRing_T *ring, Int item, const RingTag_T *tag)
+ Function: Bool SpscRing_popTagged(SpscRing_T *ring, Int *item, RingTag_T *tag)
+
+ SpscRing_push/SpscRing_pop that also store/return the item's tag. The tag is ignored when the
+ ring has no tag array (pop then leaves *tag untouched); a NULL tag is allowed.
+ */
+Bool SpscRing_pushTagged(SpscRing_T *ring, Int item, const RingTag_T *tag);
+Bool SpscRing_popTagged(SpscRing_T *ring, Int *item, RingTag_T *tag);
+
+/*
+ Function: UInt SpscRing_count(SpscRing_T *ring)
+
+ Returns the number of items currently held in the ring (a snapshot - may be stale by the
+ time the caller looks at it, it is meant for Logs/statistics only).
+ */
+UInt SpscRing_count(SpscRing_T *ring);
+
+/*
+ Function: Void MpmcRing_init(MpmcRing_T *ring, MpmcCell_T *cells, UInt capacity)
+
+ Initialises an empty MPMC ring over caller supplied "capacity" cells (power of two).
+ */
+Void MpmcRing_init(MpmcRing_T *ring, MpmcCell_T *cells, UInt capacity);
+
+/*
+ Function: Bool MpmcRing_push(MpmcRing_T *ring, Int item)
+
+ May be called concurrently by any number of producers. Returns FALSE if the ring is full.
+ */
+Bool MpmcRing_push(MpmcRing_T *ring, Int item);
+
+/*
+ Function: Bool MpmcRing_pop(MpmcRing_T *ring, Int *item)
+
+ May be called concurrently by any number of consumers. Returns FALSE if the ring is empty.
+ */
+Bool MpmcRing_pop(MpmcRing_T *ring, Int *item);
+
+/*
+ Function: Void MpmcRing_setTags(MpmcRing_T *ring, RingTag_T *tags)
+
+ Gives the ring a parallel array of tags, indexed like its cells. The array must have
+ "capacity" entries (the capacity of MpmcRing_init), NULL for none. Call it after MpmcRing_init
+ and before the first push or pop - it is a plain store, not published to running producers
+ or consumers.
+ */
+Void MpmcRing_setTags(MpmcRing_T *ring, RingTag_T *tags);
+
+/*
+ Function: Bool MpmcRing_pushTagged(MpmcRing_T *ring, Int item, const RingTag_T *tag)
+ Function: Bool MpmcRing_popTagged(MpmcRing_T *ring, Int *item, RingTag_T *tag)
+
+ Same as the SPSC versions - the tag is written before the cell is published to consumers and
+ read before the cell is handed back to producers.
+ */
+Bool MpmcRing_pushTagged(MpmcRing_T *ring, Int item, const RingTag_T *tag);
+Bool MpmcRing_popTagged(MpmcRing_T *ring, Int *item, RingTag_T *tag);
+
+/*
+ Function: UInt MpmcRing_count(MpmcRing_T *ring)
+
+ Returns a snapshot of the number of claimed (produced but not yet consumed) positions.
+ */
+UInt MpmcRing_count(MpmcRing_T *ring);
+
+#endif /* RING_H_ */
@@ -0,0 +1,437 @@
+/*
+ * spool.c
+ *
+ * Overflow spool of a bounded buffer - see spool.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/gates/GateMutexPri.h>
+#include <driverlib.h>
+
+#include "spool.h"
+#include "cpuacct.h"
+
+#define SPOOL_SEGMENTS		(SPOOL_FLASH_SIZE / SPOOL_SEGMENT_SIZE)
+#define SPOOL_MAGIC			0x5350		// "PS" - first half of a segment header
+#define SPOOL_SEG_HEADER	4			// UInt16 magic, UInt16 sequence number
+#define SPOOL_REC_HEADER	4			// UInt8 state, UInt8 count, UInt16 CRC
+#define SPOOL_RECORD(n)		(SPOOL_REC_HEADER + 2 * (n))
+
+#define SPOOL_ERASED		0xFF		// state of an erased byte - no more records in the segment
+#define SPOOL_ALLOCATED		0x7F		// header written, CRC and items may be incomplete
+#define SPOOL_VALID			0x3F		// CRC and items written
+#define SPOOL_CONSUMED		0x00		// every item back in the buffer
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ Spool counters, see SpoolStats_T.
+ */
+SpoolStats_T spoolStats;
+
+/*
+ The flash region. On the target the SPOOL range of the linker command file, kept out of the
+ program image (NOLOAD) so a reset - or a reload of the program - leaves the log alone.
+ */
+#if defined(__MSP430__)
+#pragma DATA_SECTION(spoolFlash, ".spool")
+static UInt8 spoolFlash[SPOOL_FLASH_SIZE];
+#endif
+static UInt8 *spoolBase = NULL;
+
+static GateMutexPri_Struct spoolGateObj;
+static GateMutexPri_Handle spoolGate = NULL;
+
+static Int writeSeg;					// segment of the next record
+static UInt16 writeOff;					// its offset, SPOOL_SEGMENT_SIZE - the segment is closed
+static UInt16 writeSeq;					// sequence number of writeSeg
+static Int readSeg;						// segment of the oldest record not yet read
+static UInt16 readOff;
+static UInt flashItems;					// items of the records not yet read
+
+static Int16 readBuf[SPOOL_BATCH];		// the record being drained
+static Int readCount;					// its items, 0 - none
+static Int readPos;						// next item of it
+static Int readRecSeg;					// where it is, to mark it consumed
+static UInt16 readRecOff;
+
+static Int16 batch[SPOOL_BATCH];		// the newest items, not written yet
+static Int batchFirst;					// oldest one still in the batch
+static Int batchCount;
+
+/*
+ CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF), four bits at a time.
+ */
+static const UInt16 crcNibble[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+
+static UInt16 crc16(UInt16 crc, const UInt8 *bytes, Int n)
+{
+	Int i = 0;
+
+	for(i = 0 ; i < n ; i++) {
+		crc = (UInt16)((crc << 4) ^ crcNibble[(crc >> 12) ^ (bytes[i] >> 4)]);
+		crc = (UInt16)((crc << 4) ^ crcNibble[(crc >> 12) ^ (bytes[i] & 0x0F)]);
+	}
+	return crc;
+}
+
+/*
+ * Function: recordCrc
+ * Description: the CRC of a record - over its count and items, around the CRC field.
+ * Input: const UInt8 *rec - the record, UInt8 count - its item count.
+ * Output: UInt16 - the CRC.
+*/
+static UInt16 recordCrc(const UInt8 *rec, UInt8 count)
+{
+	return crc16(crc16(0xFFFF, rec + 1, 1), rec + SPOOL_REC_HEADER, 2 * count);
+}
+
+static UInt8 *segment(Int s)
+{
+	return spoolBase + (SizeT)s * SPOOL_SEGMENT_SIZE;
+}
+
+static UInt16 readU16(const UInt8 *p)
+{
+	return (UInt16)(p[0] | (p[1] << 8));
+}
+
+static Void program(UInt8 *dst, UInt8 *src, UInt16 n)
+{
+	FlashCtl_write8(src, dst, n);
+	spoolStats.bytes = spoolStats.bytes + n;
+}
+
+static Void setState(Int s, UInt16 off, UInt8 state)
+{
+	program(segment(s) + off, &state, 1);
+}
+
+/*
+ * Function: segmentSeq
+ * Description: the sequence number of a segment in use.
+ * Input: Int s - the segment, UInt16 *seq - receives its sequence number.
+ * Output: Bool - FALSE for a segment without a (complete) header.
+*/
+static Bool segmentSeq(Int s, UInt16 *seq)
+{
+	const UInt8 *p = segment(s);
+
+	*seq = readU16(p + 2);
+	return readU16(p) == SPOOL_MAGIC && *seq != 0xFFFF;
+}
+
+/*
+ * Function: follows
+ * Description: whether segment s continues the log of the segment before it.
+ * Input: Int s.
+ * Output: Bool - TRUE if both are in use and s has the next sequence number.
+*/
+static Bool follows(Int s)
+{
+	UInt16 seq, prevSeq;
+	Int prev = (s + SPOOL_SEGMENTS - 1) % SPOOL_SEGMENTS;
+
+	return segmentSeq(s, &seq) && segmentSeq(prev, &prevSeq) && seq == (UInt16)(prevSeq + 1);
+}
+
+/*
+ * Function: updatePending
+ * Description: add to the items in the spool.
+ * Input: Int n - items added (removed if negative).
+ * Output: void
+ * Algorithm: the UInt store is a single write, so Spool_pending needs no lock; keep the maximum.
+*/
+static Void updatePending(Int n)
+{
+	spoolStats.pending = (UInt)(spoolStats.pending + n);
+	if(spoolStats.pending > spoolStats.pendingMax) {
+		spoolStats.pendingMax = spoolStats.pending;
+	}
+}
+
+/*
+ * Function: recover
+ * Description: find the log in the flash after a reset.
+ * Input: void
+ * Output: void
+ * Algorithm: the newest segment is the one in use that its successor doesn't follow; walk back
+ * 			  while the segments follow each other to the oldest. Scan their records oldest
+ * 			  first: the first valid one with a good CRC that is not consumed is where reading
+ * 			  starts, and the end of the newest segment's records is where writing goes on -
+ * 			  after a cut short record whose length is unknown, in the next segment. Bad
+ * 			  records are marked consumed, so the next scan skips them too.
+*/
+static Void recover(Void)
+{
+	Int newest = -1;
+	Int oldest, s, n;
+	UInt16 off, size;
+	UInt8 state, count;
+	const UInt8 *p;
+
+	for(s = 0 ; s < SPOOL_SEGMENTS && newest < 0 ; s++) {
+		if(segmentSeq(s, &writeSeq) && !follows((s + 1) % SPOOL_SEGMENTS)) {
+			newest = s;
+		}
+	}
+	if(newest < 0) {							// a blank log - the first record opens segment 0
+		writeSeg = SPOOL_SEGMENTS - 1;
+		writeOff = SPOOL_SEGMENT_SIZE;
+		writeSeq = 0;
+		readSeg = writeSeg;
+		readOff = writeOff;
+		return;
+	}
+	oldest = newest;
+	for(n = 1 ; n < SPOOL_SEGMENTS && follows(oldest) ; n++) {
+		oldest = (oldest + SPOOL_SEGMENTS - 1) % SPOOL_SEGMENTS;
+	}
+
+	readSeg = -1;
+	for(s = oldest ; ; s = (s + 1) % SPOOL_SEGMENTS) {
+		p = segment(s);
+		off = SPOOL_SEG_HEADER;
+		while(off + SPOOL_REC_HEADER <= SPOOL_SEGMENT_SIZE && p[off] != SPOOL_ERASED) {
+			state = p[off];
+			count = p[off + 1];
+			size = SPOOL_RECORD(count);
+			if(count == 0 || count > SPOOL_BATCH || off + size > SPOOL_SEGMENT_SIZE) {
+				spoolStats.torn = spoolStats.torn + 1;	// cut short before its count was written
+				off = SPOOL_SEGMENT_SIZE;
+				break;
+			}
+			if(state == SPOOL_VALID && recordCrc(p + off, count) == readU16(p + off + 2)) {
+				if(readSeg < 0) {
+					readSeg = s;
+					readOff = off;
+				}
+				flashItems = flashItems + count;
+				spoolStats.recoveredRecords = spoolStats.recoveredRecords + 1;
+			} else if(state == SPOOL_VALID) {
+				spoolStats.crcErrors = spoolStats.crcErrors + 1;
+				setState(s, off, SPOOL_CONSUMED);
+			} else if(state != SPOOL_CONSUMED) {
+				spoolStats.torn = spoolStats.torn + 1;
+				setState(s, off, SPOOL_CONSUMED);
+			}
+			off = off + size;
+		}
+		if(s == newest) {
+			writeOff = off;
+			break;
+		}
+	}
+	writeSeg = newest;
+	if(readSeg < 0) {
+		readSeg = writeSeg;
+		readOff = writeOff;
+	}
+	spoolStats.recovered = flashItems;
+	updatePending((Int)flashItems);
+}
+
+Void Spool_init(Void)
+{
+	GateMutexPri_Params gateParams;
+
+	if(spoolGate != NULL) {
+		return;
+	}
+#if defined(__MSP430__)
+	spoolBase = spoolFlash;
+#else
+	spoolBase = HostFlash_map(SPOOL_FLASH_SIZE);
+#endif
+	recover();
+
+	GateMutexPri_Params_init(&gateParams);
+	gateParams.instance->name = "spool";
+	GateMutexPri_construct(&spoolGateObj, &gateParams);
+	spoolGate = GateMutexPri_handle(&spoolGateObj);
+}
+
+IArg Spool_lock(Void)
+{
+	IArg key;
+
+	cpuAcctWait = cpuWaitMutex_e;
+	key = GateMutexPri_enter(spoolGate);
+	cpuAcctWait = cpuWaitOther_e;
+	return key;
+}
+
+Void Spool_unlock(IArg key)
+{
+	GateMutexPri_leave(spoolGate, key);
+}
+
+/*
+ * Function: flushBatch
+ * Description: write the RAM batch to the log as one record.
+ * Input: void
+ * Output: Bool - FALSE if the log is full (the batch stays in RAM).
+ * Algorithm: a record that doesn't fit in the current segment opens the next one - unless an
+ * 			  unconsumed record is still in it: the oldest live segment is that of the record
+ * 			  being drained, or the next one to read. Opening erases the segment and writes its
+ * 			  header. A reader with nothing left to read waits where the record goes. The record
+ * 			  is written in the three steps of spool.h.
+*/
+static Bool flushBatch(Void)
+{
+	UInt8 image[SPOOL_RECORD(SPOOL_BATCH)];
+	UInt8 header[SPOOL_SEG_HEADER];
+	Int n = batchCount - batchFirst;
+	UInt16 size = SPOOL_RECORD(n);
+	UInt16 crc;
+	Int next, oldest, i;
+
+	if(writeOff + size > SPOOL_SEGMENT_SIZE) {
+		next = (writeSeg + 1) % SPOOL_SEGMENTS;
+		oldest = (readCount > 0) ? readRecSeg : readSeg;
+		if((flashItems > 0 || readCount > 0) && next == oldest) {
+			return FALSE;
+		}
+		writeSeq = (UInt16)(writeSeq + 1);
+		if(writeSeq == 0xFFFF) {
+			writeSeq = 0;						// 0xFFFF is an erased header
+		}
+		FlashCtl_eraseSegment(segment(next));
+		spoolStats.erases = spoolStats.erases + 1;
+		header[0] = SPOOL_MAGIC & 0xFF;
+		header[1] = SPOOL_MAGIC >> 8;
+		header[2] = (UInt8)(writeSeq & 0xFF);
+		header[3] = (UInt8)(writeSeq >> 8);
+		program(segment(next), header, SPOOL_SEG_HEADER);
+		writeSeg = next;
+		writeOff = SPOOL_SEG_HEADER;
+	}
+	if(flashItems == 0 && readCount == 0) {
+		readSeg = writeSeg;
+		readOff = writeOff;
+	}
+
+	image[0] = SPOOL_ALLOCATED;
+	image[1] = (UInt8)n;
+	for(i = 0 ; i < n ; i++) {
+		image[SPOOL_REC_HEADER + 2 * i] = (UInt8)(batch[batchFirst + i] & 0xFF);
+		image[SPOOL_REC_HEADER + 2 * i + 1] = (UInt8)((batch[batchFirst + i] >> 8) & 0xFF);
+	}
+	crc = recordCrc(image, (UInt8)n);
+	image[2] = (UInt8)(crc & 0xFF);
+	image[3] = (UInt8)(crc >> 8);
+	program(segment(writeSeg) + writeOff, image, 2);						// state allocated, count
+	program(segment(writeSeg) + writeOff + 2, &image[2], size - 2);		// CRC, items
+	setState(writeSeg, writeOff, SPOOL_VALID);
+	writeOff = writeOff + size;
+
+	flashItems = flashItems + n;
+	spoolStats.records = spoolStats.records + 1;
+	batchFirst = 0;
+	batchCount = 0;
+	return TRUE;
+}
+
+Bool Spool_append(Int item)
+{
+	if(batchCount == SPOOL_BATCH && !flushBatch()) {
+		spoolStats.dropped = spoolStats.dropped + 1;
+		return FALSE;
+	}
+	batch[batchCount] = (Int16)item;
+	batchCount = batchCount + 1;
+	spoolStats.spooled = spoolStats.spooled + 1;
+	updatePending(1);
+	if(batchCount == SPOOL_BATCH) {
+		flushBatch();							// a full log: retried by the next append
+	}
+	return TRUE;
+}
+
+/*
+ * Function: loadRecord
+ * Description: read the oldest unread record into readBuf.
+ * Input: void
+ * Output: void
+ * Algorithm: only called while flashItems > 0, so there is one. Past the records of a segment
+ * 			  go on in the next one; skip consumed and cut short records (recover marked the
+ * 			  bad ones). The CRC was checked by recover or written by this run.
+*/
+static Void loadRecord(Void)
+{
+	const UInt8 *p;
+	UInt8 count;
+	Int i;
+
+	while(1) {
+		p = segment(readSeg) + readOff;
+		if(readOff + SPOOL_REC_HEADER > SPOOL_SEGMENT_SIZE || p[0] == SPOOL_ERASED ||
+				p[1] == 0 || p[1] > SPOOL_BATCH || readOff + SPOOL_RECORD(p[1]) > SPOOL_SEGMENT_SIZE) {
+			readSeg = (readSeg + 1) % SPOOL_SEGMENTS;
+			readOff = SPOOL_SEG_HEADER;
+			continue;
+		}
+		count = p[1];
+		if(p[0] == SPOOL_VALID) {
+			for(i = 0 ; i < count ; i++) {
+				readBuf[i] = (Int16)readU16(p + SPOOL_REC_HEADER + 2 * i);
+			}
+			readCount = count;
+			readPos = 0;
+			readRecSeg = readSeg;
+			readRecOff = readOff;
+			readOff = readOff + SPOOL_RECORD(count);
+			flashItems = flashItems - count;
+			return;
+		}
+		readOff = readOff + SPOOL_RECORD(count);
+	}
+}
+
+Bool Spool_peek(Int *item)
+{
+	if(readCount == 0 && flashItems > 0) {
+		loadRecord();
+	}
+	if(readCount > 0) {
+		*item = readBuf[readPos];
+		return TRUE;
+	}
+	if(batchFirst < batchCount) {
+		*item = batch[batchFirst];
+		return TRUE;
+	}
+	return FALSE;
+}
+
+Void Spool_advance(Void)
+{
+	if(readCount > 0) {
+		readPos = readPos + 1;
+		if(readPos == readCount) {
+			setState(readRecSeg, readRecOff, SPOOL_CONSUMED);
+			readCount = 0;
+		}
+	} else if(batchFirst < batchCount) {
+		batchFirst = batchFirst + 1;
+		if(batchFirst == batchCount) {
+			batchFirst = 0;
+			batchCount = 0;
+		}
+	} else {
+		return;
+	}
+	spoolStats.unspooled = spoolStats.unspooled + 1;
+	updatePending(-1);
+}
+
+UInt Spool_pending(Void)
+{
+	return spoolStats.pending;
+}
@@ -0,0 +1,132 @@
+/*
+ * spool.h
+ *
+ * Overflow spool of a bounded buffer - a persistent, append-only log of the items the buffer
+ * had no room for.
+ *
+ * Under bbPolicyBlock_e a burst longer than the buffer blocks the producers on emptySlots, and
+ * the samples they would have taken meanwhile are lost upstream; the drop policies lose them in
+ * the buffer instead. With bbPolicySpool_e (bounded_buffer.h) insert_item no longer waits: once
+ * the buffer holds its high-water mark of items, the new items are appended to the spool, and
+ * every remove_item first moves the oldest spooled items back into the free slots. The items
+ * reach the consumers in the order they were inserted, whichever way they went.
+ *
+ * The spool lives in SPOOL_FLASH_SIZE bytes of on-chip flash (the SPOOL range of
+ * MSP_EXP430F5529LP.cmd), written through the DriverLib FlashCtl calls; the host build emulates
+ * them on a memory-mapped file (PC_SPOOL=<file>, host/src/driverlib_host.c). The flash is a
+ * circular log of SPOOL_SEGMENT_SIZE segments - the erase unit - each with a 4-byte header (magic,
+ * sequence number) and records of up to SPOOL_BATCH items:
+ *
+ *   UInt8 state, UInt8 count, UInt16 CRC-16/CCITT of count and items, Int16 item[count]
+ *
+ * little endian. Items are collected in a RAM batch and written as one record when it is full,
+ * so a record costs one header per SPOOL_BATCH items. A record is written in three steps -
+ * header (state allocated), CRC and items, state valid - and its state is cleared to consumed
+ * once its last item went back into the buffer. A segment is erased when the log wraps into it,
+ * which it only does once all of its records are consumed; a full log drops new items
+ * (bbInsertDropped_e) rather than overwrite unconsumed ones.
+ *
+ * Spool_init scans the log after a reset: the newest segment is the one whose successor does not
+ * continue its sequence numbers, and every valid record with a good CRC that was not consumed is
+ * spooled again, so the consumers drain it first. A reset loses only the open RAM batch and the
+ * items taken from the record being drained - at most 2 x SPOOL_BATCH - 1 items. Records cut
+ * short by a reset, or with a bad CRC, are counted and marked consumed.
+ *
+ * Items are stored as Int16, the target's Int. A spooled item's latency (latency.h) is stamped
+ * when it goes back into the buffer - the time it spent in the spool is not included.
+ */
+
+#ifndef SPOOL_H_
+#define SPOOL_H_
+
+#include <xdc/std.h>
+
+#ifndef SPOOL_FLASH_SIZE
+#define SPOOL_FLASH_SIZE	8192	//Bytes of flash for the spool - the length of the SPOOL range in MSP_EXP430F5529LP.cmd
+#endif
+#ifndef SPOOL_BATCH
+#define SPOOL_BATCH			16		//Items per record (1..255) - the RAM batch written in one go
+#endif
+#define SPOOL_SEGMENT_SIZE	512		//Erase unit of the MSP430F5529's main flash
+
+#if SPOOL_FLASH_SIZE % SPOOL_SEGMENT_SIZE != 0 || SPOOL_FLASH_SIZE < 2 * SPOOL_SEGMENT_SIZE
+#error "SPOOL_FLASH_SIZE must be two or more whole flash segments"
+#endif
+#if SPOOL_BATCH < 1 || SPOOL_BATCH > 255 || 4 + 4 + 2 * SPOOL_BATCH > SPOOL_SEGMENT_SIZE
+#error "SPOOL_BATCH must be 1..255 items and a record must fit in a segment"
+#endif
+
+
+/*
+ Structure SpoolStats_T - spool counters (RAM, readable from ROV/the memory browser).
+ */
+typedef struct
+{
+	UInt32 spooled;				// items appended
+	UInt32 unspooled;			// items moved back into the buffer
+	UInt32 dropped;				// items refused - the log was full
+	UInt32 records;				// records written
+	UInt32 bytes;				// bytes programmed, headers and state changes included
+	UInt32 erases;				// segments erased
+	UInt32 recovered;			// items found unconsumed by Spool_init
+	UInt32 recoveredRecords;	// their records
+	UInt32 torn;				// records cut short by a reset
+	UInt32 crcErrors;			// records with a bad CRC
+	UInt pending;				// items in the spool now
+	UInt pendingMax;			// most items in the spool at once
+} SpoolStats_T;
+
+extern SpoolStats_T spoolStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Spool_init(Void)
+
+ Maps the flash region, recovers the unconsumed records of the log (see above) and constructs
+ the spool's lock. Called once, from main before BIOS_start - BoundedBuffer_setPolicy does it
+ for the buffer that gets bbPolicySpool_e. Further calls do nothing.
+ */
+Void Spool_init(Void);
+
+/*
+ Function: IArg Spool_lock(Void)
+ Function: Void Spool_unlock(IArg key)
+
+ Enter/leave the spool - a priority inheritance GateMutexPri, Tasks only. Spool_append,
+ Spool_peek and Spool_advance are called inside it. A block is charged to cpuWaitMutex_e.
+ */
+IArg Spool_lock(Void);
+Void Spool_unlock(IArg key);
+
+/*
+ Function: Bool Spool_append(Int item)
+
+ Appends an item to the RAM batch, and writes the batch to flash once it is full. FALSE (and
+ counted in dropped) if the batch is full and the log has no free segment for it.
+ */
+Bool Spool_append(Int item);
+
+/*
+ Function: Bool Spool_peek(Int *item)
+ Function: Void Spool_advance(Void)
+
+ Spool_peek gives the oldest item, reading its record from flash if need be - FALSE if the spool
+ is empty. Spool_advance removes that item, once the caller has stored it in the buffer; the
+ last item of a record marks the record consumed. Spool_pending only drops in Spool_advance, so
+ a producer that finds the spool empty knows its own spooled items are in the buffer.
+ */
+Bool Spool_peek(Int *item);
+Void Spool_advance(Void);
+
+/*
+ Function: UInt Spool_pending(Void)
+
+ Items in the spool - a snapshot that can be read without the lock.
+ */
+UInt Spool_pending(Void);
+
+#endif /* SPOOL_H_ */
@@ -0,0 +1,135 @@
+/*
+ * stackprof.c
+ *
+ * Stack high-water marks - see stackprof.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <string.h>						//for memset/memcpy in StackProf_init
+
+#include "stackprof.h"
+#include "topology.h"
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The high-water marks, see StackProfStats_T.
+ */
+StackProfStats_T stackProfStats;
+
+static Task_Handle watched[STACKPROF_MAX_WATCHED];
+static Int numWatched = 0;
+static UInt32 lastSampleTick = 0;
+
+
+/*
+ * Function: StackProf_init
+ * Description: empty the high-water marks and the watch list.
+ * Input: void
+ * Output: void
+ * Algorithm: memset, magic set.
+*/
+Void StackProf_init(void)
+{
+	memset(&stackProfStats, 0, sizeof(stackProfStats));
+	memcpy(stackProfStats.magic, "STKP", sizeof(stackProfStats.magic));
+	numWatched = 0;
+	lastSampleTick = 0;
+}
+
+Void StackProf_watch(Task_Handle task)
+{
+	if(task != NULL && numWatched < STACKPROF_MAX_WATCHED) {
+		watched[numWatched] = task;
+		numWatched = numWatched + 1;
+	}
+}
+
+/*
+ * Function: record
+ * Description: merge one stack's size and use into its entry.
+ * Input: Int index - the entry, StackKind_E kind, Task_Handle task - the Task (NULL for the
+ * 		  system stack), SizeT size, SizeT used - from Task_stat/Hwi_getStackInfo.
+ * Output: void
+ * Algorithm: the entries are filled in the same order on every sample, so an index always
+ * 			  stands for the same stack; the peak only grows.
+*/
+static Void record(Int index, StackKind_E kind, Task_Handle task, SizeT size, SizeT used)
+{
+	StackProfEntry_T *entry;
+
+	if(index >= STACKPROF_MAX_ENTRIES) {
+		return;
+	}
+	entry = &stackProfStats.entry[index];
+	entry->kind = (UInt8)kind;
+	entry->size = (UInt16)size;
+	if(used > entry->peak) {
+		entry->peak = (UInt16)used;
+	}
+	if(task != NULL) {
+		entry->role = (UInt8)Topology_workerRole(task);
+		entry->id = (UInt8)Topology_workerId(task);
+		entry->priority = (UInt8)Task_getPri(task);
+	}
+	if(index >= stackProfStats.numEntries) {
+		stackProfStats.numEntries = index + 1;
+	}
+}
+
+static Int recordTask(Int index, StackKind_E kind, Task_Handle task)
+{
+	Task_Stat stat;
+
+	Task_stat(task, &stat);
+	record(index, kind, task, stat.stackSize, stat.used);
+	return index + 1;
+}
+
+/*
+ * Function: StackProf_sample
+ * Description: refresh the high-water marks of all the profiled stacks.
+ * Input: void
+ * Output: void
+ * Algorithm: Hwi_getStackInfo with computeStackDepth for the system stack, Task_stat for the Idle
+ * 			  Task (target only - the host's idle loop has no Task), the topology Tasks and the
+ * 			  watched ones. Both scan the painted stack from its far end for the first byte
+ * 			  that is not the fill value.
+*/
+Void StackProf_sample(void)
+{
+	Hwi_StackInfo info;
+	Int index = 0;
+	Int i = 0;
+
+	Hwi_getStackInfo(&info, TRUE);
+	record(index, stackSystem_e, NULL, info.hwiStackSize, info.hwiStackPeak);
+	index = index + 1;
+#if defined(__MSP430__)
+	index = recordTask(index, stackIdle_e, Task_getIdleTask());
+#endif
+	for(i = 0 ; i < Topology_numTasks() ; i++) {
+		index = recordTask(index, stackTask_e, Topology_task(i));
+	}
+	for(i = 0 ; i < numWatched ; i++) {
+		index = recordTask(index, stackTask_e, watched[i]);
+	}
+	stackProfStats.samples = stackProfStats.samples + 1;
+}
+
+Void StackProf_poll(void)
+{
+#if STACK_PROFILE
+	UInt32 now = Clock_getTicks();
+
+	if(stackProfStats.samples == 0 || now - lastSampleTick >= STACKPROF_SAMPLE_TICKS) {
+		lastSampleTick = now;
+		StackProf_sample();
+	}
+#endif
+}
@@ -0,0 +1,120 @@
+/*
+ * stackprof.h
+ *
+ * Stack high-water marks of every Task and of the system stack - what the stack sizes should be.
+ *
+ * The stack sizes are guesses: 700 bytes for every producer and consumer (WORKER_STACK_SIZE),
+ * 512 for ledSrvTask and the trace drain Task, Program.stack = 1024 for the system stack that the
+ * Hwis and Swis run on - most of the MSP430F5529's 8 KB of RAM. SYS/BIOS paints every Task stack
+ * and the system stack with 0xBE when it creates them (Task.initStackFlag, Hwi.initStackFlag in
+ * empty.cfg) and finds the deepest byte ever written by scanning for the first unpainted one -
+ * Task_stat's "used", Hwi_getStackInfo's hwiStackPeak. StackProf_sample collects them for the
+ * topology Tasks, the Tasks given to StackProf_watch, the Idle Task and the system stack into
+ * stackProfStats, keeping the largest value seen. The trace drain Task samples every
+ * STACKPROF_SAMPLE_TICKS; a sample scans the unused part of every stack, so it costs roughly a
+ * cycle per free stack byte.
+ *
+ * stackProfStats is a fixed-layout RAM structure - the 12-byte header, then numEntries
+ * StackProfEntry_T, little endian. Save it from the debugger after a run that exercised the worst
+ * case (a memory save of sizeof(StackProfStats_T) bytes at &stackProfStats) and give it to
+ * host/tools/stack_budget.py with the linker map in Debug/: it prints the RAM budget and the
+ * recommended stack size of every Task. The host build's Tasks run on pthreads, so its samples
+ * have the configured sizes but no high-water marks.
+ *
+ * STACK_PROFILE 0 compiles the sampling out.
+ */
+
+#ifndef STACKPROF_H_
+#define STACKPROF_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#ifndef STACK_PROFILE
+#define STACK_PROFILE			1		//1 - sample the stack high-water marks, 0 - no sampling
+#endif
+#ifndef STACKPROF_MAX_ENTRIES
+#define STACKPROF_MAX_ENTRIES	12		//Stacks profiled, the system stack and the Idle Task included
+#endif
+#ifndef STACKPROF_SAMPLE_TICKS
+#define STACKPROF_SAMPLE_TICKS	1000	//Clock ticks between two samples by the trace drain Task
+#endif
+#define STACKPROF_MAX_WATCHED	4		//Tasks other than the topology's (StackProf_watch)
+
+
+/*
+ Enum StackKind_E - what a stack belongs to. Keep in sync with host/tools/stack_budget.py.
+ */
+typedef enum
+{
+	stackTask_e = 0,
+	stackIdle_e = 1,			// the Idle Task
+	stackSystem_e = 2			// the system stack (Program.stack) - Hwis, Swis and main
+} StackKind_E;
+
+
+/*
+ Structure StackProfEntry_T - one profiled stack.
+ */
+typedef struct
+{
+	UInt16 size;				// bytes
+	UInt16 peak;				// bytes ever used (0 - not measurable, host build)
+	UInt8 kind;					// StackKind_E
+	UInt8 role;					// TopologyRole_E, 0 for other Tasks
+	UInt8 id;					// producer/consumer id
+	UInt8 priority;
+} StackProfEntry_T;
+
+
+/*
+ Structure StackProfStats_T - the RAM snapshot structure.
+ */
+typedef struct
+{
+	Char magic[4];				// "STKP"
+	UInt32 samples;				// StackProf_sample calls
+	UInt16 numEntries;
+	UInt16 reserved;
+	StackProfEntry_T entry[STACKPROF_MAX_ENTRIES];
+} StackProfStats_T;
+
+extern StackProfStats_T stackProfStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void StackProf_init(void)
+
+ Empties stackProfStats and the watch list. Called from main before BIOS_start.
+ */
+Void StackProf_init(void);
+
+/*
+ Function: Void StackProf_watch(Task_Handle task)
+
+ Adds a Task that is not part of the topology (ledSrvTask, the trace drain Task) to the sampled
+ ones. Ignored past STACKPROF_MAX_WATCHED.
+ */
+Void StackProf_watch(Task_Handle task);
+
+/*
+ Function: Void StackProf_sample(void)
+
+ Refreshes stackProfStats - the system stack, the Idle Task, the topology Tasks and the watched
+ ones, in that order. Call it from a Task.
+ */
+Void StackProf_sample(void);
+
+/*
+ Function: Void StackProf_poll(void)
+
+ StackProf_sample once STACKPROF_SAMPLE_TICKS have passed since the last one - called by the
+ trace drain Task on every round.
+ */
+Void StackProf_poll(void);
+
+#endif /* STACKPROF_H_ */
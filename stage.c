@@ -0,0 +1,220 @@
+/*
+ * stage.c
+ *
+ * Multi-stage pipelines - see stage.h for the full description.
+ */
+
+#include <string.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/Log.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "stage.h"
+#include "topology.h"
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The graph's counters, see StageStats_T.
+ */
+StageStats_T stageStats;
+
+static const StageGraph_T *stageGraph = NULL;			// the graph of Stage_create
+static BoundedBuffer_Handle linkBuffers[STAGE_MAX_LINKS];
+
+
+/*
+ * Function: Stage_create
+ * Description: create the links and the workers of a stage graph.
+ * Input: const StageGraph_T *graph - the graph, Task_FuncPtr handler - the workers' Task function.
+ * Output: Int - number of worker Tasks created, 0 on a graph that doesn't fit.
+ * Algorithm: check the table sizes and every stage's links and batch, create the link buffers
+ * 			  (BoundedBuffer_create), then one topology entry per worker - ids count up over the
+ * 			  whole graph, arg1 is the stage index. Stops at the first Task the topology pools
+ * 			  can't hold.
+*/
+Int Stage_create(const StageGraph_T *graph, Task_FuncPtr handler)
+{
+	TopologyTask_T task;
+	Int s = 0;
+	Int l = 0;
+	Int w = 0;
+	Int created = 0;
+
+	memset(&stageStats, 0, sizeof(stageStats));
+	if(graph->numStages > STAGE_MAX_STAGES || graph->numLinks > STAGE_MAX_LINKS) {
+		Log_info2("ERROR! Stage graph too large, %d stages and %d links.\n", graph->numStages, graph->numLinks); //error log
+		return 0;
+	}
+	for(s = 0 ; s < graph->numStages ; s++) {
+		const StageDef_T *def = &graph->stages[s];
+		if(def->input >= graph->numLinks || def->output >= graph->numLinks || def->batch < 1 || def->batch > STAGE_MAX_BATCH) {
+			Log_info1("ERROR! Stage %d has a bad link or batch.\n", s); //error log
+			return 0;
+		}
+	}
+	for(l = 0 ; l < graph->numLinks ; l++) {
+		linkBuffers[l] = BoundedBuffer_create(graph->engine, graph->links[l].capacity);
+		if(linkBuffers[l] == NULL) {
+			return 0;						// BoundedBuffer_create issued the Log message
+		}
+		stageStats.link[l].capacity = graph->links[l].capacity;
+	}
+	stageGraph = graph;
+	stageStats.numStages = graph->numStages;
+	stageStats.numLinks = graph->numLinks;
+
+	task.fxn = handler;
+	task.role = topoStage_e;
+	for(s = 0 ; s < graph->numStages ; s++) {
+		task.name = graph->stages[s].name;
+		task.arg1 = (UArg)s;
+		task.priority = graph->stages[s].priority;
+		task.stackSize = graph->stages[s].stackSize;
+		for(w = 0 ; w < graph->stages[s].workers ; w++) {
+			task.id = created + 1;
+			if(Topology_create(&task, 1) == 0) {
+				return created;
+			}
+			created++;
+		}
+	}
+	return created;
+}
+
+const StageDef_T *Stage_def(Int stage)
+{
+	return &stageGraph->stages[stage];
+}
+
+BoundedBuffer_Handle Stage_input(Int stage)
+{
+	Int l = stageGraph->stages[stage].input;
+
+	return (l == STAGE_NONE) ? NULL : linkBuffers[l];
+}
+
+BoundedBuffer_Handle Stage_output(Int stage)
+{
+	Int l = stageGraph->stages[stage].output;
+
+	return (l == STAGE_NONE) ? NULL : linkBuffers[l];
+}
+
+/*
+ * Function: Stage_initCtx
+ * Description: prepare a worker's context before its first call.
+ * Input: StageCtx_T *ctx - the context, Int stage - the stage index, Int worker - 1..workers.
+ * Output: void
+ * Algorithm: copy the stage's batch and arg, zero the rest, seed the PRNG from the entropy
+ * 			  source mixed with the stage and worker.
+*/
+Void Stage_initCtx(StageCtx_T *ctx, Int stage, Int worker)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->stage = stage;
+	ctx->worker = worker;
+	ctx->batch = stageGraph->stages[stage].batch;
+	ctx->arg = stageGraph->stages[stage].arg;
+	Prng_seed(&ctx->prng, Prng_entropy() ^ ((UInt32)stage << 8) ^ (UInt32)worker);
+}
+
+/*
+ * Function: Stage_sample
+ * Description: sample the depth of a stage's input link.
+ * Input: Int stage - the stage index.
+ * Output: void
+ * Algorithm: the depth is fullSlots' count - the items published and not yet reserved by a
+ * 			  consumer, the same for every engine. Nothing to sample for a source.
+*/
+Void Stage_sample(Int stage)
+{
+	Int l = stageGraph->stages[stage].input;
+	StageLinkCounters_T *link;
+	Int depth;
+	UInt key;
+
+	if(l == STAGE_NONE) {
+		return;
+	}
+	depth = Semaphore_getCount(linkBuffers[l]->fullSlots);
+	link = &stageStats.link[l];
+	key = Hwi_disable();
+	link->samples = link->samples + 1;
+	link->depthSum = link->depthSum + depth;
+	if(depth > link->depthMax) {
+		link->depthMax = depth;
+	}
+	Hwi_restore(key);
+}
+
+Void Stage_account(Int stage, Int in, Int out)
+{
+	StageCounters_T *counters = &stageStats.stage[stage];
+	UInt key;
+
+	key = Hwi_disable();
+	counters->calls = counters->calls + 1;
+	counters->itemsIn = counters->itemsIn + in;
+	counters->itemsOut = counters->itemsOut + out;
+	Hwi_restore(key);
+}
+
+/*
+ * Function: occupancy
+ * Description: mean fill of a link in 1/256ths of its capacity.
+ * Input: Int l - link index, or STAGE_NONE, Int none - the value for STAGE_NONE.
+ * Output: Int - 0..256, -1 for a link without samples.
+ * Algorithm: depthSum * 256 / (samples * capacity) - one division, at report time only.
+*/
+static Int occupancy(Int l, Int none)
+{
+	const StageLinkCounters_T *link;
+
+	if(l == STAGE_NONE) {
+		return none;
+	}
+	link = &stageStats.link[l];
+	if(link->samples == 0 || link->capacity == 0) {
+		return -1;
+	}
+	return (Int)(((UInt64)link->depthSum << 8) / ((UInt64)link->samples * link->capacity));
+}
+
+/*
+ * Function: Stage_bottleneck
+ * Description: the stage holding the flow back.
+ * Input: void
+ * Output: Int - its index, -1 before any sample.
+ * Algorithm: the stage with the largest input occupancy minus output occupancy; a source's
+ * 			  input counts as full (256), a sink's output as empty (0). Stages next to a link
+ * 			  without samples are skipped.
+*/
+Int Stage_bottleneck(void)
+{
+	Int s = 0;
+	Int best = -1;
+	Int bestScore = 0;
+	Int in, out;
+
+	if(stageGraph == NULL) {
+		return -1;
+	}
+	for(s = 0 ; s < stageGraph->numStages ; s++) {
+		in = occupancy(stageGraph->stages[s].input, 256);
+		out = occupancy(stageGraph->stages[s].output, 0);
+		if(in < 0 || out < 0) {
+			continue;
+		}
+		if(best < 0 || in - out > bestScore) {
+			best = s;
+			bestScore = in - out;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,195 @@
+/*
+ * stage.h
+ *
+ * Multi-stage pipelines - a chain (or any graph) of Tasks linked by bounded buffers.
+ *
+ * main.c's pipelines are one hop: producerHandler -> buffer -> consumerHandler. A real flow has
+ * more steps - acquire -> filter -> aggregate -> transmit - each taking the previous step's items
+ * and handing its results to the next. A StageGraph_T describes such a flow in two static tables:
+ *
+ *  - links (StageLink_T): the bounded buffers between the stages, with their capacities;
+ *  - stages (StageDef_T): a stage function, the link it reads (none - a source), the link it
+ *    writes (none - a sink), its number of worker Tasks, their priority and stack, the largest
+ *    batch it takes per call, and a parameter of its own.
+ *
+ * Stage_create creates the links (BoundedBuffer_create, all with the graph's engine) and the
+ * workers (Topology_create, role topoStage_e), so a new stage or a bigger batch is a table edit,
+ * not an empty.cfg edit. Every worker runs the same Task function (stageHandler, main.c): remove
+ * up to "batch" items from the input link (remove_items), call the stage function, insert its
+ * results into the output link (insert_items). Stage functions never touch a buffer or a
+ * semaphore - they are plain functions on arrays, with a StageCtx_T for the state they keep
+ * between calls, so the host can run them on threads as well (host/src/stage_threads.c).
+ *
+ * Counters (stageStats): items in/out and calls per stage, and the depth of every link, sampled by
+ * the stage reading it before every call. A stage whose input link is mostly full while its output
+ * link is mostly empty is the one holding the flow back - Stage_bottleneck picks the stage with
+ * the largest difference (a source counts as always having input, a sink as never having output).
+ *
+ * The capacities follow BoundedBuffer_create's rules (a power of two, from the BB_POOL_SIZE pool),
+ * and all the workers share the topology pools with any other topology Task.
+ */
+
+#ifndef STAGE_H_
+#define STAGE_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "bounded_buffer.h"
+#include "prng.h"
+
+#ifndef STAGE_MAX_STAGES
+#define STAGE_MAX_STAGES	6		//Stages of a graph
+#endif
+#ifndef STAGE_MAX_LINKS
+#define STAGE_MAX_LINKS		4		//Links of a graph (at most BB_MAX_BUFFERS)
+#endif
+#ifndef STAGE_MAX_BATCH
+#define STAGE_MAX_BATCH		8		//Largest batch of a stage - the worker's item arrays hold this many
+#endif
+#define STAGE_CTX_WORDS		10		//Words of state a stage function keeps between calls
+#define STAGE_NONE			(-1)	//StageDef_T.input of a source, StageDef_T.output of a sink
+
+
+/*
+ Structure StageCtx_T - one worker's state, passed to every call of its stage function. The
+ framework fills in the first fields and zeroes state[] before the first call.
+ */
+typedef struct
+{
+	Int stage;					// index in the graph's stage table
+	Int worker;					// the worker's topology id (Task arg0)
+	Int batch;					// the stage's batch - the number of items a source produces per call
+	UArg arg;					// the stage's StageDef_T.arg
+	UInt32 calls;				// calls made so far
+	Prng_T prng;				// seeded per worker, for sources
+	UInt sleep;					// set by the function: Clock ticks to sleep after this call
+	UInt32 state[STAGE_CTX_WORDS];	// the function's own
+} StageCtx_T;
+
+/*
+ A stage function: n items of in (none for a source) -> items written to out (up to
+ STAGE_MAX_BATCH; out is NULL for a sink). Returns the number of items written.
+ */
+typedef Int (*StageFxn)(StageCtx_T *ctx, const Int *in, Int n, Int *out);
+
+
+/*
+ Structure StageLink_T - a buffer between stages.
+ */
+typedef struct
+{
+	CString name;
+	Int capacity;				// a power of two
+} StageLink_T;
+
+/*
+ Structure StageDef_T - a stage and its workers.
+ */
+typedef struct
+{
+	CString name;				// also the workers' Task name
+	StageFxn fxn;
+	Int input;					// link index, STAGE_NONE for a source
+	Int output;					// link index, STAGE_NONE for a sink
+	Int workers;				// Tasks running the stage - more than one only on MPMC/locked links
+	Int priority;
+	Int batch;					// 1..STAGE_MAX_BATCH items per call
+	SizeT stackSize;			// bytes per worker, from the topology stack pool
+	UArg arg;					// the stage's parameter (StageCtx_T.arg)
+} StageDef_T;
+
+/*
+ Structure StageGraph_T - the whole flow.
+ */
+typedef struct
+{
+	const StageLink_T *links;
+	Int numLinks;
+	const StageDef_T *stages;
+	Int numStages;
+	BBEngine_E engine;			// of every link
+} StageGraph_T;
+
+
+/*
+ Structure StageStats_T - the counters of the graph, readable in RAM (stageStats).
+ */
+typedef struct
+{
+	UInt32 calls;				// stage function calls
+	UInt32 itemsIn;				// items taken from the input link
+	UInt32 itemsOut;			// items given to the output link
+} StageCounters_T;
+
+typedef struct
+{
+	UInt32 samples;				// depth samples taken
+	UInt32 depthSum;			// sum of the samples - mean depth = depthSum / samples
+	Int depthMax;
+	Int capacity;
+} StageLinkCounters_T;
+
+typedef struct
+{
+	Int numStages;
+	Int numLinks;
+	StageCounters_T stage[STAGE_MAX_STAGES];
+	StageLinkCounters_T link[STAGE_MAX_LINKS];
+} StageStats_T;
+
+extern StageStats_T stageStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Int Stage_create(const StageGraph_T *graph, Task_FuncPtr handler)
+
+ Creates the links and the worker Tasks of graph (kept - the tables must be static), in table
+ order; every worker runs handler with arg0 = a topology id unique in the graph (1, 2, ...) and
+ arg1 = its stage index. Called from main before BIOS_start. Returns the number of Tasks created
+ - 0 if the graph doesn't fit STAGE_MAX_* or a link can't be created (a Log message is issued).
+ */
+Int Stage_create(const StageGraph_T *graph, Task_FuncPtr handler);
+
+/*
+ Function: const StageDef_T *Stage_def(Int stage)
+ Function: BoundedBuffer_Handle Stage_input(Int stage)
+ Function: BoundedBuffer_Handle Stage_output(Int stage)
+
+ A stage's table entry and its input/output link buffers (NULL for a source's input and a sink's
+ output).
+ */
+const StageDef_T *Stage_def(Int stage);
+BoundedBuffer_Handle Stage_input(Int stage);
+BoundedBuffer_Handle Stage_output(Int stage);
+
+/*
+ Function: Void Stage_initCtx(StageCtx_T *ctx, Int stage, Int worker)
+
+ Prepares a worker's context - called by the worker itself, as the seed comes from Prng_entropy.
+ */
+Void Stage_initCtx(StageCtx_T *ctx, Int stage, Int worker);
+
+/*
+ Function: Void Stage_sample(Int stage)
+ Function: Void Stage_account(Int stage, Int in, Int out)
+
+ Called by the workers around every call: Stage_sample adds the current depth of the stage's
+ input link to its counters, Stage_account counts a call that took "in" and gave "out" items.
+ Both update the counters in a short Hwi_disable window - several workers may run a stage.
+ */
+Void Stage_sample(Int stage);
+Void Stage_account(Int stage, Int in, Int out);
+
+/*
+ Function: Int Stage_bottleneck(void)
+
+ Index of the stage holding the flow back (see above), -1 before any link was sampled.
+ */
+Int Stage_bottleneck(void);
+
+#endif /* STAGE_H_ */
@@ -0,0 +1,162 @@
+/*
+ * stage_graph.c
+ *
+ * The production flow as a stage graph - see stage_graph.h for the full description.
+ */
+
+#include <xdc/std.h>
+
+#include "stage_graph.h"
+#include "prng.h"
+
+#define ACQUIRE_BITS		10		// sample resolution
+#define ACQUIRE_NOISE		64		// noise amplitude, in sample units
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ What the transmit stage sent, see StageTransmit_T.
+ */
+StageTransmit_T stageTransmitStats;
+
+
+/*
+ * Function: log2Of
+ * Description: exponent of a power of two.
+ * Input: UArg n - a power of two.
+ * Output: Int - log2(n).
+ * Algorithm: count the shifts - the averages divide with a shift, never with /.
+*/
+static Int log2Of(UArg n)
+{
+	Int shift = 0;
+
+	while(n > 1) {
+		n = n >> 1;
+		shift++;
+	}
+	return shift;
+}
+
+/*
+ * Function: acquireStage
+ * Description: source - one batch of samples.
+ * Input: StageCtx_T *ctx - state[0] is the saw tooth phase; const Int *in, Int n - unused;
+ * 		  Int *out - receives ctx->batch samples.
+ * Output: Int - ctx->batch.
+ * Algorithm: phase + noise, masked to ACQUIRE_BITS; ctx->sleep = arg paces the source.
+*/
+static Int acquireStage(StageCtx_T *ctx, const Int *in, Int n, Int *out)
+{
+	Int i = 0;
+
+	(Void)in;
+	(Void)n;
+	for(i = 0 ; i < ctx->batch ; i++) {
+		out[i] = (Int)((ctx->state[0] + Prng_below(&ctx->prng, ACQUIRE_NOISE)) & ((1 << ACQUIRE_BITS) - 1));
+		ctx->state[0] = ctx->state[0] + 1;
+	}
+	ctx->sleep = (UInt)ctx->arg;
+	return ctx->batch;
+}
+
+/*
+ * Function: filterStage
+ * Description: moving average over the last arg samples.
+ * Input: StageCtx_T *ctx - state[0] is the history position, state[1..] the history;
+ * 		  const Int *in, Int n - the samples; Int *out - receives n averages.
+ * Output: Int - n.
+ * Algorithm: store the sample in the history ring, sum the whole window (arg additions, the
+ * 			  stage's deliberate cost) and shift by log2(arg).
+*/
+static Int filterStage(StageCtx_T *ctx, const Int *in, Int n, Int *out)
+{
+	UInt32 *history = &ctx->state[1];
+	Int taps = (Int)ctx->arg;
+	Int shift = log2Of(ctx->arg);
+	Int i = 0;
+	Int t = 0;
+	UInt32 sum;
+
+	for(i = 0 ; i < n ; i++) {
+		history[ctx->state[0]] = (UInt32)in[i];
+		ctx->state[0] = (ctx->state[0] + 1) & (taps - 1);
+		sum = 0;
+		for(t = 0 ; t < taps ; t++) {
+			sum = sum + history[t];
+		}
+		out[i] = (Int)(sum >> shift);
+	}
+	return n;
+}
+
+/*
+ * Function: aggregateStage
+ * Description: the mean of every arg filtered samples.
+ * Input: StageCtx_T *ctx - state[0] the running sum, state[1] the samples in it;
+ * 		  const Int *in, Int n - the samples; Int *out - receives the completed means.
+ * Output: Int - means completed by this call (the rest carries over to the next).
+ * Algorithm: accumulate; at arg samples emit sum >> log2(arg) and restart.
+*/
+static Int aggregateStage(StageCtx_T *ctx, const Int *in, Int n, Int *out)
+{
+	Int i = 0;
+	Int produced = 0;
+
+	for(i = 0 ; i < n ; i++) {
+		ctx->state[0] = ctx->state[0] + (UInt32)in[i];
+		ctx->state[1] = ctx->state[1] + 1;
+		if(ctx->state[1] == (UInt32)ctx->arg) {
+			out[produced] = (Int)(ctx->state[0] >> log2Of(ctx->arg));
+			produced++;
+			ctx->state[0] = 0;
+			ctx->state[1] = 0;
+		}
+	}
+	return produced;
+}
+
+/*
+ * Function: transmitStage
+ * Description: sink - send the aggregates.
+ * Input: StageCtx_T *ctx - unused; const Int *in, Int n - the aggregates; Int *out - NULL.
+ * Output: Int - 0.
+ * Algorithm: count them and fold them into the checksum of stageTransmitStats.
+*/
+static Int transmitStage(StageCtx_T *ctx, const Int *in, Int n, Int *out)
+{
+	Int i = 0;
+
+	(Void)ctx;
+	(Void)out;
+	for(i = 0 ; i < n ; i++) {
+		stageTransmitStats.checksum = stageTransmitStats.checksum + (UInt32)in[i];
+	}
+	stageTransmitStats.items = stageTransmitStats.items + n;
+	return 0;
+}
+
+/*
+ The links and the stages - edit here to change the flow.
+ */
+static const StageLink_T links[] = {
+	{"samples", STAGE_LINK_CAPACITY},
+	{"filtered", STAGE_LINK_CAPACITY},
+	{"aggregates", STAGE_LINK_CAPACITY}
+};
+
+static const StageDef_T stages[] = {
+	/* name			fxn				input		output		workers					priority		batch	stack				arg */
+	{"acquire",		acquireStage,	STAGE_NONE,	0,			1,						STAGE_PRIORITY,	4,		STAGE_STACK_SIZE,	STAGE_ACQUIRE_TICKS},
+	{"filter",		filterStage,	0,			1,			STAGE_FILTER_WORKERS,	STAGE_PRIORITY,	4,		STAGE_STACK_SIZE,	STAGE_FILTER_TAPS},
+	{"aggregate",	aggregateStage,	1,			2,			1,						STAGE_PRIORITY,	8,		STAGE_STACK_SIZE,	STAGE_AGGREGATE_N},
+	{"transmit",	transmitStage,	2,			STAGE_NONE,	1,						STAGE_PRIORITY,	4,		STAGE_STACK_SIZE,	0}
+};
+
+const StageGraph_T stageGraph = {
+	links, sizeof(links) / sizeof(links[0]),
+	stages, sizeof(stages) / sizeof(stages[0]),
+	(BBEngine_E)STAGE_ENGINE
+};
@@ -0,0 +1,69 @@
+/*
+ * stage_graph.h
+ *
+ * The production flow as a stage graph (stage.h): acquire -> filter -> aggregate -> transmit.
+ *
+ *  - acquire (source): a batch of 10 bit samples per call - a saw tooth with noise - then sleeps
+ *    its arg (Clock ticks, 0 - produce as fast as the flow takes them);
+ *  - filter: a moving average over the last arg samples (a power of two, at most 8) - arg
+ *    additions per item, the stage to make heavy for a bottleneck experiment;
+ *  - aggregate: the mean of every arg filtered samples (a power of two), so it passes on one
+ *    item for arg it takes;
+ *  - transmit (sink): hands the aggregates on - here it folds them into stageTransmitStats, where
+ *    a real device would write a radio frame.
+ *
+ * STAGE_GRAPH 1 (main.c) runs it instead of the producer/consumer pipelines; the host runs the
+ * same table on threads with host/src/stage_threads.c. All items are >= 0, so the locked engine's
+ * empty marker -1 never appears.
+ */
+
+#ifndef STAGE_GRAPH_H_
+#define STAGE_GRAPH_H_
+
+#include <xdc/std.h>
+
+#include "stage.h"
+
+#ifndef STAGE_ENGINE
+#define STAGE_ENGINE			0		//BBEngine_E of every link - 0 locked, 1 SPSC (one worker per stage), 2 MPMC
+#endif
+#ifndef STAGE_LINK_CAPACITY
+#define STAGE_LINK_CAPACITY		4		//Slots of every link (a power of two)
+#endif
+#ifndef STAGE_ACQUIRE_TICKS
+#define STAGE_ACQUIRE_TICKS		0		//Clock ticks acquire sleeps after a batch (0 - as fast as possible)
+#endif
+#ifndef STAGE_FILTER_TAPS
+#define STAGE_FILTER_TAPS		8		//Samples of the moving average (power of two, 1..8)
+#endif
+#ifndef STAGE_FILTER_WORKERS
+#define STAGE_FILTER_WORKERS	1		//Tasks running the filter stage (> 1 needs an MPMC or locked engine)
+#endif
+#ifndef STAGE_AGGREGATE_N
+#define STAGE_AGGREGATE_N		4		//Filtered samples per aggregate (power of two)
+#endif
+#ifndef STAGE_PRIORITY
+#define STAGE_PRIORITY			1		//Priority of every stage's workers (below ledSrvTask's 3)
+#endif
+#ifndef STAGE_STACK_SIZE
+#define STAGE_STACK_SIZE		600		//Stack bytes of every worker
+#endif
+
+
+/*
+ Structure StageTransmit_T - what the transmit stage sent.
+ */
+typedef struct
+{
+	UInt32 items;				// aggregates transmitted
+	UInt32 checksum;			// running sum of them
+} StageTransmit_T;
+
+extern StageTransmit_T stageTransmitStats;
+
+/*
+ The graph - links and stages, see stage_graph.c.
+ */
+extern const StageGraph_T stageGraph;
+
+#endif /* STAGE_GRAPH_H_ */
@@ -0,0 +1,148 @@
+/*
+ * timeslice.c
+ *
+ * Time-slicing policy of the equal priority Tasks - see timeslice.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <string.h>						//for memset in TimeSlice_init
+
+#include "timeslice.h"
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ Time-slice counters, see TimeSliceStats_T.
+ */
+TimeSliceStats_T timeSliceStats;
+
+
+/*
+ * Function: TimeSlice_init
+ * Description: clear the counters, full budgets.
+ * Input: void
+ * Output: void
+ * Algorithm: memset, then budget = TIMESLICE_QUANTUM for every entry.
+*/
+Void TimeSlice_init(void)
+{
+	Int i = 0;
+
+	memset(&timeSliceStats, 0, sizeof(timeSliceStats));
+	for(i = 0 ; i <= TIMESLICE_OTHER ; i++) {
+		timeSliceStats.task[i].budget = TIMESLICE_QUANTUM;
+	}
+}
+
+Int TimeSlice_taskIndex(Task_Handle task)
+{
+	Int i = 0;
+
+	for(i = 0 ; i < Topology_numTasks() ; i++) {
+		if(Topology_task(i) == task) {
+			return i;
+		}
+	}
+	return TIMESLICE_OTHER;
+}
+
+/*
+ * Function: peerReady
+ * Description: is another topology Task of the same priority ready to run?
+ * Input: Task_Handle self - the running Task.
+ * Output: Bool - TRUE if a Task_yield would hand the CPU to a peer.
+ * Algorithm: scan the (at most TOPOLOGY_MAX_TASKS) topology Tasks for a READY one at self's priority.
+*/
+static Bool peerReady(Task_Handle self)
+{
+	Int pri = Task_getPri(self);
+	Int i = 0;
+
+	for(i = 0 ; i < Topology_numTasks() ; i++) {
+		Task_Handle peer = Topology_task(i);
+		if(peer != self && Task_getMode(peer) == Task_Mode_READY && Task_getPri(peer) == pri) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Function: TimeSlice_tick
+ * Description: charge the tick to the running Task and apply the time-slice policy.
+ * Input: void
+ * Output: void
+ * Algorithm: the Task interrupted by the tick is Task_self(). Always: yield every quantum.
+ * 			  Contended: the slice ends when sliceTicks (reset by the switch hook) reaches the
+ * 			  quantum. Budget: the slice ends when the budget (not reset on switch) runs out, and
+ * 			  is refilled. When the slice ends, yield only if a peer is ready - otherwise the
+ * 			  Task starts a new slice on the CPU it keeps.
+*/
+Void TimeSlice_tick(void)
+{
+	Task_Handle self = Task_self();
+	TimeSliceTask_T *entry;
+	Bool expired = FALSE;
+
+	timeSliceStats.ticks = timeSliceStats.ticks + 1;
+	if(self == NULL) {
+		timeSliceStats.idleTicks = timeSliceStats.idleTicks + 1;
+		return;
+	}
+	entry = &timeSliceStats.task[TimeSlice_taskIndex(self)];
+	entry->ticks = entry->ticks + 1;
+
+	if(TIMESLICE_POLICY == tsPolicyBudget_e) {
+		entry->budget = entry->budget - 1;
+		if(entry->budget <= 0) {
+			entry->budget = entry->budget + TIMESLICE_QUANTUM;
+			expired = TRUE;
+		}
+	} else {
+		entry->sliceTicks = entry->sliceTicks + 1;
+		if(entry->sliceTicks >= TIMESLICE_QUANTUM) {
+			entry->sliceTicks = 0;
+			expired = TRUE;
+		}
+	}
+	if(!expired) {
+		return;
+	}
+
+	if(TIMESLICE_POLICY == tsPolicyAlways_e || peerReady(self)) {
+		timeSliceStats.yields = timeSliceStats.yields + 1;
+		Task_yield();
+	} else {
+		timeSliceStats.skippedYields = timeSliceStats.skippedYields + 1;
+	}
+}
+
+/*
+ * Function: TimeSlice_switchHook
+ * Description: count the end of prev's slice and the start of next's.
+ * Input: Task_Handle prev - the Task switched out, Task_Handle next - the Task switched in.
+ * Output: void
+ * Algorithm: prev still READY means it was preempted (yield or higher priority Task), otherwise
+ * 			  it blocked (or terminated) by itself. next starts a new slice.
+*/
+Void TimeSlice_switchHook(Task_Handle prev, Task_Handle next)
+{
+	TimeSliceTask_T *entry;
+
+	if(prev != NULL) {
+		entry = &timeSliceStats.task[TimeSlice_taskIndex(prev)];
+		if(Task_getMode(prev) == Task_Mode_READY) {
+			entry->forcedPreemptions = entry->forcedPreemptions + 1;
+		} else {
+			entry->voluntaryBlocks = entry->voluntaryBlocks + 1;
+		}
+	}
+	if(next != NULL) {
+		entry = &timeSliceStats.task[TimeSlice_taskIndex(next)];
+		entry->slices = entry->slices + 1;
+		entry->sliceTicks = 0;
+	}
+}
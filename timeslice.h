@@ -0,0 +1,119 @@
+/*
+ * timeslice.h
+ *
+ * Time-slicing policy of the equal priority producer/consumer Tasks.
+ *
+ * timeSharingClk fires on every Clock tick (Clock.tickPeriod = 500 usec) and tsClockHandler used
+ * to call Task_yield() every time - in the middle of a batch, and even when every other Task of
+ * the same priority was blocked, so the "yield" only cost a trip through the scheduler. At 8 MHz
+ * MCLK a tick is about 4000 cycles, and the switch overhead was a large part of it. tsClockHandler
+ * now calls TimeSlice_tick, which charges the tick to the running Task and yields according to
+ * TIMESLICE_POLICY:
+ *
+ *  - tsPolicyAlways_e: the old behaviour - yield every TIMESLICE_QUANTUM ticks, unconditionally;
+ *  - tsPolicyContended_e: yield once the running Task has held the CPU for TIMESLICE_QUANTUM
+ *    ticks since it was switched in, and only if another topology Task of the same priority is
+ *    READY - otherwise it keeps the CPU (counted as a skipped yield);
+ *  - tsPolicyBudget_e: every Task has a CPU budget of TIMESLICE_QUANTUM ticks that survives its
+ *    blocks - a Task that blocks just before every tick does not get a fresh quantum each time it
+ *    wakes up. The budget is refilled when it runs out; the Task then yields if contended.
+ *
+ * A Task switch hook (TimeSlice_switchHook, registered by Task.addHookSet in empty.cfg) counts,
+ * per topology Task, the slices it got (switches in), its voluntary blocks (switched out while
+ * BLOCKED - a Semaphore_pend) and its forced preemptions (switched out while still READY - a
+ * time-slice yield or a higher priority Task such as ledSrvTask). Tasks outside the topology
+ * share the last entry of timeSliceStats.task.
+ */
+
+#ifndef TIMESLICE_H_
+#define TIMESLICE_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#include "topology.h"
+
+#ifndef TIMESLICE_POLICY
+#define TIMESLICE_POLICY	1		//TimeSlicePolicy_E - 1: yield only when contended
+#endif
+#ifndef TIMESLICE_QUANTUM
+#define TIMESLICE_QUANTUM	1		//Clock ticks per time slice (or per budget)
+#endif
+#define TIMESLICE_OTHER		TOPOLOGY_MAX_TASKS	//timeSliceStats.task entry of the non-topology Tasks
+
+
+/*
+ Enum TimeSlicePolicy_E - when TimeSlice_tick yields the running Task.
+ */
+typedef enum
+{
+	tsPolicyAlways_e = 0,		// every quantum, contended or not
+	tsPolicyContended_e = 1,	// every quantum since switch in, only if a peer is ready
+	tsPolicyBudget_e = 2		// when the Task's CPU budget runs out, only if a peer is ready
+} TimeSlicePolicy_E;
+
+
+/*
+ Structure TimeSliceTask_T - time-slice counters of one Task.
+ */
+typedef struct
+{
+	UInt32 slices;				// times it was switched in
+	UInt32 voluntaryBlocks;		// switched out while blocked
+	UInt32 forcedPreemptions;	// switched out while still ready
+	UInt32 ticks;				// Clock ticks it was running on
+	UInt sliceTicks;			// ticks of the current slice (contended policy)
+	Int budget;					// ticks left of its budget (budget policy)
+} TimeSliceTask_T;
+
+
+/*
+ Structure TimeSliceStats_T - all the time-slice counters (RAM, readable from ROV).
+ */
+typedef struct
+{
+	UInt32 ticks;				// TimeSlice_tick calls
+	UInt32 yields;				// Task_yield calls made
+	UInt32 skippedYields;		// quantum expired but no peer was ready
+	UInt32 idleTicks;			// ticks with no topology or other Task running
+	TimeSliceTask_T task[TOPOLOGY_MAX_TASKS + 1];	// [topology index], [TIMESLICE_OTHER]
+} TimeSliceStats_T;
+
+extern TimeSliceStats_T timeSliceStats;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void TimeSlice_init(void)
+
+ Clears the counters and gives every Task a full budget. Called from main before BIOS_start.
+ */
+Void TimeSlice_init(void);
+
+/*
+ Function: Void TimeSlice_tick(void)
+
+ Called by tsClockHandler (Swi context) on every tick: charges the tick to the running Task and
+ yields it according to TIMESLICE_POLICY.
+ */
+Void TimeSlice_tick(void);
+
+/*
+ Function: Void TimeSlice_switchHook(Task_Handle prev, Task_Handle next)
+
+ Task switch hook (Task.addHookSet switchFxn) - counts slices, voluntary blocks and forced
+ preemptions. Runs inside the scheduler: it only reads Task state and updates counters.
+ */
+Void TimeSlice_switchHook(Task_Handle prev, Task_Handle next);
+
+/*
+ Function: Int TimeSlice_taskIndex(Task_Handle task)
+
+ timeSliceStats.task index of a Task - its topology index, TIMESLICE_OTHER for other Tasks.
+ */
+Int TimeSlice_taskIndex(Task_Handle task);
+
+#endif /* TIMESLICE_H_ */
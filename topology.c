@@ -0,0 +1,134 @@
+/*
+ * topology.c
+ *
+ * Runtime producer/consumer topology - see topology.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+#include <xdc/runtime/Log.h>
+
+#include "topology.h"
+
+#define TOPOLOGY_STACK_ALIGN	sizeof(UInt32)		// stacks start and end on a 32-bit boundary
+
+#define TOPOLOGY_ENV(role, id)	((Ptr)(IArg)(((role) << 8) | ((id) & 0xFF)))	// Task env of a worker
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The Task objects and the stack memory of the topology (no heap - BIOS.heapSize = 0).
+ */
+static Task_Struct topologyTasks[TOPOLOGY_MAX_TASKS];
+static UInt32 topologyStacks[TOPOLOGY_STACK_POOL_SIZE / sizeof(UInt32)];
+
+static Int numTasks = 0;		// Task objects used
+static SizeT stackUsed = 0;		// bytes of topologyStacks used
+
+
+/*
+ * Function: Topology_create
+ * Description: construct the Tasks of a topology table.
+ * Input: const TopologyTask_T *tasks - the table, Int n - number of entries.
+ * Output: Int - number of Tasks created.
+ * Algorithm: for every entry take the next Task object and the next stackSize bytes (rounded up
+ * 			  to TOPOLOGY_STACK_ALIGN) of the stack pool, and Task_construct the Task with the
+ * 			  entry's id as arg0 and its role/id in env. Stops at the first entry that doesn't
+ * 			  fit the pools.
+*/
+Int Topology_create(const TopologyTask_T *tasks, Int n)
+{
+	Int i = 0;
+	Task_Params taskParams;
+
+	for(i = 0 ; i < n ; i++) {
+		SizeT stackSize = (tasks[i].stackSize + TOPOLOGY_STACK_ALIGN - 1) & ~(TOPOLOGY_STACK_ALIGN - 1);
+
+		if(numTasks == TOPOLOGY_MAX_TASKS || stackUsed + stackSize > sizeof(topologyStacks)) {
+			Log_info2("ERROR! Topology pools exhausted, only %d of %d tasks created.\n", i, n); //error log
+			break;
+		}
+
+		Task_Params_init(&taskParams);
+		taskParams.instance->name = tasks[i].name;
+		taskParams.arg0 = (UArg)tasks[i].id;
+		taskParams.arg1 = tasks[i].arg1;
+		taskParams.env = TOPOLOGY_ENV(tasks[i].role, tasks[i].id);
+		taskParams.priority = tasks[i].priority;
+		taskParams.stack = (Ptr)((UInt8 *)topologyStacks + stackUsed);
+		taskParams.stackSize = stackSize;
+		Task_construct(&topologyTasks[numTasks], tasks[i].fxn, &taskParams, NULL);
+
+		numTasks++;
+		stackUsed = stackUsed + stackSize;
+	}
+	return i;
+}
+
+/*
+ * Function: Topology_createUniform
+ * Description: construct "producers" producer and "consumers" consumer Tasks.
+ * Input: Task_FuncPtr producerFxn/consumerFxn - the handlers, Int producers/consumers - how many,
+ * 		  Int priority, SizeT stackSize, UArg arg1 - of every Task.
+ * Output: Int - number of Tasks created.
+ * Algorithm: interleave the producer and consumer entries (ids from 1) and create them one by
+ * 			  one with Topology_create.
+*/
+Int Topology_createUniform(Task_FuncPtr producerFxn, Int producers,
+		Task_FuncPtr consumerFxn, Int consumers, Int priority, SizeT stackSize, UArg arg1)
+{
+	Int i = 0;
+	Int created = 0;
+	TopologyTask_T task;
+
+	task.priority = priority;
+	task.stackSize = stackSize;
+	task.arg1 = arg1;
+	for(i = 1 ; i <= producers || i <= consumers ; i++) {
+		task.id = i;
+		if(i <= producers) {
+			task.fxn = producerFxn;
+			task.role = topoProducer_e;
+			task.name = "producer";
+			if(Topology_create(&task, 1) == 0) {
+				break;
+			}
+			created++;
+		}
+		if(i <= consumers) {
+			task.fxn = consumerFxn;
+			task.role = topoConsumer_e;
+			task.name = "consumer";
+			if(Topology_create(&task, 1) == 0) {
+				break;
+			}
+			created++;
+		}
+	}
+	return created;
+}
+
+TopologyRole_E Topology_workerRole(Task_Handle task)
+{
+	return (task == NULL) ? topoNone_e : (TopologyRole_E)(((IArg)Task_getEnv(task) >> 8) & 0xFF);
+}
+
+Int Topology_workerId(Task_Handle task)
+{
+	return (task == NULL) ? 0 : (Int)((IArg)Task_getEnv(task) & 0xFF);
+}
+
+Int Topology_numTasks(void)
+{
+	return numTasks;
+}
+
+Task_Handle Topology_task(Int index)
+{
+	if(index < 0 || index >= numTasks) {
+		return NULL;
+	}
+	return Task_handle(&topologyTasks[index]);
+}
@@ -0,0 +1,113 @@
+/*
+ * topology.h
+ *
+ * Runtime producer/consumer topology.
+ *
+ * The producer and consumer Tasks used to be static instances in empty.cfg (producerTask1/2,
+ * consumerTask1/2, 700 byte stacks each), so changing the load meant editing the configuration
+ * in the GUI and rebuilding it. They are now created by main, before BIOS_start, from a table of
+ * TopologyTask_T entries - handler function, id (arg0 of the handler), priority and stack size.
+ *
+ * The heap is disabled (BIOS.heapSize = 0), so the Tasks are constructed (Task_construct) into
+ * a static pool of TOPOLOGY_MAX_TASKS Task objects, and their stacks are carved out of a static
+ * stack pool of TOPOLOGY_STACK_POOL_SIZE bytes. An entry that does not fit either pool is not
+ * created - Topology_create returns the number of Tasks it did create.
+ *
+ * Every Task's env holds its role and id (Topology_workerRole/Topology_workerId), so code running
+ * in a worker's context - insert_item stamping an item with its producer id, for instance - can
+ * tell which worker it runs for without an extra parameter.
+ */
+
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Task.h>
+
+#ifndef TOPOLOGY_MAX_TASKS
+#define TOPOLOGY_MAX_TASKS			8		//Task objects in the pool
+#endif
+#ifndef TOPOLOGY_STACK_POOL_SIZE
+#define TOPOLOGY_STACK_POOL_SIZE	2800	//Bytes of stack for all of them (the 4 x 700 of the static Tasks)
+#endif
+
+
+/*
+ Enum TopologyRole_E - what a Task does in the topology.
+ */
+typedef enum
+{
+	topoNone_e = 0,			// not a topology Task (ledSrvTask, ...)
+	topoProducer_e = 1,
+	topoConsumer_e = 2,
+	topoStage_e = 3			// a worker of a multi-stage pipeline (stage.h)
+} TopologyRole_E;
+
+
+/*
+ Structure TopologyTask_T - one Task of the topology.
+ */
+typedef struct
+{
+	Task_FuncPtr fxn;		// producerHandler/consumerHandler
+	TopologyRole_E role;
+	CString name;			// instance name (ROV/logs), may be NULL
+	Int id;					// passed as arg0 - the producer/consumer id
+	UArg arg1;				// passed as arg1 - the pipeline's BoundedBuffer_Handle
+	Int priority;
+	SizeT stackSize;		// bytes, taken from the stack pool
+} TopologyTask_T;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Int Topology_create(const TopologyTask_T *tasks, Int n)
+
+ Constructs the n Tasks of the "tasks" table, in table order. Called from main before
+ BIOS_start (may also be called later, to add Tasks to a running system). Returns the number
+ of Tasks created - less than n when the Task or stack pool is exhausted.
+ */
+Int Topology_create(const TopologyTask_T *tasks, Int n);
+
+/*
+ Function: Int Topology_createUniform(Task_FuncPtr producerFxn, Int producers,
+ 	 	 	 	 	 	 	 	 	 	 Task_FuncPtr consumerFxn, Int consumers,
+ 	 	 	 	 	 	 	 	 	 	 Int priority, SizeT stackSize, UArg arg1)
+
+ The common case: "producers" producer Tasks with ids 1..producers and "consumers" consumer
+ Tasks with ids 1..consumers, all with the same priority, stack size and arg1. Producers and
+ consumers are interleaved (producer 1, consumer 1, producer 2, ...), so every pair starts in
+ the ready queue together. The Tasks are named "producer"/"consumer" - the id tells them
+ apart. Returns the number of Tasks created.
+ */
+Int Topology_createUniform(Task_FuncPtr producerFxn, Int producers,
+		Task_FuncPtr consumerFxn, Int consumers, Int priority, SizeT stackSize, UArg arg1);
+
+/*
+ Function: TopologyRole_E Topology_workerRole(Task_Handle task)
+ Function: Int Topology_workerId(Task_Handle task)
+
+ Role and id of a topology Task (topoNone_e and 0 for any other Task). Cheap enough for the
+ per-item path: both just decode the Task's env.
+ */
+TopologyRole_E Topology_workerRole(Task_Handle task);
+Int Topology_workerId(Task_Handle task);
+
+/*
+ Function: Int Topology_numTasks(void)
+
+ Number of Tasks created so far.
+ */
+Int Topology_numTasks(void);
+
+/*
+ Function: Task_Handle Topology_task(Int index)
+
+ Handle of the index-th created Task (0 based, in creation order), NULL if there is none.
+ */
+Task_Handle Topology_task(Int index);
+
+#endif /* TOPOLOGY_H_ */
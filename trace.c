@@ -0,0 +1,246 @@
+/*
+ * trace.c
+ *
+ * Binary event trace - see trace.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/knl/Task.h>
+#include <string.h>						//for memcpy of the dump header
+
+#include "trace.h"
+#include "topology.h"
+#include "record.h"
+#include "stackprof.h"
+
+#define TRACE_MASK	(TRACE_RING_SIZE - 1)
+
+/*
+ Structure TraceCell_T - one ring slot: the event and its sequence number (see MpmcCell_T).
+ */
+typedef struct
+{
+	RingIndex_T seq;
+	TraceEvent_T event;
+} TraceCell_T;
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ Trace counters, see TraceStats_T.
+ */
+TraceStats_T traceStats;
+
+static TraceCell_T traceCells[TRACE_RING_SIZE];
+static RingIndex_T traceTail;		// next position to write (CAS'ed by the writers)
+static RingIndex_T traceHead;		// next position to drain (drainer only)
+static Trace_SinkFxn traceSink = NULL;
+
+#if TRACE_DUMP_SIZE
+/*
+ The target's dump area, in USB RAM - NOLOAD, so Trace_init fills in the header.
+ */
+#if defined(__MSP430__)
+#pragma DATA_SECTION(traceDump, ".dumpram")
+#endif
+TraceDump_T traceDump;
+#endif
+
+static Task_Struct drainTaskObj;
+static UInt32 drainStack[TRACE_DRAIN_STACK_SIZE / sizeof(UInt32)];
+
+
+/*
+ * Function: Trace_init
+ * Description: empty the ring and clear the counters.
+ * Input: void
+ * Output: void
+ * Algorithm: slot i starts with sequence number i - free for the writer of position i. The
+ * 			  dump area gets its header and is emptied.
+*/
+Void Trace_init(void)
+{
+	UInt i = 0;
+#if TRACE_DUMP_SIZE
+	Types_FreqHz freq;
+
+	memset(&traceDump, 0, sizeof(traceDump));
+	memcpy(traceDump.header.magic, "PCTRACE1", sizeof(traceDump.header.magic));
+	Timestamp_getFreq(&freq);
+	traceDump.header.freq = freq.lo;
+	traceDump.header.ringSize = TRACE_RING_SIZE;
+#endif
+
+	for(i = 0 ; i < TRACE_RING_SIZE ; i++) {
+		RING_STORE_RELAXED(&traceCells[i].seq, i);
+	}
+	RING_STORE_RELAXED(&traceTail, 0);
+	RING_STORE_RELAXED(&traceHead, 0);
+	RING_STORE_RELAXED(&traceStats.dropped, 0);
+	traceStats.drained = 0;
+	traceStats.drainHighWater = 0;
+	traceStats.dumped = 0;
+}
+
+/*
+ * Function: Trace_event
+ * Description: write one event into the ring.
+ * Input: TraceEventId_E event, Int item.
+ * Output: void
+ * Algorithm: claim a position like MpmcRing_push - the slot's sequence number equals the
+ * 			  position when it is free for this lap, and a CAS of the tail makes it ours; a
+ * 			  sequence number behind the position means the ring is full (the drainer has not
+ * 			  freed the slot yet), so the event is dropped. The event is filled in and published
+ * 			  by the release store of the sequence number.
+*/
+Void Trace_event(TraceEventId_E event, Int item)
+{
+	Task_Handle self = Task_self();
+	TraceCell_T *cell;
+	UInt pos = RING_LOAD_RELAXED(&traceTail);
+	UInt dropped;
+
+	while(1) {
+		cell = &traceCells[pos & TRACE_MASK];
+		Int dif = (Int)(RING_LOAD_ACQUIRE(&cell->seq) - pos);
+		if(dif == 0) {
+			if(ringCas(&traceTail, pos, pos + 1)) {
+				break;
+			}
+		} else if(dif < 0) {
+			do {					// ring full - count the lost event
+				dropped = RING_LOAD_RELAXED(&traceStats.dropped);
+			} while(!ringCas(&traceStats.dropped, dropped, dropped + 1));
+			return;
+		}
+		pos = RING_LOAD_RELAXED(&traceTail);
+	}
+
+	cell->event.event = (UInt8)event;
+	cell->event.task = (UInt8)((Topology_workerRole(self) << 6) | (Topology_workerId(self) & 0x3F));
+	cell->event.item = (Int16)item;
+	cell->event.tick = Timestamp_get32();
+	RING_STORE_RELEASE(&cell->seq, pos + 1);
+}
+
+/*
+ * Function: Trace_drain
+ * Description: move the oldest events from the ring to dst.
+ * Input: TraceEvent_T *dst - receives the events, Int max - room in dst.
+ * Output: Int - number of events moved.
+ * Algorithm: MpmcRing_pop with a single consumer - no CAS on the head; a slot whose writer has
+ * 			  claimed it but not yet published it ends the drain (the next one picks it up).
+*/
+Int Trace_drain(TraceEvent_T *dst, Int max)
+{
+	UInt pos = RING_LOAD_RELAXED(&traceHead);
+	Int n = 0;
+
+	while(n < max) {
+		TraceCell_T *cell = &traceCells[pos & TRACE_MASK];
+		if(RING_LOAD_ACQUIRE(&cell->seq) != pos + 1) {
+			break;
+		}
+		dst[n] = cell->event;
+		RING_STORE_RELEASE(&cell->seq, pos + TRACE_RING_SIZE);	// free for the next lap
+		pos = pos + 1;
+		n = n + 1;
+	}
+	RING_STORE_RELAXED(&traceHead, pos);
+	return n;
+}
+
+Void Trace_setSink(Trace_SinkFxn fxn)
+{
+	traceSink = fxn;
+}
+
+/*
+ * Function: Trace_dumpSink
+ * Description: the RAM dump sink - append the events to traceDump.
+ * Input: const TraceEvent_T *events, Int n - the drained events.
+ * Output: void
+ * Algorithm: copy as many as fit; once traceDump is full the rest are only counted (drained).
+*/
+Void Trace_dumpSink(const TraceEvent_T *events, Int n)
+{
+#if TRACE_DUMP_SIZE
+	Int i = 0;
+
+	for(i = 0 ; i < n && traceStats.dumped < TRACE_DUMP_SIZE ; i++) {
+		traceDump.events[traceStats.dumped] = events[i];
+		traceStats.dumped = traceStats.dumped + 1;
+	}
+#else
+	(Void)events;
+	(Void)n;
+#endif
+}
+
+/*
+ * Function: Trace_flush
+ * Description: drain the whole ring into the sink.
+ * Input: void
+ * Output: void
+ * Algorithm: TRACE_DRAIN_BATCH events at a time, until the ring is empty.
+*/
+Void Trace_flush(void)
+{
+	TraceEvent_T batch[TRACE_DRAIN_BATCH];
+	UInt found = 0;
+	Int n = 0;
+
+	do {
+		n = Trace_drain(batch, TRACE_DRAIN_BATCH);
+		if(n > 0 && traceSink != NULL) {
+			traceSink(batch, n);
+		}
+		traceStats.drained = traceStats.drained + n;
+		found = found + n;
+	} while(n == TRACE_DRAIN_BATCH);
+
+	if(found > traceStats.drainHighWater) {
+		traceStats.drainHighWater = found;
+	}
+}
+
+/*
+ * Function: drainTaskHandler
+ * Description: the drain Task - empties the ring periodically.
+ * Input: UArg arg0, UArg arg1 - unused.
+ * Output: void
+ * Algorithm: flush both rings and poll the stack profiler, then sleep TRACE_DRAIN_TICKS Clock
+ * 			  ticks, forever.
+*/
+static Void drainTaskHandler(UArg arg0, UArg arg1)
+{
+	while(1) {
+		Trace_flush();
+		Record_flush();					// the interleaving record (record.h) shares the drain Task
+		StackProf_poll();				// and so does the stack profiler (stackprof.h)
+		Task_sleep(TRACE_DRAIN_TICKS);
+	}
+}
+
+/*
+ * Function: Trace_createDrainTask
+ * Description: construct the drain Task.
+ * Input: Int priority, SizeT stackSize - at most TRACE_DRAIN_STACK_SIZE.
+ * Output: Task_Handle - the drain Task.
+ * Algorithm: Task_construct from the static object and stack (no heap - BIOS.heapSize = 0).
+*/
+Task_Handle Trace_createDrainTask(Int priority, SizeT stackSize)
+{
+	Task_Params taskParams;
+
+	Task_Params_init(&taskParams);
+	taskParams.instance->name = "traceDrain";
+	taskParams.priority = priority;
+	taskParams.stack = (Ptr)drainStack;
+	taskParams.stackSize = (stackSize < sizeof(drainStack)) ? stackSize : sizeof(drainStack);
+	Task_construct(&drainTaskObj, drainTaskHandler, &taskParams, NULL);
+	return Task_handle(&drainTaskObj);
+}
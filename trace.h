@@ -0,0 +1,215 @@
+/*
+ * trace.h
+ *
+ * Binary event trace - a compact replacement for the per-item Log_info2 records.
+ *
+ * Every successful insert_item/remove_item used to emit two formatted Log records, one of them
+ * inside the mutex critical section, and LoggingSetup's 256 word main logger overflowed within
+ * seconds under load. The hot path now writes one fixed 8-byte TraceEvent_T instead:
+ *
+ *  - event id (TraceEventId_E), task (topology role and id), item, and a Timestamp_get32 tick;
+ *  - written AFTER the critical section, into a multi-producer ring of TRACE_RING_SIZE events
+ *    with a per-slot sequence number (the MpmcRing_T protocol of ring.h), so a writer never
+ *    blocks and never takes a lock - one compare-and-swap of the ring's tail;
+ *  - a full ring drops the new event and counts it (traceStats.dropped), it never stalls the
+ *    producers and consumers.
+ *
+ * A drain Task (Trace_createDrainTask) empties the ring every TRACE_DRAIN_TICKS Clock ticks and
+ * hands the events to a sink function (Trace_setSink). It runs at TRACE_DRAIN_PRIORITY (main.c),
+ * ABOVE the workers and below ledSrvTask, not below the workers: the workers have the lowest
+ * Task priority there is above the Idle Task's 0, so a drain below them would never run, and
+ * one at their priority would wait behind them for a time slice. The same Task empties the
+ * interleaving record (record.h), whose ring stops the recording for good once it overflows -
+ * so it drains every tick, and the MSP430 pays a Task switch and a short flush per 500 usec tick.
+ *
+ * The sinks: on the target main installs Trace_dumpSink, which copies the first TRACE_DUMP_SIZE
+ * events into traceDump - a RAM dump area in the MSP430F5529's USB RAM (the .dumpram section of
+ * the linker command file; the application doesn't use the USB module). Once it is full the
+ * events are counted and discarded. Save traceDump from the CCS memory browser as a binary file
+ * (TraceFileHeader_T plus 8 x traceStats.dumped bytes, or all of it - trace_decode.py skips the
+ * empty tail) and decode it with host/tools/trace_decode.py. The host build writes every event
+ * to a file instead (PC_TRACE, host/src/app_report.c). Without a sink the events are only
+ * counted.
+ *
+ * Dump format (what a sink should write, and what trace_decode.py reads): a TraceFileHeader_T
+ * ("PCTRACE1", Timestamp frequency), then the 8-byte events as they are in memory (little
+ * endian on both the MSP430 and x86 hosts).
+ *
+ * TRACE_EVENTS 0 compiles the events out.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <xdc/std.h>
+#include "ring.h"
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS		1		//1 - trace the hot path into the event ring, 0 - no tracing
+#endif
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE		64		//Events in the ring, a power of two
+#endif
+#ifndef TRACE_DRAIN_TICKS
+#define TRACE_DRAIN_TICKS	1		//Clock ticks the drain Task sleeps between two drains
+#endif
+#ifndef TRACE_DRAIN_STACK_SIZE
+#define TRACE_DRAIN_STACK_SIZE	512	//Bytes of the drain Task's static stack
+#endif
+#define TRACE_DRAIN_BATCH	16		//Events handed to the sink per call
+#ifndef TRACE_DUMP_SIZE
+#if defined(__MSP430__)
+#define TRACE_DUMP_SIZE		88		//Events of traceDump, the target's sink - in USB RAM next to recordDump
+#else
+#define TRACE_DUMP_SIZE		0		//No traceDump - the host writes PC_TRACE files
+#endif
+#endif
+
+#if (TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) != 0
+#error "TRACE_RING_SIZE must be a power of two"
+#endif
+
+
+/*
+ Enum TraceEventId_E - the traced events. Keep in sync with EVENTS in host/tools/trace_decode.py.
+ */
+typedef enum
+{
+	traceNone_e = 0,
+	traceInsert_e = 1,			// insert_item succeeded, item = the item
+	traceRemove_e = 2,			// remove_item succeeded, item = the item
+	traceInsertBatch_e = 3,		// insert_items succeeded, item = number of items
+	traceRemoveBatch_e = 4,		// remove_items succeeded, item = number of items
+	traceDrop_e = 5,			// insert_item gave the item up (backpressure drop or timeout), item = the item
+	traceSpool_e = 6,			// insert_item appended the item to the spool (spool.h), item = the item
+	traceUnspool_e = 7			// the item went from the spool into the buffer, item = the item
+} TraceEventId_E;
+
+
+/*
+ Structure TraceEvent_T - one 8-byte trace event.
+ */
+typedef struct
+{
+	UInt8 event;				// TraceEventId_E
+	UInt8 task;					// (topology role << 6) | topology id, 0 for other Tasks
+	Int16 item;
+	UInt32 tick;				// Timestamp_get32()
+} TraceEvent_T;
+
+
+/*
+ Structure TraceFileHeader_T - first 16 bytes of a trace dump.
+ */
+typedef struct
+{
+	Char magic[8];				// "PCTRACE1"
+	UInt32 freq;				// Timestamp ticks per second
+	UInt32 ringSize;			// TRACE_RING_SIZE
+} TraceFileHeader_T;
+
+
+/*
+ Structure TraceStats_T - trace counters (RAM, readable from ROV/the memory browser).
+ */
+typedef struct
+{
+	RingIndex_T dropped;		// events lost to a full ring
+	UInt32 drained;				// events handed to the sink (or discarded without one)
+	UInt drainHighWater;		// most events found in the ring by one drain
+	UInt dumped;				// events in traceDump
+} TraceStats_T;
+
+extern TraceStats_T traceStats;
+
+
+#if TRACE_DUMP_SIZE
+/*
+ Structure TraceDump_T - the target's RAM dump area: a trace dump as trace_decode.py reads it.
+ */
+typedef struct
+{
+	TraceFileHeader_T header;
+	TraceEvent_T events[TRACE_DUMP_SIZE];	// the first traceStats.dumped are valid, the rest are 0
+} TraceDump_T;
+
+extern TraceDump_T traceDump;
+#endif
+
+
+/*
+ Type Trace_SinkFxn - receives the drained events, called from the drain Task.
+ */
+typedef Void (*Trace_SinkFxn)(const TraceEvent_T *events, Int n);
+
+
+/*
+ TRACE_EVENT - what the hot path calls, nothing when TRACE_EVENTS is 0.
+ */
+#if TRACE_EVENTS
+#define TRACE_EVENT(event, item)	Trace_event((event), (item))
+#else
+#define TRACE_EVENT(event, item)
+#endif
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Trace_init(void)
+
+ Empties the ring and clears traceStats. Called from main before BIOS_start.
+ */
+Void Trace_init(void);
+
+/*
+ Function: Void Trace_event(TraceEventId_E event, Int item)
+
+ Writes one event for the calling Task. Lock-free, never blocks; safe from Task, Swi and Hwi
+ context. Drops (and counts) the event when the ring is full.
+ */
+Void Trace_event(TraceEventId_E event, Int item);
+
+/*
+ Function: Int Trace_drain(TraceEvent_T *dst, Int max)
+
+ Moves up to max events, oldest first, from the ring to dst and returns how many. Single
+ drainer only - the drain Task, or the host report once the Tasks are stopped.
+ */
+Int Trace_drain(TraceEvent_T *dst, Int max);
+
+/*
+ Function: Void Trace_setSink(Trace_SinkFxn fxn)
+
+ Sets the function the drain Task hands the events to (NULL - count and discard them).
+ */
+Void Trace_setSink(Trace_SinkFxn fxn);
+
+/*
+ Function: Void Trace_dumpSink(const TraceEvent_T *events, Int n)
+
+ The RAM dump sink (TRACE_DUMP_SIZE > 0): appends the events to traceDump until it is full.
+ */
+Void Trace_dumpSink(const TraceEvent_T *events, Int n);
+
+/*
+ Function: Void Trace_flush(void)
+
+ Drains the whole ring into the sink. Used by the drain Task, and by the host report at exit.
+ */
+Void Trace_flush(void);
+
+/*
+ Function: Task_Handle Trace_createDrainTask(Int priority, SizeT stackSize)
+
+ Constructs the drain Task ("traceDrain"), which also empties the interleaving record ring
+ (record.h) and samples the stack high-water marks (stackprof.h), from a static object and
+ stack - call it from main with a priority above the workers' WORKER_PRIORITY (see above) and
+ below ledSrvTask. stackSize is clipped to TRACE_DRAIN_STACK_SIZE.
+ Returns the Task.
+ */
+Task_Handle Trace_createDrainTask(Int priority, SizeT stackSize);
+
+#endif /* TRACE_H_ */
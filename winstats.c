@@ -0,0 +1,373 @@
+/*
+ * winstats.c
+ *
+ * Windowed statistics of the consumed items - see winstats.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <string.h>						//for memset
+
+#include "winstats.h"
+
+//-----------------------------------------
+// Globals
+//-----------------------------------------
+
+/*
+ The engine pool, and the number of engines taken from it.
+ */
+static WinStats_T engines[WINSTATS_MAX_ENGINES];
+static Int numOpen;
+
+
+/*
+ * Function: bucket
+ * Description: the histogram bucket of an item.
+ * Input: const WinStatsDef_T *def - the window, Int item.
+ * Output: Int - 0..WINSTATS_BUCKETS-1.
+ * Algorithm: a shift instead of a division, and clamps instead of branches - below the range
+ * 			  goes to the first bucket (a negative shift result), above it to the last.
+*/
+static inline Int bucket(const WinStatsDef_T *def, Int item)
+{
+	Int32 b = ((Int32)item - def->histLow) >> def->histShift;
+
+	b = (b < 0) ? 0 : b;
+	return (Int)((b > WINSTATS_BUCKETS - 1) ? WINSTATS_BUCKETS - 1 : b);
+}
+
+static inline Void accAdd(WinStatsAcc_T *acc, const WinStatsDef_T *def, Int item)
+{
+	Int b = bucket(def, item);
+
+	if(acc->count == 0 || item < acc->min) {
+		acc->min = item;
+	}
+	if(acc->count == 0 || item > acc->max) {
+		acc->max = item;
+	}
+	acc->count = acc->count + 1;
+	acc->sum = acc->sum + item;
+	acc->sumSq = acc->sumSq + (UInt32)((Int32)item * item);
+	acc->hist[b] = acc->hist[b] + 1;
+}
+
+/*
+ * Function: accMerge
+ * Description: add the totals of src to dst.
+ * Input: WinStatsAcc_T *dst, const WinStatsAcc_T *src.
+ * Output: void
+*/
+static Void accMerge(WinStatsAcc_T *dst, const WinStatsAcc_T *src)
+{
+	Int i = 0;
+
+	if(src->count == 0) {
+		return;
+	}
+	if(dst->count == 0 || src->min < dst->min) {
+		dst->min = src->min;
+	}
+	if(dst->count == 0 || src->max > dst->max) {
+		dst->max = src->max;
+	}
+	dst->count = dst->count + src->count;
+	dst->sum = dst->sum + src->sum;
+	dst->sumSq = dst->sumSq + src->sumSq;
+	for(i = 0 ; i < WINSTATS_BUCKETS ; i++) {
+		dst->hist[i] = dst->hist[i] + src->hist[i];
+	}
+}
+
+/*
+ * Function: accAddRun
+ * Description: add n (1 or more) items to a pane at once.
+ * Input: WinStatsAcc_T *acc - the pane, const WinStatsDef_T *def - its window, const Int *items, Int n.
+ * Output: void
+ * Algorithm: the totals of the run are reduced first, in a loop without branches or stores that
+ * 			  the host compiler vectorizes, then added to the pane's. The buckets are counted
+ * 			  item by item.
+*/
+static Void accAddRun(WinStatsAcc_T *acc, const WinStatsDef_T *def, const Int *items, Int n)
+{
+	Int32 sum = 0;
+	UInt64 sumSq = 0;
+	Int min = items[0];
+	Int max = items[0];
+	Int i = 0, b = 0;
+
+	for(i = 0 ; i < n ; i++) {
+		sum = sum + items[i];
+		sumSq = sumSq + (UInt32)((Int32)items[i] * items[i]);
+		min = (items[i] < min) ? items[i] : min;
+		max = (items[i] > max) ? items[i] : max;
+	}
+	for(i = 0 ; i < n ; i++) {
+		b = bucket(def, items[i]);
+		acc->hist[b] = acc->hist[b] + 1;
+	}
+	if(acc->count == 0 || min < acc->min) {
+		acc->min = min;
+	}
+	if(acc->count == 0 || max > acc->max) {
+		acc->max = max;
+	}
+	acc->count = acc->count + (UInt32)n;
+	acc->sum = acc->sum + sum;
+	acc->sumSq = acc->sumSq + sumSq;
+}
+
+/*
+ * Function: closePane
+ * Description: publish a window at the end of its current pane, and start the next pane.
+ * Input: WinStatsWindow_T *w - the window, UInt32 endTick - Clock tick the pane ended at.
+ * Output: void
+ * Algorithm: combine the current pane with the closed ones still in the window (up to
+ * 			  def->panes in all). Publish it: sequence number odd, copy 0, even, copy 1 (see
+ * 			  winstats.h) - a reader takes the copy the parity points at, which is never the one
+ * 			  being written. The next pane replaces the oldest one.
+*/
+static Void closePane(WinStatsWindow_T *w, UInt32 endTick)
+{
+	WinStatsSnapshot_T snap;
+	Int panes = w->def->panes;
+	Int p = w->current;
+	Int i = 0;
+	UInt seq;
+
+	snap.window = w->snapshot[1].window + 1;
+	snap.endTick = endTick;
+	snap.panes = (UInt8)(w->filled + 1);
+	snap.acc = w->pane[p];
+	for(i = 0 ; i < w->filled ; i++) {
+		p = (p + panes - 1) % panes;
+		accMerge(&snap.acc, &w->pane[p]);
+	}
+
+	seq = RING_LOAD_RELAXED(&w->seq);
+	RING_STORE_RELEASE(&w->seq, seq + 1);
+	RING_FENCE_RELEASE();
+	w->snapshot[0] = snap;
+	RING_STORE_RELEASE(&w->seq, seq + 2);
+	RING_FENCE_RELEASE();
+	w->snapshot[1] = snap;
+
+	if(w->filled < panes - 1) {
+		w->filled = w->filled + 1;
+	}
+	w->current = (w->current + 1) % panes;
+	memset(&w->pane[w->current], 0, sizeof(w->pane[w->current]));
+}
+
+/*
+ * Function: advanceTicks
+ * Description: close the panes of a tick window that ended before "now".
+ * Input: WinStatsWindow_T *w, UInt32 now - the current Clock tick.
+ * Output: void
+ * Algorithm: one close per pane length elapsed; after def->panes of them the window is empty,
+ * 			  so a longer gap only moves the pane start on, keeping it on a pane boundary.
+*/
+static Void advanceTicks(WinStatsWindow_T *w, UInt32 now)
+{
+	UInt32 length = w->def->paneLength;
+	Int closed = 0;
+
+	while(now - w->paneStart >= length) {
+		if(closed == w->def->panes) {
+			w->paneStart = now - (now - w->paneStart) % length;
+			break;
+		}
+		closePane(w, w->paneStart + length);
+		w->paneStart = w->paneStart + length;
+		closed = closed + 1;
+	}
+}
+
+Void WinStats_init(void)
+{
+	memset(engines, 0, sizeof(engines));
+	numOpen = 0;
+}
+
+/*
+ * Function: WinStats_open
+ * Description: take an engine from the pool.
+ * Input: const WinStatsDef_T *defs - the windows, Int numDefs - their number, Int owner - the caller's id.
+ * Output: WinStats_Handle - the engine, NULL if the pool is empty.
+ * Algorithm: the consumers open their engines as they start, so the pool index is taken in a
+ * 			  short Hwi_disable window. Windows without panes or pane length are left out, and a
+ * 			  sliding window has at most WINSTATS_MAX_PANES panes.
+*/
+WinStats_Handle WinStats_open(const WinStatsDef_T *defs, Int numDefs, Int owner)
+{
+	WinStats_Handle ws;
+	UInt32 now = Clock_getTicks();
+	UInt key;
+	Int i = 0;
+
+	key = Hwi_disable();
+	if(numOpen >= WINSTATS_MAX_ENGINES) {
+		Hwi_restore(key);
+		return NULL;
+	}
+	ws = &engines[numOpen];
+	numOpen = numOpen + 1;
+	Hwi_restore(key);
+
+	ws->owner = owner;
+	for(i = 0 ; i < numDefs && ws->numWindows < WINSTATS_MAX_WINDOWS ; i++) {
+		if(defs[i].panes == 0 || defs[i].panes > WINSTATS_MAX_PANES || defs[i].paneLength == 0) {
+			continue;
+		}
+		ws->window[ws->numWindows].def = &defs[i];
+		ws->window[ws->numWindows].paneStart = now;
+		if(defs[i].unit == winStatsTicks_e) {
+			ws->ticks = TRUE;
+		}
+		ws->numWindows = ws->numWindows + 1;
+	}
+	return ws;
+}
+
+/*
+ * Function: WinStats_add
+ * Description: add an item to every window of an engine.
+ * Input: WinStats_Handle ws - the caller's engine, Int item.
+ * Output: void
+ * Algorithm: a tick window first closes the panes that ended; the item goes to the current pane
+ * 			  of every window, and a count window closes its pane when it is full. The Clock is
+ * 			  read once, and only if there is a tick window.
+*/
+Void WinStats_add(WinStats_Handle ws, Int item)
+{
+	WinStatsWindow_T *w;
+	UInt32 now = 0;
+	Int i = 0;
+
+	if(ws == NULL) {
+		return;
+	}
+	if(ws->ticks) {
+		now = Clock_getTicks();
+	}
+	for(i = 0 ; i < ws->numWindows ; i++) {
+		w = &ws->window[i];
+		if(w->def->unit == winStatsTicks_e) {
+			advanceTicks(w, now);
+		}
+		accAdd(&w->pane[w->current], w->def, item);
+		if(w->def->unit == winStatsCount_e && w->pane[w->current].count >= w->def->paneLength) {
+			closePane(w, Clock_getTicks());
+		}
+	}
+	ws->items = ws->items + 1;
+}
+
+/*
+ * Function: WinStats_addBatch
+ * Description: add n items to every window of an engine.
+ * Input: WinStats_Handle ws - the caller's engine, const Int *items, Int n.
+ * Output: void
+ * Algorithm: a batch arrives at one Clock tick, so a tick window takes it as one run. A count
+ * 			  window takes it in runs that fill its current pane, closing the pane after each.
+*/
+Void WinStats_addBatch(WinStats_Handle ws, const Int *items, Int n)
+{
+	WinStatsWindow_T *w;
+	UInt32 now = 0;
+	UInt32 room;
+	Int i = 0, done = 0, run = 0;
+
+	if(ws == NULL || n <= 0) {
+		return;
+	}
+	if(ws->ticks) {
+		now = Clock_getTicks();
+	}
+	for(i = 0 ; i < ws->numWindows ; i++) {
+		w = &ws->window[i];
+		if(w->def->unit == winStatsTicks_e) {
+			advanceTicks(w, now);
+			accAddRun(&w->pane[w->current], w->def, items, n);
+			continue;
+		}
+		for(done = 0 ; done < n ; done = done + run) {
+			room = w->def->paneLength - w->pane[w->current].count;
+			run = ((UInt32)(n - done) < room) ? n - done : (Int)room;
+			accAddRun(&w->pane[w->current], w->def, items + done, run);
+			if(w->pane[w->current].count >= w->def->paneLength) {
+				closePane(w, Clock_getTicks());
+			}
+		}
+	}
+	ws->items = ws->items + n;
+}
+
+/*
+ * Function: WinStats_read
+ * Description: copy the newest published result of a window.
+ * Input: WinStats_Handle ws, Int window - its index, WinStatsSnapshot_T *snap - receives it.
+ * Output: Bool - FALSE if nothing was published yet (or there is no such window).
+ * Algorithm: an odd sequence number means copy 0 is being written and copy 1 is complete, an
+ * 			  even one the other way round. Copy that one, and take it if the number did not
+ * 			  change meanwhile - otherwise the owner published again, so try again.
+*/
+Bool WinStats_read(WinStats_Handle ws, Int window, WinStatsSnapshot_T *snap)
+{
+	WinStatsWindow_T *w;
+	UInt before, after;
+
+	if(ws == NULL || window < 0 || window >= ws->numWindows) {
+		return FALSE;
+	}
+	w = &ws->window[window];
+	do {
+		before = RING_LOAD_ACQUIRE(&w->seq);
+		*snap = w->snapshot[(before & 1) ? 1 : 0];
+		RING_FENCE_ACQUIRE();
+		after = RING_LOAD_RELAXED(&w->seq);
+	} while(before != after);
+	return (snap->window != 0) ? TRUE : FALSE;
+}
+
+Int32 WinStats_meanQ8(const WinStatsAcc_T *acc)
+{
+	if(acc->count == 0) {
+		return 0;
+	}
+	return (Int32)(((Int64)acc->sum * 256) / (Int64)acc->count);
+}
+
+/*
+ * Function: WinStats_varianceQ8
+ * Description: population variance of a window, times 256.
+ * Input: const WinStatsAcc_T *acc.
+ * Output: UInt32 - the variance in 1/256 units, 0 for an empty window.
+ * Algorithm: (sumSq - sum^2 / n) / n - sum^2 fits in 64 bits for any Int32 sum, and the
+ * 			  difference is at most sumSq, which leaves 8 bits for the fraction.
+*/
+UInt32 WinStats_varianceQ8(const WinStatsAcc_T *acc)
+{
+	UInt64 squares;
+
+	if(acc->count == 0) {
+		return 0;
+	}
+	squares = (UInt64)(((Int64)acc->sum * acc->sum) / (Int64)acc->count);
+	if(squares > acc->sumSq) {
+		return 0;								// truncation of an all-equal window
+	}
+	return (UInt32)(((acc->sumSq - squares) << 8) / acc->count);
+}
+
+Int WinStats_numOpen(void)
+{
+	return numOpen;
+}
+
+WinStats_Handle WinStats_get(Int index)
+{
+	return (index >= 0 && index < numOpen) ? &engines[index] : NULL;
+}
@@ -0,0 +1,202 @@
+/*
+ * winstats.h
+ *
+ * Windowed statistics of the consumed items - what a real consumer computes from its stream,
+ * without recomputing anything per item.
+ *
+ * A consumer opens an engine (WinStats_open) with a table of windows (WinStatsDef_T). Every
+ * item it removes goes to WinStats_add, or a batch of them to WinStats_addBatch, which updates
+ * every window in O(1) per item: count, sum, sum of squares, min, max and a fixed-bucket
+ * histogram. Mean and variance are derived from those when they are read (WinStats_meanQ8,
+ * WinStats_varianceQ8), so nothing is divided on the hot path.
+ *
+ * A window is made of panes of "paneLength" items (winStatsCount_e) or Clock ticks
+ * (winStatsTicks_e):
+ *
+ *  - panes 1: a tumbling window - the pane is the window;
+ *  - panes P > 1: a sliding window over the last P panes, advancing one pane at a time.
+ *
+ * When a pane closes, the window is combined from its P panes - O(P x WINSTATS_BUCKETS) once
+ * per pane, not per item - and published, and the oldest pane is reused for the next one. A
+ * tick pane closes at the first item after its end; the panes no item arrived in are closed
+ * empty at the same time.
+ *
+ * The published result of a window (WinStatsSnapshot_T) is kept in two copies behind a
+ * sequence number - a seqlock that never makes a reader wait for the writer. The consumer makes
+ * the number odd and writes copy 0, then makes it even and writes copy 1. WinStats_read copies
+ * the copy the number's parity says is complete and retries only if the number changed
+ * meanwhile. On one core a plain seqlock would hang a reporting Task of higher priority than the
+ * consumer it preempted halfway through a write; with two copies it finds a complete one, and
+ * the consumer never waits for a reader either.
+ *
+ * On the host build, WinStats_addBatch reduces each run of items with loops the compiler
+ * vectorizes (host/CMakeLists.txt builds winstats.c with the dynamic vectorizer cost model).
+ * The histogram is counted item by item on both builds.
+ *
+ * Items are expected in the range of the target's Int (16 bits): the sum is an Int32, which
+ * holds any 65535 of them. Each engine has a single writer - the Task that opened it. WINSTATS 0
+ * compiles the updates out.
+ */
+
+#ifndef WINSTATS_H_
+#define WINSTATS_H_
+
+#include <xdc/std.h>
+#include "ring.h"
+
+#ifndef WINSTATS
+#define WINSTATS				1		//1 - the consumers keep windowed statistics of their items, 0 - no statistics
+#endif
+#ifndef WINSTATS_MAX_ENGINES
+#define WINSTATS_MAX_ENGINES	2		//Engines in the static pool - one per consumer Task
+#endif
+#ifndef WINSTATS_MAX_WINDOWS
+#define WINSTATS_MAX_WINDOWS	2		//Windows per engine
+#endif
+#ifndef WINSTATS_MAX_PANES
+#define WINSTATS_MAX_PANES		4		//Panes of a sliding window
+#endif
+#ifndef WINSTATS_BUCKETS
+#define WINSTATS_BUCKETS		8		//Histogram buckets of a window
+#endif
+
+/*
+ WINSTATS_ADD/WINSTATS_ADD_BATCH - what the consumers call, nothing when WINSTATS is 0.
+ */
+#if WINSTATS
+#define WINSTATS_ADD(ws, item)			WinStats_add((ws), (item))
+#define WINSTATS_ADD_BATCH(ws, items, n)	WinStats_addBatch((ws), (items), (n))
+#else
+#define WINSTATS_ADD(ws, item)			((Void)0)
+#define WINSTATS_ADD_BATCH(ws, items, n)	((Void)0)
+#endif
+
+
+/*
+ Enum WinStatsUnit_E - what a window's panes are measured in.
+ */
+typedef enum
+{
+	winStatsCount_e = 0,		// items
+	winStatsTicks_e = 1			// Clock ticks
+} WinStatsUnit_E;
+
+/*
+ Structure WinStatsDef_T - one window of an engine's table.
+ */
+typedef struct
+{
+	UInt8 unit;					// WinStatsUnit_E
+	UInt8 panes;				// 1 - tumbling, 2..WINSTATS_MAX_PANES - sliding over that many panes
+	UInt16 paneLength;			// items or ticks per pane
+	Int histLow;				// lower edge of bucket 0 - smaller items are counted in it too
+	UInt8 histShift;			// buckets are 2^histShift wide, the last one is open ended
+} WinStatsDef_T;
+
+/*
+ Structure WinStatsAcc_T - the running totals of a pane or window.
+ */
+typedef struct
+{
+	UInt32 count;
+	Int32 sum;
+	UInt64 sumSq;				// sum of the squares
+	Int min;					// valid when count > 0
+	Int max;
+	UInt32 hist[WINSTATS_BUCKETS];
+} WinStatsAcc_T;
+
+/*
+ Structure WinStatsSnapshot_T - a published window.
+ */
+typedef struct
+{
+	UInt32 window;				// windows published so far, this one included
+	UInt32 endTick;				// Clock tick it was published at
+	UInt8 panes;				// panes it covers - fewer while a sliding window fills up
+	WinStatsAcc_T acc;
+} WinStatsSnapshot_T;
+
+/*
+ Structure WinStatsWindow_T - a window's panes and its published result.
+ */
+typedef struct
+{
+	const WinStatsDef_T *def;
+	WinStatsAcc_T pane[WINSTATS_MAX_PANES];	// ring of the last def->panes panes
+	Int current;				// the pane being filled
+	Int filled;					// panes closed so far, up to def->panes - 1
+	UInt32 paneStart;			// Clock tick the current pane started at (winStatsTicks_e)
+	RingIndex_T seq;			// odd while copy 0 is written, even while copy 1 is
+	volatile WinStatsSnapshot_T snapshot[2];
+} WinStatsWindow_T;
+
+/*
+ Structure WinStats_T - a consumer's engine.
+ */
+typedef struct
+{
+	Int owner;					// the consumer id given to WinStats_open
+	Int numWindows;
+	Bool ticks;					// some window is measured in Clock ticks
+	UInt32 items;				// items added
+	WinStatsWindow_T window[WINSTATS_MAX_WINDOWS];
+} WinStats_T, *WinStats_Handle;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void WinStats_init(void)
+
+ Empties the engine pool. Called from main before BIOS_start.
+ */
+Void WinStats_init(void);
+
+/*
+ Function: WinStats_Handle WinStats_open(const WinStatsDef_T *defs, Int numDefs, Int owner)
+
+ Takes an engine from the pool for the calling Task, with the first WINSTATS_MAX_WINDOWS windows
+ of defs (a static table - the engine keeps a pointer to it). NULL if the pool is empty;
+ WinStats_add and WinStats_addBatch ignore a NULL engine.
+ */
+WinStats_Handle WinStats_open(const WinStatsDef_T *defs, Int numDefs, Int owner);
+
+/*
+ Function: Void WinStats_add(WinStats_Handle ws, Int item)
+ Function: Void WinStats_addBatch(WinStats_Handle ws, const Int *items, Int n)
+
+ Add one item, or n items in their order, to every window of ws. Only the Task that opened ws.
+ */
+Void WinStats_add(WinStats_Handle ws, Int item);
+Void WinStats_addBatch(WinStats_Handle ws, const Int *items, Int n);
+
+/*
+ Function: Bool WinStats_read(WinStats_Handle ws, Int window, WinStatsSnapshot_T *snap)
+
+ Copies the newest published result of window "window" of ws - from any Task, without blocking
+ the engine's owner. FALSE if none was published yet.
+ */
+Bool WinStats_read(WinStats_Handle ws, Int window, WinStatsSnapshot_T *snap);
+
+/*
+ Function: Int32 WinStats_meanQ8(const WinStatsAcc_T *acc)
+ Function: UInt32 WinStats_varianceQ8(const WinStatsAcc_T *acc)
+
+ Mean and population variance of a window, times 256. 0 for an empty window.
+ */
+Int32 WinStats_meanQ8(const WinStatsAcc_T *acc);
+UInt32 WinStats_varianceQ8(const WinStatsAcc_T *acc);
+
+/*
+ Function: Int WinStats_numOpen(void)
+ Function: WinStats_Handle WinStats_get(Int index)
+
+ Number of engines opened so far, and the index-th one (NULL if there is none) - for reports.
+ */
+Int WinStats_numOpen(void);
+WinStats_Handle WinStats_get(Int index);
+
+#endif /* WINSTATS_H_ */
@@ -0,0 +1,144 @@
+/*
+ * workload.c
+ *
+ * Workload generators - see workload.h for the full description.
+ */
+
+#include <xdc/std.h>
+#include <string.h>						//for memset in workloadInit
+
+#include "workload.h"
+#include "record.h"
+
+#define WORKLOAD_MAX_GAP_FACTOR	16		// a Poisson gap is cut at 16 mean gaps (probability e^-16)
+
+
+/*
+ * Function: nextUniform
+ * Description: uniform items, no delay.
+ * Input: Workload_T *wl, UInt *delay.
+ * Output: Int - the item.
+ * Algorithm: Prng_below(maxVal).
+*/
+static Int nextUniform(Workload_T *wl, UInt *delay)
+{
+	*delay = 0;
+	return (Int)Prng_below(&wl->prng, (UInt)wl->maxVal);
+}
+
+/*
+ * Function: nextBursty
+ * Description: burstLen back to back items, then a burstGap ticks pause.
+ * Input: Workload_T *wl, UInt *delay.
+ * Output: Int - the item.
+ * Algorithm: the first item of every burst carries the pause before it.
+*/
+static Int nextBursty(Workload_T *wl, UInt *delay)
+{
+	*delay = 0;
+	if(wl->burstLeft == 0) {
+		wl->burstLeft = wl->burstLen;
+		*delay = wl->burstGap;
+	}
+	wl->burstLeft = wl->burstLeft - 1;
+	return (Int)Prng_below(&wl->prng, (UInt)wl->maxVal);
+}
+
+/*
+ * Function: nextPoisson
+ * Description: Poisson arrivals, meanGap ticks apart on average.
+ * Input: Workload_T *wl, UInt *delay.
+ * Output: Int - the item.
+ * Algorithm: count the ticks until a 1/meanGap per-tick trial succeeds (geometric gap, mean
+ * 			  meanGap), capped at WORKLOAD_MAX_GAP_FACTOR mean gaps.
+*/
+static Int nextPoisson(Workload_T *wl, UInt *delay)
+{
+	UInt gap = 0;
+	UInt limit = wl->meanGap * WORKLOAD_MAX_GAP_FACTOR;
+
+	if(wl->meanGap > 1) {
+		gap = 1;
+		while(gap < limit && Prng_below(&wl->prng, wl->meanGap) != 0) {
+			gap = gap + 1;
+		}
+	} else if(wl->meanGap == 1) {
+		gap = 1;
+	}
+	*delay = gap;
+	return (Int)Prng_below(&wl->prng, (UInt)wl->maxVal);
+}
+
+/*
+ * Function: nextReplay
+ * Description: the next step of the replay table, cyclically.
+ * Input: Workload_T *wl, UInt *delay.
+ * Output: Int - the item.
+ * Algorithm: table[pos], then pos = (pos + 1) wrapped at tableLen.
+*/
+static Int nextReplay(Workload_T *wl, UInt *delay)
+{
+	const WorkloadStep_T *step = &wl->table[wl->pos];
+
+	wl->pos = (wl->pos + 1 == wl->tableLen) ? 0 : wl->pos + 1;
+	*delay = step->delay;
+	return step->item;
+}
+
+/*
+ * Function: workloadInit
+ * Description: common part of the Workload_init* functions.
+ * Input: Workload_T *wl, WorkloadKind_E kind, Workload_NextFxn next, Int id - producer id, Int maxVal.
+ * Output: void
+ * Algorithm: clear, then seed the generator's PRNG from the id (spread by a large odd constant)
+ * 			  and Prng_entropy - recorded (record.h), so a replay gets the same items and delays.
+*/
+static Void workloadInit(Workload_T *wl, WorkloadKind_E kind, Workload_NextFxn next, Int id, Int maxVal)
+{
+	memset(wl, 0, sizeof(*wl));
+	wl->kind = kind;
+	wl->next = next;
+	wl->maxVal = (maxVal > 0) ? maxVal : 1;
+	Prng_seed(&wl->prng, ((UInt32)id * 0x9E3779B9u) ^ RECORD_ENTROPY(Prng_entropy()));
+}
+
+Void Workload_initUniform(Workload_T *wl, Int id, Int maxVal)
+{
+	workloadInit(wl, wlUniform_e, nextUniform, id, maxVal);
+}
+
+Void Workload_initBursty(Workload_T *wl, Int id, Int maxVal, UInt burstLen, UInt burstGap)
+{
+	workloadInit(wl, wlBursty_e, nextBursty, id, maxVal);
+	wl->burstLen = (burstLen > 0) ? burstLen : 1;
+	wl->burstGap = burstGap;
+}
+
+Void Workload_initPoisson(Workload_T *wl, Int id, Int maxVal, UInt meanGap)
+{
+	workloadInit(wl, wlPoisson_e, nextPoisson, id, maxVal);
+	wl->meanGap = meanGap;
+}
+
+Void Workload_initReplay(Workload_T *wl, Int id, const WorkloadStep_T *table, Int n)
+{
+	workloadInit(wl, wlReplay_e, nextReplay, id, 1);
+	wl->table = table;
+	wl->tableLen = n;
+	wl->pos = (n > 0 && id > 0) ? (id - 1) % n : 0;
+	if(n <= 0) {					// nothing to replay - fall back to uniform items
+		wl->kind = wlUniform_e;
+		wl->next = nextUniform;
+	}
+}
+
+Void Workload_initCustom(Workload_T *wl, Int id, Int maxVal, Workload_NextFxn fxn, Ptr ctx)
+{
+	workloadInit(wl, wlCustom_e, fxn, id, maxVal);
+	wl->ctx = ctx;
+}
+
+Int Workload_next(Workload_T *wl, UInt *delay)
+{
+	return wl->next(wl, delay);
+}
@@ -0,0 +1,112 @@
+/*
+ * workload.h
+ *
+ * Workload generators - what a producer inserts, and when.
+ *
+ * A producer asks its Workload_T for the next item with Workload_next, which also returns how
+ * many Clock ticks the producer should wait (Task_sleep) before inserting it. The built-in
+ * generators, all driven by the producer's own Prng_T (prng.h):
+ *
+ *  - wlUniform_e: items uniform in [0, maxVal), back to back - the original producer behaviour;
+ *  - wlBursty_e: bursts of burstLen back to back items, separated by burstGap idle ticks;
+ *  - wlPoisson_e: Poisson arrivals with a mean of meanGap ticks between items - the gap is the
+ *    number of ticks until a per-tick Bernoulli trial with probability 1/meanGap succeeds, the
+ *    discrete (geometric) form of the exponential inter-arrival time;
+ *  - wlReplay_e: a recorded WorkloadStep_T table of (item, delay) pairs, replayed cyclically.
+ *
+ * Any other traffic shape plugs in with Workload_initCustom: a Workload_NextFxn of its own and
+ * a context pointer, called exactly like the built-in ones.
+ */
+
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+
+#include <xdc/std.h>
+
+#include "prng.h"
+
+
+/*
+ Enum WorkloadKind_E - the built-in generators.
+ */
+typedef enum
+{
+	wlUniform_e = 0,
+	wlBursty_e = 1,
+	wlPoisson_e = 2,
+	wlReplay_e = 3,
+	wlCustom_e = 4
+} WorkloadKind_E;
+
+
+/*
+ Structure WorkloadStep_T - one step of a replay table.
+ */
+typedef struct
+{
+	Int item;
+	UInt delay;					// Clock ticks to wait before inserting item
+} WorkloadStep_T;
+
+
+struct Workload_T;
+
+/*
+ Type Workload_NextFxn - returns the next item and stores the ticks to wait before it in *delay.
+ */
+typedef Int (*Workload_NextFxn)(struct Workload_T *wl, UInt *delay);
+
+
+/*
+ Structure Workload_T - a generator instance, owned by one producer Task.
+ */
+typedef struct Workload_T
+{
+	WorkloadKind_E kind;
+	Workload_NextFxn next;
+	Prng_T prng;
+	Int maxVal;					// items are drawn from [0, maxVal)
+
+	UInt burstLen;				// wlBursty_e
+	UInt burstGap;
+	UInt burstLeft;				// items left in the current burst
+
+	UInt meanGap;				// wlPoisson_e, ticks
+
+	const WorkloadStep_T *table;	// wlReplay_e
+	Int tableLen;
+	Int pos;
+
+	Ptr ctx;					// wlCustom_e
+} Workload_T;
+
+
+//-----------------------------------------
+// Prototypes
+//-----------------------------------------
+
+/*
+ Function: Void Workload_initUniform(Workload_T *wl, Int id, Int maxVal)
+ Function: Void Workload_initBursty(Workload_T *wl, Int id, Int maxVal, UInt burstLen, UInt burstGap)
+ Function: Void Workload_initPoisson(Workload_T *wl, Int id, Int maxVal, UInt meanGap)
+ Function: Void Workload_initReplay(Workload_T *wl, Int id, const WorkloadStep_T *table, Int n)
+ Function: Void Workload_initCustom(Workload_T *wl, Int id, Int maxVal, Workload_NextFxn fxn, Ptr ctx)
+
+ Set up a generator for producer id. The Prng_T is seeded from id and Prng_entropy, so call
+ them from the producer Task. A replay starts at table step (id - 1) % n, so producers replaying
+ the same table do not run in lock step.
+ */
+Void Workload_initUniform(Workload_T *wl, Int id, Int maxVal);
+Void Workload_initBursty(Workload_T *wl, Int id, Int maxVal, UInt burstLen, UInt burstGap);
+Void Workload_initPoisson(Workload_T *wl, Int id, Int maxVal, UInt meanGap);
+Void Workload_initReplay(Workload_T *wl, Int id, const WorkloadStep_T *table, Int n);
+Void Workload_initCustom(Workload_T *wl, Int id, Int maxVal, Workload_NextFxn fxn, Ptr ctx);
+
+/*
+ Function: Int Workload_next(Workload_T *wl, UInt *delay)
+
+ Next item of the workload, and in *delay the Clock ticks to wait before inserting it.
+ */
+Int Workload_next(Workload_T *wl, UInt *delay);
+
+#endif /* WORKLOAD_H_ */